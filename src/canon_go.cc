@@ -14,6 +14,7 @@
 #include "rs274ngc.h"		// rs274ngc_sequence_number()
 #include "taskintf.h"		// task_interplist
 #include "interplist.h"
+#include "canon_go.h"
 
 static bool dbflag = false;
 
@@ -120,6 +121,288 @@ static double interp_per_go_angle = DEG_PER_RAD;
 #define GO_TO_INTERP_ANGLE(go) ((go)*interp_per_go_angle)
 #define INTERP_TO_GO_ANGLE(in) ((in)*go_per_interp_angle)
 
+// In continuous mode (G64), moves blend into the next using the traj
+// controller's configured tolerance; exact stop and exact path modes
+// (G61.1, G61) stop at the end of each move.
+static double go_blend_tol()
+{
+  return (_motion_mode IS CANON_CONTINUOUS) ? -1.0 : 0.0;
+}
+
+/*
+  Segment compression. With canon_compress_tol positive, STRAIGHT_FEED
+  holds back runs of feeds that translate with the same speed, blend
+  tolerance and orientation, and when a run ends puts fewer, longer
+  moves on the interp list in their place: lines through points that
+  are nearly collinear, and arcs through points that lie nearly on a
+  circle, each passing within the tolerance of every point it replaces
+  and of the middle of every chord between them. Anything else put on
+  the interp list ends the run first, so the moves stay in order.
+*/
+
+/*
+  The tolerance, in meters, defined in taskmain.c and set from [TASK]
+  COMPRESS_TOL. Zero leaves feeds as they are.
+*/
+extern "C" double canon_compress_tol;
+
+#define COMPRESS_RUN_MAX 64
+
+// [0] is where the run starts, [1..compress_number] where each feed ends
+static go_cart compress_point[COMPRESS_RUN_MAX + 1];
+static go_integer compress_id[COMPRESS_RUN_MAX + 1];
+static int compress_number = 0;
+// the last feed held back, the pattern for what replaces the run
+static interplist_type compress_val;
+static canon_go_compress_stats compress_stats = {0, 0, 0, 0.0};
+
+// distance from 'p' to the segment from 'a' to 'b', and where along the
+// segment it projects, scaled so 'b' is at the segment length
+static go_real compress_line_dist(const go_cart *a, const go_cart *b,
+				  const go_cart *p, go_real *along)
+{
+  go_cart ab, ap, perp;
+  go_real len, t, d;
+
+  go_cart_cart_sub(b, a, &ab);
+  go_cart_cart_sub(p, a, &ap);
+  go_cart_mag(&ab, &len);
+  if (len < GO_REAL_EPSILON) {
+    *along = 0;
+    go_cart_mag(&ap, &d);
+    return d;
+  }
+  go_cart_cart_dot(&ap, &ab, &t);
+  t /= len;
+  *along = t;
+  if (t < 0) {
+    go_cart_mag(&ap, &d);
+    return d;
+  }
+  if (t > len) {
+    go_cart_cart_sub(p, b, &ap);
+    go_cart_mag(&ap, &d);
+    return d;
+  }
+  go_cart_scale_mult(&ab, t / len, &perp);
+  go_cart_cart_sub(&ap, &perp, &perp);
+  go_cart_mag(&perp, &d);
+  return d;
+}
+
+/*
+  Returns 1 if a line from point 'from' to 'to' passes within the
+  tolerance of every point between, moving forward along it, else 0.
+  Sets 'dev' to the furthest point.
+*/
+static int compress_line_fits(int from, int to, go_real *dev)
+{
+  go_real d, along, last;
+  int k;
+
+  *dev = 0;
+  last = 0;
+  for (k = from + 1; k < to; k++) {
+    d = compress_line_dist(&compress_point[from], &compress_point[to],
+			   &compress_point[k], &along);
+    if (d > canon_compress_tol || along < last) return 0;
+    if (d > *dev) *dev = d;
+    last = along;
+  }
+
+  return 1;
+}
+
+// distance from 'p' to the circle of radius 'r' about 'center' in the
+// plane with unit normal 'normal'
+static go_real compress_circle_dist(const go_cart *center,
+				    const go_cart *normal, go_real r,
+				    const go_cart *p)
+{
+  go_cart v, inplane;
+  go_real h, rad;
+
+  go_cart_cart_sub(p, center, &v);
+  go_cart_cart_dot(&v, normal, &h);
+  go_cart_scale_mult(normal, h, &inplane);
+  go_cart_cart_sub(&v, &inplane, &inplane);
+  go_cart_mag(&inplane, &rad);
+  rad -= r;
+
+  return sqrt(h * h + rad * rad);
+}
+
+/*
+  Returns 1 if the arc through points 'from', the middle one and 'to'
+  passes within the tolerance of every point between and of the middle
+  of each chord, sweeping the same way less than a full turn, else 0.
+  Sets 'center', 'normal' and 'dev' for the arc that fits.
+*/
+static int compress_arc_fits(int from, int to, go_cart *center,
+			     go_cart *normal, go_real *dev)
+{
+  const go_cart *pa = &compress_point[from];
+  const go_cart *pb = &compress_point[(from + to) / 2];
+  const go_cart *pc = &compress_point[to];
+  go_cart a, b, n, v1, v2, w;
+  go_real aa, bb, nn, r, d, s, c, sweep;
+  int k;
+
+  // the circumcenter of the three points
+  go_cart_cart_sub(pa, pc, &a);
+  go_cart_cart_sub(pb, pc, &b);
+  go_cart_cart_cross(&a, &b, &n);
+  go_cart_cart_dot(&a, &a, &aa);
+  go_cart_cart_dot(&b, &b, &bb);
+  go_cart_cart_dot(&n, &n, &nn);
+  if (nn <= GO_REAL_EPSILON * aa * bb) return 0;
+  go_cart_scale_mult(&b, aa, &v1);
+  go_cart_scale_mult(&a, bb, &v2);
+  go_cart_cart_sub(&v1, &v2, &v1);
+  go_cart_cart_cross(&v1, &n, &w);
+  go_cart_scale_mult(&w, 0.5 / nn, &w);
+  go_cart_cart_add(pc, &w, center);
+  go_cart_mag(&w, &r);
+
+  // the normal points the way that makes the motion counterclockwise
+  go_cart_cart_sub(pb, pa, &v1);
+  go_cart_cart_sub(pc, pb, &v2);
+  go_cart_cart_cross(&v1, &v2, &n);
+  go_cart_mag(&n, &d);
+  if (d <= 0) return 0;
+  go_cart_scale_mult(&n, 1 / d, normal);
+
+  *dev = 0;
+  sweep = 0;
+  for (k = from; k < to; k++) {
+    d = compress_circle_dist(center, normal, r, &compress_point[k + 1]);
+    if (d > *dev) *dev = d;
+    go_cart_cart_add(&compress_point[k], &compress_point[k + 1], &w);
+    go_cart_scale_mult(&w, 0.5, &w);
+    d = compress_circle_dist(center, normal, r, &w);
+    if (d > *dev) *dev = d;
+    if (*dev > canon_compress_tol) return 0;
+    go_cart_cart_sub(&compress_point[k], center, &v1);
+    go_cart_cart_sub(&compress_point[k + 1], center, &v2);
+    go_cart_cart_cross(&v1, &v2, &w);
+    go_cart_cart_dot(&w, normal, &s);
+    go_cart_cart_dot(&v1, &v2, &c);
+    if (s <= 0) return 0;
+    sweep += atan2(s, c);
+  }
+  if (sweep >= GO_2_PI) return 0;
+
+  return 1;
+}
+
+// puts what replaces the held-back run on the interp list, and empties it
+static void compress_flush()
+{
+  interplist_type val;
+  go_cart center, normal;
+  go_real line_dev, arc_dev, dev;
+  int from, line_to, arc_to, to;
+
+  val = compress_val;
+  from = 0;
+  while (from < compress_number) {
+    // the longest line from here, at least one chord
+    for (line_to = from + 1;
+	 line_to < compress_number &&
+	   compress_line_fits(from, line_to + 1, &dev);
+	 line_to++);
+    compress_line_fits(from, line_to, &line_dev);
+    // the longest arc from here, at least three chords
+    arc_to = from;
+    for (to = from + 3; to <= compress_number; to++) {
+      if (! compress_arc_fits(from, to, &center, &normal, &dev)) break;
+      arc_to = to;
+    }
+    if (arc_to > line_to) {
+      compress_arc_fits(from, arc_to, &center, &normal, &arc_dev);
+      val.u.move_world.type = GO_MOTION_CIRCULAR;
+      val.u.move_world.center = center;
+      val.u.move_world.normal = normal;
+      val.u.move_world.turns = 0;
+      to = arc_to;
+      dev = arc_dev;
+      compress_stats.arcs++;
+    } else {
+      val.u.move_world.type = GO_MOTION_LINEAR;
+      to = line_to;
+      dev = line_dev;
+    }
+    val.u.move_world.id = compress_id[to];
+    val.u.move_world.end.tran = compress_point[to];
+    interplist_put(&task_interplist, val);
+    compress_stats.out++;
+    if (dev > compress_stats.deviation) compress_stats.deviation = dev;
+    from = to;
+  }
+
+  compress_number = 0;
+}
+
+// puts 'val' on the interp list, after anything held back
+static void canon_put(interplist_type val)
+{
+  if (compress_number > 0) {
+    // the run was put after its own wait, and nothing since has used
+    // the tool, so another wait would be a no-op
+    if (TASK_EXEC_WAIT_FOR_TOOL_TYPE == val.type) return;
+    compress_flush();
+  }
+  interplist_put(&task_interplist, val);
+}
+
+// holds back the feed 'val' from 'start', or puts it if not compressing
+static void compress_put(interplist_type val, const go_cart *start)
+{
+  traj_cmd_move_world *last = &compress_val.u.move_world;
+
+  compress_stats.in++;
+  if (canon_compress_tol <= 0) {
+    canon_put(val);
+    compress_stats.out++;
+    return;
+  }
+
+  if (compress_number > 0 &&
+      (val.u.move_world.tv != last->tv ||
+       val.u.move_world.rv != last->rv ||
+       val.u.move_world.tol != last->tol ||
+       ! go_quat_quat_compare(&val.u.move_world.end.rot, &last->end.rot))) {
+    compress_flush();
+  }
+  if (0 == compress_number) {
+    compress_point[0] = *start;
+  }
+  compress_number++;
+  compress_point[compress_number] = val.u.move_world.end.tran;
+  compress_id[compress_number] = val.u.move_world.id;
+  compress_val = val;
+  if (COMPRESS_RUN_MAX == compress_number) compress_flush();
+}
+
+void canon_go_flush(void)
+{
+  if (compress_number > 0) compress_flush();
+}
+
+void canon_go_reset(void)
+{
+  compress_number = 0;
+  compress_stats.in = 0;
+  compress_stats.out = 0;
+  compress_stats.arcs = 0;
+  compress_stats.deviation = 0;
+}
+
+void canon_go_stats(canon_go_compress_stats *stats)
+{
+  *stats = compress_stats;
+}
+
 /*
   Canonical "do it" functions.
 */
@@ -248,16 +531,16 @@ void STRAIGHT_TRAVERSE
 #endif
   
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.traj_cmd.type = TRAJ_CMD_MOVE_WORLD_TYPE;
-  val.u.traj_cmd.u.move_world.id = rs274ngc_sequence_number();
-  val.u.traj_cmd.u.move_world.type = GO_MOTION_LINEAR;
-  val.u.traj_cmd.u.move_world.tv = FLT_MAX;
-  val.u.traj_cmd.u.move_world.rv = FLT_MAX;
-  val.u.traj_cmd.u.move_world.end.tran.x = go_x;
-  val.u.traj_cmd.u.move_world.end.tran.y = go_y;
-  val.u.traj_cmd.u.move_world.end.tran.z = go_z;
+  val.type = TRAJ_CMD_MOVE_WORLD_TYPE;
+  val.u.move_world.id = rs274ngc_sequence_number();
+  val.u.move_world.type = GO_MOTION_LINEAR;
+  val.u.move_world.tv = FLT_MAX;
+  val.u.move_world.rv = FLT_MAX;
+  val.u.move_world.end.tran.x = go_x;
+  val.u.move_world.end.tran.y = go_y;
+  val.u.move_world.end.tran.z = go_z;
 
 #ifdef USE_ZYZ
 
@@ -299,9 +582,10 @@ void STRAIGHT_TRAVERSE
 
 #endif
 
-  val.u.traj_cmd.u.move_world.end.rot = quat;
-  val.u.traj_cmd.u.move_world.time = -1;
-  interplist_put(&task_interplist, val);
+  val.u.move_world.end.rot = quat;
+  val.u.move_world.tol = go_blend_tol();
+  val.u.move_world.time = -1;
+  canon_put(val);
 
   _program_position_x SET_TO x;
   _program_position_y SET_TO y;
@@ -515,35 +799,35 @@ void ARC_FEED
 #endif
   
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.traj_cmd.type = TRAJ_CMD_MOVE_WORLD_TYPE;
-  val.u.traj_cmd.u.move_world.id = rs274ngc_sequence_number();
-  val.u.traj_cmd.u.move_world.type = GO_MOTION_CIRCULAR;
+  val.type = TRAJ_CMD_MOVE_WORLD_TYPE;
+  val.u.move_world.id = rs274ngc_sequence_number();
+  val.u.move_world.type = GO_MOTION_CIRCULAR;
 
   if (fabs(x - _program_position_x) < FLT_EPSILON &&
       fabs(y - _program_position_y) < FLT_EPSILON &&
       fabs(z - _program_position_z) < FLT_EPSILON) {
     // no translation, so let angular motion dictate speed
-    val.u.traj_cmd.u.move_world.tv = FLT_MAX;
-    val.u.traj_cmd.u.move_world.rv = _go_angular_feed_rate;
+    val.u.move_world.tv = FLT_MAX;
+    val.u.move_world.rv = _go_angular_feed_rate;
   } else {
     // some translation, so let that dictate speed
-    val.u.traj_cmd.u.move_world.tv = _go_linear_feed_rate;
-    val.u.traj_cmd.u.move_world.rv = FLT_MAX;
+    val.u.move_world.tv = _go_linear_feed_rate;
+    val.u.move_world.rv = FLT_MAX;
   }
   // the ta and tj params will be written by the task controller
   // ditto for the ra and rj params
-  val.u.traj_cmd.u.move_world.end.tran.x = go_end_x;
-  val.u.traj_cmd.u.move_world.end.tran.y = go_end_y;
-  val.u.traj_cmd.u.move_world.end.tran.z = go_end_z;
-  val.u.traj_cmd.u.move_world.center.x = go_center_x;
-  val.u.traj_cmd.u.move_world.center.y = go_center_y;
-  val.u.traj_cmd.u.move_world.center.z = go_center_z;
-  val.u.traj_cmd.u.move_world.normal.x = go_normal_x;
-  val.u.traj_cmd.u.move_world.normal.y = go_normal_y;
-  val.u.traj_cmd.u.move_world.normal.z = go_normal_z;
-  val.u.traj_cmd.u.move_world.turns = go_turns;
+  val.u.move_world.end.tran.x = go_end_x;
+  val.u.move_world.end.tran.y = go_end_y;
+  val.u.move_world.end.tran.z = go_end_z;
+  val.u.move_world.center.x = go_center_x;
+  val.u.move_world.center.y = go_center_y;
+  val.u.move_world.center.z = go_center_z;
+  val.u.move_world.normal.x = go_normal_x;
+  val.u.move_world.normal.y = go_normal_y;
+  val.u.move_world.normal.z = go_normal_z;
+  val.u.move_world.turns = go_turns;
 
 #ifdef USE_ZYZ
 
@@ -585,9 +869,10 @@ void ARC_FEED
 
 #endif
 
-  val.u.traj_cmd.u.move_world.end.rot = quat;
-  val.u.traj_cmd.u.move_world.time = -1;
-  interplist_put(&task_interplist, val);
+  val.u.move_world.end.rot = quat;
+  val.u.move_world.tol = go_blend_tol();
+  val.u.move_world.time = -1;
+  canon_put(val);
 
   _program_position_x SET_TO x;
   _program_position_y SET_TO y;
@@ -655,6 +940,8 @@ void STRAIGHT_FEED
   go_rpy rpy;
 #endif
   go_quat quat;
+  go_cart start;
+  bool rotates = false;
   interplist_type val;
 
   go_x SET_TO INTERP_TO_GO_LENGTH(x - _program_origin_x);
@@ -671,28 +958,28 @@ void STRAIGHT_FEED
 #endif
   
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.traj_cmd.type = TRAJ_CMD_MOVE_WORLD_TYPE;
-  val.u.traj_cmd.u.move_world.id = rs274ngc_sequence_number();
-  val.u.traj_cmd.u.move_world.type = GO_MOTION_LINEAR;
+  val.type = TRAJ_CMD_MOVE_WORLD_TYPE;
+  val.u.move_world.id = rs274ngc_sequence_number();
+  val.u.move_world.type = GO_MOTION_LINEAR;
 
   if (fabs(x - _program_position_x) < FLT_EPSILON &&
       fabs(y - _program_position_y) < FLT_EPSILON &&
       fabs(z - _program_position_z) < FLT_EPSILON) {
     // no translation, so let angular motion dictate speed
-    val.u.traj_cmd.u.move_world.tv = FLT_MAX;
-    val.u.traj_cmd.u.move_world.rv = _go_angular_feed_rate;
+    val.u.move_world.tv = FLT_MAX;
+    val.u.move_world.rv = _go_angular_feed_rate;
   } else {
     // some translation, so let that dictate speed
-    val.u.traj_cmd.u.move_world.tv = _go_linear_feed_rate;
-    val.u.traj_cmd.u.move_world.rv = FLT_MAX;
+    val.u.move_world.tv = _go_linear_feed_rate;
+    val.u.move_world.rv = FLT_MAX;
   }
   // the ta and tj params will be written by the task controller
   // ditto for the ra and rj params
-  val.u.traj_cmd.u.move_world.end.tran.x = go_x;
-  val.u.traj_cmd.u.move_world.end.tran.y = go_y;
-  val.u.traj_cmd.u.move_world.end.tran.z = go_z;
+  val.u.move_world.end.tran.x = go_x;
+  val.u.move_world.end.tran.y = go_y;
+  val.u.move_world.end.tran.z = go_z;
 
 #ifdef USE_ZYZ
 
@@ -734,9 +1021,28 @@ void STRAIGHT_FEED
 
 #endif
 
-  val.u.traj_cmd.u.move_world.end.rot = quat;
-  val.u.traj_cmd.u.move_world.time = -1;
-  interplist_put(&task_interplist, val);
+  val.u.move_world.end.rot = quat;
+  val.u.move_world.tol = go_blend_tol();
+  val.u.move_world.time = -1;
+
+#ifdef AA
+  if (fabs(a - _program_position_a) >= FLT_EPSILON) rotates = true;
+#endif
+#ifdef BB
+  if (fabs(b - _program_position_b) >= FLT_EPSILON) rotates = true;
+#endif
+#ifdef CC
+  if (fabs(c - _program_position_c) >= FLT_EPSILON) rotates = true;
+#endif
+  if (val.u.move_world.rv == FLT_MAX && ! rotates) {
+    // pure translation, which may be merged with its neighbors
+    start.x = INTERP_TO_GO_LENGTH(_program_position_x - _program_origin_x);
+    start.y = INTERP_TO_GO_LENGTH(_program_position_y - _program_origin_y);
+    start.z = INTERP_TO_GO_LENGTH(_program_position_z - _program_origin_z);
+    compress_put(val, &start);
+  } else {
+    canon_put(val);
+  }
 
   _program_position_x SET_TO x;
   _program_position_y SET_TO y;
@@ -832,26 +1138,26 @@ void STRAIGHT_PROBE
 #endif
   
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
   // this is the same as for a STRAIGHT_FEED
 
-  val.type = val.u.traj_cmd.type = TRAJ_CMD_MOVE_WORLD_TYPE;
-  val.u.traj_cmd.u.move_world.id = rs274ngc_sequence_number();
-  val.u.traj_cmd.u.move_world.type = GO_MOTION_LINEAR;
+  val.type = TRAJ_CMD_MOVE_WORLD_TYPE;
+  val.u.move_world.id = rs274ngc_sequence_number();
+  val.u.move_world.type = GO_MOTION_LINEAR;
 
   if (fabs(x - _program_position_x) < FLT_EPSILON &&
       fabs(y - _program_position_y) < FLT_EPSILON &&
       fabs(z - _program_position_z) < FLT_EPSILON) {
-    val.u.traj_cmd.u.move_world.tv = FLT_MAX;
-    val.u.traj_cmd.u.move_world.rv = _go_angular_feed_rate;
+    val.u.move_world.tv = FLT_MAX;
+    val.u.move_world.rv = _go_angular_feed_rate;
   } else {
-    val.u.traj_cmd.u.move_world.tv = _go_linear_feed_rate;
-    val.u.traj_cmd.u.move_world.rv = FLT_MAX;
+    val.u.move_world.tv = _go_linear_feed_rate;
+    val.u.move_world.rv = FLT_MAX;
   }
-  val.u.traj_cmd.u.move_world.end.tran.x = go_x;
-  val.u.traj_cmd.u.move_world.end.tran.y = go_y;
-  val.u.traj_cmd.u.move_world.end.tran.z = go_z;
+  val.u.move_world.end.tran.x = go_x;
+  val.u.move_world.end.tran.y = go_y;
+  val.u.move_world.end.tran.z = go_z;
 
 #ifdef USE_ZYZ
 
@@ -893,9 +1199,15 @@ void STRAIGHT_PROBE
 
 #endif
 
-  val.u.traj_cmd.u.move_world.end.rot = quat;
-  val.u.traj_cmd.u.move_world.time = -1;
-  interplist_put(&task_interplist, val);
+  val.u.move_world.end.rot = quat;
+  val.u.move_world.tol = 0; // probe moves always stop
+  val.u.move_world.time = -1;
+  canon_put(val);
+
+  // the probe result isn't known until the move is done, so don't
+  // let the interpreter read ahead of it
+  val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
+  canon_put(val);
 
   dx SET_TO (_program_position_x - x);
   dy SET_TO (_program_position_y - y);
@@ -955,9 +1267,9 @@ void DWELL(double seconds)
 {
   interplist_type val;
 
-  val.type = val.u.task_cmd.type = TASK_EXEC_DELAY_TYPE;
-  val.u.task_cmd.u.delay.time = seconds;
-  interplist_put(&task_interplist, val);
+  val.type = TASK_EXEC_DELAY_TYPE;
+  val.u.delay.time = seconds;
+  canon_put(val);
 }
 
 /* Spindle Functions */
@@ -971,14 +1283,14 @@ void START_SPINDLE_CLOCKWISE()
   interplist_type val;
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.traj_cmd.type = TOOL_CMD_ON_TYPE;
-  val.u.tool_cmd.id = SPINDLE_ID;
-  val.u.tool_cmd.u.on.value = +_spindle_speed;
-  interplist_put(&task_interplist, val);
+  val.type = TOOL_CMD_ON_TYPE;
+  val.u.tool.id = SPINDLE_ID;
+  val.u.tool.on.value = +_spindle_speed;
+  canon_put(val);
 
   _spindle_turning SET_TO ((_spindle_speed IS 0) ? CANON_STOPPED : CANON_CLOCKWISE);
 }
@@ -988,14 +1300,14 @@ void START_SPINDLE_COUNTERCLOCKWISE()
   interplist_type val;
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.traj_cmd.type = TOOL_CMD_ON_TYPE;
-  val.u.tool_cmd.id = SPINDLE_ID;
-  val.u.tool_cmd.u.on.value = -_spindle_speed;
-  interplist_put(&task_interplist, val);
+  val.type = TOOL_CMD_ON_TYPE;
+  val.u.tool.id = SPINDLE_ID;
+  val.u.tool.on.value = -_spindle_speed;
+  canon_put(val);
 
   _spindle_turning SET_TO ((_spindle_speed IS 0) ? CANON_STOPPED : CANON_COUNTERCLOCKWISE);
 }
@@ -1010,13 +1322,13 @@ void STOP_SPINDLE_TURNING()
   interplist_type val;
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.traj_cmd.type = TOOL_CMD_OFF_TYPE;
-  val.u.tool_cmd.id = SPINDLE_ID;
-  interplist_put(&task_interplist, val);
+  val.type = TOOL_CMD_OFF_TYPE;
+  val.u.tool.id = SPINDLE_ID;
+  canon_put(val);
 
   _spindle_turning SET_TO CANON_STOPPED;
 }
@@ -1051,9 +1363,9 @@ void CHANGE_TOOL(int slot)
   // This is an M6
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
   dbprintf("CHANGE_TOOL(%d)", (int) slot);
   if (slot < 0 || slot >= sizeof(_tools)/sizeof(*_tools)) {
@@ -1117,13 +1429,13 @@ void FLOOD_OFF()
   interplist_type val;
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.tool_cmd.type = TOOL_CMD_OFF_TYPE;
-  val.u.tool_cmd.id = FLOOD_ID;
-  interplist_put(&task_interplist, val);
+  val.type = TOOL_CMD_OFF_TYPE;
+  val.u.tool.id = FLOOD_ID;
+  canon_put(val);
 
   _flood SET_TO 0;
 }
@@ -1133,14 +1445,14 @@ void FLOOD_ON()
   interplist_type val;
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.traj_cmd.type = TOOL_CMD_ON_TYPE;
-  val.u.tool_cmd.id = FLOOD_ID;
-  val.u.tool_cmd.u.on.value = 1;
-  interplist_put(&task_interplist, val);
+  val.type = TOOL_CMD_ON_TYPE;
+  val.u.tool.id = FLOOD_ID;
+  val.u.tool.on.value = 1;
+  canon_put(val);
 
   _flood SET_TO 1;
 }
@@ -1168,13 +1480,13 @@ void MIST_OFF()
   interplist_type val;
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.tool_cmd.type = TOOL_CMD_OFF_TYPE;
-  val.u.tool_cmd.id = MIST_ID;
-  interplist_put(&task_interplist, val);
+  val.type = TOOL_CMD_OFF_TYPE;
+  val.u.tool.id = MIST_ID;
+  canon_put(val);
 
   _mist SET_TO 0;
 }
@@ -1184,14 +1496,14 @@ void MIST_ON()
   interplist_type val;
   
   val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
   val.type = TASK_EXEC_WAIT_FOR_TOOL_TYPE;
-  interplist_put(&task_interplist, val);
+  canon_put(val);
 
-  val.type = val.u.tool_cmd.type = TOOL_CMD_ON_TYPE;
-  val.u.tool_cmd.id = MIST_ID;
-  val.u.tool_cmd.u.on.value = 1;
-  interplist_put(&task_interplist, val);
+  val.type = TOOL_CMD_ON_TYPE;
+  val.u.tool.id = MIST_ID;
+  val.u.tool.on.value = 1;
+  canon_put(val);
 
   _mist SET_TO 1;
 }
@@ -1220,12 +1532,22 @@ void UNCLAMP_AXIS(CANON_AXIS axis)
 
 void PROGRAM_STOP()
 {
-  // FIXME -- do something with it
+  interplist_type val;
+
+  // FIXME -- pause until resumed; for now, at least don't read
+  // ahead of the stop
+  val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
+  canon_put(val);
 }
 
 void OPTIONAL_PROGRAM_STOP()
 {
-  // FIXME -- do something with it
+  interplist_type val;
+
+  // FIXME -- pause until resumed; for now, at least don't read
+  // ahead of the stop
+  val.type = TASK_EXEC_WAIT_FOR_MOTION_TYPE;
+  canon_put(val);
 }
 
 void PROGRAM_END()
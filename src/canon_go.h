@@ -0,0 +1,59 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*
+  canon_go.h
+
+  What the Go canonical interface in canon_go.cc offers Task and the
+  other C programs that run the interpreter, beyond the canonical
+  functions in canon.h that the interpreter calls.
+*/
+
+#ifndef CANON_GO_H
+#define CANON_GO_H
+
+#include "go.h"			/* go_integer, go_real */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if 0
+}
+#endif
+
+/*
+  The Go canonical interface may hold back runs of short feeds to merge
+  them into longer lines and arcs. canon_go_flush puts what it's holding
+  on the interp list, canon_go_reset drops it and zeros the counts for a
+  new program, and canon_go_stats gets the counts so far.
+*/
+typedef struct {
+  go_integer in;		/*< feeds from the interpreter */
+  go_integer out;		/*< moves put on the interp list for them */
+  go_integer arcs;		/*< how many of those are arcs */
+  go_real deviation;		/*< furthest a feed end or chord middle is
+				  from what replaced it */
+} canon_go_compress_stats;
+
+extern void canon_go_flush(void);
+
+extern void canon_go_reset(void);
+
+extern void canon_go_stats(canon_go_compress_stats *stats);
+
+#if 0
+{
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* CANON_GO_H */
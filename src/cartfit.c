@@ -1,38 +1,139 @@
+/*
+  cartfit {<file>}
+
+  Prints the best-fit pose, as x y z / r p y, that takes the first
+  point of each pair to the second. With no file, the pairs are read
+  from stdin as lines of "x1 y1 z1 x2 y2 z2", and other lines are
+  ignored. With a file, the pairs are read from it as records of six
+  doubles in the machine's own byte order, as written by fwrite. The
+  file is memory-mapped where that's available. The pairs are
+  accumulated as they're read, not kept, so the size of the fit is
+  limited only by the file.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/types.h>
+#include <sys/stat.h>		/* fstat */
+#include <sys/mman.h>		/* mmap */
+#include <fcntl.h>		/* open */
+#include <unistd.h>		/* close */
+#endif
 #include "go.h"
 
-int main(int argc, char *argv[])
+enum {RECORD_SIZE = 6 * sizeof(double)};
+
+static void add_record(go_cart_cart_pose_acc * acc, const double * d)
+{
+  go_cart v1, v2;
+
+  v1.x = d[0], v1.y = d[1], v1.z = d[2];
+  v2.x = d[3], v2.y = d[4], v2.z = d[5];
+  go_cart_cart_pose_acc_add(acc, &v1, &v2);
+}
+
+static void read_text(go_cart_cart_pose_acc * acc)
 {
-  go_cart *v1 = NULL;
-  go_cart *v2 = NULL;
-  go_cart *v1c = NULL;
-  go_cart *v2c = NULL;
   enum {BUFFERSIZE = 256};
   char buffer[BUFFERSIZE];
-  int num;
-  go_pose pout;
-  go_rpy rpy;
+  double d[6];
 
-  for (num = 0; ;) {
-    double d1, d2, d3, d4, d5, d6;
-    if (NULL == fgets(buffer, sizeof(buffer), stdin)) break;
-    if (6 == sscanf(buffer, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
-      v1 = realloc(v1, (num+1) * sizeof(*v1));
-      v2 = realloc(v2, (num+1) * sizeof(*v2));
-      v1[num].x = d1, v1[num].y = d2, v1[num].z = d3,
-	v2[num].x = d4, v2[num].y = d5, v2[num].z = d6;
-      num++;
+  while (NULL != fgets(buffer, sizeof(buffer), stdin)) {
+    if (6 == sscanf(buffer, "%lf %lf %lf %lf %lf %lf",
+		    &d[0], &d[1], &d[2], &d[3], &d[4], &d[5])) {
+      add_record(acc, d);
     }
     /* else ignore the line */
   }
-  if (0 == num) return 0;
+}
+
+static int read_binary(go_cart_cart_pose_acc * acc, const char * path)
+{
+#ifdef HAVE_SYS_MMAN_H
+  struct stat st;
+  size_t size, t;
+  void * base;
+  const double * d;
+  int fd;
+
+  if (-1 == (fd = open(path, O_RDONLY))) return 1;
+  if (0 != fstat(fd, &st)) {
+    close(fd);
+    return 1;
+  }
+  size = (size_t) st.st_size;
+  if (0 != size % RECORD_SIZE) {
+    fprintf(stderr, "cartfit: %s is not a whole number of records\n", path);
+    close(fd);
+    return 1;
+  }
+  if (0 == size) {
+    close(fd);
+    return 0;
+  }
+  base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  /* the mapping stays after the file is closed */
+  close(fd);
+  if (MAP_FAILED == base) return 1;
 
-  v1c = malloc(num * sizeof(*v1c));
-  v2c = malloc(num * sizeof(*v2c));
+  d = (const double *) base;
+  for (t = 0; t < size / RECORD_SIZE; t++, d += 6) {
+    add_record(acc, d);
+  }
+
+  munmap(base, size);
+#else
+  enum {CHUNK = 1024};
+  static double d[CHUNK][6];
+  FILE * fp;
+  size_t n, t;
+
+  if (NULL == (fp = fopen(path, "rb"))) return 1;
+  /* in bytes, so a short record at the end shows */
+  while (0 != (n = fread(d, 1, sizeof(d), fp))) {
+    for (t = 0; t < n / RECORD_SIZE; t++) {
+      add_record(acc, d[t]);
+    }
+    if (0 != n % RECORD_SIZE) {
+      fprintf(stderr, "cartfit: %s is not a whole number of records\n", path);
+      fclose(fp);
+      return 1;
+    }
+  }
+  if (ferror(fp)) {
+    fclose(fp);
+    return 1;
+  }
+  fclose(fp);
+#endif
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  go_cart_cart_pose_acc acc;
+  go_pose pout;
+  go_rpy rpy;
+
+  go_cart_cart_pose_acc_init(&acc);
+
+  if (argc > 1) {
+    if (0 != read_binary(&acc, argv[1])) {
+      fprintf(stderr, "cartfit: can't read %s\n", argv[1]);
+      return 1;
+    }
+  } else {
+    read_text(&acc);
+  }
+  if (0 == acc.num) return 0;
 
-  if (GO_RESULT_OK !=
-      go_cart_cart_pose(v1, v2, v1c, v2c, num, &pout)) {
+  if (GO_RESULT_OK != go_cart_cart_pose_acc_solve(&acc, &pout)) {
     return 1;
   }
 
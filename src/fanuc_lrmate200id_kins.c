@@ -118,21 +118,11 @@ go_result fanuc_lrmate200id_kin_fwd(fanuc_lrmate200id_kin_struct *kins,
   return GO_RESULT_OK;
 }
 
-go_result fanuc_lrmate200id_kin_inv(fanuc_lrmate200id_kin_struct *kins,
-				    const go_pose *pos,
-				    go_real *motors)
+static void fanuc_lrmate200id_gearing_inv(const go_real *joints,
+					  go_real *motors)
 {
-  go_pose end_pos;
-  go_real joints[6];
-  go_result retval;
   go_integer t;
 
-  /* take off the end frame */
-  go_pose_pose_mult(pos, &kins->t7_inv, &end_pos);
-  
-  retval = three21_kin_inv(&kins->tk, &end_pos, joints);
-  if (GO_RESULT_OK != retval) return retval;
-
   /* gearing equations */
   motors[0] = joints[0];
   motors[1] = joints[1] + GO_PI_2;
@@ -146,6 +136,47 @@ go_result fanuc_lrmate200id_kin_inv(fanuc_lrmate200id_kin_struct *kins,
     if (motors[t] < -GO_PI) motors[t] += GO_2_PI;
     else if (motors[t] > GO_PI) motors[t] -= GO_2_PI;
   }
+}
+
+go_result fanuc_lrmate200id_kin_inv(fanuc_lrmate200id_kin_struct *kins,
+				    const go_pose *pos,
+				    go_real *motors)
+{
+  go_pose end_pos;
+  go_real joints[6];
+  go_result retval;
+
+  /* take off the end frame */
+  go_pose_pose_mult(pos, &kins->t7_inv, &end_pos);
+  
+  retval = three21_kin_inv(&kins->tk, &end_pos, joints);
+  if (GO_RESULT_OK != retval) return retval;
+
+  fanuc_lrmate200id_gearing_inv(joints, motors);
+
+  return GO_RESULT_OK;
+}
+
+go_result fanuc_lrmate200id_kin_inv_all(fanuc_lrmate200id_kin_struct *kins,
+					const go_pose *pos,
+					go_real *motors,
+					go_flag *iflags,
+					go_integer *count)
+{
+  go_pose end_pos;
+  go_real joints[8 * 6];
+  go_integer n;
+  go_result retval;
+
+  /* take off the end frame */
+  go_pose_pose_mult(pos, &kins->t7_inv, &end_pos);
+
+  retval = three21_kin_inv_all(&kins->tk, &end_pos, joints, iflags, count);
+  if (GO_RESULT_OK != retval) return retval;
+
+  for (n = 0; n < *count; n++) {
+    fanuc_lrmate200id_gearing_inv(&joints[n * 6], &motors[n * 6]);
+  }
 
   return GO_RESULT_OK;
 }
@@ -49,6 +49,12 @@ extern go_result fanuc_lrmate200id_kin_inv(fanuc_lrmate200id_kin_struct *kins,
 					   const go_pose *world,
 					   go_real *motors);
 
+extern go_result fanuc_lrmate200id_kin_inv_all(fanuc_lrmate200id_kin_struct *kins,
+					       const go_pose *pos,
+					       go_real *motors,
+					       go_flag *iflags,
+					       go_integer *count);
+
 extern go_kin_type fanuc_lrmate200id_kin_get_type(fanuc_lrmate200id_kin_struct *kins); 
 
 extern go_result fanuc_lrmate200id_kin_set_parameters(fanuc_lrmate200id_kin_struct *kins, go_link *params, go_integer num);
@@ -16,6 +16,7 @@
   the three21kins functions for most of the work.
 */
 
+#include <stddef.h>		/* NULL */
 #include <math.h>
 #include "gotypes.h"		/* go_result, go_integer */
 #include "gomath.h"		/* go_pose */
@@ -234,6 +235,140 @@ go_result fanuc_kin_inv(fanuc_kin_struct *kins,
   return GO_RESULT_OK;
 }
 
+/*
+  As fanuc_kin_inv, for each of the arm's solutions, with the gantry
+  motor taken from the first row of 'motors' and copied to the rest.
+*/
+go_result fanuc_kin_inv_all(fanuc_kin_struct *kins,
+			    const go_pose *pos,
+			    go_real *motors,
+			    go_flag *iflags,
+			    go_integer *count)
+{
+  go_real joints[8 * 6];
+  go_real gantry;
+  go_real *m;
+  go_pose adj;
+  go_pose wristoff = {{0,0,-WRIST_OFFSET},{1,0,0,0}};
+  go_integer n, t;
+  go_result retval;
+
+  gantry = motors[6];
+  adj = *pos;
+  adj.tran.x -= gantry;
+  go_pose_pose_mult(&adj, &wristoff, &adj);
+
+  retval = three21_kin_inv_all(&kins->tk, &adj, joints, iflags, count);
+  if (GO_RESULT_OK != retval) return retval;
+
+  for (n = 0; n < *count; n++) {
+    m = &motors[n * FANUC_KIN_NUM_JOINTS];
+    fanuc_kin_gearing_inv(kins, &joints[n * 6], m);
+    for (t = 0; t < 6; t++) {
+      if (m[t] < -GO_PI) m[t] += GO_2_PI;
+      else if (m[t] > GO_PI) m[t] -= GO_2_PI;
+    }
+    m[6] = gantry;
+  }
+
+  return GO_RESULT_OK;
+}
+
+/*
+  The batches work on the 3-2-1 arm's homogeneous transform, adding
+  the wrist offset along its Z column and the gantry to its X rather
+  than with pose multiplies, and move the motors and poses straight
+  between it and the arrays. The forward skips the flags for all but
+  the last item, which is what they're left set from. For the inverse
+  the gantry motor must be set in its array as for fanuc_kin_inv, and
+  is left alone.
+*/
+
+go_result fanuc_kin_fwd_batch(fanuc_kin_struct *kins,
+			      go_integer num,
+			      go_real **motors,
+			      go_pose_batch *world,
+			      go_result *results)
+{
+  go_real motor[FANUC_KIN_NUM_JOINTS];
+  go_real joints[6];
+  go_hom hom;
+  go_quat quat;
+  go_pose pose;
+  go_integer n, t;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  for (n = 0; n < num; n++) {
+    for (t = 0; t < FANUC_KIN_NUM_JOINTS; t++) motor[t] = motors[t][n];
+    if (n < num - 1) {
+      fanuc_kin_gearing_fwd(kins, motor, joints);
+      three21_kin_fwd_hom(&kins->tk, joints, &hom);
+      retval = go_mat_quat_convert(&hom.rot, &quat);
+      if (GO_RESULT_OK == retval) {
+	world->x[n] = hom.tran.x + WRIST_OFFSET * hom.rot.z.x + motor[6];
+	world->y[n] = hom.tran.y + WRIST_OFFSET * hom.rot.z.y;
+	world->z[n] = hom.tran.z + WRIST_OFFSET * hom.rot.z.z;
+	world->s[n] = quat.s;
+	world->i[n] = quat.x;
+	world->j[n] = quat.y;
+	world->k[n] = quat.z;
+      }
+    } else {
+      retval = fanuc_kin_fwd(kins, motor, &pose);
+      if (GO_RESULT_OK == retval) go_pose_batch_put(world, n, &pose);
+    }
+    if (GO_RESULT_OK != retval && GO_RESULT_OK == first) first = retval;
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
+go_result fanuc_kin_inv_batch(fanuc_kin_struct *kins,
+			      go_integer num,
+			      const go_pose_batch *world,
+			      go_real **motors,
+			      go_result *results)
+{
+  go_real motor[FANUC_KIN_NUM_JOINTS];
+  go_real joints[6];
+  go_hom hom;
+  go_quat quat;
+  go_integer n, t;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  for (n = 0; n < num; n++) {
+    quat.s = world->s[n];
+    quat.x = world->i[n];
+    quat.y = world->j[n];
+    quat.z = world->k[n];
+    /* as fanuc_kin_inv, this goes ahead with an unnormalized quaternion */
+    (void) go_quat_mat_convert(&quat, &hom.rot);
+    /* take off the gantry X position and the wrist offset */
+    hom.tran.x = world->x[n] - motors[6][n] - WRIST_OFFSET * hom.rot.z.x;
+    hom.tran.y = world->y[n] - WRIST_OFFSET * hom.rot.z.y;
+    hom.tran.z = world->z[n] - WRIST_OFFSET * hom.rot.z.z;
+
+    retval = three21_kin_inv_hom(&kins->tk, &hom, joints);
+    if (GO_RESULT_OK == retval) {
+      fanuc_kin_gearing_inv(kins, joints, motor);
+      /* normalize motor angles to range [-180..180] as Fanuc does */
+      for (t = 0; t < 6; t++) {
+	if (motor[t] < -GO_PI) motor[t] += GO_2_PI;
+	else if (motor[t] > GO_PI) motor[t] -= GO_2_PI;
+	motors[t][n] = motor[t];
+      }
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
 /* the speed counterpart to the forward gearing function */
 static void fanuc_kin_gearing_vel_fwd(fanuc_kin_struct *kins,
 				      const go_real *motorvels,
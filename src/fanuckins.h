@@ -57,6 +57,24 @@ extern go_result fanuc_kin_inv(fanuc_kin_struct *kins,
 			       const go_pose *world,
 			       go_real *motors);
 
+extern go_result fanuc_kin_inv_all(fanuc_kin_struct *kins,
+				   const go_pose *pos,
+				   go_real *motors,
+				   go_flag *iflags,
+				   go_integer *count);
+
+extern go_result fanuc_kin_fwd_batch(fanuc_kin_struct *kins,
+				    go_integer num,
+				    go_real **motors,
+				    go_pose_batch *world,
+				    go_result *results);
+
+extern go_result fanuc_kin_inv_batch(fanuc_kin_struct *kins,
+				    go_integer num,
+				    const go_pose_batch *world,
+				    go_real **motors,
+				    go_result *results);
+
 extern go_kin_type fanuc_kin_get_type(fanuc_kin_struct *kins); 
 
 extern go_result fanuc_kin_set_parameters(fanuc_kin_struct *kins, go_link *params, go_integer num);
@@ -17,6 +17,7 @@
   Hallam at http://www.roble.info/ for this.
 */
 
+#include <stddef.h>		/* NULL */
 #include <math.h>
 #include "gotypes.h"		/* go_result, go_integer */
 #include "gomath.h"		/* go_pose */
@@ -80,6 +81,13 @@ go_result genser_kin_init(void * kins)
   genser->link_num = 6;
   genser->iterations = 0;
   genser->max_iterations = GENSER_DEFAULT_MAX_ITERATIONS;
+  genser->damping = 0.0;
+  genser->timer = NULL;
+  genser->time = 0.0;
+  genser->calls = 0;
+  genser->total_iterations = 0;
+  genser->total_time = 0.0;
+  genser->jfwd = NULL;
 
   return GO_RESULT_OK;
 }
@@ -135,6 +143,26 @@ go_result genser_kin_get_parameters(void * kins, go_link * params, go_integer nu
 extern go_result genser_kin_compute_jfwd(go_link *link_params, int link_number, go_matrix *Jfwd, go_pose *T_L_0);
 extern go_result genser_kin_compute_jinv(go_matrix *Jfwd, go_matrix *Jinv, go_real *weights);
 
+/*
+  The Jacobian and pose at the joints, from the links or from the
+  chain's own function if it has one.
+*/
+static go_result genser_jfwd(genser_struct * genser, const go_real * joints, go_matrix * Jfwd, go_pose * T_L_0)
+{
+  go_link linkout[GENSER_MAX_JOINTS];
+  go_integer link;
+  go_result retval;
+
+  if (NULL != genser->jfwd) return genser->jfwd(joints, Jfwd, T_L_0);
+
+  for (link = 0; link < genser->link_num; link++) {
+    retval = go_link_joint_set(&genser->links[link], joints[link], &linkout[link]);
+    if (GO_RESULT_OK != retval) return retval;
+  }
+
+  return genser_kin_compute_jfwd(linkout, genser->link_num, Jfwd, T_L_0);
+}
+
 go_result genser_kin_jac_inv(void * kins,
 			     const go_pose * pos,
 			     const go_vel * vel,
@@ -149,22 +177,21 @@ go_result genser_kin_jac_inv(void * kins,
 #else
   go_quat Rinv;
 #endif
-  go_link linkout[GENSER_MAX_JOINTS];
   go_real vw[6];
   go_vector weights[GENSER_MAX_JOINTS];
-  go_integer link;
+  go_real J6[6][6];
+  go_real J6n[6][GO_MAT6N_MAX];
+  go_real winv[GO_MAT6N_MAX];
+  go_integer link, row;
   go_result retval;
 
   go_matrix_init(Jfwd, Jfwd_stg, 6, genser->link_num);
   go_matrix_init(Jinv, Jinv_stg, GENSER_MAX_JOINTS, 6);
 
   for (link = 0; link < genser->link_num; link++) {
-    go_link_joint_set(&genser->links[link], joints[link], &linkout[link]);
     weights[link] = (GO_QUANTITY_LENGTH == genser->links[link].quantity ? genser->links[link].body.mass : GO_QUANTITY_ANGLE == genser->links[link].quantity ? genser->links[link].body.inertia[2][2] : 1);
   }
-  retval = genser_kin_compute_jfwd(linkout, genser->link_num, &Jfwd, &T_L_0);
-  if (GO_RESULT_OK != retval) return retval;
-  retval = genser_kin_compute_jinv(&Jfwd, &Jinv, weights);
+  retval = genser_jfwd(genser, joints, &Jfwd, &T_L_0);
   if (GO_RESULT_OK != retval) return retval;
 
 #ifdef ROTATE_JACOBIANS_BACK
@@ -181,6 +208,31 @@ go_result genser_kin_jac_inv(void * kins,
   vw[4] = vel->w.y;
   vw[5] = vel->w.z;
 
+  /*
+    With 6 up to GO_MAT6N_MAX joints the fixed-size solvers do this
+    straight from the Jacobian, without forming its inverse
+  */
+  if (6 == genser->link_num) {
+    for (row = 0; row < 6; row++) {
+      for (link = 0; link < 6; link++) {
+	J6[row][link] = Jfwd.el[row][link];
+      }
+    }
+    return go_mat6_solve(J6, vw, jointvels);
+  }
+  if (genser->link_num > 6 && genser->link_num <= GO_MAT6N_MAX) {
+    for (link = 0; link < genser->link_num; link++) {
+      winv[link] = weights[link] > 0.0 ? 1.0 / weights[link] : 1.0;
+      for (row = 0; row < 6; row++) {
+	J6n[row][link] = Jfwd.el[row][link];
+      }
+    }
+    return go_mat6n_dls_solve(J6n, genser->link_num, winv, 0.0, vw, jointvels);
+  }
+
+  retval = genser_kin_compute_jinv(&Jfwd, &Jinv, weights);
+  if (GO_RESULT_OK != retval) return retval;
+
   return go_matrix_vector_mult(&Jinv, vw, jointvels);
 }
 
@@ -197,19 +249,12 @@ go_result genser_kin_jac_fwd(void * kins,
 #else
   go_quat Rinv;
 #endif
-  go_link linkout[GENSER_MAX_JOINTS];
   go_real vw[6];
-  go_integer link;
   go_result retval;
 
   go_matrix_init(Jfwd, Jfwd_stg, 6, genser->link_num);
 
-  for (link = 0; link < genser->link_num; link++) {
-    retval = go_link_joint_set(&genser->links[link], joints[link], &linkout[link]);
-    if (GO_RESULT_OK != retval) return retval;
-  }
-
-  retval = genser_kin_compute_jfwd(linkout, genser->link_num, &Jfwd, &T_L_0);
+  retval = genser_jfwd(genser, joints, &Jfwd, &T_L_0);
   if (GO_RESULT_OK != retval) return retval;
 
   go_matrix_vector_mult(&Jfwd, jointvels, vw);
@@ -250,47 +295,182 @@ go_result genser_kin_fwd(void * kins,
   return GO_RESULT_OK;
 }
 
-go_result genser_kin_inv(void  * kins,
-			 const go_pose * pos,
-			 go_real * joints)
+/*
+  Solves J dj = dvw in the damped least-squares sense, for the 6 x n
+  Jacobian J, joint weights w and damping lambda. With at least 6
+  joints this is the weighted least-norm solution
+
+  dj = Winv JT (J Winv JT + lambda^2 I)inv dvw
+
+  and with fewer it's the least-squares solution
+
+  dj = (JT J + lambda^2 I)inv JT dvw
+
+  In both the matrix to invert is symmetric positive definite and no
+  bigger than GENSER_MAX_JOINTS square, so we solve with it by
+  Cholesky factoring in place rather than forming its inverse. The
+  first case, for up to GO_MAT6N_MAX joints, is done by
+  go_mat6n_dls_solve(), which factors J itself rather than J Winv JT
+  and so is better conditioned near a singularity, or with exactly 6
+  joints and no damping, where it's just J inv dvw, by go_mat6_solve().
+*/
+static go_result genser_dls_solve(const go_matrix * J, const go_vector * w, go_real lambda, const go_real * dvw, go_real * dj)
+{
+  go_real A[GENSER_MAX_JOINTS][GENSER_MAX_JOINTS];
+  go_real Jn[6][GO_MAT6N_MAX];
+  go_real J6[6][6];
+  go_real b[GENSER_MAX_JOINTS];
+  go_real winv[GENSER_MAX_JOINTS];
+  go_real sum, floor;
+  go_integer n, m, i, j, k;
+
+  n = J->cols;
+
+  if (n >= 6) {
+    for (k = 0; k < n; k++) {
+      winv[k] = w[k] > 0.0 ? 1.0 / w[k] : 1.0;
+    }
+    if (n <= GO_MAT6N_MAX) {
+      for (i = 0; i < 6; i++) {
+	for (k = 0; k < n; k++) {
+	  Jn[i][k] = J->el[i][k];
+	}
+      }
+      if (6 == n && lambda <= 0.0) {
+	/* square and undamped, so this is just J inv dvw */
+	for (i = 0; i < 6; i++) {
+	  for (k = 0; k < 6; k++) {
+	    J6[i][k] = J->el[i][k];
+	  }
+	}
+	return go_mat6_solve(J6, (go_real *) dvw, dj);
+      }
+      return go_mat6n_dls_solve(Jn, n, winv, lambda, (go_real *) dvw, dj);
+    }
+    m = 6;
+    for (i = 0; i < 6; i++) {
+      for (j = 0; j <= i; j++) {
+	for (k = 0, sum = 0.0; k < n; k++) {
+	  sum += J->el[i][k] * winv[k] * J->el[j][k];
+	}
+	A[i][j] = sum;
+      }
+      b[i] = dvw[i];
+    }
+  } else {
+    m = n;
+    for (i = 0; i < n; i++) {
+      for (j = 0; j <= i; j++) {
+	for (k = 0, sum = 0.0; k < 6; k++) {
+	  sum += J->el[k][i] * J->el[k][j];
+	}
+	A[i][j] = sum;
+      }
+      for (k = 0, sum = 0.0; k < 6; k++) {
+	sum += J->el[k][i] * dvw[k];
+      }
+      b[i] = sum;
+    }
+  }
+
+  /* A = L LT, with L overwriting the lower triangle of A */
+  for (i = 0, floor = 0.0; i < m; i++) {
+    A[i][i] += lambda * lambda;
+    if (A[i][i] > floor) floor = A[i][i];
+  }
+  floor *= GO_REAL_EPSILON * GO_REAL_EPSILON;
+  for (j = 0; j < m; j++) {
+    for (k = 0, sum = A[j][j]; k < j; k++) {
+      sum -= A[j][k] * A[j][k];
+    }
+    if (sum <= floor) return GO_RESULT_SINGULAR;
+    A[j][j] = sqrt(sum);
+    for (i = j + 1; i < m; i++) {
+      for (k = 0, sum = A[i][j]; k < j; k++) {
+	sum -= A[i][k] * A[j][k];
+      }
+      A[i][j] = sum / A[j][j];
+    }
+  }
+
+  /* solve L y = b, then LT x = y, in b */
+  for (i = 0; i < m; i++) {
+    for (k = 0, sum = b[i]; k < i; k++) {
+      sum -= A[i][k] * b[k];
+    }
+    b[i] = sum / A[i][i];
+  }
+  for (i = m - 1; i >= 0; i--) {
+    for (k = i + 1, sum = b[i]; k < m; k++) {
+      sum -= A[k][i] * b[k];
+    }
+    b[i] = sum / A[i][i];
+  }
+
+  if (n >= 6) {
+    for (k = 0; k < n; k++) {
+      for (i = 0, sum = 0.0; i < 6; i++) {
+	sum += J->el[i][k] * b[i];
+      }
+      dj[k] = winv[k] * sum;
+    }
+  } else {
+    for (k = 0; k < n; k++) {
+      dj[k] = b[k];
+    }
+  }
+
+  return GO_RESULT_OK;
+}
+
+/*
+  The iterations of genser_kin_inv. Each builds the Jacobian at the
+  joint estimate, and the chain of link poses built along with it is
+  the pose estimate, so forward kinematics aren't done separately.
+*/
+static go_result genser_kin_inv_iterate(genser_struct * genser,
+					const go_pose * pos,
+					go_real * joints)
 {
-  genser_struct * genser = (genser_struct *) kins;
   GO_MATRIX_DECLARE(Jfwd, Jfwd_stg, 6, GENSER_MAX_JOINTS);
-  GO_MATRIX_DECLARE(Jinv, Jinv_stg, GENSER_MAX_JOINTS, 6);
-  go_pose T_L_0;
-  go_real dvw[6];
+  GO_MATRIX_DECLARE(Jlast, Jlast_stg, 6, GENSER_MAX_JOINTS);
+  go_real dvw[6], dvwlast[6];
+  go_real err, errlast;
+  go_real lambda;
   go_real jest[GENSER_MAX_JOINTS];
+  go_real jlast[GENSER_MAX_JOINTS];
   go_real dj[GENSER_MAX_JOINTS];
+#ifdef GO_REAL_FLOAT
+  go_real jthere[GENSER_MAX_JOINTS];
+#endif
   go_pose pest, pestinv, Tdelta;
   go_rvec rvec;
   go_cart cart;
-  go_link linkout[GENSER_MAX_JOINTS];
   go_vector weights[GENSER_MAX_JOINTS];
-  go_integer link;
+  go_integer link, row;
   go_integer smalls;
+  go_flag retry;
+#ifdef GO_REAL_FLOAT
+  go_flag there = 0;
+#endif
   go_result retval;
 
   go_matrix_init(Jfwd, Jfwd_stg, 6, genser->link_num);
-  go_matrix_init(Jinv, Jinv_stg, genser->link_num, 6);
+  go_matrix_init(Jlast, Jlast_stg, 6, genser->link_num);
 
   /* jest[] is a copy of joints[], which is the joint estimate */
   for (link = 0; link < genser->link_num; link++) {
     jest[link] = joints[link];
+    weights[link] = (GO_QUANTITY_LENGTH == genser->links[link].quantity ? genser->links[link].body.mass : GO_QUANTITY_ANGLE == genser->links[link].quantity ? genser->links[link].body.inertia[2][2] : 1);
   }
+  lambda = genser->damping;
+  errlast = 0.0;
 
   for (genser->iterations = 0; genser->iterations < genser->max_iterations; genser->iterations++) {
-    /* update the Jacobians */
-    for (link = 0; link < genser->link_num; link++) {
-      go_link_joint_set(&genser->links[link], jest[link], &linkout[link]);
-      weights[link] = (GO_QUANTITY_LENGTH == genser->links[link].quantity ? genser->links[link].body.mass : GO_QUANTITY_ANGLE == genser->links[link].quantity ? genser->links[link].body.inertia[2][2] : 1);
-    }
-    retval = genser_kin_compute_jfwd(linkout, genser->link_num, &Jfwd, &T_L_0);
-    if (GO_RESULT_OK != retval) return retval;
-    retval = genser_kin_compute_jinv(&Jfwd, &Jinv, weights);
+    /* update the Jacobian, and with it pest, the pose estimate */
+    retval = genser_jfwd(genser, jest, &Jfwd, &pest);
     if (GO_RESULT_OK != retval) return retval;
 
-    /* pest is the resulting pose estimate given joint estimate */
-    genser_kin_fwd(kins, jest, &pest);
     /* pestinv is its inverse */
     go_pose_inv(&pest, &pestinv);
     /*
@@ -334,17 +514,75 @@ go_result genser_kin_inv(void  * kins,
     dvw[4] = cart.y;
     dvw[5] = cart.z;
 
-    /* push the Cartesian velocity vector through the inverse Jacobian */
-    go_matrix_vector_mult(&Jinv, dvw, dj);
+#ifdef GO_REAL_FLOAT
+    /* remember where the pose was last reached, for below */
+    if (GO_TRAN_SMALL(dvw[0]) && GO_TRAN_SMALL(dvw[1]) && GO_TRAN_SMALL(dvw[2]) &&
+	GO_ROT_SMALL(dvw[3]) && GO_ROT_SMALL(dvw[4]) && GO_ROT_SMALL(dvw[5])) {
+      there = 1;
+      for (link = 0; link < genser->link_num; link++) {
+	jthere[link] = jest[link];
+      }
+    }
+#endif
+
+    /*
+      With damping, a step that didn't reduce the error is taken back
+      and retried with more damping, from where it started. Otherwise
+      the damping is relaxed and this becomes where to retry from.
+    */
+    retry = 0;
+    if (genser->damping > 0.0) {
+      err = dvw[0] * dvw[0] + dvw[1] * dvw[1] + dvw[2] * dvw[2] +
+	dvw[3] * dvw[3] + dvw[4] * dvw[4] + dvw[5] * dvw[5];
+      if (genser->iterations > 0 && err > errlast) {
+	retry = 1;
+	lambda *= 10.0;
+	for (link = 0; link < genser->link_num; link++) {
+	  jest[link] = jlast[link];
+	}
+	for (row = 0; row < 6; row++) {
+	  dvw[row] = dvwlast[row];
+	  for (link = 0; link < genser->link_num; link++) {
+	    Jfwd.el[row][link] = Jlast.el[row][link];
+	  }
+	}
+      } else {
+	if (genser->iterations > 0) lambda *= 0.1;
+	errlast = err;
+	for (link = 0; link < genser->link_num; link++) {
+	  jlast[link] = jest[link];
+	}
+	for (row = 0; row < 6; row++) {
+	  dvwlast[row] = dvw[row];
+	  for (link = 0; link < genser->link_num; link++) {
+	    Jlast.el[row][link] = Jfwd.el[row][link];
+	  }
+	}
+      }
+    }
 
-    /* check for small joint increments, if so we're done */
+    /* solve for the joint increments that take out the error */
+    retval = genser_dls_solve(&Jfwd, weights, lambda, dvw, dj);
+    if (GO_RESULT_OK != retval) return retval;
+
+    /*
+      check for small joint increments, if so we're done, unless
+      they're small only because a retry damped them down and the
+      error being retried isn't small too, since near the solution
+      the error is just noise and may go either way
+    */
     for (link = 0, smalls = 0; link < genser->link_num; link++) {
-      if (GO_QUANTITY_LENGTH == linkout[link].quantity) {
+      if (GO_QUANTITY_LENGTH == genser->links[link].quantity) {
 	if (GO_TRAN_SMALL(dj[link])) smalls++;
       } else {
 	if (GO_ROT_SMALL(dj[link])) smalls++;
       }
     }
+    if (retry &&
+	! (GO_TRAN_SMALL(dvw[0]) && GO_TRAN_SMALL(dvw[1]) && GO_TRAN_SMALL(dvw[2]) &&
+	   GO_ROT_SMALL(dvw[3]) && GO_ROT_SMALL(dvw[4]) && GO_ROT_SMALL(dvw[5]))) {
+      smalls = 0;
+    }
     if (smalls == genser->link_num) {
       /* converged, copy jest[] out */
       for (link = 0; link < genser->link_num; link++) {
@@ -356,16 +594,149 @@ go_result genser_kin_inv(void  * kins,
     /* else keep iterating */
     for (link = 0; link < genser->link_num; link++) {
       jest[link] += dj[link];
-      if (GO_QUANTITY_ANGLE == linkout[link].quantity) {
+      if (GO_QUANTITY_ANGLE == genser->links[link].quantity) {
 	if (jest[link] > GO_PI) jest[link] -= GO_2_PI;
 	else if (jest[link] < -GO_PI) jest[link] += GO_2_PI;
       }
     }
   } /* for (iterations) */
 
+#ifdef GO_REAL_FLOAT
+  /*
+    With float go_reals the increments for what's left of the error,
+    which is just rounding, may never get small near a singularity,
+    so if the pose was reached settle for that. Doubles are left to
+    fail as they always have.
+  */
+  if (there) {
+    for (link = 0; link < genser->link_num; link++) {
+      joints[link] = jthere[link];
+    }
+    return GO_RESULT_OK;
+  }
+#endif
+
   return GO_RESULT_ERROR;
 }
 
+go_result genser_kin_inv(void  * kins,
+			 const go_pose * pos,
+			 go_real * joints)
+{
+  genser_struct * genser = (genser_struct *) kins;
+  go_real start;
+  go_result retval;
+
+  start = (NULL == genser->timer ? 0.0 : genser->timer());
+  retval = genser_kin_inv_iterate(genser, pos, joints);
+  genser->time = (NULL == genser->timer ? 0.0 : genser->timer() - start);
+
+  genser->calls++;
+  genser->total_iterations += genser->iterations;
+  genser->total_time += genser->time;
+
+  return retval;
+}
+
+/*
+  For chains of DH links the batch forward kinematics take the sines
+  and cosines of the alphas once, build each link's homogeneous
+  transform directly and multiply them out, converting to a pose
+  only at the end rather than for every link. Other chains, and the
+  inverse, go item by item through the scalar functions.
+*/
+
+go_result genser_kin_fwd_batch(void * kins,
+			       go_integer num,
+			       go_real ** joints,
+			       go_pose_batch * world,
+			       go_result * results)
+{
+  genser_struct * genser = (genser_struct *) kins;
+  go_real sal[GENSER_MAX_JOINTS], cal[GENSER_MAX_JOINTS];
+  go_real joint[GENSER_MAX_JOINTS];
+  go_real sth, cth, d;
+  const go_dh * dh;
+  go_hom hom, h;
+  go_pose pose;
+  go_flag all_dh;
+  go_integer link, n;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  all_dh = (genser->link_num > 0);
+  for (link = 0; link < genser->link_num; link++) {
+    if (GO_LINK_DH != genser->links[link].type) {
+      all_dh = 0;
+      break;
+    }
+    go_sincos(genser->links[link].u.dh.alpha, &sal[link], &cal[link]);
+  }
+
+  for (n = 0; n < num; n++) {
+    if (all_dh) {
+      for (link = 0; link < genser->link_num; link++) {
+	dh = &genser->links[link].u.dh;
+	if (GO_QUANTITY_LENGTH == genser->links[link].quantity) {
+	  go_sincos(dh->theta, &sth, &cth);
+	  d = joints[link][n];
+	} else {
+	  go_sincos(joints[link][n], &sth, &cth);
+	  d = dh->d;
+	}
+	h.rot.x.x = cth, h.rot.y.x = -sth, h.rot.z.x = 0.0;
+	h.rot.x.y = sth*cal[link], h.rot.y.y = cth*cal[link], h.rot.z.y = -sal[link];
+	h.rot.x.z = sth*sal[link], h.rot.y.z = cth*sal[link], h.rot.z.z = cal[link];
+	h.tran.x = dh->a;
+	h.tran.y = -sal[link]*d;
+	h.tran.z = cal[link]*d;
+	if (0 == link) hom = h;
+	else go_hom_hom_mult(&hom, &h, &hom);
+      }
+      retval = go_hom_pose_convert(&hom, &pose);
+    } else {
+      for (link = 0; link < genser->link_num; link++) joint[link] = joints[link][n];
+      retval = genser_kin_fwd(kins, joint, &pose);
+    }
+    if (GO_RESULT_OK == retval) {
+      go_pose_batch_put(world, n, &pose);
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
+go_result genser_kin_inv_batch(void * kins,
+			       go_integer num,
+			       const go_pose_batch * world,
+			       go_real ** joints,
+			       go_result * results)
+{
+  genser_struct * genser = (genser_struct *) kins;
+  go_real joint[GENSER_MAX_JOINTS];
+  go_pose pose;
+  go_integer link, n;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  for (n = 0; n < num; n++) {
+    for (link = 0; link < genser->link_num; link++) joint[link] = joints[link][n];
+    go_pose_batch_get(world, n, &pose);
+    retval = genser_kin_inv(kins, &pose, joint);
+    if (GO_RESULT_OK == retval) {
+      for (link = 0; link < genser->link_num; link++) joints[link][n] = joint[link];
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
 go_kin_type genser_kin_get_type(void * kins)
 {
   return GO_KIN_BOTH;
@@ -476,15 +847,7 @@ go_result genser_kin_compute_jfwd(go_link * link_params, int link_number, go_mat
       Jw.el[0][col] = 0, Jw.el[1][col] = 0, Jw.el[2][col] = (GO_QUANTITY_ANGLE == link_params[col].quantity ? 1 : 0);
     }
 
-    if (GO_LINK_DH == link_params[col].type) {
-      go_dh_pose_convert(&link_params[col].u.dh, &pose);
-    } else if (GO_LINK_PP == link_params[col].type) {
-      pose = link_params[col].u.pp.pose;
-    } else if (GO_LINK_URDF == link_params[col].type) {
-      pose = link_params[col].u.urdf.pose;
-    } else {
-      return GO_RESULT_IMPL_ERROR;
-    }
+    /* pose is still T_ip1_i, so chain it on */
     go_pose_pose_mult(T_L_0, &pose, T_L_0);
   }
 
@@ -582,3 +945,43 @@ go_integer genser_kin_inv_get_max_iterations(genser_struct * genser)
 {
   return genser->max_iterations;
 }
+
+go_result genser_kin_inv_set_damping(genser_struct * genser, go_real damping)
+{
+  if (damping < 0.0) return GO_RESULT_ERROR;
+  genser->damping = damping;
+  return GO_RESULT_OK;
+}
+
+go_real genser_kin_inv_get_damping(genser_struct * genser)
+{
+  return genser->damping;
+}
+
+go_result genser_kin_inv_set_timer(genser_struct * genser, go_timestamp_func timer)
+{
+  genser->timer = timer;
+  genser->time = 0.0;
+  return GO_RESULT_OK;
+}
+
+go_real genser_kin_inv_time(genser_struct * genser)
+{
+  return genser->time;
+}
+
+go_result genser_kin_inv_counts(genser_struct * genser, go_integer * calls, go_integer * iterations, go_real * time)
+{
+  if (NULL != calls) *calls = genser->calls;
+  if (NULL != iterations) *iterations = genser->total_iterations;
+  if (NULL != time) *time = genser->total_time;
+  return GO_RESULT_OK;
+}
+
+go_result genser_kin_inv_clear_counts(genser_struct * genser)
+{
+  genser->calls = 0;
+  genser->total_iterations = 0;
+  genser->total_time = 0.0;
+  return GO_RESULT_OK;
+}
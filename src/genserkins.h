@@ -19,6 +19,7 @@
 #include "gotypes.h"		/* go_result, go_integer */
 #include "gomath.h"		/* go_pose */
 #include "gokin.h"		/* go_kin_type */
+#include "goutil.h"		/* go_timestamp_func */
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,11 +34,25 @@ extern "C" {
 */
 #define GENSER_MAX_JOINTS 8
 
+/*!
+  Computes the Jacobian and the pose at the joints, for chains whose
+  links are known ahead of time and have their own code for this,
+  e.g., those made by gokingen.
+*/
+typedef go_result (*genser_jfwd_func)(const go_real *joints, go_matrix *Jfwd, go_pose *T_L_0);
+
 typedef struct {
   go_link links[GENSER_MAX_JOINTS]; /*!< The link description of the device. */
   go_integer link_num;		/*!< How many are actually present. */
   go_integer iterations;	/*!< How many iterations were actually used to compute the inverse kinematics. */
   go_integer max_iterations;	/*!< Number of iterations after which to give up and report an error. */
+  go_real damping;		/*!< Starting Levenberg-Marquardt damping for the inverse kinematics, 0 for plain Gauss-Newton steps. */
+  go_timestamp_func timer;	/*!< Returns the time in seconds, to time the inverse kinematics, or NULL not to. */
+  go_real time;			/*!< How long the last call to the inverse kinematics took, in seconds. */
+  go_integer calls;		/*!< Calls to the inverse kinematics since the counts were cleared. */
+  go_integer total_iterations;	/*!< Iterations used by those calls. */
+  go_real total_time;		/*!< Time taken by those calls, in seconds. */
+  genser_jfwd_func jfwd;	/*!< Computes the Jacobian and pose in place of the links, or NULL to use them. */
 } genser_struct;
 
 extern go_integer genser_kin_size(void); 
@@ -56,6 +71,18 @@ extern go_result genser_kin_inv(void *kins,
 				const go_pose *world,
 				go_real *joint);
 
+extern go_result genser_kin_fwd_batch(void *kins,
+				      go_integer num,
+				      go_real **joints,
+				      go_pose_batch *world,
+				      go_result *results);
+
+extern go_result genser_kin_inv_batch(void *kins,
+				      go_integer num,
+				      const go_pose_batch *world,
+				      go_real **joints,
+				      go_result *results);
+
 extern go_kin_type genser_kin_get_type(void *kins); 
 
 extern go_result genser_kin_set_parameters(void *kins, go_link *params, go_integer num); 
@@ -98,6 +125,32 @@ extern go_result genser_kin_inv_set_max_iterations(genser_struct *genser, go_int
  compute inverse kinematics functions */
 extern go_integer genser_kin_inv_get_max_iterations(genser_struct *genser);
 
+/*! Sets the starting Levenberg-Marquardt damping for future calls to
+  the inverse kinematics functions. Each step that reduces the pose
+  error divides it by 10, and each that doesn't is taken back and
+  retried with 10 times the damping. Zero, the default, takes plain
+  Gauss-Newton steps. */
+extern go_result genser_kin_inv_set_damping(genser_struct *genser, go_real damping);
+
+/*! Returns the starting Levenberg-Marquardt damping */
+extern go_real genser_kin_inv_get_damping(genser_struct *genser);
+
+/*! Sets the function that returns the time in seconds, used to time
+  the inverse kinematics functions, or NULL not to time them */
+extern go_result genser_kin_inv_set_timer(genser_struct *genser, go_timestamp_func timer);
+
+/*! Returns the time in seconds taken by the last call to the inverse
+  kinematics functions, or 0 if they're not being timed */
+extern go_real genser_kin_inv_time(genser_struct *genser);
+
+/*! Gets the number of calls to the inverse kinematics functions since
+  the counts were last cleared, and the iterations and time they took
+  in all. Any of the pointers may be NULL. */
+extern go_result genser_kin_inv_counts(genser_struct *genser, go_integer *calls, go_integer *iterations, go_real *time);
+
+/*! Clears the counts of calls, iterations and time */
+extern go_result genser_kin_inv_clear_counts(genser_struct *genser);
+
 #if 0
 {
 #endif
@@ -144,6 +144,13 @@ static void dbprintf(int prefix, const char * fmt, ...)
    double max_vel = 1.0, max_acc = 1.0, max_jerk = 1.0;
    double max_tvel = 1.0, max_tacc = 1.0, max_tjerk = 1.0;
    double max_rvel = 1.0, max_racc = 1.0, max_rjerk = 1.0;
+   double blend_tol = 0.0;
+   int kin_predict = 0;
+   int kin_fwd_every = 1;
+   int kin_cache_size = 0;
+   double kin_cache_resolution = 1.0e-6;
+   double kin_cache_rot_resolution = 1.0e-6;
+   int kin_nearest = 0;
    double max_scale = 1.0, max_scale_v = 1.0, max_scale_a = 1.0;
    pid_struct pid;
    servo_cfg_parameters parameters;
@@ -1073,6 +1080,42 @@ static void dbprintf(int prefix, const char * fmt, ...)
 	 saw_profile = 1;
        } else
 	 REPORT_BAD;
+     } else if (! strcmp(ini_entries[entry].tag, "BLEND_TOL")) {
+       if (1 == sscanf(ini_entries[entry].rest, "%lf", &d1) && d1 >= 0.0) {
+	 blend_tol = TGL(d1);
+	 saw_profile = 1;
+       } else
+	 REPORT_BAD;
+     } else if (! strcmp(ini_entries[entry].tag, "KIN_PREDICT")) {
+       if (1 == sscanf(ini_entries[entry].rest, "%i", &i1) && i1 >= 0 && i1 <= GO_KIN_PREDICT_ORDER_MAX) {
+	 kin_predict = i1;
+       } else
+	 REPORT_BAD;
+     } else if (! strcmp(ini_entries[entry].tag, "KIN_FWD_EVERY")) {
+       if (1 == sscanf(ini_entries[entry].rest, "%i", &i1) && i1 >= 1) {
+	 kin_fwd_every = i1;
+       } else
+	 REPORT_BAD;
+     } else if (! strcmp(ini_entries[entry].tag, "KIN_CACHE_SIZE")) {
+       if (1 == sscanf(ini_entries[entry].rest, "%i", &i1) && i1 >= 0 && i1 <= GO_KIN_CACHE_SIZE) {
+	 kin_cache_size = i1;
+       } else
+	 REPORT_BAD;
+     } else if (! strcmp(ini_entries[entry].tag, "KIN_CACHE_RESOLUTION")) {
+       if (1 == sscanf(ini_entries[entry].rest, "%lf", &d1) && d1 > 0.0) {
+	 kin_cache_resolution = TGL(d1);
+       } else
+	 REPORT_BAD;
+     } else if (! strcmp(ini_entries[entry].tag, "KIN_CACHE_ROT_RESOLUTION")) {
+       if (1 == sscanf(ini_entries[entry].rest, "%lf", &d1) && d1 > 0.0) {
+	 kin_cache_rot_resolution = TGA(d1);
+       } else
+	 REPORT_BAD;
+     } else if (! strcmp(ini_entries[entry].tag, "KIN_NEAREST")) {
+       if (1 == sscanf(ini_entries[entry].rest, "%i", &i1)) {
+	 kin_nearest = i1;
+       } else
+	 REPORT_BAD;
      } else if (! strcmp(ini_entries[entry].tag, "MAX_SCALE")) {
        if (1 == sscanf(ini_entries[entry].rest, "%lf", &d1) && d1 > 0.0) {
 	 max_scale = d1;
@@ -1179,6 +1222,7 @@ static void dbprintf(int prefix, const char * fmt, ...)
     traj_cfg.u.profile.max_rvel = max_rvel;
     traj_cfg.u.profile.max_racc = max_racc;
     traj_cfg.u.profile.max_rjerk = max_rjerk;
+    traj_cfg.u.profile.blend_tol = blend_tol;
     SEND_AND_CHECK;
   }
 
@@ -1197,6 +1241,12 @@ static void dbprintf(int prefix, const char * fmt, ...)
     traj_cfg.u.kinematics.parameters[joint] = link_params[joint];
   }
   traj_cfg.u.kinematics.num = joint_num;
+  traj_cfg.u.kinematics.predict = kin_predict;
+  traj_cfg.u.kinematics.fwd_every = kin_fwd_every;
+  traj_cfg.u.kinematics.cache_size = kin_cache_size;
+  traj_cfg.u.kinematics.cache_resolution = kin_cache_resolution;
+  traj_cfg.u.kinematics.cache_rot_resolution = kin_cache_rot_resolution;
+  traj_cfg.u.kinematics.nearest = (kin_nearest != 0);
   SEND_AND_CHECK;
 
   /* TOOL */
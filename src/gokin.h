@@ -63,12 +63,32 @@ enum {GO_KIN_NAME_LEN = 80};	/* how long a name can be */
    the particular implementation */
 extern go_integer go_kin_size(void);
 
-/* pass the name of the kins you want */
+/*
+  Pass the name of the kins you want. This picks which kinematics the
+  following go_kin_size() and go_kin_init() are for, so selecting
+  something else afterwards doesn't affect kinematics already
+  initialized, and one process can hold several different kinds.
+*/
 extern go_result go_kin_select(const char * name);
 
-/* go_kin_init() initializes the kinematics pointed to by 'kins' */
+/*
+  go_kin_init() initializes the kinematics pointed to by 'kins', of
+  go_kin_size() bytes, as the selected kind. The blob starts with the
+  kind's function table, and the rest of the go_kin_ calls on it go
+  straight through that.
+*/
 extern go_result go_kin_init(void * kins);
 
+/* the name of the kind of kinematics 'kins' were initialized as */
+extern const char * go_kin_get_instance_name(void * kins);
+
+/*
+  go_kin_impl() returns the kinematics' own structure inside the
+  blob, e.g., the genser_struct for genserkins, for calling their
+  extras directly.
+*/
+extern void * go_kin_impl(void * kins);
+
 /* returns the actual number of joints, possibly less than the max
    supported depending on how many links were present in the call
    to go_kin_set_parameters */
@@ -94,6 +114,83 @@ extern go_result go_kin_inv(void * kins,
 			    const go_pose * world,
 			    go_real *joints);
 
+/*
+  The batch kinematics run 'num' joint sets or poses through at once,
+  for offline tools like program verifiers, workspace maps and
+  calibration that push hundreds of thousands through. They're laid
+  out as structures of arrays, so that kinematics with straight-line
+  math can run down the arrays in tight loops. Poses are split into
+  seven arrays for the translation and rotation quaternion, and
+  joints are an array of 'go_kin_num_joints' pointers, one to each
+  joint's array of values.
+
+  The result of each item goes into 'results', if not null, and the
+  call returns GO_RESULT_OK if all went well, else the first bad
+  result. Failed items are left as they were. The kinematics flags
+  are used for the whole batch as they were on entry, and the
+  forward batch leaves them as the last item set them.
+
+  For the inverse batch the joints are both the seeds for iterative
+  kinematics and the solutions. Kinematics with no batch support of
+  their own are run item by item.
+*/
+
+enum {GO_KIN_BATCH_JOINTS = 8};	/* most joints the batch fallback handles */
+
+/* go_pose_batch is in gomath.h, with the batch pose arithmetic */
+
+extern go_result go_kin_fwd_batch(void * kins,
+				  go_integer num,
+				  go_real ** joints,
+				  go_pose_batch * world,
+				  go_result * results);
+
+extern go_result go_kin_inv_batch(void * kins,
+				  go_integer num,
+				  const go_pose_batch * world,
+				  go_real ** joints,
+				  go_result * results);
+
+/* These get and put item 'n' of a pose batch. */
+extern void go_pose_batch_get(const go_pose_batch * batch, go_integer n, go_pose * pose);
+
+extern void go_pose_batch_put(go_pose_batch * batch, go_integer n, const go_pose * pose);
+
+/*
+  The most solutions go_kin_inv_all gives, e.g., for the shoulder,
+  elbow and wrist branches of a 6R arm with a spherical wrist.
+*/
+enum {GO_KIN_INV_ALL_MAX = 8};
+
+/*
+  Fills 'joints' with every solution for 'world', one row of
+  go_kin_num_joints() after another, up to GO_KIN_INV_ALL_MAX rows,
+  with the inverse flags that give each in 'iflags', and sets 'count'.
+  The first row is read as the estimate, as for go_kin_inv. Closed-form
+  kinematics with branches work out the terms they share once; the
+  rest give the single solution go_kin_inv does.
+*/
+extern go_result go_kin_inv_all(void * kins,
+				const go_pose * world,
+				go_real * joints,
+				go_flag * iflags,
+				go_integer * count);
+
+/*
+  Replaces 'joints' with the solution for 'world' that the arm gets to
+  soonest from them, i.e., whose largest joint move, each scaled by
+  its 'weights' entry (e.g., one over the joint's top speed; null for
+  all 1), is least, and puts the inverse flags of its branch in
+  'iflags' unless that's null. The kinematics' own flags are left
+  alone; a caller that moves the arm onto the branch, e.g., with a
+  joint move, sets them with go_kin_set_flags once it's there.
+*/
+extern go_result go_kin_inv_nearest(void * kins,
+				    const go_pose * world,
+				    const go_real * weights,
+				    go_real * joints,
+				    go_flag * iflags);
+
 extern go_kin_type go_kin_get_type(void * kins);
 
 extern go_result go_kin_set_parameters(void * kins, go_link * params, go_integer num);
@@ -119,6 +216,150 @@ extern go_result go_kin_get_flags(void *kins,
 				  go_flag *fflags,
 				  go_flag *iflags);
 
+/*
+  For kinematics that solve iteratively, these return how many
+  iterations the last call to go_kin_fwd or go_kin_inv took. For
+  closed-form kinematics they return 0.
+*/
+extern go_integer go_kin_fwd_iterations(void *kins);
+
+extern go_integer go_kin_inv_iterations(void *kins);
+
+/*
+  The function table for a kind of kinematics. Those a kind doesn't
+  have are null, and the go_kin_ call does its default, e.g., the
+  batches loop over the scalar calls.
+*/
+typedef struct {
+  const char * (*get_name)(void);
+  go_integer (*size)(void);
+  go_result (*init)(void * kins);
+  go_integer (*num_joints)(void * kins);
+  go_result (*fwd)(void * kins, const go_real * joint, go_pose * world);
+  go_result (*inv)(void * kins, const go_pose * world, go_real * joint);
+  go_kin_type (*get_type)(void * kins);
+  go_result (*set_parameters)(void * kins, go_link * params, go_integer num);
+  go_result (*get_parameters)(void * kins, go_link * params, go_integer num);
+  go_result (*jac_inv)(void * kins, const go_pose * pos, const go_vel * vel, const go_real * joints, go_real * jointvels);
+  go_result (*jac_fwd)(void * kins, const go_real * joints, const go_real * jointvels, const go_pose * pos, go_vel * vel);
+  go_result (*set_flags)(void * kins, go_flag fflags, go_flag iflags);
+  go_result (*get_flags)(void * kins, go_flag * fflags, go_flag * iflags);
+  go_integer (*fwd_iterations)(void * kins);
+  go_integer (*inv_iterations)(void * kins);
+  go_result (*fwd_batch)(void * kins, go_integer num, go_real ** joints, go_pose_batch * world, go_result * results);
+  go_result (*inv_batch)(void * kins, go_integer num, const go_pose_batch * world, go_real ** joints, go_result * results);
+  go_result (*inv_all)(void * kins, const go_pose * world, go_real * joints, go_flag * iflags, go_integer * count);
+} go_kin_ops;
+
+/*
+  The predictor seeds iterative kinematics from the solutions of the
+  last few cycles, extrapolating them to first or second order, so
+  at speed the solver starts closer to where it will end up. Cycles
+  are told apart by a 'stamp' the caller increments each cycle, and
+  history that isn't from consecutive cycles is dropped, so the
+  seed passed in is left alone until there's enough to go on.
+
+  The predictor is separate from the kinematics structure, so the
+  kinematics see only a better seed.
+*/
+
+enum {
+  GO_KIN_PREDICT_ORDER_MAX = 2,
+  GO_KIN_PREDICT_JOINTS = 8
+};
+
+typedef struct {
+  go_real joints[GO_KIN_PREDICT_ORDER_MAX + 1][GO_KIN_PREDICT_JOINTS];
+  go_pose pose[GO_KIN_PREDICT_ORDER_MAX + 1];
+  go_integer order;		/* 0 turns it off, else 1 or 2 */
+  go_integer number;		/* how many solutions are held, newest first */
+  go_integer stamp;		/* the cycle of the newest */
+} go_kin_predictor;
+
+extern go_result go_kin_predict_init(go_kin_predictor *p, go_integer order);
+
+/*
+  Replaces the seed 'joints' with the extrapolation for cycle 'stamp',
+  returning GO_RESULT_OK, or leaves it and returns GO_RESULT_IGNORED
+  if there's no history for the cycle before.
+*/
+extern go_result go_kin_predict_joints(go_kin_predictor *p, go_integer stamp, go_integer num, go_real *joints);
+
+/* Adds the solution 'joints' for cycle 'stamp' to the history. */
+extern go_result go_kin_predict_joints_add(go_kin_predictor *p, go_integer stamp, go_integer num, const go_real *joints);
+
+/* As go_kin_predict_joints, for the seed pose of the forward kinematics. */
+extern go_result go_kin_predict_pose(go_kin_predictor *p, go_integer stamp, go_pose *pose);
+
+/* As go_kin_predict_joints_add, for forward kinematics solutions. */
+extern go_result go_kin_predict_pose_add(go_kin_predictor *p, go_integer stamp, const go_pose *pose);
+
+/*
+  The cache holds inverse kinematics solutions for poses that come up
+  again and again, such as the taught poses of a repetitive cell, so
+  they're not solved anew each time. Poses are rounded to the cache's
+  resolutions, in length units for the translation and in radians for
+  the rotation, and matched along with the inverse flags, so a solution
+  may be for a pose up to half the resolution away. That makes it fit
+  for checking the end of a move, not for servo setpoints. When the
+  cache is full the least recently used solution is dropped.
+
+  A solution is only used if each joint is within 'jump' of the seed,
+  so that one solved from some other seed doesn't switch the robot to
+  another of its solutions. Clear the cache whenever the kinematics
+  parameters change.
+*/
+
+enum {
+  GO_KIN_CACHE_SIZE = 256,
+  GO_KIN_CACHE_BUCKETS = 64,
+  GO_KIN_CACHE_JOINTS = 8
+};
+
+typedef struct {
+  long key[7];			/* the rounded pose */
+  go_flag iflags;
+  go_real joints[GO_KIN_CACHE_JOINTS];
+  go_integer next;		/* the next in its bucket, or -1 */
+  go_integer older;		/* the next less recently used, or -1 */
+  go_integer newer;		/* the next more recently used, or -1 */
+} go_kin_cache_entry;
+
+typedef struct {
+  go_kin_cache_entry entry[GO_KIN_CACHE_SIZE];
+  go_integer bucket[GO_KIN_CACHE_BUCKETS];
+  go_integer size;		/* how many entries to use, 0 for none */
+  go_integer num;		/* how many joints */
+  go_real resolution;		/* for the translation */
+  go_real rot_resolution;	/* for the rotation */
+  go_real jump;
+  go_integer count;		/* how many entries are in use */
+  go_integer newest;		/* the most recently used, or -1 */
+  go_integer oldest;		/* the least recently used, or -1 */
+  go_integer hits;
+  go_integer misses;
+} go_kin_cache;
+
+/*
+  Sets up the cache to hold 'size' solutions of 'num' joints, with
+  translations rounded to 'resolution' and rotations to
+  'rot_resolution'. A size of 0 turns it off.
+*/
+extern go_result go_kin_cache_init(go_kin_cache *c, go_integer size, go_integer num, go_real resolution, go_real rot_resolution, go_real jump);
+
+/* Drops all the solutions, leaving the counts. */
+extern go_result go_kin_cache_clear(go_kin_cache *c);
+
+/*
+  Replaces the seed 'joints' with the solution for 'pose' and returns
+  GO_RESULT_OK if there's one near them, or leaves them and returns
+  GO_RESULT_IGNORED if not, counting a hit or miss.
+*/
+extern go_result go_kin_cache_get(go_kin_cache *c, void *kins, const go_pose *pose, go_real *joints);
+
+/* Adds the solution 'joints' for 'pose', dropping the oldest if full. */
+extern go_result go_kin_cache_put(go_kin_cache *c, void *kins, const go_pose *pose, const go_real *joints);
+
 #if 0
 {
 #endif
@@ -0,0 +1,931 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file gokingen.c
+
+  \brief Makes a kinematics module for one serial robot, with the link
+  parameters from its .ini file built into the code.
+
+  The general serial kinematics, genserkins, runs the links through
+  go_link_joint_set and the pose and matrix math each time. For a
+  robot whose links never change this is mostly multiplying by zeros
+  and ones. This writes out the forward kinematics and the Jacobian
+  as straight-line code, with the products worked out here for the
+  parts known ahead of time, so that only the terms that depend on
+  the joints are left. The inverse kinematics is genserkins' own,
+  which gets its Jacobian through the genser_jfwd_func hook.
+
+  Syntax: gokingen -i <ini file> -n <name> {-o <directory>}
+
+  writes <name>kins.c and <name>kins.h, with the kinematics known as
+  "<name>kins" to go_kin_select.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>		/* malloc */
+#include <string.h>		/* strncpy */
+#include <ctype.h>		/* toupper */
+#include <math.h>		/* fabs */
+#include <inifile.h>
+#include <ulapi.h>		/* ulapi_getopt */
+#include "go.h"			/* go_link */
+#include "genserkins.h"		/* GENSER_MAX_JOINTS */
+
+static int
+ini_load(char * inifile_name,
+	 int * link_number,
+	 go_link * link_params)
+{
+  FILE * fp;
+  const char * inistring;
+  char servo_string[32];
+  int link;
+  double m_per_length_units = 1;
+  double rad_per_angle_units = 1;
+  double d1, d2, d3, d4, d5, d6, d7, d8, d9;
+  go_rpy rpy;
+  go_cart cart;
+
+  if (NULL == (fp = fopen(inifile_name, "r"))) return 1;
+
+#define CLOSE_AND_RETURN(ret)			\
+  fclose(fp);					\
+  return (ret)
+
+  inistring = ini_find(fp, "LENGTH_UNITS_PER_M", "GOMOTION");
+  if (NULL == inistring) {
+    fprintf(stderr, "[GOMOTION] LENGTH_UNITS_PER_M not found, using 1\n");
+  } else if (1 != sscanf(inistring, "%lf", &d1) || d1 <= 0.0) {
+    fprintf(stderr, "bad entry: [GOMOTION] LENGTH_UNITS_PER_M = %s\n", inistring);
+    CLOSE_AND_RETURN(1);
+  } else {
+    m_per_length_units = 1.0 / d1;
+  }
+
+  inistring = ini_find(fp, "ANGLE_UNITS_PER_RAD", "GOMOTION");
+  if (NULL == inistring) {
+    fprintf(stderr, "[GOMOTION] ANGLE_UNITS_PER_RAD not found, using 1\n");
+  } else if (1 != sscanf(inistring, "%lf", &d1) || d1 <= 0.0) {
+    fprintf(stderr, "bad entry: [GOMOTION] ANGLE_UNITS_PER_RAD = %s\n", inistring);
+    CLOSE_AND_RETURN(1);
+  } else {
+    rad_per_angle_units = 1.0 / d1;
+  }
+
+#define TGL(x) (go_real) ((x) * m_per_length_units)
+#define TGA(x) (go_real) ((x) * rad_per_angle_units)
+
+  for (link = 0; link < GENSER_MAX_JOINTS; link++) {
+    sprintf(servo_string, "SERVO_%d", link + 1);
+
+    inistring = ini_find(fp, "QUANTITY", servo_string);
+    if (NULL == inistring) {
+      /* no "QUANTITY" in this section, or no section, so we're done */
+      break;
+    } else if (ini_match(inistring, "ANGLE")) {
+      link_params[link].quantity = GO_QUANTITY_ANGLE;
+    } else if (ini_match(inistring, "LENGTH")) {
+      link_params[link].quantity = GO_QUANTITY_LENGTH;
+    } else {
+      fprintf(stderr, "bad entry: [%s] QUANTITY = %s\n", servo_string, inistring);
+      CLOSE_AND_RETURN(1);
+    }
+
+    go_body_init(&link_params[link].body);
+
+    inistring = ini_find(fp, "MASS", servo_string);
+    if (NULL != inistring) {
+      if (1 == sscanf(inistring, "%lf", &d1)) {
+	link_params[link].body.mass = d1;
+      } else {
+	fprintf(stderr, "bad entry: [%s] MASS = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    }
+
+    inistring = ini_find(fp, "INERTIA", servo_string);
+    if (NULL != inistring) {
+      if (9 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6, &d7, &d8, &d9)) {
+	link_params[link].body.inertia[0][0] = TGL(TGL(d1));
+	link_params[link].body.inertia[0][1] = TGL(TGL(d2));
+	link_params[link].body.inertia[0][2] = TGL(TGL(d3));
+	link_params[link].body.inertia[1][0] = TGL(TGL(d4));
+	link_params[link].body.inertia[1][1] = TGL(TGL(d5));
+	link_params[link].body.inertia[1][2] = TGL(TGL(d6));
+	link_params[link].body.inertia[2][0] = TGL(TGL(d7));
+	link_params[link].body.inertia[2][1] = TGL(TGL(d8));
+	link_params[link].body.inertia[2][2] = TGL(TGL(d9));
+      } else {
+	fprintf(stderr, "bad entry: [%s] INERTIA = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    }
+
+    if (NULL != (inistring = ini_find(fp, "DH_PARAMETERS", servo_string))) {
+      if (4 == sscanf(inistring, "%lf %lf %lf %lf", &d1, &d2, &d3, &d4)) {
+	link_params[link].u.dh.a = TGL(d1);
+	link_params[link].u.dh.alpha = TGA(d2);
+	link_params[link].u.dh.d = TGL(d3);
+	link_params[link].u.dh.theta = TGA(d4);
+	link_params[link].type = GO_LINK_DH;
+      } else {
+	fprintf(stderr, "bad entry: [%s] DH = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "PP_PARAMETERS", servo_string))) {
+      if (6 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+	link_params[link].u.pp.pose.tran.x = TGL(d1);
+	link_params[link].u.pp.pose.tran.y = TGL(d2);
+	link_params[link].u.pp.pose.tran.z = TGL(d3);
+	rpy.r = TGA(d4);
+	rpy.p = TGA(d5);
+	rpy.y = TGA(d6);
+	go_rpy_quat_convert(&rpy, &link_params[link].u.pp.pose.rot);
+	link_params[link].type = GO_LINK_PP;
+      } else {
+	fprintf(stderr, "bad entry: [%s] PP = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "URDF_PARAMETERS", servo_string))) {
+      if (9 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6, &d7, &d8, &d9)) {
+	link_params[link].u.urdf.pose.tran.x = TGL(d1);
+	link_params[link].u.urdf.pose.tran.y = TGL(d2);
+	link_params[link].u.urdf.pose.tran.z = TGL(d3);
+	rpy.r = TGA(d4);
+	rpy.p = TGA(d5);
+	rpy.y = TGA(d6);
+	go_rpy_quat_convert(&rpy, &link_params[link].u.urdf.pose.rot);
+	cart.x = TGL(d7);
+	cart.y = TGL(d8);
+	cart.z = TGL(d9);
+	if (GO_RESULT_OK != go_cart_unit(&cart, &cart)) {
+	  fprintf(stderr, "bad entry: [%s] URDF = %s\n", servo_string, inistring);
+	  CLOSE_AND_RETURN(1);
+	}
+	link_params[link].u.urdf.axis = cart;
+	link_params[link].type = GO_LINK_URDF;
+      } else {
+	fprintf(stderr, "bad entry: [%s] URDF = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else {
+      /* only serial links can be built in */
+      fprintf(stderr, "no DH,PP,URDF_PARAMETERS in [%s]\n", servo_string);
+      CLOSE_AND_RETURN(1);
+    }
+  } /* for (link) */
+  *link_number = link;
+
+#undef TGL
+#undef TGA
+
+  CLOSE_AND_RETURN(0);
+}
+
+/*
+  The code is worked out symbolically. Each entry of the rotation
+  matrix and translation vector of the chain so far is either a number
+  known here, or a variable in the generated code. New entries are
+  sums of products of at most two of these, with numbers for
+  coefficients; those that come out to a number or to another
+  variable don't need any code.
+*/
+
+/* numbers this close to 0 or 1 are taken to be 0 or 1 */
+#define GEN_SMALL 1.0e-15
+
+/* ATOM_LEN fits "joints[%d]" with any int, so names aren't cut off */
+enum {ATOM_MAX = 4096, ATOM_LEN = 32, TERM_MAX = 64};
+
+/* the variables, and the joints and their sines and cosines */
+static char atom_name[ATOM_MAX][ATOM_LEN];
+static int atom_declare[ATOM_MAX];
+static int atom_num = 0;
+static int var_num = 0;
+
+typedef struct {
+  int atom;			/* index of the variable, or -1 */
+  double val;			/* the number, if not a variable */
+} gen_elem;
+
+typedef struct {
+  double coef;
+  int a;			/* first variable, or -1 */
+  int b;			/* second variable, or -1 */
+} gen_term;
+
+typedef struct {
+  gen_term term[TERM_MAX];
+  int num;
+} gen_sum;
+
+/* the code is written here, and the declarations ahead of it after */
+static FILE * gen_body = NULL;
+
+static double gen_snap(double x)
+{
+  if (fabs(x) < GEN_SMALL) return 0;
+  if (fabs(x - 1) < GEN_SMALL) return 1;
+  if (fabs(x + 1) < GEN_SMALL) return -1;
+  return x;
+}
+
+static gen_elem gen_num(double x)
+{
+  gen_elem e;
+
+  e.atom = -1;
+  e.val = gen_snap(x);
+
+  return e;
+}
+
+static gen_elem gen_atom(const char * name, int declare)
+{
+  gen_elem e;
+
+  if (atom_num >= ATOM_MAX) {
+    fprintf(stderr, "too many variables\n");
+    exit(1);
+  }
+  strncpy(atom_name[atom_num], name, ATOM_LEN);
+  atom_name[atom_num][ATOM_LEN - 1] = 0;
+  atom_declare[atom_num] = declare;
+  e.atom = atom_num++;
+  e.val = 0;
+
+  return e;
+}
+
+static void gen_sum_init(gen_sum * sum)
+{
+  sum->num = 0;
+}
+
+/* adds coef * e1 * e2 to the sum */
+static void gen_sum_add(gen_sum * sum, double coef, gen_elem e1, gen_elem e2)
+{
+  int a, b, t;
+
+  if (e1.atom < 0) coef *= e1.val;
+  if (e2.atom < 0) coef *= e2.val;
+  if (0 == coef) return;
+  a = e1.atom, b = e2.atom;
+  if (a < b) t = a, a = b, b = t;
+
+  for (t = 0; t < sum->num; t++) {
+    if (sum->term[t].a == a && sum->term[t].b == b) {
+      sum->term[t].coef += coef;
+      return;
+    }
+  }
+  if (sum->num >= TERM_MAX) {
+    fprintf(stderr, "too many terms\n");
+    exit(1);
+  }
+  sum->term[sum->num].coef = coef;
+  sum->term[sum->num].a = a;
+  sum->term[sum->num].b = b;
+  sum->num++;
+}
+
+static void gen_number_print(FILE * fp, double x)
+{
+  char buffer[32];
+
+  sprintf(buffer, "%.17g", x);
+  fprintf(fp, "%s", buffer);
+  /* make sure it's a real number */
+  if (NULL == strpbrk(buffer, ".eEn")) fprintf(fp, ".0");
+}
+
+static void gen_elem_print(FILE * fp, gen_elem e)
+{
+  if (e.atom < 0) gen_number_print(fp, e.val);
+  else fprintf(fp, "%s", atom_name[e.atom]);
+}
+
+/* writes out the sum, if needed, and returns what it came to */
+static gen_elem gen_sum_elem(gen_sum * sum)
+{
+  char name[ATOM_LEN];
+  gen_term * term;
+  gen_elem e;
+  int t, n;
+
+  for (t = 0, n = 0; t < sum->num; t++) {
+    sum->term[t].coef = gen_snap(sum->term[t].coef);
+    if (0 != sum->term[t].coef) sum->term[n++] = sum->term[t];
+  }
+  sum->num = n;
+
+  if (0 == sum->num) return gen_num(0);
+  term = &sum->term[0];
+  if (1 == sum->num && term->a < 0) return gen_num(term->coef);
+  if (1 == sum->num && 1 == term->coef && term->b < 0) {
+    e.atom = term->a;
+    e.val = 0;
+    return e;
+  }
+
+  snprintf(name, sizeof(name), "v%d", var_num++);
+  e = gen_atom(name, 1);
+  fprintf(gen_body, "  %s =", name);
+  for (t = 0; t < sum->num; t++) {
+    term = &sum->term[t];
+    fprintf(gen_body, " %s", term->coef < 0 ? "-" : t > 0 ? "+ " : "");
+    if (term->coef < 0 && t > 0) fprintf(gen_body, " ");
+    if (term->a < 0) {
+      gen_number_print(gen_body, fabs(term->coef));
+      continue;
+    }
+    if (1 != fabs(term->coef)) {
+      gen_number_print(gen_body, fabs(term->coef));
+      fprintf(gen_body, "*");
+    }
+    fprintf(gen_body, "%s", atom_name[term->a]);
+    if (term->b >= 0) fprintf(gen_body, "*%s", atom_name[term->b]);
+  }
+  fprintf(gen_body, ";\n");
+
+  return e;
+}
+
+/* the chain so far, R[row][col] and p[row] */
+static gen_elem gen_R[3][3];
+static gen_elem gen_p[3];
+
+static void gen_chain_init(void)
+{
+  int i, j;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      gen_R[i][j] = gen_num(i == j ? 1 : 0);
+    }
+    gen_p[i] = gen_num(0);
+  }
+}
+
+/* p = p + R t, with t(q) = t0 + tq q */
+static void gen_chain_tran(const double t0[3], const double tq[3], gen_elem q)
+{
+  gen_elem one = gen_num(1);
+  gen_sum sum;
+  int i, k;
+
+  for (i = 0; i < 3; i++) {
+    gen_sum_init(&sum);
+    gen_sum_add(&sum, 1, gen_p[i], one);
+    for (k = 0; k < 3; k++) {
+      gen_sum_add(&sum, gen_snap(t0[k]), gen_R[i][k], one);
+      gen_sum_add(&sum, gen_snap(tq[k]), gen_R[i][k], q);
+    }
+    gen_p[i] = gen_sum_elem(&sum);
+  }
+}
+
+/* R = R K, with K(c,s) = K0 + Kc c + Ks s */
+static void gen_chain_rot(double K0[3][3], double Kc[3][3], double Ks[3][3], gen_elem c, gen_elem s)
+{
+  gen_elem one = gen_num(1);
+  gen_elem R[3][3];
+  gen_sum sum;
+  int i, j, k;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      gen_sum_init(&sum);
+      for (k = 0; k < 3; k++) {
+	gen_sum_add(&sum, gen_snap(K0[k][j]), gen_R[i][k], one);
+	gen_sum_add(&sum, gen_snap(Kc[k][j]), gen_R[i][k], c);
+	gen_sum_add(&sum, gen_snap(Ks[k][j]), gen_R[i][k], s);
+      }
+      R[i][j] = gen_sum_elem(&sum);
+    }
+  }
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      gen_R[i][j] = R[i][j];
+    }
+  }
+}
+
+/* the constant transform (R, t) */
+static void gen_chain_const(const go_mat * mat, const go_cart * tran)
+{
+  static double zero[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+  double K0[3][3];
+  double t0[3], tq[3] = {0, 0, 0};
+  gen_elem none = gen_num(0);
+
+  /* go_mat holds the columns */
+  K0[0][0] = mat->x.x, K0[0][1] = mat->y.x, K0[0][2] = mat->z.x;
+  K0[1][0] = mat->x.y, K0[1][1] = mat->y.y, K0[1][2] = mat->z.y;
+  K0[2][0] = mat->x.z, K0[2][1] = mat->y.z, K0[2][2] = mat->z.z;
+  t0[0] = tran->x, t0[1] = tran->y, t0[2] = tran->z;
+
+  gen_chain_tran(t0, tq, none);
+  gen_chain_rot(K0, zero, zero, none, none);
+}
+
+/* rotation by the joint about the unit axis 'a', given its sine and cosine */
+static void gen_chain_joint_rot(const double a[3], gen_elem c, gen_elem s)
+{
+  double K0[3][3], Kc[3][3], Ks[3][3];
+  int i, j;
+
+  /* Rodrigues: a a^T + (I - a a^T) c + [a]x s */
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      K0[i][j] = a[i] * a[j];
+      Kc[i][j] = (i == j ? 1 : 0) - a[i] * a[j];
+    }
+  }
+  Ks[0][0] = 0, Ks[0][1] = -a[2], Ks[0][2] = a[1];
+  Ks[1][0] = a[2], Ks[1][1] = 0, Ks[1][2] = -a[0];
+  Ks[2][0] = -a[1], Ks[2][1] = a[0], Ks[2][2] = 0;
+
+  gen_chain_rot(K0, Kc, Ks, c, s);
+}
+
+/* R a, the axis 'a' of the current frame in the base frame */
+static void gen_chain_axis(const double a[3], gen_elem axis[3])
+{
+  gen_elem one = gen_num(1);
+  gen_sum sum;
+  int i, k;
+
+  for (i = 0; i < 3; i++) {
+    gen_sum_init(&sum);
+    for (k = 0; k < 3; k++) {
+      gen_sum_add(&sum, gen_snap(a[k]), gen_R[i][k], one);
+    }
+    axis[i] = gen_sum_elem(&sum);
+  }
+}
+
+/*
+  Writes the chain of links, leaving the end in gen_R and gen_p, and
+  the base frame joint axes and frame origins in 'axis' and 'origin'.
+*/
+static void gen_chain(const go_link * links, int link_number, gen_elem axis[][3], gen_elem origin[][3])
+{
+  static const double zaxis[3] = {0, 0, 1};
+  double a[3], t0[3], tq[3];
+  char name[ATOM_LEN];
+  gen_elem none = gen_num(0);
+  gen_elem c = none, s = none, q;
+  go_pose pose;
+  go_mat mat;
+  go_real sal, cal, sth, cth;
+  int link, i;
+
+  gen_chain_init();
+
+  for (link = 0; link < link_number; link++) {
+    snprintf(name, sizeof(name), "joints[%d]", link);
+    q = gen_atom(name, 0);
+    if (GO_QUANTITY_ANGLE == links[link].quantity) {
+      snprintf(name, sizeof(name), "s%d", link);
+      s = gen_atom(name, 1);
+      snprintf(name, sizeof(name), "c%d", link);
+      c = gen_atom(name, 1);
+      fprintf(gen_body, "  go_sincos(joints[%d], &s%d, &c%d);\n", link, link, link);
+    }
+
+    if (GO_LINK_DH == links[link].type) {
+      /* Rx(alpha) Tx(a), then Rz(theta) and Tz(d), either the joint */
+      go_sincos(links[link].u.dh.alpha, &sal, &cal);
+      mat.x.x = 1, mat.y.x = 0, mat.z.x = 0;
+      mat.x.y = 0, mat.y.y = cal, mat.z.y = -sal;
+      mat.x.z = 0, mat.y.z = sal, mat.z.z = cal;
+      pose.tran.x = links[link].u.dh.a, pose.tran.y = 0, pose.tran.z = 0;
+      gen_chain_const(&mat, &pose.tran);
+      for (i = 0; i < 3; i++) a[i] = zaxis[i];
+      if (GO_QUANTITY_ANGLE == links[link].quantity) {
+	/* Tz(d) first, since Rz(theta) leaves Z alone */
+	t0[0] = 0, t0[1] = 0, t0[2] = links[link].u.dh.d;
+	tq[0] = 0, tq[1] = 0, tq[2] = 0;
+	gen_chain_tran(t0, tq, none);
+	gen_chain_joint_rot(a, c, s);
+      } else {
+	go_sincos(links[link].u.dh.theta, &sth, &cth);
+	mat.x.x = cth, mat.y.x = -sth, mat.z.x = 0;
+	mat.x.y = sth, mat.y.y = cth, mat.z.y = 0;
+	mat.x.z = 0, mat.y.z = 0, mat.z.z = 1;
+	pose.tran.x = 0, pose.tran.y = 0, pose.tran.z = links[link].u.dh.d;
+	gen_chain_const(&mat, &pose.tran);
+      }
+    } else {
+      if (GO_LINK_PP == links[link].type) {
+	pose = links[link].u.pp.pose;
+	for (i = 0; i < 3; i++) a[i] = zaxis[i];
+      } else {
+	pose = links[link].u.urdf.pose;
+	a[0] = links[link].u.urdf.axis.x;
+	a[1] = links[link].u.urdf.axis.y;
+	a[2] = links[link].u.urdf.axis.z;
+      }
+      go_quat_mat_convert(&pose.rot, &mat);
+      gen_chain_const(&mat, &pose.tran);
+      if (GO_QUANTITY_ANGLE == links[link].quantity) {
+	gen_chain_joint_rot(a, c, s);
+      }
+    }
+
+    if (NULL != axis) {
+      gen_chain_axis(a, axis[link]);
+      for (i = 0; i < 3; i++) origin[link][i] = gen_p[i];
+    }
+
+    if (GO_QUANTITY_LENGTH == links[link].quantity) {
+      t0[0] = 0, t0[1] = 0, t0[2] = 0;
+      gen_chain_tran(t0, a, q);
+    }
+  }
+}
+
+/* starts a function, whose body goes to gen_body until gen_func_end */
+static void gen_func_begin(void)
+{
+  atom_num = 0;
+  var_num = 0;
+  gen_body = tmpfile();
+  if (NULL == gen_body) {
+    fprintf(stderr, "can't open temporary file\n");
+    exit(1);
+  }
+}
+
+/* writes the declarations, then the body */
+static void gen_func_end(FILE * fp)
+{
+  int t, n, ch;
+
+  for (t = 0, n = 0; t < atom_num; t++) {
+    if (! atom_declare[t]) continue;
+    fprintf(fp, "%s%s", 0 == n % 8 ? (0 == n ? "  go_real " : ";\n  go_real ") : ", ", atom_name[t]);
+    n++;
+  }
+  if (n > 0) fprintf(fp, ";\n\n");
+
+  rewind(gen_body);
+  while (EOF != (ch = getc(gen_body))) putc(ch, fp);
+  fclose(gen_body);
+  gen_body = NULL;
+}
+
+static void gen_hom_print(FILE * fp)
+{
+  static const char xyz[] = "xyz";
+  int i, j;
+
+  for (j = 0; j < 3; j++) {
+    for (i = 0; i < 3; i++) {
+      fprintf(fp, "  hom->rot.%c.%c = ", xyz[j], xyz[i]);
+      gen_elem_print(fp, gen_R[i][j]);
+      fprintf(fp, ";\n");
+    }
+  }
+  for (i = 0; i < 3; i++) {
+    fprintf(fp, "  hom->tran.%c = ", xyz[i]);
+    gen_elem_print(fp, gen_p[i]);
+    fprintf(fp, ";\n");
+  }
+}
+
+static void gen_links_print(FILE * fp, const char * name, const go_link * links, int link_number)
+{
+  const go_pose * pose;
+  int link, i, j;
+
+#define GEN_PRINT(fmt, x)			\
+  fprintf(fp, fmt, link);			\
+  gen_number_print(fp, x);			\
+  fprintf(fp, ";\n")
+
+  fprintf(fp, "static void %s_links(go_link * links)\n{\n", name);
+  for (link = 0; link < link_number; link++) {
+    if (link > 0) fprintf(fp, "\n");
+    fprintf(fp, "  go_body_init(&links[%d].body);\n", link);
+    GEN_PRINT("  links[%d].body.mass = ", links[link].body.mass);
+    for (i = 0; i < 3; i++) {
+      for (j = 0; j < 3; j++) {
+	if (0 == links[link].body.inertia[i][j]) continue;
+	fprintf(fp, "  links[%d].body.inertia[%d][%d] = ", link, i, j);
+	gen_number_print(fp, links[link].body.inertia[i][j]);
+	fprintf(fp, ";\n");
+      }
+    }
+    fprintf(fp, "  links[%d].quantity = %s;\n", link, GO_QUANTITY_ANGLE == links[link].quantity ? "GO_QUANTITY_ANGLE" : "GO_QUANTITY_LENGTH");
+    if (GO_LINK_DH == links[link].type) {
+      fprintf(fp, "  links[%d].type = GO_LINK_DH;\n", link);
+      GEN_PRINT("  links[%d].u.dh.a = ", links[link].u.dh.a);
+      GEN_PRINT("  links[%d].u.dh.alpha = ", links[link].u.dh.alpha);
+      GEN_PRINT("  links[%d].u.dh.d = ", links[link].u.dh.d);
+      GEN_PRINT("  links[%d].u.dh.theta = ", links[link].u.dh.theta);
+      continue;
+    }
+    if (GO_LINK_PP == links[link].type) {
+      fprintf(fp, "  links[%d].type = GO_LINK_PP;\n", link);
+      pose = &links[link].u.pp.pose;
+      GEN_PRINT("  links[%d].u.pp.pose.tran.x = ", pose->tran.x);
+      GEN_PRINT("  links[%d].u.pp.pose.tran.y = ", pose->tran.y);
+      GEN_PRINT("  links[%d].u.pp.pose.tran.z = ", pose->tran.z);
+      GEN_PRINT("  links[%d].u.pp.pose.rot.s = ", pose->rot.s);
+      GEN_PRINT("  links[%d].u.pp.pose.rot.x = ", pose->rot.x);
+      GEN_PRINT("  links[%d].u.pp.pose.rot.y = ", pose->rot.y);
+      GEN_PRINT("  links[%d].u.pp.pose.rot.z = ", pose->rot.z);
+      continue;
+    }
+    fprintf(fp, "  links[%d].type = GO_LINK_URDF;\n", link);
+    pose = &links[link].u.urdf.pose;
+    GEN_PRINT("  links[%d].u.urdf.pose.tran.x = ", pose->tran.x);
+    GEN_PRINT("  links[%d].u.urdf.pose.tran.y = ", pose->tran.y);
+    GEN_PRINT("  links[%d].u.urdf.pose.tran.z = ", pose->tran.z);
+    GEN_PRINT("  links[%d].u.urdf.pose.rot.s = ", pose->rot.s);
+    GEN_PRINT("  links[%d].u.urdf.pose.rot.x = ", pose->rot.x);
+    GEN_PRINT("  links[%d].u.urdf.pose.rot.y = ", pose->rot.y);
+    GEN_PRINT("  links[%d].u.urdf.pose.rot.z = ", pose->rot.z);
+    GEN_PRINT("  links[%d].u.urdf.axis.x = ", links[link].u.urdf.axis.x);
+    GEN_PRINT("  links[%d].u.urdf.axis.y = ", links[link].u.urdf.axis.y);
+    GEN_PRINT("  links[%d].u.urdf.axis.z = ", links[link].u.urdf.axis.z);
+  }
+  fprintf(fp, "}\n\n");
+
+#undef GEN_PRINT
+}
+
+static void gen_hom_func_print(FILE * fp, const char * name, const go_link * links, int link_number)
+{
+  fprintf(fp, "static void %s_hom(const go_real * joints, go_hom * hom)\n{\n", name);
+  gen_func_begin();
+  gen_chain(links, link_number, NULL, NULL);
+  gen_func_end(fp);
+  gen_hom_print(fp);
+  fprintf(fp, "}\n\n");
+}
+
+/*
+  The Jacobian is in the base frame, as genserkins has it with
+  ROTATE_JACOBIANS_BACK. For revolute joints the column is the axis
+  crossed with the vector from the joint to the end, and the axis;
+  for prismatic joints it's the axis, and nothing.
+*/
+static void gen_jfwd_func_print(FILE * fp, const char * name, const go_link * links, int link_number)
+{
+  gen_elem axis[GENSER_MAX_JOINTS][3];
+  gen_elem origin[GENSER_MAX_JOINTS][3];
+  gen_elem d[3], J[6][GENSER_MAX_JOINTS];
+  gen_elem one = gen_num(1);
+  gen_sum sum;
+  int link, i;
+
+  fprintf(fp, "static go_result %s_jfwd(const go_real * joints, go_matrix * Jfwd, go_pose * T_L_0)\n{\n", name);
+  fprintf(fp, "  go_hom h;\n  go_hom * hom = &h;\n");
+  gen_func_begin();
+  gen_chain(links, link_number, axis, origin);
+
+  for (link = 0; link < link_number; link++) {
+    if (GO_QUANTITY_LENGTH == links[link].quantity) {
+      for (i = 0; i < 3; i++) {
+	J[i][link] = axis[link][i];
+	J[i + 3][link] = gen_num(0);
+      }
+      continue;
+    }
+    for (i = 0; i < 3; i++) {
+      /* the part along the axis drops out of the cross product */
+      if (axis[link][(i + 1) % 3].atom < 0 && 0 == axis[link][(i + 1) % 3].val &&
+	  axis[link][(i + 2) % 3].atom < 0 && 0 == axis[link][(i + 2) % 3].val) {
+	d[i] = gen_num(0);
+	continue;
+      }
+      gen_sum_init(&sum);
+      gen_sum_add(&sum, 1, gen_p[i], one);
+      gen_sum_add(&sum, -1, origin[link][i], one);
+      d[i] = gen_sum_elem(&sum);
+    }
+    for (i = 0; i < 3; i++) {
+      gen_sum_init(&sum);
+      gen_sum_add(&sum, 1, axis[link][(i + 1) % 3], d[(i + 2) % 3]);
+      gen_sum_add(&sum, -1, axis[link][(i + 2) % 3], d[(i + 1) % 3]);
+      J[i][link] = gen_sum_elem(&sum);
+      J[i + 3][link] = axis[link][i];
+    }
+  }
+
+  gen_func_end(fp);
+  for (i = 0; i < 6; i++) {
+    for (link = 0; link < link_number; link++) {
+      fprintf(fp, "  Jfwd->el[%d][%d] = ", i, link);
+      gen_elem_print(fp, J[i][link]);
+      fprintf(fp, ";\n");
+    }
+  }
+  gen_hom_print(fp);
+  fprintf(fp, "\n  return go_hom_pose_convert(hom, T_L_0);\n}\n\n");
+}
+
+static void gen_h_print(FILE * fp, const char * name, const char * NAME)
+{
+  fprintf(fp, "/*\n  %skins.h\n\n  Made by gokingen; don't edit.\n*/\n\n", name);
+  fprintf(fp, "#ifndef %sKINS_H\n#define %sKINS_H\n\n", NAME, NAME);
+  fprintf(fp, "#include \"gotypes.h\"\t\t/* go_result, go_integer */\n");
+  fprintf(fp, "#include \"gomath.h\"\t\t/* go_pose */\n");
+  fprintf(fp, "#include \"gokin.h\"\t\t/* go_kin_ops */\n\n");
+  fprintf(fp, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n#if 0\n}\n#endif\n\n");
+  fprintf(fp, "extern const char *%s_kin_get_name(void);\n\n", name);
+  fprintf(fp, "extern go_result %s_kin_init(void *kins);\n\n", name);
+  fprintf(fp, "extern go_result %s_kin_fwd(void *kins,\n\t\t\t const go_real *joints,\n\t\t\t go_pose *world);\n\n", name);
+  fprintf(fp, "extern go_result %s_kin_set_parameters(void *kins, go_link *params, go_integer num);\n\n", name);
+  fprintf(fp, "extern const go_kin_ops %s_kin_ops;\n\n", name);
+  fprintf(fp, "#if 0\n{\n#endif\n#ifdef __cplusplus\n}\n#endif\n\n");
+  fprintf(fp, "#endif /* %sKINS_H */\n", NAME);
+}
+
+static void gen_c_print(FILE * fp, const char * name, const char * NAME, const char * inifile_name, const go_link * links, int link_number)
+{
+  fprintf(fp, "/*\n  %skins.c\n\n  Made by gokingen from %s; don't edit.\n\n", name, inifile_name);
+  fprintf(fp, "  The serial kinematics for these links, with the forward kinematics\n");
+  fprintf(fp, "  and Jacobian worked out ahead of time. The rest is genserkins'.\n*/\n\n");
+  fprintf(fp, "#include <stddef.h>\t\t/* NULL */\n");
+  fprintf(fp, "#include \"gotypes.h\"\t\t/* go_result, go_integer */\n");
+  fprintf(fp, "#include \"gomath.h\"\t\t/* go_pose */\n");
+  fprintf(fp, "#include \"gokin.h\"\t\t/* go_kin_ops */\n");
+  fprintf(fp, "#include \"genserkins.h\"\t\t/* genser_struct */\n");
+  fprintf(fp, "#include \"%skins.h\"\n\n", name);
+  fprintf(fp, "#define %s_JOINTS %d\n\n", NAME, link_number);
+
+  gen_links_print(fp, name, links, link_number);
+  gen_hom_func_print(fp, name, links, link_number);
+  gen_jfwd_func_print(fp, name, links, link_number);
+
+  fprintf(fp, "const char *%s_kin_get_name(void)\n{\n  return \"%skins\";\n}\n\n", name, name);
+
+  fprintf(fp, "go_result %s_kin_init(void *kins)\n{\n", name);
+  fprintf(fp, "  genser_struct * genser = (genser_struct *) kins;\n  go_result retval;\n\n");
+  fprintf(fp, "  retval = genser_kin_init(kins);\n  if (GO_RESULT_OK != retval) return retval;\n\n");
+  fprintf(fp, "  %s_links(genser->links);\n", name);
+  fprintf(fp, "  genser->link_num = %s_JOINTS;\n", NAME);
+  fprintf(fp, "  genser->jfwd = %s_jfwd;\n\n  return GO_RESULT_OK;\n}\n\n", name);
+
+  fprintf(fp, "go_result %s_kin_fwd(void *kins,\n\t\t\t const go_real *joints,\n\t\t\t go_pose *world)\n{\n", name);
+  fprintf(fp, "  go_hom hom;\n\n  %s_hom(joints, &hom);\n\n  return go_hom_pose_convert(&hom, world);\n}\n\n", name);
+
+  fprintf(fp, "/* the geometry has to be what was built in; the bodies are taken */\n");
+  fprintf(fp, "static go_flag link_match(const go_link * a, const go_link * b)\n{\n");
+  fprintf(fp, "  if (a->type != b->type || a->quantity != b->quantity) return 0;\n\n");
+  fprintf(fp, "  if (GO_LINK_DH == a->type) {\n");
+  fprintf(fp, "    return GO_TRAN_CLOSE(a->u.dh.a, b->u.dh.a) &&\n");
+  fprintf(fp, "      GO_ROT_CLOSE(a->u.dh.alpha, b->u.dh.alpha) &&\n");
+  fprintf(fp, "      GO_TRAN_CLOSE(a->u.dh.d, b->u.dh.d) &&\n");
+  fprintf(fp, "      GO_ROT_CLOSE(a->u.dh.theta, b->u.dh.theta);\n  }\n\n");
+  fprintf(fp, "  if (GO_LINK_PP == a->type) {\n");
+  fprintf(fp, "    return go_pose_pose_compare(&a->u.pp.pose, &b->u.pp.pose);\n  }\n\n");
+  fprintf(fp, "  return go_pose_pose_compare(&a->u.urdf.pose, &b->u.urdf.pose) &&\n");
+  fprintf(fp, "    go_cart_cart_compare(&a->u.urdf.axis, &b->u.urdf.axis);\n}\n\n");
+
+  fprintf(fp, "go_result %s_kin_set_parameters(void *kins, go_link *params, go_integer num)\n{\n", name);
+  fprintf(fp, "  go_link links[%s_JOINTS];\n  go_integer t;\n\n", NAME);
+  fprintf(fp, "  if (%s_JOINTS != num) return GO_RESULT_BAD_ARGS;\n\n", NAME);
+  fprintf(fp, "  %s_links(links);\n", name);
+  fprintf(fp, "  for (t = 0; t < num; t++) {\n    if (! link_match(&links[t], &params[t])) return GO_RESULT_BAD_ARGS;\n  }\n\n");
+  fprintf(fp, "  return genser_kin_set_parameters(kins, params, num);\n}\n\n");
+
+  fprintf(fp, "const go_kin_ops %s_kin_ops = {\n", name);
+  fprintf(fp, "  %s_kin_get_name,\n", name);
+  fprintf(fp, "  genser_kin_size,\n");
+  fprintf(fp, "  %s_kin_init,\n", name);
+  fprintf(fp, "  genser_kin_num_joints,\n");
+  fprintf(fp, "  %s_kin_fwd,\n", name);
+  fprintf(fp, "  genser_kin_inv,\n");
+  fprintf(fp, "  genser_kin_get_type,\n");
+  fprintf(fp, "  %s_kin_set_parameters,\n", name);
+  fprintf(fp, "  genser_kin_get_parameters,\n");
+  fprintf(fp, "  genser_kin_jac_inv,\n");
+  fprintf(fp, "  genser_kin_jac_fwd,\n");
+  fprintf(fp, "  NULL,\n  NULL,\n  NULL,\n");
+  fprintf(fp, "  (go_integer (*)(void *)) genser_kin_inv_iterations,\n");
+  fprintf(fp, "  NULL,\n");
+  fprintf(fp, "  genser_kin_inv_batch,\n");
+  fprintf(fp, "  NULL\n};\n");
+}
+
+/*
+  Syntax: gokingen -i <ini file> -n <name> {-o <directory>}
+*/
+
+int main(int argc, char *argv[])
+{
+  enum { BUFFERLEN = 256 };
+  int option;
+  char inifile_name[BUFFERLEN] = "gomotion.ini";
+  char name[BUFFERLEN] = "";
+  char NAME[BUFFERLEN];
+  char dir[BUFFERLEN] = ".";
+  char path[2 * BUFFERLEN];
+  int link_number;
+  go_link link_params[GENSER_MAX_JOINTS];
+  FILE * fp;
+  int t;
+
+  opterr = 0;
+  while (1) {
+    option = ulapi_getopt(argc, argv, ":i:n:o:");
+    if (option == -1)
+      break;
+
+    switch (option) {
+    case 'i':
+      strncpy(inifile_name, ulapi_optarg, BUFFERLEN);
+      inifile_name[BUFFERLEN - 1] = 0;
+      break;
+
+    case 'n':
+      strncpy(name, ulapi_optarg, BUFFERLEN);
+      name[BUFFERLEN - 1] = 0;
+      break;
+
+    case 'o':
+      strncpy(dir, ulapi_optarg, BUFFERLEN);
+      dir[BUFFERLEN - 1] = 0;
+      break;
+
+    case ':':
+      fprintf(stderr, "missing value for -%c\n", ulapi_optopt);
+      return 1;
+      break;
+
+    default:			/* '?' */
+      fprintf (stderr, "unrecognized option -%c\n", ulapi_optopt);
+      return 1;
+      break;
+    }
+  }
+  if (ulapi_optind < argc) {
+    fprintf(stderr, "extra non-option characters: %s\n", argv[ulapi_optind]);
+    return 1;
+  }
+
+  if (0 == name[0]) {
+    fprintf(stderr, "need a name with -n\n");
+    return 1;
+  }
+  for (t = 0; 0 != name[t]; t++) {
+    if (! (isalnum((int) name[t]) || '_' == name[t])) {
+      fprintf(stderr, "bad name %s, need letters, digits and _\n", name);
+      return 1;
+    }
+    NAME[t] = toupper((int) name[t]);
+  }
+  NAME[t] = 0;
+
+  if (0 != go_init()) {
+    fprintf(stderr, "can't init go\n");
+    return 1;
+  }
+
+  if (0 != ini_load(inifile_name, &link_number, link_params)) {
+    fprintf(stderr, "can't load ini file %s\n", inifile_name);
+    return 1;
+  }
+
+  if (link_number < 1) {
+    fprintf(stderr, "no links found\n");
+    return 1;
+  }
+
+  sprintf(path, "%s/%skins.h", dir, name);
+  if (NULL == (fp = fopen(path, "w"))) {
+    fprintf(stderr, "can't open %s\n", path);
+    return 1;
+  }
+  gen_h_print(fp, name, NAME);
+  fclose(fp);
+
+  sprintf(path, "%s/%skins.c", dir, name);
+  if (NULL == (fp = fopen(path, "w"))) {
+    fprintf(stderr, "can't open %s\n", path);
+    return 1;
+  }
+  gen_c_print(fp, name, NAME, inifile_name, link_params, link_number);
+  fclose(fp);
+
+  return 0;
+}
@@ -18,6 +18,7 @@
 #include <string.h>		/* strncmp */
 #include <ctype.h>		/* isspace */
 #include <stddef.h>		/* NULL, sizeof */
+#include <math.h>		/* fabs */
 #include <inifile.h>
 #include <ulapi.h>		/* ulapi_time */
 #include "go.h"			/* go_pose */
@@ -480,7 +481,7 @@ int main(int argc, char *argv[])
     printf("|%f %f %f|\n ---\n", FGL(FGL(link_params[t].body.inertia[2][0])), FGL(FGL(link_params[t].body.inertia[2][1])), FGL(FGL(link_params[t].body.inertia[2][2]))); \
   }
 
-#define PRINT_TYPE printf("%s\n", go_kin_get_name())
+#define PRINT_TYPE printf("%s\n", go_kin_get_instance_name(kinematics))
 
   if (GO_RESULT_OK != go_kin_select(kin_name)) {
     fprintf(stderr, "can't select kinematics %s\n", kin_name);
@@ -627,6 +628,162 @@ int main(int argc, char *argv[])
       }
       continue;
 
+    } else if (*ptr == 'b') {
+      /* random testing of the batch kinematics, timed */
+      while (!isspace(*ptr) && 0 != *ptr) ptr++;
+      while (isspace(*ptr)) ptr++;
+      if (1 == sscanf(ptr, "%i", &i1) && i1 > 0) {
+	go_real * store;
+	go_real * joints_in[MAX_JOINT_NUM];
+	go_real * joints_out[MAX_JOINT_NUM];
+	go_pose_batch poses;
+	go_result * results;
+	int fwd_bad = 0, inv_bad = 0;
+	double maxerr = 0;
+	store = (go_real *) malloc((2 * link_number + 7) * i1 * sizeof(go_real));
+	results = (go_result *) malloc(i1 * sizeof(go_result));
+	if (NULL == store || NULL == results) {
+	  fprintf(stderr, "can't allocate %d runs\n", i1);
+	} else {
+	  for (tt = 0; tt < link_number; tt++) {
+	    joints_in[tt] = store + tt * i1;
+	    joints_out[tt] = store + (link_number + tt) * i1;
+	  }
+	  poses.x = store + (2 * link_number) * i1;
+	  poses.y = poses.x + i1;
+	  poses.z = poses.y + i1;
+	  poses.s = poses.z + i1;
+	  poses.i = poses.s + i1;
+	  poses.j = poses.i + i1;
+	  poses.k = poses.j + i1;
+	  for (t = 0; t < i1; t++) {
+	    for (tt = 0; tt < link_number; tt++) {
+	      joints_in[tt][t] = GO_PI * go_random() - GO_PI_2;
+	      joints_out[tt][t] = joints_in[tt][t]; /* seed the estimate */
+	    }
+	    go_pose_batch_put(&poses, t, &home_position);
+	  }
+	  start = ulapi_time();
+	  go_kin_fwd_batch(kinematics, i1, joints_in, &poses, results);
+	  diff = ulapi_time() - start;
+	  for (t = 0; t < i1; t++) if (GO_RESULT_OK != results[t]) fwd_bad++;
+	  printf("forward: %d errors, %f usec each\n", fwd_bad, (double) (diff * 1.0e6 / i1));
+	  start = ulapi_time();
+	  go_kin_inv_batch(kinematics, i1, &poses, joints_out, results);
+	  diff = ulapi_time() - start;
+	  for (t = 0; t < i1; t++) {
+	    if (GO_RESULT_OK != results[t]) {
+	      inv_bad++;
+	      continue;
+	    }
+	    for (tt = 0; tt < link_number; tt++) {
+	      d1 = fabs(joints_out[tt][t] - joints_in[tt][t]);
+	      if (d1 > maxerr) maxerr = d1;
+	    }
+	  }
+	  printf("inverse: %d errors, %f usec each, %g max joint difference\n", inv_bad, (double) (diff * 1.0e6 / i1), maxerr);
+	}
+	if (NULL != store) free(store);
+	if (NULL != results) free(results);
+      } else {
+	fprintf(stderr, "need a number of runs\n");
+      }
+      continue;
+
+    } else if (*ptr == 'c') {
+      /* compare against genserkins with the same links, timed */
+      while (!isspace(*ptr) && 0 != *ptr) ptr++;
+      while (isspace(*ptr)) ptr++;
+      if (1 == sscanf(ptr, "%i", &i1) && i1 > 0) {
+	void * genser = NULL;
+	go_real * store;
+	go_real * joints_in;
+	go_real * joints_out;
+	go_real * genser_out;
+	go_pose * poses;
+	go_pose pose;
+	go_quat quat;
+	go_cart cart;
+	go_real mag;
+	int inv_bad = 0, genser_bad = 0, other = 0;
+	double tranerr = 0, roterr = 0, jointerr = 0;
+	ulapi_real genser_diff;
+	store = (go_real *) malloc(3 * link_number * i1 * sizeof(go_real));
+	poses = (go_pose *) malloc(i1 * sizeof(go_pose));
+	if (NULL == store || NULL == poses) {
+	  fprintf(stderr, "can't allocate %d runs\n", i1);
+	} else if (GO_RESULT_OK != go_kin_select("genserkins") ||
+		   NULL == (genser = malloc(go_kin_size())) ||
+		   GO_RESULT_OK != go_kin_init(genser) ||
+		   GO_RESULT_OK != go_kin_set_parameters(genser, link_params, link_number)) {
+	  fprintf(stderr, "can't set up genserkins to compare\n");
+	} else {
+	  joints_in = store;
+	  joints_out = store + link_number * i1;
+	  genser_out = store + 2 * link_number * i1;
+	  for (t = 0; t < i1 * link_number; t++) {
+	    joints_in[t] = GO_PI * go_random() - GO_PI_2;
+	  }
+	  /* the poses are the same as far as they go */
+	  for (t = 0; t < i1; t++) {
+	    go_kin_fwd(genser, &joints_in[t * link_number], &pose);
+	    go_kin_fwd(kinematics, &joints_in[t * link_number], &poses[t]);
+	    go_cart_cart_disp(&pose.tran, &poses[t].tran, &mag);
+	    if (mag > tranerr) tranerr = mag;
+	    go_quat_inv(&pose.rot, &quat);
+	    go_quat_quat_mult(&poses[t].rot, &quat, &quat);
+	    /* the angle is about twice the vector part, when small */
+	    cart.x = quat.x, cart.y = quat.y, cart.z = quat.z;
+	    go_cart_mag(&cart, &mag);
+	    if (2 * mag > roterr) roterr = 2 * mag;
+	  }
+	  printf("forward: %g max position difference, %g max rotation difference\n", tranerr, roterr);
+	  start = ulapi_time();
+	  for (t = 0; t < i1; t++) {
+	    go_kin_fwd(genser, &joints_in[t * link_number], &pose);
+	  }
+	  genser_diff = ulapi_time() - start;
+	  start = ulapi_time();
+	  for (t = 0; t < i1; t++) {
+	    go_kin_fwd(kinematics, &joints_in[t * link_number], &poses[t]);
+	  }
+	  diff = ulapi_time() - start;
+	  printf("forward: %f usec each, genserkins %f\n", (double) (diff * 1.0e6 / i1), (double) (genser_diff * 1.0e6 / i1));
+	  /* seed the inverse a bit away from the answer */
+	  for (t = 0; t < i1 * link_number; t++) {
+	    genser_out[t] = joints_out[t] = joints_in[t] + 0.01;
+	  }
+	  start = ulapi_time();
+	  for (t = 0; t < i1; t++) {
+	    if (GO_RESULT_OK != go_kin_inv(genser, &poses[t], &genser_out[t * link_number])) genser_bad++;
+	  }
+	  genser_diff = ulapi_time() - start;
+	  start = ulapi_time();
+	  for (t = 0; t < i1; t++) {
+	    if (GO_RESULT_OK != go_kin_inv(kinematics, &poses[t], &joints_out[t * link_number])) inv_bad++;
+	  }
+	  diff = ulapi_time() - start;
+	  printf("inverse: %d errors, %f usec each, genserkins %d errors, %f usec each\n", inv_bad, (double) (diff * 1.0e6 / i1), genser_bad, (double) (genser_diff * 1.0e6 / i1));
+	  /* they may go to different solutions, so count those apart */
+	  for (t = 0; t < i1; t++) {
+	    mag = 0;
+	    for (tt = 0; tt < link_number; tt++) {
+	      d1 = fabs(joints_out[t * link_number + tt] - genser_out[t * link_number + tt]);
+	      if (d1 > mag) mag = d1;
+	    }
+	    if (mag > 1.0e-3) other++;
+	    else if (mag > jointerr) jointerr = mag;
+	  }
+	  printf("inverse: %g max joint difference, %d went to other solutions\n", jointerr, other);
+	}
+	if (NULL != genser) free(genser);
+	if (NULL != store) free(store);
+	if (NULL != poses) free(poses);
+      } else {
+	fprintf(stderr, "need a number of runs\n");
+      }
+      continue;
+
     } else if (*ptr == 0) {
       /* blank line */
       continue;
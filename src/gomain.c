@@ -57,6 +57,7 @@ static void * traj_task = NULL;
 
 static void * servo_shm = NULL;
 static void * traj_shm = NULL;
+static void * traj_queue_shm = NULL;
 static void * go_log_shm = NULL;
 static void * go_io_shm = NULL;
 
@@ -69,6 +70,9 @@ go_io_struct * global_go_io_ptr = NULL;
 /* declare comm params that aren't set via the config process later */
 RTAPI_DECL_INT(DEBUG, 0);
 RTAPI_DECL_INT(TRAJ_SHM_KEY, 201);
+RTAPI_DECL_INT(TRAJ_QUEUE_SHM_KEY, 202);
+RTAPI_DECL_INT(TRAJ_QUEUE_SIZE, 100);
+RTAPI_DECL_INT(TRAJ_SPLINE_POINTS, 1000);
 RTAPI_DECL_INT(SERVO_HOWMANY, SERVO_NUM);
 RTAPI_DECL_INT(SERVO_SHM_KEY, 101);
 RTAPI_DECL_INT(SERVO_SEM_KEY, 101);
@@ -103,6 +107,12 @@ int rtapi_app_main(RTAPI_APP_ARGS_DECL)
 
   (void) rtapi_arg_get_int(&TRAJ_SHM_KEY, "TRAJ_SHM_KEY");
   if (DEBUG) rtapi_print("gomain: using TRAJ_SHM_KEY = %d\n", TRAJ_SHM_KEY);
+  (void) rtapi_arg_get_int(&TRAJ_QUEUE_SHM_KEY, "TRAJ_QUEUE_SHM_KEY");
+  if (DEBUG) rtapi_print("gomain: using TRAJ_QUEUE_SHM_KEY = %d\n", TRAJ_QUEUE_SHM_KEY);
+  (void) rtapi_arg_get_int(&TRAJ_QUEUE_SIZE, "TRAJ_QUEUE_SIZE");
+  if (DEBUG) rtapi_print("gomain: using TRAJ_QUEUE_SIZE = %d\n", TRAJ_QUEUE_SIZE);
+  (void) rtapi_arg_get_int(&TRAJ_SPLINE_POINTS, "TRAJ_SPLINE_POINTS");
+  if (DEBUG) rtapi_print("gomain: using TRAJ_SPLINE_POINTS = %d\n", TRAJ_SPLINE_POINTS);
   (void) rtapi_arg_get_int(&SERVO_HOWMANY, "SERVO_HOWMANY");
   if (DEBUG) rtapi_print("gomain: using SERVO_HOWMANY = %d\n", SERVO_HOWMANY);
   (void) rtapi_arg_get_int(&SERVO_SHM_KEY, "SERVO_SHM_KEY");
@@ -122,6 +132,10 @@ int rtapi_app_main(RTAPI_APP_ARGS_DECL)
   if (SERVO_HOWMANY < 1) SERVO_HOWMANY = 1;
   else if (SERVO_HOWMANY > SERVO_NUM) SERVO_HOWMANY = SERVO_NUM;
 
+  /* the motion queue needs at least two entries to look ahead */
+  if (TRAJ_QUEUE_SIZE < 2) TRAJ_QUEUE_SIZE = 2;
+  if (TRAJ_SPLINE_POINTS < 0) TRAJ_SPLINE_POINTS = 0;
+
   if (DEBUG) rtapi_print("gomain running off base clock period %d\n", rtapi_clock_period);
 
   /* allocate the servo comm buffers */
@@ -151,6 +165,18 @@ int rtapi_app_main(RTAPI_APP_ARGS_DECL)
   }
   global_traj_comm_ptr = rtapi_rtm_addr(traj_shm);
 
+  /* allocate the traj motion queue, which can be too big for its
+     stack, followed by the control points for its spline moves */
+  traj_queue_shm = rtapi_rtm_new(TRAJ_QUEUE_SHM_KEY, TRAJ_QUEUE_SIZE * sizeof(go_motion_spec) + TRAJ_SPLINE_POINTS * sizeof(go_motion_spline_point));
+  if (NULL == traj_queue_shm) {
+    rtapi_print("can't get traj motion queue shm\n");
+    return 1;
+  }
+  traj_args.queue_space = rtapi_rtm_addr(traj_queue_shm);
+  traj_args.queue_size = TRAJ_QUEUE_SIZE;
+  traj_args.points_space = (go_motion_spline_point *) (traj_args.queue_space + TRAJ_QUEUE_SIZE);
+  traj_args.points_size = TRAJ_SPLINE_POINTS;
+
   /* allocate the log buffer */
   go_log_shm = rtapi_rtm_new(GO_LOG_SHM_KEY, sizeof(go_log_struct));
   if (NULL == go_log_shm) {
@@ -296,6 +322,13 @@ void rtapi_app_exit(void)
   }
   global_traj_comm_ptr = NULL;
 
+  if (NULL != traj_queue_shm) {
+    rtapi_rtm_delete(traj_queue_shm);
+    traj_queue_shm = NULL;
+  }
+  traj_args.queue_space = NULL;
+  traj_args.points_space = NULL;
+
   if (NULL != servo_shm) {
     rtapi_rtm_delete(servo_shm);
     servo_shm = NULL;
@@ -504,48 +504,49 @@ go_result go_mat_quat_convert(const go_mat *m, go_quat *q)
   }
 
   discr = 1.0 + m->x.x + m->y.y + m->z.z;
-  if (discr < 0.0) discr = 0.0;	/* give sqrt some slack for tiny negs */
-  
-  q->s = 0.5 * sqrt(discr);
-
-  if (GO_ROT_SMALL(q->s)) {
-    q->s = 0;
-    discr = 1.0 + m->x.x - m->y.y - m->z.z;
-    if (discr < 0.0) discr = 0.0;
-    q->x = sqrt(discr) / 2.0;
-    discr = 1.0 + m->y.y - m->x.x - m->z.z;
-    if (discr < 0.0) discr = 0.0;
-    q->y = sqrt(discr) / 2.0;
-    discr = 1.0 + m->z.z - m->y.y - m->x.x;
-    if (discr < 0.0) discr = 0.0;
-    q->z = sqrt(discr) / 2.0;
-
-    if (q->x > q->y && q->x > q->z) {
-      if (m->x.y < 0.0) {
-	q->y *= -1;
-      }
-      if (m->x.z < 0.0) {
-	q->z *= -1;
-      }
-    } else if (q->y > q->z) {
-      if (m->x.y < 0.0) {
-	q->x *= -1;
-      }
-      if (m->y.z < 0.0) {
-	q->z *= -1;
-      }
-    } else {
-      if (m->x.z < 0.0) {
-	q->x *= -1;
-      }
-      if (m->y.z < 0.0) {
-	q->y *= -1;
-      }
-    }
-  } else {
+
+  if (discr >= 1.0) {
+    /* s is at least 1/2, so dividing by it is well conditioned */
+    q->s = 0.5 * sqrt(discr);
     q->x = (m->y.z - m->z.y) / (a = 4 * q->s);
     q->y = (m->z.x - m->x.z) / a;
     q->z = (m->x.y - m->y.x) / a;
+  } else {
+    /*
+      Near a half turn s goes to 0, and dividing by it magnifies the
+      rounding in the matrix, badly so with float go_reals. Here the
+      largest of x, y and z is at least 1/2, so get that one from the
+      diagonal and divide by it instead.
+    */
+    if (m->x.x >= m->y.y && m->x.x >= m->z.z) {
+      discr = 1.0 + m->x.x - m->y.y - m->z.z;
+      q->x = 0.5 * sqrt(discr);
+      a = 4 * q->x;
+      q->s = (m->y.z - m->z.y) / a;
+      q->y = (m->y.x + m->x.y) / a;
+      q->z = (m->z.x + m->x.z) / a;
+    } else if (m->y.y >= m->z.z) {
+      discr = 1.0 - m->x.x + m->y.y - m->z.z;
+      q->y = 0.5 * sqrt(discr);
+      a = 4 * q->y;
+      q->s = (m->z.x - m->x.z) / a;
+      q->x = (m->y.x + m->x.y) / a;
+      q->z = (m->z.y + m->y.z) / a;
+    } else {
+      discr = 1.0 - m->x.x - m->y.y + m->z.z;
+      q->z = 0.5 * sqrt(discr);
+      a = 4 * q->z;
+      q->s = (m->x.y - m->y.x) / a;
+      q->x = (m->z.x + m->x.z) / a;
+      q->y = (m->z.y + m->y.z) / a;
+    }
+    /* keep s non-negative, as everywhere else */
+    if (q->s < 0.0) {
+      q->s = -q->s;
+      q->x = -q->x;
+      q->y = -q->y;
+      q->z = -q->z;
+    }
   }
 
   return go_quat_norm(q, q);
@@ -2021,62 +2022,38 @@ go_result go_tridiag_ql(go_real *d,
   See Berthold K. P. Horn, "Closed-form solution of absolute
   orientation using unit quaternions," Journal of the Optical Society
   of America A, Vol. 4, page 629, April 1987.
+
+  This part takes the sums S[i][j] of the products of the centroidized
+  points, v1c[i] * v2c[j], and the centroids 'c1' and 'c2', and
+  finishes the fit. go_cart_cart_pose and the accumulator both use it.
 */
-go_result go_cart_cart_pose(const go_cart *v1,
-			    const go_cart *v2,
-			    go_cart *v1c,
-			    go_cart *v2c,
-			    go_integer num,
-			    go_pose *pout)
+static go_result cart_cart_pose_solve(go_real S[3][3],
+				      const go_cart *c1,
+				      const go_cart *c2,
+				      go_pose *pout)
 {
-  go_integer t;
-  go_cart c1, c2;
-  go_real Sxx, Sxy, Sxz;
-  go_real Syx, Syy, Syz;
-  go_real Szx, Szy, Szz;
   GO_MATRIX_DECLARE(N, Nspace, 4, 4);
   go_real d[4], e[4];
   go_real eigenval;
+  go_cart c;
+  go_integer t;
   go_result retval;
 
-  Sxx = Sxy = Sxz = 0.0;
-  Syx = Syy = Syz = 0.0;
-  Szx = Szy = Szz = 0.0;
-
   go_matrix_init(N, Nspace, 4, 4);
 
-  retval = go_cart_centroidize(v1, num, &c1, v1c);
-  if (GO_RESULT_OK != retval) return retval;
-  retval = go_cart_centroidize(v2, num, &c2, v2c);
-  if (GO_RESULT_OK != retval) return retval;
-
-  for (t = 0; t < num; t++) {
-    Sxx += v1c[t].x * v2c[t].x;
-    Sxy += v1c[t].x * v2c[t].y;
-    Sxz += v1c[t].x * v2c[t].z;
-
-    Syx += v1c[t].y * v2c[t].x;
-    Syy += v1c[t].y * v2c[t].y;
-    Syz += v1c[t].y * v2c[t].z;
+  N.el[0][0] = S[0][0] + S[1][1] + S[2][2];
+  N.el[0][1] = N.el[1][0] = S[1][2] - S[2][1];
+  N.el[0][2] = N.el[2][0] = S[2][0] - S[0][2];
+  N.el[0][3] = N.el[3][0] = S[0][1] - S[1][0];
 
-    Szx += v1c[t].z * v2c[t].x;
-    Szy += v1c[t].z * v2c[t].y;
-    Szz += v1c[t].z * v2c[t].z;
-  }
-
-  N.el[0][0] = Sxx + Syy + Szz;
-  N.el[0][1] = N.el[1][0] = Syz - Szy;
-  N.el[0][2] = N.el[2][0] = Szx - Sxz;
-  N.el[0][3] = N.el[3][0] = Sxy - Syx;
-
-  N.el[1][1] = Sxx - Syy - Szz;
-  N.el[1][2] = N.el[2][1] = Sxy + Syx;
-  N.el[1][3] = N.el[3][1] = Szx + Sxz;
+  N.el[1][1] = S[0][0] - S[1][1] - S[2][2];
+  N.el[1][2] = N.el[2][1] = S[0][1] + S[1][0];
+  N.el[1][3] = N.el[3][1] = S[2][0] + S[0][2];
   
-  N.el[2][2] = -Sxx + Syy - Szz;
-  N.el[2][3] = N.el[3][2] = Syz + Szy;
+  N.el[2][2] = -S[0][0] + S[1][1] - S[2][2];
+  N.el[2][3] = N.el[3][2] = S[1][2] + S[2][1];
 
-  N.el[3][3] = -Sxx -Syy + Szz;
+  N.el[3][3] = -S[0][0] - S[1][1] + S[2][2];
 
   /* compute eigenvectors */
   retval = go_tridiag_reduce(N.el, 4, d, e);
@@ -2098,12 +2075,191 @@ go_result go_cart_cart_pose(const go_cart *v1,
   if (GO_RESULT_OK != retval) return retval;
 
   /* rotate left centroid, subtract left from right to get translation */
-  (void) go_quat_cart_mult(&pout->rot, &c1, &c1);
-  (void) go_cart_cart_sub(&c2, &c1, &pout->tran);
+  (void) go_quat_cart_mult(&pout->rot, c1, &c);
+  (void) go_cart_cart_sub(c2, &c, &pout->tran);
+
+  return GO_RESULT_OK;
+}
+
+go_result go_cart_cart_pose(const go_cart *v1,
+			    const go_cart *v2,
+			    go_cart *v1c,
+			    go_cart *v2c,
+			    go_integer num,
+			    go_pose *pout)
+{
+  go_integer t;
+  go_cart c1, c2;
+  go_real S[3][3];
+  go_result retval;
+
+  S[0][0] = S[0][1] = S[0][2] = 0.0;
+  S[1][0] = S[1][1] = S[1][2] = 0.0;
+  S[2][0] = S[2][1] = S[2][2] = 0.0;
+
+  retval = go_cart_centroidize(v1, num, &c1, v1c);
+  if (GO_RESULT_OK != retval) return retval;
+  retval = go_cart_centroidize(v2, num, &c2, v2c);
+  if (GO_RESULT_OK != retval) return retval;
+
+  for (t = 0; t < num; t++) {
+    S[0][0] += v1c[t].x * v2c[t].x;
+    S[0][1] += v1c[t].x * v2c[t].y;
+    S[0][2] += v1c[t].x * v2c[t].z;
+
+    S[1][0] += v1c[t].y * v2c[t].x;
+    S[1][1] += v1c[t].y * v2c[t].y;
+    S[1][2] += v1c[t].y * v2c[t].z;
+
+    S[2][0] += v1c[t].z * v2c[t].x;
+    S[2][1] += v1c[t].z * v2c[t].y;
+    S[2][2] += v1c[t].z * v2c[t].z;
+  }
+
+  return cart_cart_pose_solve(S, &c1, &c2, pout);
+}
+
+/*
+  The accumulator keeps the centroids and the sums about them current
+  with each pair, Welford-style, rather than keeping raw sums and
+  subtracting the centroids at the end. Calibration points are often
+  meters from the origin but spread over millimeters, and the raw sums
+  would lose the spread to cancellation.
+
+  Adding a pair (a, b) to n pairs moves the centroids by da/(n+1) and
+  db/(n+1), where da = a - c1 and db = b - c2, and adds
+  da (b - c2')T to S, c2' being the moved centroid. Merging two
+  accumulators of n and m pairs adds their S, plus
+  (c1m - c1n)(c2m - c2n)T n m / (n + m) for the offset between their
+  centroids.
+*/
+
+go_result go_cart_cart_pose_acc_init(go_cart_cart_pose_acc *acc)
+{
+  go_integer i, j;
+
+  acc->num = 0;
+  acc->c1.x = acc->c1.y = acc->c1.z = 0.0;
+  acc->c2.x = acc->c2.y = acc->c2.z = 0.0;
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      acc->s[i][j] = 0.0;
+    }
+  }
 
   return GO_RESULT_OK;
 }
 
+go_result go_cart_cart_pose_acc_add(go_cart_cart_pose_acc *acc,
+				    const go_cart *v1,
+				    const go_cart *v2)
+{
+  go_real inv;
+  go_real d1[3], d2[3];
+  go_integer i, j;
+
+  acc->num++;
+  inv = 1.0 / (go_real) acc->num;
+
+  d1[0] = v1->x - acc->c1.x;
+  d1[1] = v1->y - acc->c1.y;
+  d1[2] = v1->z - acc->c1.z;
+  acc->c1.x += d1[0] * inv;
+  acc->c1.y += d1[1] * inv;
+  acc->c1.z += d1[2] * inv;
+
+  acc->c2.x += (v2->x - acc->c2.x) * inv;
+  acc->c2.y += (v2->y - acc->c2.y) * inv;
+  acc->c2.z += (v2->z - acc->c2.z) * inv;
+  /* against the moved centroid, which makes the update exact */
+  d2[0] = v2->x - acc->c2.x;
+  d2[1] = v2->y - acc->c2.y;
+  d2[2] = v2->z - acc->c2.z;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      acc->s[i][j] += d1[i] * d2[j];
+    }
+  }
+
+  return GO_RESULT_OK;
+}
+
+go_result go_cart_cart_pose_acc_add_n(go_cart_cart_pose_acc *acc,
+				      const go_cart *v1,
+				      const go_cart *v2,
+				      go_integer num)
+{
+  go_integer t;
+
+  if (num < 0) return GO_RESULT_BAD_ARGS;
+
+  for (t = 0; t < num; t++) {
+    (void) go_cart_cart_pose_acc_add(acc, &v1[t], &v2[t]);
+  }
+
+  return GO_RESULT_OK;
+}
+
+go_result go_cart_cart_pose_acc_merge(go_cart_cart_pose_acc *acc,
+				      const go_cart_cart_pose_acc *other)
+{
+  go_real n, m, w;
+  go_real d1[3], d2[3];
+  go_integer i, j;
+
+  if (other->num < 1) return GO_RESULT_OK;
+  if (acc->num < 1) {
+    *acc = *other;
+    return GO_RESULT_OK;
+  }
+
+  n = (go_real) acc->num;
+  m = (go_real) other->num;
+  w = m / (n + m);
+
+  d1[0] = other->c1.x - acc->c1.x;
+  d1[1] = other->c1.y - acc->c1.y;
+  d1[2] = other->c1.z - acc->c1.z;
+  d2[0] = other->c2.x - acc->c2.x;
+  d2[1] = other->c2.y - acc->c2.y;
+  d2[2] = other->c2.z - acc->c2.z;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      acc->s[i][j] += other->s[i][j] + d1[i] * d2[j] * n * w;
+    }
+  }
+
+  acc->c1.x += d1[0] * w;
+  acc->c1.y += d1[1] * w;
+  acc->c1.z += d1[2] * w;
+  acc->c2.x += d2[0] * w;
+  acc->c2.y += d2[1] * w;
+  acc->c2.z += d2[2] * w;
+  acc->num += other->num;
+
+  return GO_RESULT_OK;
+}
+
+go_result go_cart_cart_pose_acc_solve(const go_cart_cart_pose_acc *acc,
+				      go_pose *pout)
+{
+  go_real S[3][3];
+  go_integer i, j;
+
+  if (acc->num < 1) return GO_RESULT_BAD_ARGS;
+
+  /* the solver takes the plain array go_cart_cart_pose builds */
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      S[i][j] = acc->s[i][j];
+    }
+  }
+
+  return cart_cart_pose_solve(S, &acc->c1, &acc->c2, pout);
+}
+
 static go_result trilaterate(go_real x2, go_real x3, go_real y3,
 			     go_real l1, go_real l2, go_real l3,
 			     go_cart *p)
@@ -2457,6 +2613,8 @@ go_result go_quat_quat_mult(const go_quat *q1, const go_quat *q2,
     qout->z = -cp1.s * cp2.z - cp1.x * cp2.y + cp1.y * cp2.x - cp1.z * cp2.s;
   }
 
+  GO_QUAT_RENORM(qout->s, qout->x, qout->y, qout->z);
+
   return GO_RESULT_OK;
 }
 
@@ -2576,6 +2734,284 @@ go_result go_pose_pose_interp(go_real t1, const go_pose *p1, go_real t2, const g
   return go_pose_pose_mult(p1, &pdiff, p3);
 }
 
+/* batch functions */
+
+/*
+  The batch kernels are written once, over a type V of W reals loaded
+  and stored at 'p' with LOAD(p) and STORE(p, v), a real made into a V
+  with SPLAT(r), NEGIF(s, v) for v negated where s < 0, and
+  ALL_TRAN_SMALL(v) for whether all of v is GO_TRAN_SMALL. They're
+  made for plain go_real, and on x86-64 for SSE2 and AVX2 vectors of
+  doubles. Each does as many items as fit in whole V's and returns how
+  many, leaving the rest to the plain ones. The arithmetic is that of
+  go_quat_cart_mult and go_quat_quat_mult, written out, with each item
+  loaded before any of it is stored so the output can be the input.
+  The norm check stops at the first V with a quaternion that fails
+  go_quat_is_norm, for the plain one to find it again.
+*/
+
+#define QUAT_CART_N(V, qs, qx, qy, qz, vx, vy, vz)	\
+  cx = qy * vz - qz * vy;				\
+  cy = qz * vx - qx * vz;				\
+  cz = qx * vy - qy * vx;				\
+  vx = vx + 2 * (qs * cx + qy * cz - qz * cy);		\
+  vy = vy + 2 * (qs * cy + qz * cx - qx * cz);		\
+  vz = vz + 2 * (qs * cz + qx * cy - qy * cx)
+
+#define QUAT_QUAT_N(NEGIF, as, ax, ay, az, bs, bx, by, bz, os, ox, oy, oz) \
+  os = as * bs - ax * bx - ay * by - az * bz;				\
+  ox = NEGIF(os, as * bx + ax * bs + ay * bz - az * by);		\
+  oy = NEGIF(os, as * by - ax * bz + ay * bs + az * bx);		\
+  oz = NEGIF(os, as * bz + ax * by - ay * bx + az * bs);		\
+  os = NEGIF(os, os);							\
+  GO_QUAT_RENORM(os, ox, oy, oz)
+
+#define GO_MATH_N_KERNELS(SUF, ATTR, V, W, LOAD, STORE, SPLAT, NEGIF, ALL_TRAN_SMALL) \
+ATTR static go_integer quat_norm_n_##SUF(go_integer num, const go_real *s, const go_real *x, const go_real *y, const go_real *z) \
+{									\
+  V qs, qx, qy, qz, d;							\
+  go_integer n;								\
+									\
+  for (n = 0; n + W <= num; n += W) {					\
+    qs = LOAD(s + n), qx = LOAD(x + n), qy = LOAD(y + n), qz = LOAD(z + n); \
+    d = qs * qs + qx * qx + qy * qy + qz * qz - SPLAT(1);		\
+    if (! ALL_TRAN_SMALL(d)) break;					\
+  }									\
+									\
+  return n;								\
+}									\
+									\
+ATTR static go_integer quat_cart_n_##SUF(const go_quat *q, const go_cart *t, go_integer num, const go_cart_batch *v, go_cart_batch *vout) \
+{									\
+  V qs = SPLAT(q->s), qx = SPLAT(q->x), qy = SPLAT(q->y), qz = SPLAT(q->z); \
+  V vx, vy, vz, cx, cy, cz;						\
+  go_integer n;								\
+									\
+  for (n = 0; n + W <= num; n += W) {					\
+    vx = LOAD(v->x + n), vy = LOAD(v->y + n), vz = LOAD(v->z + n);	\
+    QUAT_CART_N(V, qs, qx, qy, qz, vx, vy, vz);				\
+    if (NULL != t) {							\
+      vx = SPLAT(t->x) + vx, vy = SPLAT(t->y) + vy, vz = SPLAT(t->z) + vz; \
+    }									\
+    STORE(vout->x + n, vx), STORE(vout->y + n, vy), STORE(vout->z + n, vz); \
+  }									\
+									\
+  return n;								\
+}									\
+									\
+ATTR static go_integer quat_quat_n_##SUF(go_integer num, const go_quat_batch *q1, const go_quat_batch *q2, go_quat_batch *qout) \
+{									\
+  V as, ax, ay, az, bs, bx, by, bz, os, ox, oy, oz;			\
+  go_integer n;								\
+									\
+  for (n = 0; n + W <= num; n += W) {					\
+    as = LOAD(q1->s + n), ax = LOAD(q1->x + n), ay = LOAD(q1->y + n), az = LOAD(q1->z + n); \
+    bs = LOAD(q2->s + n), bx = LOAD(q2->x + n), by = LOAD(q2->y + n), bz = LOAD(q2->z + n); \
+    QUAT_QUAT_N(NEGIF, as, ax, ay, az, bs, bx, by, bz, os, ox, oy, oz); \
+    STORE(qout->s + n, os), STORE(qout->x + n, ox), STORE(qout->y + n, oy), STORE(qout->z + n, oz); \
+  }									\
+									\
+  return n;								\
+}									\
+									\
+ATTR static go_integer pose_pose_n_##SUF(go_integer num, const go_pose_batch *p1, const go_pose_batch *p2, go_pose_batch *pout) \
+{									\
+  V as, ax, ay, az, bs, bx, by, bz, os, ox, oy, oz;			\
+  V vx, vy, vz, cx, cy, cz;						\
+  go_integer n;								\
+									\
+  for (n = 0; n + W <= num; n += W) {					\
+    as = LOAD(p1->s + n), ax = LOAD(p1->i + n), ay = LOAD(p1->j + n), az = LOAD(p1->k + n); \
+    bs = LOAD(p2->s + n), bx = LOAD(p2->i + n), by = LOAD(p2->j + n), bz = LOAD(p2->k + n); \
+    vx = LOAD(p2->x + n), vy = LOAD(p2->y + n), vz = LOAD(p2->z + n);	\
+    QUAT_CART_N(V, as, ax, ay, az, vx, vy, vz);				\
+    vx = LOAD(p1->x + n) + vx, vy = LOAD(p1->y + n) + vy, vz = LOAD(p1->z + n) + vz; \
+    QUAT_QUAT_N(NEGIF, as, ax, ay, az, bs, bx, by, bz, os, ox, oy, oz); \
+    STORE(pout->x + n, vx), STORE(pout->y + n, vy), STORE(pout->z + n, vz); \
+    STORE(pout->s + n, os), STORE(pout->i + n, ox), STORE(pout->j + n, oy), STORE(pout->k + n, oz); \
+  }									\
+									\
+  return n;								\
+}
+
+#define REAL_LOAD(p) (*(p))
+#define REAL_STORE(p, v) (*(p) = (v))
+#define REAL_SPLAT(r) (r)
+#define REAL_NEGIF(s, v) ((s) < 0 ? -(v) : (v))
+#define REAL_ALL_TRAN_SMALL(v) GO_TRAN_SMALL(v)
+
+#define PLAIN /* no attributes */
+
+GO_MATH_N_KERNELS(real, PLAIN, go_real, 1, REAL_LOAD, REAL_STORE, REAL_SPLAT, REAL_NEGIF, REAL_ALL_TRAN_SMALL)
+
+#if defined(GO_REAL_DOUBLE) && defined(__GNUC__) && defined(__x86_64__) && ! defined(__KERNEL__) && ! defined(GO_MATH_NO_SIMD)
+#define GO_MATH_N_SIMD
+
+/* these may load from and store to unaligned reals */
+typedef double go_v2d __attribute__ ((vector_size (16), aligned (8)));
+__extension__ typedef long long go_v2l __attribute__ ((vector_size (16), aligned (8)));
+typedef double go_v4d __attribute__ ((vector_size (32), aligned (8)));
+__extension__ typedef long long go_v4l __attribute__ ((vector_size (32), aligned (8)));
+
+#define SSE2_LOAD(p) (*(const go_v2d *) (p))
+#define SSE2_STORE(p, v) (*(go_v2d *) (p) = (v))
+#define SSE2_SPLAT(r) (__extension__ (go_v2d) {(r), (r)})
+/* a bitwise select of v or -v on the mask from the compare */
+#define SSE2_NEGIF(s, v) ((go_v2d) ((((s) < SSE2_SPLAT(0)) & (go_v2l) -(v)) | (~((s) < SSE2_SPLAT(0)) & (go_v2l) (v))))
+/* the lanes of the mask from the compares, anded */
+#define SSE2_ALL_TRAN_SMALL(v) (__extension__ ({				\
+      go_v2l go_m = ((v) < SSE2_SPLAT(GO_TRAN_EPSILON)) & ((v) > SSE2_SPLAT(-GO_TRAN_EPSILON)); \
+      go_m[0] && go_m[1]; }))
+
+#define AVX2_LOAD(p) (*(const go_v4d *) (p))
+#define AVX2_STORE(p, v) (*(go_v4d *) (p) = (v))
+#define AVX2_SPLAT(r) (__extension__ (go_v4d) {(r), (r), (r), (r)})
+#define AVX2_NEGIF(s, v) ((go_v4d) ((((s) < AVX2_SPLAT(0)) & (go_v4l) -(v)) | (~((s) < AVX2_SPLAT(0)) & (go_v4l) (v))))
+#define AVX2_ALL_TRAN_SMALL(v) (__extension__ ({				\
+      go_v4l go_m = ((v) < AVX2_SPLAT(GO_TRAN_EPSILON)) & ((v) > AVX2_SPLAT(-GO_TRAN_EPSILON)); \
+      go_m[0] && go_m[1] && go_m[2] && go_m[3]; }))
+
+GO_MATH_N_KERNELS(sse2, PLAIN, go_v2d, 2, SSE2_LOAD, SSE2_STORE, SSE2_SPLAT, SSE2_NEGIF, SSE2_ALL_TRAN_SMALL)
+GO_MATH_N_KERNELS(avx2, __attribute__ ((target ("avx2"))), go_v4d, 4, AVX2_LOAD, AVX2_STORE, AVX2_SPLAT, AVX2_NEGIF, AVX2_ALL_TRAN_SMALL)
+#endif
+
+typedef struct {
+  const char *isa;
+  go_integer (*quat_norm_n)(go_integer, const go_real *, const go_real *, const go_real *, const go_real *);
+  go_integer (*quat_cart_n)(const go_quat *, const go_cart *, go_integer, const go_cart_batch *, go_cart_batch *);
+  go_integer (*quat_quat_n)(go_integer, const go_quat_batch *, const go_quat_batch *, go_quat_batch *);
+  go_integer (*pose_pose_n)(go_integer, const go_pose_batch *, const go_pose_batch *, go_pose_batch *);
+} go_math_n_kernels;
+
+static const go_math_n_kernels go_math_n_real = {
+  "none", quat_norm_n_real, quat_cart_n_real, quat_quat_n_real, pose_pose_n_real
+};
+
+#ifdef GO_MATH_N_SIMD
+static const go_math_n_kernels go_math_n_sse2 = {
+  "sse2", quat_norm_n_sse2, quat_cart_n_sse2, quat_quat_n_sse2, pose_pose_n_sse2
+};
+
+static const go_math_n_kernels go_math_n_avx2 = {
+  "avx2", quat_norm_n_avx2, quat_cart_n_avx2, quat_quat_n_avx2, pose_pose_n_avx2
+};
+#endif
+
+/*
+  The kernels for this CPU, picked on the first call. Threads racing
+  to pick them pick the same ones, so there's no need to lock.
+*/
+static const go_math_n_kernels *go_math_n = NULL;
+
+static const go_math_n_kernels *go_math_n_pick(void)
+{
+  if (NULL == go_math_n) {
+#ifdef GO_MATH_N_SIMD
+    if (__builtin_cpu_supports("avx2")) go_math_n = &go_math_n_avx2;
+    else if (__builtin_cpu_supports("sse2")) go_math_n = &go_math_n_sse2;
+    else go_math_n = &go_math_n_real;
+#else
+    go_math_n = &go_math_n_real;
+#endif
+  }
+
+  return go_math_n;
+}
+
+const char *go_math_n_isa(void)
+{
+  return go_math_n_pick()->isa;
+}
+
+/*
+  Whether all \a num quaternions are normalized, as go_quat_is_norm
+  has it. The kernel checks up to where it found one that isn't, and
+  that one and those after it are checked here.
+*/
+static go_flag quat_norm_n(go_integer num, const go_real *s, const go_real *x, const go_real *y, const go_real *z)
+{
+  go_quat q;
+  go_integer n;
+
+  for (n = go_math_n_pick()->quat_norm_n(num, s, x, y, z); n < num; n++) {
+    q.s = s[n], q.x = x[n], q.y = y[n], q.z = z[n];
+    if (!go_quat_is_norm(&q)) return 0;
+  }
+
+  return 1;
+}
+
+static go_result quat_cart_n(const go_quat *q, const go_cart *t, go_integer num, const go_cart_batch *v, go_cart_batch *vout)
+{
+  go_cart_batch vrest, voutrest;
+  go_integer n;
+
+  if (!go_quat_is_norm(q)) {
+    return GO_RESULT_NORM_ERROR;
+  }
+
+  n = go_math_n_pick()->quat_cart_n(q, t, num, v, vout);
+  vrest.x = v->x + n, vrest.y = v->y + n, vrest.z = v->z + n;
+  voutrest.x = vout->x + n, voutrest.y = vout->y + n, voutrest.z = vout->z + n;
+  (void) quat_cart_n_real(q, t, num - n, &vrest, &voutrest);
+
+  return GO_RESULT_OK;
+}
+
+go_result go_quat_cart_mult_n(const go_quat *q, go_integer num, const go_cart_batch *v, go_cart_batch *vout)
+{
+  return quat_cart_n(q, NULL, num, v, vout);
+}
+
+go_result go_pose_cart_mult_n(const go_pose *p, go_integer num, const go_cart_batch *v, go_cart_batch *vout)
+{
+  return quat_cart_n(&p->rot, &p->tran, num, v, vout);
+}
+
+go_result go_quat_quat_mult_n(go_integer num, const go_quat_batch *q1, const go_quat_batch *q2, go_quat_batch *qout)
+{
+  go_quat_batch q1rest, q2rest, qoutrest;
+  go_integer n;
+
+  if (!quat_norm_n(num, q1->s, q1->x, q1->y, q1->z) ||
+      !quat_norm_n(num, q2->s, q2->x, q2->y, q2->z)) {
+    return GO_RESULT_NORM_ERROR;
+  }
+
+  n = go_math_n_pick()->quat_quat_n(num, q1, q2, qout);
+  q1rest.s = q1->s + n, q1rest.x = q1->x + n, q1rest.y = q1->y + n, q1rest.z = q1->z + n;
+  q2rest.s = q2->s + n, q2rest.x = q2->x + n, q2rest.y = q2->y + n, q2rest.z = q2->z + n;
+  qoutrest.s = qout->s + n, qoutrest.x = qout->x + n, qoutrest.y = qout->y + n, qoutrest.z = qout->z + n;
+  (void) quat_quat_n_real(num - n, &q1rest, &q2rest, &qoutrest);
+
+  return GO_RESULT_OK;
+}
+
+static void pose_batch_offset(const go_pose_batch *p, go_integer n, go_pose_batch *rest)
+{
+  rest->x = p->x + n, rest->y = p->y + n, rest->z = p->z + n;
+  rest->s = p->s + n, rest->i = p->i + n, rest->j = p->j + n, rest->k = p->k + n;
+}
+
+go_result go_pose_pose_mult_n(go_integer num, const go_pose_batch *p1, const go_pose_batch *p2, go_pose_batch *pout)
+{
+  go_pose_batch p1rest, p2rest, poutrest;
+  go_integer n;
+
+  if (!quat_norm_n(num, p1->s, p1->i, p1->j, p1->k) ||
+      !quat_norm_n(num, p2->s, p2->i, p2->j, p2->k)) {
+    return GO_RESULT_NORM_ERROR;
+  }
+
+  n = go_math_n_pick()->pose_pose_n(num, p1, p2, pout);
+  pose_batch_offset(p1, n, &p1rest);
+  pose_batch_offset(p2, n, &p2rest);
+  pose_batch_offset(pout, n, &poutrest);
+  (void) pose_pose_n_real(num - n, &p1rest, &p2rest, &poutrest);
+
+  return GO_RESULT_OK;
+}
+
 /* homogeneous transform functions */
 
 go_result go_hom_inv(const go_hom * h1, go_hom * h2)
@@ -3953,6 +4389,323 @@ go_result go_mat6_vec6_mult(go_real a[6][6],
   return GO_RESULT_OK;
 }
 
+/*
+  The fixed-size solvers below work on the 6x6 and 6xN arrays
+  directly, with no row pointer setup, and all their loop bounds are
+  constants so the compiler can unroll them completely. The LU
+  factoring is the same Crout method with implicit pivot scaling as
+  ludcmp(), so it succeeds or fails with the same matrices as
+  go_mat6_inv().
+*/
+
+go_result go_mat6_lu(go_real a[6][6],
+		     go_real lu[6][6],
+		     go_integer index[6])
+{
+  go_real scale[6];
+  go_real big, dum, sum, temp;
+  go_integer i, imax, j, k;
+
+  for (i = 0; i < 6; i++) {
+    big = 0.0;
+    for (j = 0; j < 6; j++) {
+      lu[i][j] = a[i][j];
+      if ((temp = fabs(a[i][j])) > big) big = temp;
+    }
+    if (big < go_singular_epsilon) return GO_RESULT_SINGULAR;
+    scale[i] = 1.0 / big;
+  }
+
+  for (j = 0; j < 6; j++) {
+    for (i = 0; i < j; i++) {
+      sum = lu[i][j];
+      for (k = 0; k < i; k++) sum -= lu[i][k] * lu[k][j];
+      lu[i][j] = sum;
+    }
+    big = 0.0;
+    imax = 0;
+    for (i = j; i < 6; i++) {
+      sum = lu[i][j];
+      for (k = 0; k < j; k++) sum -= lu[i][k] * lu[k][j];
+      lu[i][j] = sum;
+      if ((dum = scale[i] * fabs(sum)) >= big) {
+	big = dum;
+	imax = i;
+      }
+    }
+    if (j != imax) {
+      for (k = 0; k < 6; k++) {
+	dum = lu[imax][k];
+	lu[imax][k] = lu[j][k];
+	lu[j][k] = dum;
+      }
+      scale[imax] = scale[j];
+    }
+    index[j] = imax;
+    if (fabs(lu[j][j]) < go_singular_epsilon) return GO_RESULT_SINGULAR;
+    dum = 1.0 / lu[j][j];
+    for (i = j + 1; i < 6; i++) lu[i][j] *= dum;
+  }
+
+  return GO_RESULT_OK;
+}
+
+go_result go_mat6_lu_solve(go_real lu[6][6],
+			   go_integer index[6],
+			   go_real b[6],
+			   go_real x[6])
+{
+  go_real y[6];
+  go_real sum;
+  go_integer i, j;
+
+  for (i = 0; i < 6; i++) y[i] = b[i];
+
+  for (i = 0; i < 6; i++) {
+    sum = y[index[i]];
+    y[index[i]] = y[i];
+    for (j = 0; j < i; j++) sum -= lu[i][j] * y[j];
+    y[i] = sum;
+  }
+  for (i = 5; i >= 0; i--) {
+    sum = y[i];
+    for (j = i + 1; j < 6; j++) sum -= lu[i][j] * y[j];
+    y[i] = sum / lu[i][i];
+  }
+
+  for (i = 0; i < 6; i++) x[i] = y[i];
+
+  return GO_RESULT_OK;
+}
+
+go_result go_mat6_solve(go_real a[6][6],
+			go_real b[6],
+			go_real x[6])
+{
+  go_real lu[6][6];
+  go_integer index[6];
+  go_result retval;
+
+  retval = go_mat6_lu(a, lu, index);
+  if (GO_RESULT_OK != retval) return retval;
+
+  return go_mat6_lu_solve(lu, index, b, x);
+}
+
+go_result go_mat6_chol(go_real a[6][6],
+		       go_real l[6][6])
+{
+  go_real sum, floor;
+  go_integer i, j, k;
+
+  for (i = 0, floor = 0.0; i < 6; i++) {
+    if (a[i][i] > floor) floor = a[i][i];
+  }
+  floor *= GO_REAL_EPSILON * GO_REAL_EPSILON;
+
+  for (j = 0; j < 6; j++) {
+    for (k = 0, sum = a[j][j]; k < j; k++) sum -= l[j][k] * l[j][k];
+    if (sum <= floor) return GO_RESULT_SINGULAR;
+    l[j][j] = sqrt(sum);
+    for (i = j + 1; i < 6; i++) {
+      for (k = 0, sum = a[i][j]; k < j; k++) sum -= l[i][k] * l[j][k];
+      l[i][j] = sum / l[j][j];
+      l[j][i] = 0.0;
+    }
+  }
+
+  return GO_RESULT_OK;
+}
+
+go_result go_mat6_chol_solve(go_real l[6][6],
+			     go_real b[6],
+			     go_real x[6])
+{
+  go_real y[6];
+  go_real sum;
+  go_integer i, k;
+
+  for (i = 0; i < 6; i++) {
+    for (k = 0, sum = b[i]; k < i; k++) sum -= l[i][k] * y[k];
+    y[i] = sum / l[i][i];
+  }
+  for (i = 5; i >= 0; i--) {
+    for (k = i + 1, sum = y[i]; k < 6; k++) sum -= l[k][i] * y[k];
+    y[i] = sum / l[i][i];
+  }
+
+  for (i = 0; i < 6; i++) x[i] = y[i];
+
+  return GO_RESULT_OK;
+}
+
+go_real go_vec6_dot(go_real a[6],
+		    go_real b[6])
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] +
+    a[3] * b[3] + a[4] * b[4] + a[5] * b[5];
+}
+
+go_result go_mat6n_vecn_mult(go_real a[6][GO_MAT6N_MAX],
+			     go_integer n,
+			     go_real v[],
+			     go_real axv[6])
+{
+  go_real work[6];
+  go_integer i, k;
+
+  if (n < 1 || n > GO_MAT6N_MAX) return GO_RESULT_BAD_ARGS;
+
+  for (i = 0; i < 6; i++) {
+    work[i] = 0.0;
+    for (k = 0; k < n; k++) work[i] += a[i][k] * v[k];
+  }
+
+  for (i = 0; i < 6; i++) axv[i] = work[i];
+
+  return GO_RESULT_OK;
+}
+
+/*
+  The 6xN solves factor the (N + 6) x 6 matrix M = [Wh JT ; lambda I],
+  where Wh is the square root of Winv, or just its first N rows with no
+  damping, as Q R by Householder reflections. Then RT R is J Winv JT +
+  lambda^2 I, but without forming that, whose condition number is the
+  square of J's and too much for float go_reals near a singularity.
+  R is left in the upper triangle of m, but for its diagonal in rdiag,
+  and the reflection vectors in the rest with their squared lengths in
+  vv. The factoring is singular for the same floor as go_mat6_chol().
+*/
+enum {MAT6N_ROWS = GO_MAT6N_MAX + 6};
+
+static go_result mat6n_qr(go_real j[6][GO_MAT6N_MAX],
+			  go_integer n,
+			  go_real winv[],
+			  go_real lambda,
+			  go_real m[MAT6N_ROWS][6],
+			  go_real rdiag[6],
+			  go_real vv[6],
+			  go_integer * rows)
+{
+  go_real wh, sum, big, alpha;
+  go_integer r, c, k, m_rows;
+
+  if (n < 6 || n > GO_MAT6N_MAX) return GO_RESULT_BAD_ARGS;
+
+  m_rows = (lambda > 0.0 ? n + 6 : n);
+  for (r = 0; r < n; r++) {
+    if (winv[r] <= 0.0) return GO_RESULT_BAD_ARGS;
+    wh = sqrt(winv[r]);
+    for (c = 0; c < 6; c++) m[r][c] = wh * j[c][r];
+  }
+  for (r = n; r < m_rows; r++) {
+    for (c = 0; c < 6; c++) m[r][c] = (r - n == c ? lambda : 0.0);
+  }
+
+  for (c = 0, big = 0.0; c < 6; c++) {
+    for (r = 0, sum = 0.0; r < m_rows; r++) sum += m[r][c] * m[r][c];
+    if (sum > big) big = sum;
+  }
+  big *= GO_REAL_EPSILON * GO_REAL_EPSILON;
+
+  for (k = 0; k < 6; k++) {
+    for (r = k, sum = 0.0; r < m_rows; r++) sum += m[r][k] * m[r][k];
+    if (sum <= big) return GO_RESULT_SINGULAR;
+    alpha = (m[k][k] > 0.0 ? -sqrt(sum) : sqrt(sum));
+    rdiag[k] = alpha;
+    m[k][k] -= alpha;
+    for (r = k, sum = 0.0; r < m_rows; r++) sum += m[r][k] * m[r][k];
+    vv[k] = sum;
+    for (c = k + 1; c < 6; c++) {
+      for (r = k, sum = 0.0; r < m_rows; r++) sum += m[r][k] * m[r][c];
+      sum = 2.0 * sum / vv[k];
+      for (r = k; r < m_rows; r++) m[r][c] -= sum * m[r][k];
+    }
+  }
+
+  *rows = m_rows;
+
+  return GO_RESULT_OK;
+}
+
+/*
+  With the factoring above, x = Wh B (MT M)inv b, for B the first N
+  rows of M. Since M R inv is the first 6 columns of Q, x is Wh times
+  the first N rows of Q [RT inv b ; 0].
+*/
+static void mat6n_qr_solve(go_real m[MAT6N_ROWS][6],
+			   go_real rdiag[6],
+			   go_real vv[6],
+			   go_integer rows,
+			   go_integer n,
+			   go_real winv[],
+			   go_real b[6],
+			   go_real x[])
+{
+  go_real y[MAT6N_ROWS];
+  go_real sum;
+  go_integer r, k;
+
+  for (r = 0; r < 6; r++) {
+    for (k = 0, sum = b[r]; k < r; k++) sum -= m[k][r] * y[k];
+    y[r] = sum / rdiag[r];
+  }
+  for (r = 6; r < rows; r++) y[r] = 0.0;
+
+  for (k = 5; k >= 0; k--) {
+    for (r = k, sum = 0.0; r < rows; r++) sum += m[r][k] * y[r];
+    sum = 2.0 * sum / vv[k];
+    for (r = k; r < rows; r++) y[r] -= sum * m[r][k];
+  }
+
+  for (k = 0; k < n; k++) x[k] = sqrt(winv[k]) * y[k];
+}
+
+go_result go_mat6n_dls_solve(go_real j[6][GO_MAT6N_MAX],
+			     go_integer n,
+			     go_real winv[],
+			     go_real lambda,
+			     go_real b[6],
+			     go_real x[])
+{
+  go_real m[MAT6N_ROWS][6];
+  go_real rdiag[6], vv[6];
+  go_integer rows;
+  go_result retval;
+
+  retval = mat6n_qr(j, n, winv, lambda, m, rdiag, vv, &rows);
+  if (GO_RESULT_OK != retval) return retval;
+
+  mat6n_qr_solve(m, rdiag, vv, rows, n, winv, b, x);
+
+  return GO_RESULT_OK;
+}
+
+go_result go_mat6n_pinv(go_real j[6][GO_MAT6N_MAX],
+			go_integer n,
+			go_real winv[],
+			go_real jinv[GO_MAT6N_MAX][6])
+{
+  go_real m[MAT6N_ROWS][6];
+  go_real rdiag[6], vv[6];
+  go_real e[6], x[GO_MAT6N_MAX];
+  go_integer rows, c, k;
+  go_result retval;
+
+  retval = mat6n_qr(j, n, winv, 0.0, m, rdiag, vv, &rows);
+  if (GO_RESULT_OK != retval) return retval;
+
+  /* column c of Jinv is the solution for the unit vector along c */
+  for (c = 0; c < 6; c++) {
+    for (k = 0; k < 6; k++) e[k] = 0.0;
+    e[c] = 1.0;
+    mat6n_qr_solve(m, rdiag, vv, rows, n, winv, e, x);
+    for (k = 0; k < n; k++) jinv[k][c] = x[k];
+  }
+
+  return GO_RESULT_OK;
+}
+
 /* recall:                          */
 /*      |  m.x.x   m.y.x   m.z.x  | */
 /* M =  |  m.x.y   m.y.y   m.z.y  | */
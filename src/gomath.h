@@ -330,14 +330,14 @@ extern go_real go_cbrt(go_real x);
 #define GO_TO_RAD(deg) ((deg)*0.0174532925199432952)
 
 /*! How close translational quantities must be to be equal. */
-#define GO_TRAN_CLOSE(x,y) (fabs((x)-(y)) < GO_REAL_EPSILON)
+#define GO_TRAN_CLOSE(x,y) (fabs((x)-(y)) < GO_TRAN_EPSILON)
 /*! How small a translational quantity must be to be zero. */
-#define GO_TRAN_SMALL(x) (fabs(x) < GO_REAL_EPSILON)
+#define GO_TRAN_SMALL(x) (fabs(x) < GO_TRAN_EPSILON)
 
 /*! How close rotational quantities must be to be equal. */
-#define GO_ROT_CLOSE(x,y) (fabs((x)-(y)) < GO_REAL_EPSILON)
+#define GO_ROT_CLOSE(x,y) (fabs((x)-(y)) < GO_ROT_EPSILON)
 /*! How small a rotational quantity must be to be zero. */
-#define GO_ROT_SMALL(x) (fabs(x) < GO_REAL_EPSILON)
+#define GO_ROT_SMALL(x) (fabs(x) < GO_ROT_EPSILON)
 
 /*! How close general quantities must be to be equal. Use this when
   you have something other than translational or rotational quantities,
@@ -348,6 +348,24 @@ extern go_real go_cbrt(go_real x);
   otherwise use one of \a GO_TRAN,ROT_SMALL. */
 #define GO_SMALL(x) (fabs(x) < GO_REAL_EPSILON)
 
+/*!
+  Products of unit quaternions drift off unit length by their
+  rounding, and with float go_reals a quaternion multiplied into
+  every cycle fails go_quat_is_norm() within seconds. With float
+  go_reals this pulls the quaternion back with a step of Newton's
+  method for the reciprocal square root of its squared length, which
+  is near 1, and the quaternion multiplies all do it. With double and
+  long double go_reals it does nothing.
+*/
+#if defined(GO_REAL_FLOAT)
+#define GO_QUAT_RENORM(s,x,y,z) do {					\
+    go_real go_renorm_k = 1.5 - 0.5 * ((s) * (s) + (x) * (x) + (y) * (y) + (z) * (z)); \
+    (s) *= go_renorm_k, (x) *= go_renorm_k, (y) *= go_renorm_k, (z) *= go_renorm_k; \
+  } while (0)
+#else
+#define GO_QUAT_RENORM(s,x,y,z) do {} while (0)
+#endif
+
 /*! Double-valued inverse sine, giving both solutions */
 extern go_result go_asines(go_real s, go_real *asp, go_real *asn);
 
@@ -744,6 +762,50 @@ extern go_result go_cart_cart_pose
  go_pose *pout			/*!< A pointer to the calculated best-fit pose filled in by this function. */
  );
 
+/*!
+  Accumulates the point pairs for a go_cart_cart_pose fit as they come
+  in, without keeping them, for fits to more points than are worth
+  holding in memory. Only the running centroids and the sums of the
+  products about them are kept. Accumulators filled separately, e.g.,
+  by threads each given part of the points, combine with
+  go_cart_cart_pose_acc_merge into what one would have had with all
+  the points.
+*/
+typedef struct {
+  go_integer num;		/* number of point pairs so far */
+  go_cart c1;			/* centroid of the first points */
+  go_cart c2;			/* centroid of the second points */
+  go_real s[3][3];		/* sum of (v1 - c1)(v2 - c2)T */
+} go_cart_cart_pose_acc;
+
+/*! Empties \a acc for a new fit. */
+extern go_result go_cart_cart_pose_acc_init(go_cart_cart_pose_acc *acc);
+
+/*! Adds the point \a v1 in the first coordinate system and the same
+  point \a v2 in the second to \a acc. */
+extern go_result go_cart_cart_pose_acc_add(go_cart_cart_pose_acc *acc,
+					   const go_cart *v1,
+					   const go_cart *v2);
+
+/*! Adds the \a num pairs in the arrays \a v1 and \a v2 to \a acc. */
+extern go_result go_cart_cart_pose_acc_add_n(go_cart_cart_pose_acc *acc,
+					     const go_cart *v1,
+					     const go_cart *v2,
+					     go_integer num);
+
+/*! Adds the pairs accumulated in \a other to \a acc. */
+extern go_result go_cart_cart_pose_acc_merge(go_cart_cart_pose_acc *acc,
+					     const go_cart_cart_pose_acc *other);
+
+/*!
+  Puts the best-fit pose for the pairs in \a acc in \a pout, as
+  go_cart_cart_pose would for the same pairs, to within roundoff.
+  \a acc is left as it is, so more pairs can be added and the fit
+  solved again. Returns GO_RESULT_BAD_ARGS if \a acc is empty.
+*/
+extern go_result go_cart_cart_pose_acc_solve(const go_cart_cart_pose_acc *acc,
+					     go_pose *pout);
+
 /*!
   Returns the Cartesian point \a p whose distances from three other points
   \a c1, \a c2 and \a c3 are \a l1, \a l2 and \a l3, respectively. In
@@ -827,6 +889,66 @@ go_pose_pose_interp(go_real t1,
 		    go_real t3, 
 		    go_pose *p3);
 
+/*
+  Batches of carts, quaternions and poses, as structures of arrays,
+  one array per member, for running the same arithmetic over many.
+*/
+
+typedef struct {
+  go_real *x;
+  go_real *y;
+  go_real *z;
+} go_cart_batch;
+
+typedef struct {
+  go_real *s;
+  go_real *x;
+  go_real *y;
+  go_real *z;
+} go_quat_batch;
+
+typedef struct {
+  go_real *x;
+  go_real *y;
+  go_real *z;
+  go_real *s;			/* quaternion scalar part */
+  go_real *i;			/* and vector part */
+  go_real *j;
+  go_real *k;
+} go_pose_batch;
+
+/*!
+  The _n functions do what the functions they're named for do, to
+  each of the \a num items of their batches, with the same arithmetic
+  in the same order so the results are the same, but for any
+  multiply-adds the compiler fuses in one and not the other. Where the x86-64 CPU
+  has them they use SSE2 or AVX2 vector instructions, picked when first
+  called, otherwise they run item by item. The output may be the input,
+  but may not otherwise overlap it.
+
+  As with the functions they're named for, the quaternions are checked
+  for being normalized, and GO_RESULT_NORM_ERROR is returned if any
+  isn't. The batches are all checked before any output is written, so
+  on error the output is left as it was.
+*/
+extern go_result go_quat_cart_mult_n(const go_quat *q, go_integer num,
+				     const go_cart_batch *v,
+				     go_cart_batch *vout);
+extern go_result go_pose_cart_mult_n(const go_pose *p, go_integer num,
+				     const go_cart_batch *v,
+				     go_cart_batch *vout);
+extern go_result go_quat_quat_mult_n(go_integer num,
+				     const go_quat_batch *q1,
+				     const go_quat_batch *q2,
+				     go_quat_batch *qout);
+extern go_result go_pose_pose_mult_n(go_integer num,
+				     const go_pose_batch *p1,
+				     const go_pose_batch *p2,
+				     go_pose_batch *pout);
+
+/*! Returns the name of the vector instructions the _n functions use. */
+extern const char *go_math_n_isa(void);
+
 /* homogeneous transform functions */
 
 extern go_result go_hom_inv(const go_hom *, go_hom *);
@@ -1010,6 +1132,109 @@ extern go_result go_mat6_vec6_mult(go_real a[6][6],
 				   go_real v[6],
 				   go_real axv[6]);
 
+/*!
+  Given a 6x6 matrix \a a, computes its LU decomposition with partial
+  pivoting and returns it in \a lu, with the row permutation in \a
+  index. Leaves \a a untouched. Returns GO_RESULT_OK, or
+  GO_RESULT_SINGULAR if the matrix is singular, for the same matrices
+  that go_mat6_inv() finds singular.
+*/
+extern go_result go_mat6_lu(go_real a[6][6],
+			    go_real lu[6][6],
+			    go_integer index[6]);
+
+/*!
+  Given the LU decomposition \a lu and \a index of a matrix A from
+  go_mat6_lu(), solves A \a x = \a b. \a b and \a x can be the same.
+  Returns GO_RESULT_OK.
+*/
+extern go_result go_mat6_lu_solve(go_real lu[6][6],
+				  go_integer index[6],
+				  go_real b[6],
+				  go_real x[6]);
+
+/*!
+  Solves \a a \a x = \a b for \a x, without forming the inverse of \a
+  a. \a b and \a x can be the same. Returns GO_RESULT_OK, or
+  GO_RESULT_SINGULAR if \a a is singular.
+*/
+extern go_result go_mat6_solve(go_real a[6][6],
+			       go_real b[6],
+			       go_real x[6]);
+
+/*!
+  Given a symmetric positive definite 6x6 matrix \a a, computes its
+  Cholesky factor, the lower triangular \a l with \a a = \a l \a lT.
+  Only the lower triangle of \a a is used. Returns GO_RESULT_OK, or
+  GO_RESULT_SINGULAR if \a a isn't positive definite to within
+  GO_REAL_EPSILON squared of its largest diagonal element.
+*/
+extern go_result go_mat6_chol(go_real a[6][6],
+			      go_real l[6][6]);
+
+/*!
+  Given the Cholesky factor \a l of a matrix A from go_mat6_chol(),
+  solves A \a x = \a b. \a b and \a x can be the same.
+  Returns GO_RESULT_OK.
+*/
+extern go_result go_mat6_chol_solve(go_real l[6][6],
+				    go_real b[6],
+				    go_real x[6]);
+
+/*!
+  Returns the dot product of the 6-vectors \a a and \a b.
+*/
+extern go_real go_vec6_dot(go_real a[6],
+			   go_real b[6]);
+
+/*!
+  The most columns of the 6xN matrices used with the go_mat6n_
+  functions, which are stored as go_real [6][GO_MAT6N_MAX] with the
+  first N columns used, e.g., the Jacobian of a redundant arm.
+*/
+#define GO_MAT6N_MAX 8
+
+/*!
+  Given a 6xN matrix \a a and an N-vector \a v, multiplies them and
+  returns the result in \a axv. Returns GO_RESULT_OK, or
+  GO_RESULT_BAD_ARGS if \a n is out of range.
+*/
+extern go_result go_mat6n_vecn_mult(go_real a[6][GO_MAT6N_MAX],
+				    go_integer n,
+				    go_real v[],
+				    go_real axv[6]);
+
+/*!
+  Given a 6xN matrix \a j with N at least 6, the inverse weights \a
+  winv of its N columns and a damping factor \a lambda, returns in
+  the N-vector \a x the weighted damped least-squares solution of \a
+  j \a x = \a b,
+
+  x = Winv JT (J Winv JT + lambda^2 I)inv b
+
+  which with \a lambda 0 is the weighted least-norm solution. It's
+  solved by QR factoring the weighted JT, without forming J Winv JT,
+  whose condition number is the square of J's. Returns GO_RESULT_OK,
+  GO_RESULT_SINGULAR if J is singular, or GO_RESULT_BAD_ARGS if \a n
+  is out of range or a weight isn't positive.
+*/
+extern go_result go_mat6n_dls_solve(go_real j[6][GO_MAT6N_MAX],
+				    go_integer n,
+				    go_real winv[],
+				    go_real lambda,
+				    go_real b[6],
+				    go_real x[]);
+
+/*!
+  Like go_mat6n_dls_solve() with no damping, but returns the Nx6
+  weighted pseudo-inverse Winv JT (J Winv JT)inv of \a j in the first
+  N rows of \a jinv, for when it's applied to more than one vector.
+*/
+extern go_result go_mat6n_pinv(go_real j[6][GO_MAT6N_MAX],
+			       go_integer n,
+			       go_real winv[],
+			       go_real jinv[GO_MAT6N_MAX][6]);
+
 /* Denavit-Hartenberg to pose conversions */
 
 /*
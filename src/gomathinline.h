@@ -0,0 +1,183 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file gomathinline.h
+
+  \brief Inline versions of the gomath functions used every cycle.
+
+  Each go_..._i function here does what the gomath.c function of the
+  same name without the _i does, with the same arithmetic, but returns
+  its result rather than a go_result, and is compiled into its caller.
+  None of them check their arguments, e.g., the quaternions aren't
+  checked for being normalized, so use them where the inputs are
+  known to be good, as in the cyclic code whose callers ignored the
+  result anyway.
+*/
+
+#ifndef GO_MATH_INLINE_H
+#define GO_MATH_INLINE_H
+
+#include <math.h>		/* sqrt */
+#include "gotypes.h"		/* go_real */
+#include "gomath.h"		/* go_cart, go_quat, go_pose */
+
+#if defined(__GNUC__)
+#define GO_INLINE static __inline__
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define GO_INLINE static inline
+#else
+#define GO_INLINE static
+#endif
+
+/* cart functions */
+
+GO_INLINE go_cart go_cart_cart_add_i(const go_cart *v1, const go_cart *v2)
+{
+  go_cart vout;
+
+  vout.x = v1->x + v2->x;
+  vout.y = v1->y + v2->y;
+  vout.z = v1->z + v2->z;
+
+  return vout;
+}
+
+GO_INLINE go_cart go_cart_cart_sub_i(const go_cart *v1, const go_cart *v2)
+{
+  go_cart vout;
+
+  vout.x = v1->x - v2->x;
+  vout.y = v1->y - v2->y;
+  vout.z = v1->z - v2->z;
+
+  return vout;
+}
+
+GO_INLINE go_cart go_cart_scale_mult_i(const go_cart *v1, go_real d)
+{
+  go_cart vout;
+
+  vout.x = v1->x * d;
+  vout.y = v1->y * d;
+  vout.z = v1->z * d;
+
+  return vout;
+}
+
+GO_INLINE go_real go_cart_cart_dot_i(const go_cart *v1, const go_cart *v2)
+{
+  return v1->x * v2->x + v1->y * v2->y + v1->z * v2->z;
+}
+
+GO_INLINE go_cart go_cart_cart_cross_i(const go_cart *v1, const go_cart *v2)
+{
+  go_cart vout;
+
+  vout.x = v1->y * v2->z - v1->z * v2->y;
+  vout.y = v1->z * v2->x - v1->x * v2->z;
+  vout.z = v1->x * v2->y - v1->y * v2->x;
+
+  return vout;
+}
+
+GO_INLINE go_real go_cart_mag_i(const go_cart *v)
+{
+  return sqrt(go_sq(v->x) + go_sq(v->y) + go_sq(v->z));
+}
+
+/* quat functions */
+
+GO_INLINE go_quat go_quat_inv_i(const go_quat *q1)
+{
+  go_quat qout;
+
+  qout.s = q1->s;
+  qout.x = -q1->x;
+  qout.y = -q1->y;
+  qout.z = -q1->z;
+
+  return qout;
+}
+
+GO_INLINE go_quat go_quat_quat_mult_i(const go_quat *q1, const go_quat *q2)
+{
+  go_quat qout;
+
+  qout.s = q1->s * q2->s - q1->x * q2->x - q1->y * q2->y - q1->z * q2->z;
+
+  if (qout.s >= 0) {
+    qout.x = q1->s * q2->x + q1->x * q2->s + q1->y * q2->z - q1->z * q2->y;
+    qout.y = q1->s * q2->y - q1->x * q2->z + q1->y * q2->s + q1->z * q2->x;
+    qout.z = q1->s * q2->z + q1->x * q2->y - q1->y * q2->x + q1->z * q2->s;
+  } else {
+    qout.s = -qout.s;
+    qout.x = -q1->s * q2->x - q1->x * q2->s - q1->y * q2->z + q1->z * q2->y;
+    qout.y = -q1->s * q2->y + q1->x * q2->z - q1->y * q2->s - q1->z * q2->x;
+    qout.z = -q1->s * q2->z - q1->x * q2->y + q1->y * q2->x - q1->z * q2->s;
+  }
+
+  GO_QUAT_RENORM(qout.s, qout.x, qout.y, qout.z);
+
+  return qout;
+}
+
+GO_INLINE go_cart go_quat_cart_mult_i(const go_quat *q1, const go_cart *v2)
+{
+  go_cart c, vout;
+
+  c.x = q1->y * v2->z - q1->z * v2->y;
+  c.y = q1->z * v2->x - q1->x * v2->z;
+  c.z = q1->x * v2->y - q1->y * v2->x;
+
+  vout.x = v2->x + 2 * (q1->s * c.x + q1->y * c.z - q1->z * c.y);
+  vout.y = v2->y + 2 * (q1->s * c.y + q1->z * c.x - q1->x * c.z);
+  vout.z = v2->z + 2 * (q1->s * c.z + q1->x * c.y - q1->y * c.x);
+
+  return vout;
+}
+
+/* pose functions */
+
+GO_INLINE go_pose go_pose_inv_i(const go_pose *p1)
+{
+  go_pose p2;
+
+  p2.rot = go_quat_inv_i(&p1->rot);
+  p2.tran = go_quat_cart_mult_i(&p2.rot, &p1->tran);
+  p2.tran.x = -p2.tran.x;
+  p2.tran.y = -p2.tran.y;
+  p2.tran.z = -p2.tran.z;
+
+  return p2;
+}
+
+GO_INLINE go_cart go_pose_cart_mult_i(const go_pose *p1, const go_cart *v2)
+{
+  go_cart vout;
+
+  vout = go_quat_cart_mult_i(&p1->rot, v2);
+
+  return go_cart_cart_add_i(&p1->tran, &vout);
+}
+
+GO_INLINE go_pose go_pose_pose_mult_i(const go_pose *p1, const go_pose *p2)
+{
+  go_pose pout;
+
+  pout.tran = go_quat_cart_mult_i(&p1->rot, &p2->tran);
+  pout.tran = go_cart_cart_add_i(&p1->tran, &pout.tran);
+  pout.rot = go_quat_quat_mult_i(&p1->rot, &p2->rot);
+
+  return pout;
+}
+
+#endif /* GO_MATH_INLINE_H */
@@ -16,10 +16,25 @@
 */
 
 #include <stdio.h>
-#include <stdlib.h>		/* atoi */
+#include <stdlib.h>		/* atoi, malloc */
 #include <math.h>		/* fabs */
+#include <time.h>		/* clock */
 #include "go.h"
 
+/*
+  Round trips through an inverse lose digits with the condition number
+  of the random matrix, and tan loses them with its slope 1 + tan^2.
+  Doubles have digits to spare and use the plain checks, but floats
+  need the tolerance scaled by how much the operation amplifies error.
+*/
+#if defined(GO_REAL_FLOAT)
+#define INV_CLOSE(a,b,gain) (fabs((a)-(b)) < GO_REAL_EPSILON * (1 + (gain)))
+#define TAN_CLOSE(a,b) (fabs((a)-(b)) < GO_ROT_EPSILON * (1 + (a)*(a)))
+#else
+#define INV_CLOSE(a,b,gain) GO_CLOSE(a,b)
+#define TAN_CLOSE(a,b) GO_ROT_CLOSE(a,b)
+#endif
+
 static int test_rotations(void)
 {
   go_rvec rvec, rout;
@@ -679,6 +694,63 @@ static int test_cart_cart_pose(void)
 #undef TWEAK
 }
 
+/*
+  Fits the same points with go_cart_cart_pose, with one accumulator
+  fed pair by pair, and with three accumulators fed parts of the
+  points and merged. The points are far from the origin compared with
+  their spread, which is what the accumulator is built for.
+*/
+static int test_cart_cart_pose_acc(void)
+{
+  enum {NUM = 1000};
+  static go_cart v1[NUM], v2[NUM], v1c[NUM], v2c[NUM];
+  go_cart_cart_pose_acc acc, part[3];
+  go_rpy rpy = {-0.3, 0.2, 1.1};
+  go_pose pose = {{10, 20, -5}, {1, 0, 0, 0}}, pbatch, pout;
+  int t;
+  /* tens of meters out are more than GO_TRAN_CLOSE resolves in float */
+#define SAME_POSE(p1,p2)					\
+  (GO_CLOSE((p1).tran.x, (p2).tran.x) &&			\
+   GO_CLOSE((p1).tran.y, (p2).tran.y) &&			\
+   GO_CLOSE((p1).tran.z, (p2).tran.z) &&			\
+   go_quat_quat_compare(&(p1).rot, &(p2).rot))
+
+  go_rpy_quat_convert(&rpy, &pose.rot);
+
+  for (t = 0; t < NUM; t++) {
+    v1[t].x = 5 + go_random() - 0.5;
+    v1[t].y = -7 + go_random() - 0.5;
+    v1[t].z = 2 + go_random() - 0.5;
+    go_pose_cart_mult(&pose, &v1[t], &v2[t]);
+    v2[t].x += 0.001 * (go_random() - 0.5);
+    v2[t].y += 0.001 * (go_random() - 0.5);
+    v2[t].z += 0.001 * (go_random() - 0.5);
+  }
+
+  if (GO_RESULT_OK != go_cart_cart_pose(v1, v2, v1c, v2c, NUM, &pbatch)) return 1;
+
+  go_cart_cart_pose_acc_init(&acc);
+  if (GO_RESULT_OK == go_cart_cart_pose_acc_solve(&acc, &pout)) return 1;
+  for (t = 0; t < NUM; t++) {
+    go_cart_cart_pose_acc_add(&acc, &v1[t], &v2[t]);
+  }
+  if (GO_RESULT_OK != go_cart_cart_pose_acc_solve(&acc, &pout)) return 1;
+  if (! SAME_POSE(pbatch, pout)) return 1;
+
+  /* uneven parts, and an empty one */
+  for (t = 0; t < 3; t++) go_cart_cart_pose_acc_init(&part[t]);
+  go_cart_cart_pose_acc_add_n(&part[0], v1, v2, 100);
+  go_cart_cart_pose_acc_add_n(&part[2], v1 + 100, v2 + 100, NUM - 100);
+  go_cart_cart_pose_acc_merge(&part[1], &part[0]);
+  go_cart_cart_pose_acc_merge(&part[1], &part[2]);
+  if (NUM != part[1].num) return 1;
+  if (GO_RESULT_OK != go_cart_cart_pose_acc_solve(&part[1], &pout)) return 1;
+  if (! SAME_POSE(pbatch, pout)) return 1;
+
+  return 0;
+#undef SAME_POSE
+}
+
 static int test_cart_trilaterate(void)
 {
   go_cart c1 = {2, 1, 1};
@@ -1066,6 +1138,7 @@ static int test_mat4_inv(void)
 {
   go_real a[4][4];
   go_real vin[4], vout[4];
+  go_real gain;
   go_result retval;
   int i, row, col;
 
@@ -1083,8 +1156,16 @@ static int test_mat4_inv(void)
 
     if (GO_RESULT_OK == retval) {
       go_mat4_vec4_mult(a, vout, vout);
+      /* the largest inverse element stands in for the condition number */
+      gain = 0;
       for (row = 0; row < 4; row++) {
-	if (! GO_CLOSE(vout[row], vin[row])) {
+	for (col = 0; col < 4; col++) {
+	  if (fabs(a[row][col]) > gain) gain = fabs(a[row][col]);
+	}
+      }
+      gain *= 4;
+      for (row = 0; row < 4; row++) {
+	if (! INV_CLOSE(vout[row], vin[row], gain)) {
 	  return 1;
 	}
       }
@@ -1098,6 +1179,7 @@ static int test_mat6_inv(void)
 {
   go_real a[6][6];
   go_real vin[6], vout[6];
+  go_real gain;
   go_result retval;
   int i, row, col;
 
@@ -1115,8 +1197,16 @@ static int test_mat6_inv(void)
 
     if (GO_RESULT_OK == retval) {
       go_mat6_vec6_mult(a, vout, vout);
+      /* the largest inverse element stands in for the condition number */
+      gain = 0;
       for (row = 0; row < 6; row++) {
-	if (! GO_CLOSE(vout[row], vin[row])) {
+	for (col = 0; col < 6; col++) {
+	  if (fabs(a[row][col]) > gain) gain = fabs(a[row][col]);
+	}
+      }
+      gain *= 6;
+      for (row = 0; row < 6; row++) {
+	if (! INV_CLOSE(vout[row], vin[row], gain)) {
 	  return 1;
 	}
       }
@@ -1292,11 +1382,11 @@ int test_atrigs()
       printf("atans not split: %f %f %f\n", (double) v, (double) thp, (double) thn);
       return 1;
     }
-    if (! GO_ROT_CLOSE(v, tan(thp))) {
+    if (! TAN_CLOSE(v, tan(thp))) {
       printf("atan pos not close: %f %f\n", (double) v, (double) thp);
       return 1;
     }
-    if (! GO_ROT_CLOSE(v, tan(thn))) {
+    if (! TAN_CLOSE(v, tan(thn))) {
       printf("atan neg not close: %f %f\n", (double) v, (double) thn);
       return 1;
     }
@@ -1364,12 +1454,384 @@ int test_eulers()
   return 0;
 }
 
+/*
+  Fills 'pb' with 'num' random poses, and 'poses' if not null.
+*/
+static void random_pose_batch(go_integer num, go_pose_batch *pb, go_pose *poses)
+{
+  go_pose pose;
+  go_rvec rvec;
+  go_integer n;
+
+  for (n = 0; n < num; n++) {
+    pose.tran.x = go_random() - 0.5;
+    pose.tran.y = go_random() - 0.5;
+    pose.tran.z = go_random() - 0.5;
+    rvec.x = GO_PI * (go_random() - 0.5);
+    rvec.y = GO_PI * (go_random() - 0.5);
+    rvec.z = GO_PI * (go_random() - 0.5);
+    go_rvec_quat_convert(&rvec, &pose.rot);
+    pb->x[n] = pose.tran.x, pb->y[n] = pose.tran.y, pb->z[n] = pose.tran.z;
+    pb->s[n] = pose.rot.s, pb->i[n] = pose.rot.x, pb->j[n] = pose.rot.y, pb->k[n] = pose.rot.z;
+    if (NULL != poses) poses[n] = pose;
+  }
+}
+
+/* 'buf' holds 7 arrays of 'num' reals */
+static void pose_batch_set(go_real *buf, go_integer num, go_pose_batch *pb)
+{
+  pb->x = buf, pb->y = buf + num, pb->z = buf + 2 * num;
+  pb->s = buf + 3 * num, pb->i = buf + 4 * num, pb->j = buf + 5 * num, pb->k = buf + 6 * num;
+}
+
+#define MULT_N_NUM 1003		/* odd, to leave a tail */
+
+int test_mult_n()
+{
+  static go_real buf[3][7 * MULT_N_NUM];
+  static go_pose p1[MULT_N_NUM], p2[MULT_N_NUM];
+  go_pose pout;
+  go_pose_batch b1, b2, bout;
+  go_quat_batch q1, q2;
+  go_cart_batch c, cout;
+  go_cart v;
+  go_integer n;
+
+  pose_batch_set(buf[0], MULT_N_NUM, &b1);
+  pose_batch_set(buf[1], MULT_N_NUM, &b2);
+  pose_batch_set(buf[2], MULT_N_NUM, &bout);
+  random_pose_batch(MULT_N_NUM, &b1, p1);
+  random_pose_batch(MULT_N_NUM, &b2, p2);
+
+  if (GO_RESULT_OK != go_pose_pose_mult_n(MULT_N_NUM, &b1, &b2, &bout)) return 1;
+  for (n = 0; n < MULT_N_NUM; n++) {
+    go_pose_pose_mult(&p1[n], &p2[n], &pout);
+    if (! GO_CLOSE(pout.tran.x, bout.x[n]) ||
+	! GO_CLOSE(pout.tran.y, bout.y[n]) ||
+	! GO_CLOSE(pout.tran.z, bout.z[n]) ||
+	! GO_CLOSE(pout.rot.s, bout.s[n]) ||
+	! GO_CLOSE(pout.rot.x, bout.i[n]) ||
+	! GO_CLOSE(pout.rot.y, bout.j[n]) ||
+	! GO_CLOSE(pout.rot.z, bout.k[n])) {
+      return 1;
+    }
+  }
+
+  /* the rotations, in place */
+  q1.s = b1.s, q1.x = b1.i, q1.y = b1.j, q1.z = b1.k;
+  q2.s = b2.s, q2.x = b2.i, q2.y = b2.j, q2.z = b2.k;
+  if (GO_RESULT_OK != go_quat_quat_mult_n(MULT_N_NUM, &q1, &q2, &q1)) return 1;
+  for (n = 0; n < MULT_N_NUM; n++) {
+    if (! GO_CLOSE(q1.s[n], bout.s[n]) ||
+	! GO_CLOSE(q1.x[n], bout.i[n]) ||
+	! GO_CLOSE(q1.y[n], bout.j[n]) ||
+	! GO_CLOSE(q1.z[n], bout.k[n])) {
+      return 1;
+    }
+  }
+
+  /* the second translations, by the first pose */
+  c.x = b2.x, c.y = b2.y, c.z = b2.z;
+  cout.x = bout.x, cout.y = bout.y, cout.z = bout.z;
+  if (GO_RESULT_OK != go_pose_cart_mult_n(&p1[0], MULT_N_NUM, &c, &cout)) return 1;
+  for (n = 0; n < MULT_N_NUM; n++) {
+    go_pose_cart_mult(&p1[0], &p2[n].tran, &v);
+    if (! GO_CLOSE(v.x, cout.x[n]) ||
+	! GO_CLOSE(v.y, cout.y[n]) ||
+	! GO_CLOSE(v.z, cout.z[n])) {
+      return 1;
+    }
+  }
+
+  /* and rotated, in place */
+  if (GO_RESULT_OK != go_quat_cart_mult_n(&p1[0].rot, MULT_N_NUM, &c, &c)) return 1;
+  for (n = 0; n < MULT_N_NUM; n++) {
+    go_quat_cart_mult(&p1[0].rot, &p2[n].tran, &v);
+    if (! GO_CLOSE(v.x, c.x[n]) ||
+	! GO_CLOSE(v.y, c.y[n]) ||
+	! GO_CLOSE(v.z, c.z[n])) {
+      return 1;
+    }
+  }
+
+  /* one unnormalized quaternion, in the vector part or the tail, fails them */
+  b2.s[MULT_N_NUM / 2] *= 2;
+  if (GO_RESULT_NORM_ERROR != go_pose_pose_mult_n(MULT_N_NUM, &b1, &b2, &bout)) return 1;
+  if (GO_RESULT_NORM_ERROR != go_quat_quat_mult_n(MULT_N_NUM, &q1, &q2, &q1)) return 1;
+  b2.s[MULT_N_NUM / 2] /= 2;
+  b1.s[MULT_N_NUM - 1] *= 2;
+  if (GO_RESULT_NORM_ERROR != go_pose_pose_mult_n(MULT_N_NUM, &b1, &b2, &bout)) return 1;
+  if (GO_RESULT_NORM_ERROR != go_quat_quat_mult_n(MULT_N_NUM, &q2, &q1, &q2)) return 1;
+
+  return 0;
+}
+
+/*
+  Prints the throughput of the pose multiplies one at a time and as
+  batches of 'num', in millions per second.
+*/
+static int see_mult_n_speed(go_integer num)
+{
+  go_real *buf;
+  go_pose *p1, *p2, *pout;
+  go_pose_batch b1, b2, bout;
+  go_cart_batch c, cout;
+  go_integer n, t, times;
+  clock_t start;
+  double secs, mps;
+
+  if (num < 1) {
+    fprintf(stderr, "bad batch size %d\n", (int) num);
+    return 1;
+  }
+
+  buf = (go_real *) malloc(3 * 7 * num * sizeof(go_real));
+  p1 = (go_pose *) malloc(3 * num * sizeof(go_pose));
+  if (NULL == buf || NULL == p1) {
+    fprintf(stderr, "can't allocate %d poses\n", (int) num);
+    return 1;
+  }
+  p2 = p1 + num;
+  pout = p2 + num;
+  pose_batch_set(buf, num, &b1);
+  pose_batch_set(buf + 7 * num, num, &b2);
+  pose_batch_set(buf + 14 * num, num, &bout);
+  random_pose_batch(num, &b1, p1);
+  random_pose_batch(num, &b2, p2);
+  c.x = b2.x, c.y = b2.y, c.z = b2.z;
+  cout.x = bout.x, cout.y = bout.y, cout.z = bout.z;
+
+  /* enough passes to make a few tens of millions */
+  times = 50000000 / num + 1;
+
+#define MPS() (secs = (double) (clock() - start) / CLOCKS_PER_SEC, \
+	       mps = secs > 0 ? times * (double) num / secs * 1.0e-6 : 0)
+
+  printf("vector instructions: %s\n", go_math_n_isa());
+
+  start = clock();
+  for (t = 0; t < times; t++)
+    for (n = 0; n < num; n++) go_pose_pose_mult(&p1[n], &p2[n], &pout[n]);
+  MPS();
+  printf("go_pose_pose_mult   %8.1f M/s\n", mps);
+
+  start = clock();
+  for (t = 0; t < times; t++) go_pose_pose_mult_n(num, &b1, &b2, &bout);
+  MPS();
+  printf("go_pose_pose_mult_n %8.1f M/s\n", mps);
+
+  start = clock();
+  for (t = 0; t < times; t++)
+    for (n = 0; n < num; n++) go_pose_cart_mult(&p1[0], &p2[n].tran, &pout[n].tran);
+  MPS();
+  printf("go_pose_cart_mult   %8.1f M/s\n", mps);
+
+  start = clock();
+  for (t = 0; t < times; t++) go_pose_cart_mult_n(&p1[0], num, &c, &cout);
+  MPS();
+  printf("go_pose_cart_mult_n %8.1f M/s\n", mps);
+
+#undef MPS
+
+  free(p1);
+  free(buf);
+
+  return 0;
+}
+
+/*
+  Checks the fixed-size solvers against the matrices they solve with:
+  A x = b for the LU and Cholesky solves, and J x = b and J Jinv = I
+  for the 6xN ones with N = 6, 7 and 8.
+*/
+int test_mat6_solvers()
+{
+  go_real a[6][6], lu[6][6], l[6][6];
+  go_real j[6][GO_MAT6N_MAX], jinv[GO_MAT6N_MAX][6];
+  go_real winv[GO_MAT6N_MAX];
+  go_real b[6], x[GO_MAT6N_MAX], ax[6];
+  go_real sum, gain;
+  go_integer index[6];
+  go_integer n;
+  int i, row, col, k;
+
+  for (i = 0; i < 1000; i++) {
+    for (row = 0; row < 6; row++) {
+      for (col = 0; col < 6; col++) {
+	a[row][col] = go_random();
+      }
+      b[row] = go_random();
+    }
+
+    if (GO_RESULT_OK == go_mat6_lu(a, lu, index)) {
+      go_mat6_lu_solve(lu, index, b, x);
+      go_mat6_vec6_mult(a, x, ax);
+      for (row = 0, gain = 0; row < 6; row++) {
+	if (fabs(x[row]) > gain) gain = fabs(x[row]);
+      }
+      gain *= 6;
+      for (row = 0; row < 6; row++) {
+	if (! INV_CLOSE(ax[row], b[row], gain)) return 1;
+      }
+      if (GO_RESULT_OK != go_mat6_solve(a, b, b)) return 1;
+      for (row = 0; row < 6; row++) {
+	if (x[row] != b[row]) return 1;
+      }
+    }
+
+    /* A AT + I is symmetric positive definite */
+    for (row = 0; row < 6; row++) {
+      for (col = 0; col < 6; col++) {
+	for (k = 0, sum = 0; k < 6; k++) sum += a[row][k] * a[col][k];
+	lu[row][col] = sum + (row == col ? 1 : 0);
+      }
+    }
+    if (GO_RESULT_OK != go_mat6_chol(lu, l)) return 1;
+    go_mat6_chol_solve(l, b, x);
+    go_mat6_vec6_mult(lu, x, ax);
+    for (row = 0, gain = 0; row < 6; row++) {
+      if (fabs(ax[row]) > gain) gain = fabs(ax[row]);
+    }
+    for (row = 0; row < 6; row++) {
+      if (! INV_CLOSE(ax[row], b[row], gain)) return 1;
+    }
+    if (! GO_CLOSE(go_vec6_dot(x, ax), go_vec6_dot(ax, x))) return 1;
+  }
+
+  for (n = 6; n <= GO_MAT6N_MAX; n++) {
+    for (i = 0; i < 1000; i++) {
+      /* keep J well conditioned so the plain checks hold */
+      for (row = 0; row < 6; row++) {
+	for (col = 0; col < n; col++) {
+	  j[row][col] = go_random() + (row == col ? 2 : 0);
+	}
+	b[row] = go_random();
+      }
+      for (col = 0; col < n; col++) {
+	winv[col] = 0.5 + go_random();
+      }
+
+      if (GO_RESULT_OK != go_mat6n_dls_solve(j, n, winv, 0, b, x)) return 1;
+      go_mat6n_vecn_mult(j, n, x, ax);
+      for (row = 0; row < 6; row++) {
+	if (! GO_CLOSE(ax[row], b[row])) return 1;
+      }
+
+      if (GO_RESULT_OK != go_mat6n_pinv(j, n, winv, jinv)) return 1;
+      for (row = 0; row < 6; row++) {
+	for (col = 0; col < 6; col++) {
+	  for (k = 0, sum = 0; k < n; k++) sum += j[row][k] * jinv[k][col];
+	  if (! GO_CLOSE(sum, row == col ? 1 : 0)) return 1;
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*
+  Prints the time for one solve of J x = b, in microseconds, with the
+  generic go_matrix functions and with the fixed-size ones, for 6xN
+  Jacobians with N = 6, 7 and 8. The generic path for N > 6 forms the
+  weighted pseudo-inverse Winv JT (J Winv JT)inv the way the general
+  serial kinematics did.
+*/
+static int see_mat6_solver_speed(void)
+{
+  GO_MATRIX_DECLARE(J, Jstg, 6, GO_MAT6N_MAX);
+  GO_MATRIX_DECLARE(JT, JTstg, GO_MAT6N_MAX, 6);
+  GO_MATRIX_DECLARE(JJT, JJTstg, 6, 6);
+  GO_MATRIX_DECLARE(Minv, Minvstg, GO_MAT6N_MAX, GO_MAT6N_MAX);
+  GO_MATRIX_DECLARE(Jinv, Jinvstg, GO_MAT6N_MAX, 6);
+  go_real j[6][GO_MAT6N_MAX], jinv[GO_MAT6N_MAX][6];
+  go_real a[6][6], ainv[6][6];
+  go_real winv[GO_MAT6N_MAX];
+  go_real b[6], x[GO_MAT6N_MAX];
+  go_integer n, row, col, t;
+  go_integer times = 200000;
+  clock_t start;
+  double us;
+
+#define US() (us = (double) (clock() - start) / CLOCKS_PER_SEC / times * 1.0e6)
+
+  for (n = 6; n <= GO_MAT6N_MAX; n++) {
+    go_matrix_init(J, Jstg, 6, n);
+    go_matrix_init(JT, JTstg, n, 6);
+    go_matrix_init(JJT, JJTstg, 6, 6);
+    go_matrix_init(Minv, Minvstg, n, n);
+    go_matrix_init(Jinv, Jinvstg, n, 6);
+    for (row = 0; row < 6; row++) {
+      for (col = 0; col < n; col++) {
+	j[row][col] = J.el[row][col] = go_random() + (row == col ? 2 : 0);
+	if (col < 6) a[row][col] = j[row][col];
+      }
+      b[row] = go_random();
+    }
+    for (row = 0; row < n; row++) {
+      winv[row] = 1;
+      for (col = 0; col < n; col++) {
+	Minv.el[row][col] = (row == col ? winv[row] : 0);
+      }
+    }
+
+    printf("N = %d\n", (int) n);
+
+    start = clock();
+    for (t = 0; t < times; t++) {
+      if (6 == n) {
+	go_matrix_inv(&J, &Jinv);
+      } else {
+	go_matrix_transpose(&J, &JT);
+	go_matrix_matrix_mult(&Minv, &JT, &JT);
+	go_matrix_matrix_mult(&J, &JT, &JJT);
+	go_matrix_inv(&JJT, &JJT);
+	go_matrix_matrix_mult(&JT, &JJT, &Jinv);
+	go_matrix_matrix_mult(&Minv, &Jinv, &Jinv);
+      }
+      go_matrix_vector_mult(&Jinv, b, x);
+    }
+    US();
+    printf("  go_matrix          %8.3f us\n", us);
+
+    if (6 == n) {
+      start = clock();
+      for (t = 0; t < times; t++) {
+	go_mat6_inv(a, ainv);
+	go_mat6_vec6_mult(ainv, b, x);
+      }
+      US();
+      printf("  go_mat6_inv        %8.3f us\n", us);
+
+      start = clock();
+      for (t = 0; t < times; t++) go_mat6_solve(a, b, x);
+      US();
+      printf("  go_mat6_solve      %8.3f us\n", us);
+    }
+
+    start = clock();
+    for (t = 0; t < times; t++) go_mat6n_dls_solve(j, n, winv, 0, b, x);
+    US();
+    printf("  go_mat6n_dls_solve %8.3f us\n", us);
+
+    start = clock();
+    for (t = 0; t < times; t++) go_mat6n_pinv(j, n, winv, jinv);
+    US();
+    printf("  go_mat6n_pinv      %8.3f us\n", us);
+  }
+
+#undef US
+
+  return 0;
+}
 
 /*
   Usage: gomathtest {<option number>}
 
   Option '1' enters an interactive pose-to-DH-parameter session
   Option '2' prints some hard-coded pose interpolation
+  Option '3 {<batch size>}' prints the speed of the batch multiplies
+  Option '4' prints the speed of the 6x6 and 6xN solvers
 */
 
 int main(int argc, char *argv[])
@@ -1390,6 +1852,12 @@ int main(int argc, char *argv[])
     case 2:
       return see_pose_pose_interp();
       break;
+    case 3:
+      return see_mult_n_speed(argc > 2 ? atoi(argv[2]) : 1000);
+      break;
+    case 4:
+      return see_mat6_solver_speed();
+      break;
     default:
       fprintf(stderr, "no test case for option %d\n", which);
       return 1;
@@ -1517,6 +1985,14 @@ int main(int argc, char *argv[])
   }
   printf("ok\n");
 
+  printf("test_cart_cart_pose_acc: ");
+  fflush(stdout);
+  if (test_cart_cart_pose_acc()) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("ok\n");
+
   printf("test_cart_trilaterate: ");
   fflush(stdout);
   if (test_cart_trilaterate()) {
@@ -1621,5 +2097,21 @@ int main(int argc, char *argv[])
   }
   printf("ok\n");
 
+  printf("test_mult_n: ");
+  fflush(stdout);
+  if (test_mult_n()) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("ok\n");
+
+  printf("test_mat6_solvers: ");
+  fflush(stdout);
+  if (test_mat6_solvers()) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("ok\n");
+
   return 0;
 }
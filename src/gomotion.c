@@ -22,6 +22,7 @@
 #include <math.h>		/* acos(), fabs() */
 #include "gotypes.h"
 #include "gomath.h"
+#include "gomathinline.h"	/* go_cart_mag_i, ... */
 #include "gotraj.h"
 #include "gomotion.h"
 
@@ -54,6 +55,16 @@ go_result go_motion_spec_init(go_motion_spec * spec)
   */
   spec->totalt = 0.0;
 
+  /*
+    A negative 'tol' means use the path blending tolerance set for the
+    queue, which is zero (exact stop) unless set otherwise.
+  */
+  spec->tol = -1.0;
+  spec->tnext = 0.0;
+  spec->tprev = 0.0;
+  spec->planned = 0;
+  spec->vjmax = 0.0;
+
   return GO_RESULT_OK;
 }
 
@@ -61,7 +72,8 @@ go_result go_motion_spec_set_type(go_motion_spec * spec, go_flag type)
 {
   if (type == GO_MOTION_JOINT ||
       type == GO_MOTION_LINEAR ||
-      type == GO_MOTION_CIRCULAR) {
+      type == GO_MOTION_CIRCULAR ||
+      type == GO_MOTION_SPLINE) {
     spec->type = type;
     return GO_RESULT_OK;
   }
@@ -173,6 +185,13 @@ go_result go_motion_spec_set_end_pose(go_motion_spec * spec, go_pose * end)
   return GO_RESULT_OK;
 }
 
+go_result go_motion_spec_set_tol(go_motion_spec * spec, go_real tol)
+{
+  spec->tol = tol;
+
+  return GO_RESULT_OK;
+}
+
 go_result go_motion_queue_init(go_motion_queue * queue,
 			       go_motion_spec * space,
 			       go_integer size,
@@ -187,6 +206,10 @@ go_result go_motion_queue_init(go_motion_queue * queue,
   queue->endptr = space + size;
   queue->deltat = deltat;
   queue->joint_num = GO_MOTION_JOINT_NUM;
+  queue->tol = 0.0;
+  queue->donet = 0.0;
+  queue->points = NULL;
+  queue->points_size = 0;
 
   return go_motion_queue_reset(queue);
 }
@@ -199,10 +222,31 @@ go_result go_motion_queue_reset(go_motion_queue * queue)
   queue->number = 0;
   queue->last_id = 0;
   queue->time = 0.0;
+  queue->points_start = 0;
+  queue->points_number = 0;
 
   return go_scale_init(&queue->timescale, 1.0);
 }
 
+go_result go_motion_queue_set_points(go_motion_queue * queue,
+				     go_motion_spline_point * space,
+				     go_integer size)
+{
+  if (queue->points_number != 0) {
+    return GO_RESULT_ERROR;
+  }
+
+  if (size < 0 || (NULL == space && size > 0)) {
+    return GO_RESULT_BAD_ARGS;
+  }
+
+  queue->points = space;
+  queue->points_size = size;
+  queue->points_start = 0;
+
+  return GO_RESULT_OK;
+}
+
 go_result go_motion_queue_set_type(go_motion_queue * queue, go_flag type)
 {
   if (type == GO_MOTION_NONE ||
@@ -258,6 +302,18 @@ go_result go_motion_queue_set_cycle_time(go_motion_queue * queue,
   return GO_RESULT_OK;
 }
 
+go_result go_motion_queue_set_tol(go_motion_queue * queue,
+				  go_real tol)
+{
+  if (tol < 0.0) {
+    return GO_RESULT_BAD_ARGS;
+  }
+
+  queue->tol = tol;
+
+  return GO_RESULT_OK;
+}
+
 go_result go_scale_init(go_scale_spec * spec, go_real scale)
 {
   spec->scaling = 0;
@@ -347,6 +403,46 @@ go_result go_motion_queue_set_scale(go_motion_queue * queue,
   return go_scale_set(&queue->timescale, scale, scale_v, scale_a);
 }
 
+/*
+  Compiles the profiles of 'spec' for interpolation, along with the
+  axes it rotates about, so that each cycle needs only a polynomial
+  evaluation per profile and a sine and cosine per rotation.
+*/
+static void
+go_motion_spec_compile(const go_motion_queue * queue, go_motion_spec * spec)
+{
+  go_real sh;
+  go_integer i;
+
+  if (queue->type != GO_MOTION_WORLD) {
+    for (i = 0; i < queue->joint_num; i++) {
+      (void) go_traj_cj_poly(&spec->cj[i], &spec->poly[i]);
+    }
+    return;
+  }
+
+  if (spec->planned) {
+    (void) go_traj_cjv_poly(&spec->cjv, &spec->poly[0]);
+  } else {
+    (void) go_traj_cj_poly(&spec->cj[0], &spec->poly[0]);
+  }
+  (void) go_traj_cj_poly(&spec->cj[1], &spec->poly[1]);
+
+  /* 'uquat' is a turn of one radian about the rotation axis */
+  sh = sqrt(go_sq(spec->uquat.x) + go_sq(spec->uquat.y) + go_sq(spec->uquat.z));
+  if (GO_SMALL(sh)) {
+    spec->raxis.x = spec->raxis.y = spec->raxis.z = 0.0;
+  } else {
+    spec->raxis.x = spec->uquat.x / sh;
+    spec->raxis.y = spec->uquat.y / sh;
+    spec->raxis.z = spec->uquat.z / sh;
+  }
+
+  if (spec->type == GO_MOTION_CIRCULAR) {
+    (void) go_cart_cart_cross(&spec->u.cpar.normal, &spec->u.cpar.urcsp, &spec->u.cpar.vrcsp);
+  }
+}
+
 /*
   Given:
   
@@ -410,6 +506,10 @@ go_motion_queue_append_joint(go_motion_queue * queue,
   }
 
   spec.totalt = maxtd;		/* set the overall motion time */
+  /* joint moves are not blended or planned */
+  spec.tnext = spec.totalt;
+  spec.tprev = 0.0;
+  spec.planned = 0;
 
   /* now all the joint motion phase times are calculated, and we have
      the maximum time, so scale all the joint moves to arrive at the 
@@ -418,6 +518,7 @@ go_motion_queue_append_joint(go_motion_queue * queue,
   for (i = 0; i < queue->joint_num; i++) {
       go_traj_cj_scale(&spec.cj[i], maxtd, &spec.cj[i]);
   }
+  go_motion_spec_compile(queue, &spec);
 
   /* copy the spec to the queue, and update the queue pointers */
   *queue->end = spec;
@@ -466,6 +567,11 @@ go_motion_queue_append_ujoint(go_motion_queue * queue,
   }
 
   spec.totalt = maxtd;		/* set the overall motion time */
+  /* joint moves are not blended or planned */
+  spec.tnext = spec.totalt;
+  spec.tprev = 0.0;
+  spec.planned = 0;
+  go_motion_spec_compile(queue, &spec);
 
   /* copy the spec to the queue, and update the queue pointers */
   *queue->end = spec;
@@ -479,6 +585,600 @@ go_motion_queue_append_ujoint(go_motion_queue * queue,
   return GO_RESULT_OK;
 }
 
+/*
+  Look-ahead planning and blending of world moves.
+
+  Translation-only world moves that aren't timed are "planned": their
+  translation follows a CJV profile that may start and end at nonzero
+  speeds, so the tool can flow through a junction rather than stop
+  there. The junction speed is limited by the corner angle using the
+  usual junction deviation rule, in which the corner is treated as an
+  arc that lies within the tolerance 'tol' of the previous motion and
+  whose centripetal acceleration is within the max accel. Straight-on
+  junctions run at the lesser of the two max speeds, and reversals
+  or moves with exact stop tolerance come to rest.
+
+  Each time a motion is appended, the planner makes a backward pass
+  from the end of the queue, where motion must stop, finding the
+  highest speed each motion may enter with and still slow down for
+  what follows, and a forward pass from the motion being executed,
+  limiting each motion's exit speed by how much it can speed up. Since
+  appending motions only gives more room to slow down, the backward
+  pass stops as soon as it finds a limit that hasn't changed.
+
+  The motion currently executing is "frozen", as is the next one if
+  the two are blending. The last frozen motion may only have its
+  ending speed raised, and only if it hasn't begun slowing down.
+
+  Where motions meet at rest, blending overlaps the deceleration of
+  the first, 'prev', with the acceleration of the second, 'spec'.
+  During the overlap the displacement of 'spec' from its start is added
+  to the position of 'prev', so the tool rounds the corner instead of
+  stopping there.
+
+  If the overlap lasts 'T', the point being interpolated is never
+  farther from the programmed corner than the distance 'prev' has left
+  to go at the start of the overlap, nor farther than the distance
+  'spec' has covered at the end of it. We bound both of these by the
+  tolerance of 'prev', and search for the largest 'T' that satisfies
+  both, since the distances increase with 'T'.
+
+  'T' is also limited to the decel phase of 'prev' and the accel phase
+  of 'spec', so that the speeds and accelerations of each are ramping
+  in opposite directions during the overlap. The overlap may not begin
+  before 'prev' is done blending with its own predecessor, so that no
+  more than two motions are ever active, nor before 'tmin'.
+
+  prev->tnext is the time into 'prev' when 'spec' begins, and
+  spec->tprev is the time into 'spec' when 'prev' ends. These are
+  totalt and 0, respectively, if no blending is done.
+*/
+
+#define BLEND_ITERATIONS 20
+
+static go_motion_spec *
+go_motion_queue_at(go_motion_queue * queue, go_integer i)
+{
+  go_motion_spec * ptr;
+
+  ptr = queue->start + i;
+  if (ptr >= queue->endptr) {
+    ptr -= queue->size;
+  }
+
+  return ptr;
+}
+
+/*
+  The control points of spline moves are kept in the queue's point
+  pool, which wraps around like the queue does. This returns the 'i'th
+  point of the spline whose first point is at 'first'.
+*/
+static go_motion_spline_point *
+go_motion_queue_point(const go_motion_queue * queue, go_integer first,
+		      go_integer i)
+{
+  go_integer index;
+
+  index = first + i;
+  if (index >= queue->points_size) {
+    index -= queue->points_size;
+  }
+
+  return &queue->points[index];
+}
+
+/*
+  Gets the weights of the four control points of a uniform cubic
+  B-spline segment at 'u' in [0,1], in 'w', and of their first and
+  second derivatives in 'dw' and 'ddw' if those aren't null.
+*/
+static void
+go_motion_spline_weights(go_real u, go_real * w, go_real * dw, go_real * ddw)
+{
+  go_real v;
+
+  v = 1.0 - u;
+  if (NULL != w) {
+    w[0] = v * v * v * (1.0 / 6.0);
+    w[1] = ((3.0 * u - 6.0) * u * u + 4.0) * (1.0 / 6.0);
+    w[2] = (((-3.0 * u + 3.0) * u + 3.0) * u + 1.0) * (1.0 / 6.0);
+    w[3] = u * u * u * (1.0 / 6.0);
+  }
+  if (NULL != dw) {
+    dw[0] = -0.5 * v * v;
+    dw[1] = (1.5 * u - 2.0) * u;
+    dw[2] = (-1.5 * u + 1.0) * u + 0.5;
+    dw[3] = 0.5 * u * u;
+  }
+  if (NULL != ddw) {
+    ddw[0] = v;
+    ddw[1] = 3.0 * u - 2.0;
+    ddw[2] = -3.0 * u + 1.0;
+    ddw[3] = u;
+  }
+}
+
+/* sums the control points of segment 'seg' with the weights 'w' */
+static void
+go_motion_spline_sum(const go_motion_queue * queue, go_integer first,
+		     go_integer seg, const go_real * w, go_cart * cart)
+{
+  const go_cart * p;
+  go_integer i;
+
+  cart->x = cart->y = cart->z = 0.0;
+  for (i = 0; i < 4; i++) {
+    p = &go_motion_queue_point(queue, first, seg + i)->point;
+    cart->x += w[i] * p->x;
+    cart->y += w[i] * p->y;
+    cart->z += w[i] * p->z;
+  }
+}
+
+/* the speed along segment 'seg' at 'u', per unit 'u' */
+static go_real
+go_motion_spline_speed(const go_motion_queue * queue, go_integer first,
+		       go_integer seg, go_real u)
+{
+  go_real dw[4];
+  go_cart cart;
+
+  go_motion_spline_weights(u, NULL, dw, NULL);
+  go_motion_spline_sum(queue, first, seg, dw, &cart);
+
+  return go_cart_mag_i(&cart);
+}
+
+/* the curvature of segment 'seg' at 'u', or 0 where it's not moving */
+static go_real
+go_motion_spline_curvature(const go_motion_queue * queue, go_integer first,
+			   go_integer seg, go_real u)
+{
+  go_real dw[4], ddw[4];
+  go_cart d1, d2, cross;
+  go_real mag1, magx;
+
+  go_motion_spline_weights(u, NULL, dw, ddw);
+  go_motion_spline_sum(queue, first, seg, dw, &d1);
+  go_motion_spline_sum(queue, first, seg, ddw, &d2);
+  mag1 = go_cart_mag_i(&d1);
+  if (GO_TRAN_SMALL(mag1)) return 0.0;
+  cross = go_cart_cart_cross_i(&d1, &d2);
+  magx = go_cart_mag_i(&cross);
+
+  return magx / (mag1 * mag1 * mag1);
+}
+
+/*
+  Returns the arc length of segment 'seg' from 'u0' to 'u1', using
+  three-point Gauss-Legendre quadrature, which is exact for the
+  polynomial parts of the speed and close enough for the rest over the
+  short spans we use it.
+*/
+static go_real
+go_motion_spline_length(const go_motion_queue * queue, go_integer first,
+			go_integer seg, go_real u0, go_real u1)
+{
+  go_real mid, half;
+
+  mid = 0.5 * (u0 + u1);
+  half = 0.5 * (u1 - u0);
+
+  return half * ((5.0 / 9.0) * go_motion_spline_speed(queue, first, seg, mid - half * 0.774596669241483377) +
+		 (8.0 / 9.0) * go_motion_spline_speed(queue, first, seg, mid) +
+		 (5.0 / 9.0) * go_motion_spline_speed(queue, first, seg, mid + half * 0.774596669241483377));
+}
+
+/*
+  Finds the segment 'seg' and its parameter 'u' that are 's' along
+  the spline, from the arc length table.
+*/
+static void
+go_motion_spline_locate(const go_motion_queue * queue,
+			const go_motion_spline_params * spar,
+			go_real s, go_integer * seg, go_real * u)
+{
+  const go_motion_spline_point * point;
+  go_integer last;
+  go_integer lo, hi, mid;
+  go_integer k;
+  go_real s0, s1;
+  go_real frac;
+
+  /* find the last segment that starts at or before 's' */
+  last = spar->num - 4;
+  lo = 0, hi = last;
+  while (lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    if (go_motion_queue_point(queue, spar->first, mid)->s[0] <= s) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  point = go_motion_queue_point(queue, spar->first, lo);
+
+  /* and the division of it */
+  for (k = GO_MOTION_SPLINE_DIVS - 1; k > 0 && point->s[k] > s; k--);
+  s0 = point->s[k];
+  if (k < GO_MOTION_SPLINE_DIVS - 1) {
+    s1 = point->s[k + 1];
+  } else if (lo < last) {
+    s1 = go_motion_queue_point(queue, spar->first, lo + 1)->s[0];
+  } else {
+    s1 = spar->stot;
+  }
+
+  frac = s1 > s0 ? (s - s0) / (s1 - s0) : 0.0;
+  if (frac < 0.0) frac = 0.0;
+  else if (frac > 1.0) frac = 1.0;
+
+  *seg = lo;
+  *u = (k + frac) * (1.0 / GO_MOTION_SPLINE_DIVS);
+}
+
+/*
+  Fills in the control points and arc length table of the spline
+  'spar' from 'start' to 'end' through the 'num' 'points', in the
+  free part of the queue's point pool, and returns in 'kmax' the
+  highest curvature found along the way. The points aren't taken from
+  the pool until the move is appended.
+*/
+static go_result
+go_motion_spline_build(const go_motion_queue * queue,
+		       go_motion_spline_params * spar,
+		       const go_cart * start, const go_cart * end,
+		       const go_cart * points, go_integer num,
+		       go_real * kmax)
+{
+  go_motion_spline_point * point;
+  go_cart cart;
+  go_real stot;
+  go_real u;
+  go_real k;
+  go_integer seg;
+  go_integer i;
+
+  if (num < 0 || (num > 0 && NULL == points)) {
+    return GO_RESULT_BAD_ARGS;
+  }
+  if (queue->points_number + num + 4 > queue->points_size) {
+    return GO_RESULT_NO_SPACE;
+  }
+
+  spar->num = num + 4;
+  spar->first = queue->points_start + queue->points_number;
+  if (spar->first >= queue->points_size) {
+    spar->first -= queue->points_size;
+  }
+
+  /* put the start and end between points reflected through them, so
+     the curve goes through them without slowing down there */
+  for (i = 1; i < spar->num - 1; i++) {
+    point = go_motion_queue_point(queue, spar->first, i);
+    if (i == 1) point->point = *start;
+    else if (i < num + 2) point->point = points[i - 2];
+    else point->point = *end;
+  }
+  point = go_motion_queue_point(queue, spar->first, 0);
+  go_cart_scale_mult(start, 2.0, &cart);
+  go_cart_cart_sub(&cart, &go_motion_queue_point(queue, spar->first, 2)->point, &point->point);
+  point = go_motion_queue_point(queue, spar->first, spar->num - 1);
+  go_cart_scale_mult(end, 2.0, &cart);
+  go_cart_cart_sub(&cart, &go_motion_queue_point(queue, spar->first, spar->num - 3)->point, &point->point);
+
+  /* tabulate the arc length and look for the tightest bend */
+  stot = 0.0;
+  *kmax = 0.0;
+  for (seg = 0; seg < spar->num - 3; seg++) {
+    point = go_motion_queue_point(queue, spar->first, seg);
+    for (i = 0; i < GO_MOTION_SPLINE_DIVS; i++) {
+      u = (go_real) i / GO_MOTION_SPLINE_DIVS;
+      point->s[i] = stot;
+      stot += go_motion_spline_length(queue, spar->first, seg, u, u + 1.0 / GO_MOTION_SPLINE_DIVS);
+      k = go_motion_spline_curvature(queue, spar->first, seg, u);
+      if (k > *kmax) *kmax = k;
+    }
+  }
+  spar->stot = stot;
+
+  /* the end tangents point along the first and last distinct points */
+  spar->ustart.x = 1, spar->ustart.y = spar->ustart.z = 0;
+  for (i = 2; i < spar->num; i++) {
+    go_cart_cart_sub(&go_motion_queue_point(queue, spar->first, i)->point, start, &cart);
+    if (GO_RESULT_OK == go_cart_unit(&cart, &spar->ustart)) break;
+  }
+  spar->uend = spar->ustart;
+  for (i = spar->num - 3; i >= 0; i--) {
+    go_cart_cart_sub(end, &go_motion_queue_point(queue, spar->first, i)->point, &cart);
+    if (GO_RESULT_OK == go_cart_unit(&cart, &spar->uend)) break;
+  }
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Takes the control points of the spline moves that were dropped from
+  the queue back into the pool. The points in use are those of the
+  moves left, which are the oldest.
+*/
+static void
+go_motion_queue_points_trim(go_motion_queue * queue)
+{
+  go_motion_spec * spec;
+  go_integer i;
+
+  queue->points_number = 0;
+  if (queue->type != GO_MOTION_WORLD) return;
+
+  for (i = 0; i < queue->number; i++) {
+    spec = go_motion_queue_at(queue, i);
+    if (spec->type == GO_MOTION_SPLINE) {
+      queue->points_number += spec->u.spar.num;
+    }
+  }
+}
+
+static void
+go_motion_spec_tran_interp(const go_motion_spec * spec, go_real time,
+			   go_traj_interp_spec * tis)
+{
+  if (spec->planned) {
+    go_traj_cjv_interp(&spec->cjv, time, tis);
+  } else {
+    go_traj_cj_interp(&spec->cj[0], time, tis);
+  }
+}
+
+/* how long it takes 'spec' to speed up from rest at its start */
+static go_real
+go_motion_spec_accel_time(const go_motion_spec * spec, go_integer i)
+{
+  if (spec->planned && 0 == i) {
+    return spec->cjv.v0 > 0.0 ? 0.0 : spec->cjv.tr1;
+  }
+
+  return spec->cj[i].t3;
+}
+
+/* how long it takes 'spec' to slow down to rest at its end */
+static go_real
+go_motion_spec_decel_time(const go_motion_spec * spec, go_integer i)
+{
+  if (spec->planned && 0 == i) {
+    return spec->cjv.v1 > 0.0 ? 0.0 : spec->cjv.tend - spec->cjv.tc;
+  }
+
+  return spec->cj[i].tend - spec->cj[i].t4;
+}
+
+/* the unit tangent to the path at the start or end of 'spec' */
+static void
+go_motion_spec_tangent(const go_motion_spec * spec, go_flag atend,
+		       go_cart * tan)
+{
+  go_quat quat;
+  go_cart rvec;
+  go_cart cart;
+  go_real frac;
+
+  if (spec->type == GO_MOTION_CIRCULAR) {
+    frac = atend ? 1.0 : 0.0;
+    /* the radial vector at this point on the curve */
+    go_quat_scale_mult(&spec->u.cpar.qnormal, frac * spec->u.cpar.thtot, &quat);
+    go_cart_scale_mult(&spec->u.cpar.urcsp, spec->u.cpar.rstart + frac * spec->u.cpar.rtot, &rvec);
+    go_quat_cart_mult(&quat, &rvec, &rvec);
+    /* sweeping it gives the azimuthal part of the tangent */
+    go_cart_cart_cross(&spec->u.cpar.normal, &rvec, tan);
+    go_cart_scale_mult(tan, spec->u.cpar.thtot, tan);
+    /* growing it gives the radial part */
+    go_cart_unit(&rvec, &cart);
+    go_cart_scale_mult(&cart, spec->u.cpar.rtot, &cart);
+    go_cart_cart_add(tan, &cart, tan);
+    /* and sliding along the normal gives the axial part */
+    go_cart_scale_mult(&spec->u.cpar.normal, spec->u.cpar.ztot, &cart);
+    go_cart_cart_add(tan, &cart, tan);
+    if (GO_RESULT_OK != go_cart_unit(tan, tan)) {
+      *tan = spec->u.cpar.normal;
+    }
+  } else if (spec->type == GO_MOTION_SPLINE) {
+    *tan = atend ? spec->u.spar.uend : spec->u.spar.ustart;
+  } else {
+    *tan = spec->u.lpar.uvec;
+  }
+}
+
+/* the highest speed at which 'prev' can flow into 'next' */
+static go_real
+go_motion_junction_speed(const go_motion_spec * prev,
+			 const go_motion_spec * next)
+{
+  go_cart t1, t2;
+  go_real dot;
+  go_real sinhalf;
+  go_real vel, acc;
+  go_real v;
+
+  if (! prev->planned || ! next->planned || prev->tol <= 0.0) {
+    return 0.0;
+  }
+
+  vel = prev->par[0].vel < next->par[0].vel ? prev->par[0].vel : next->par[0].vel;
+  acc = prev->par[0].acc < next->par[0].acc ? prev->par[0].acc : next->par[0].acc;
+
+  go_motion_spec_tangent(prev, 1, &t1);
+  go_motion_spec_tangent(next, 0, &t2);
+  go_cart_cart_dot(&t1, &t2, &dot);
+  /* sine of half the angle inside the corner, 1 for straight on */
+  sinhalf = sqrt(0.5 * (1.0 + dot));
+  if (sinhalf >= 1.0 - GO_REAL_EPSILON) {
+    return vel;
+  }
+  if (sinhalf <= GO_REAL_EPSILON) {
+    return 0.0;
+  }
+  v = sqrt(acc * prev->tol * sinhalf / (1.0 - sinhalf));
+
+  return v < vel ? v : vel;
+}
+
+static void
+go_motion_queue_blend(go_motion_spec * prev,
+		      go_motion_spec * spec,
+		      go_real tmin)
+{
+  go_traj_interp_spec tis;
+  go_real dtend;
+  go_real tmax;
+  go_real tlo, thi, t;
+  go_integer i;
+  go_integer it;
+
+  prev->tnext = prev->totalt;
+  spec->tprev = 0.0;
+
+  if (prev->tol <= 0.0) return;
+  if (prev->type != GO_MOTION_LINEAR &&
+      prev->type != GO_MOTION_CIRCULAR &&
+      prev->type != GO_MOTION_SPLINE) return;
+
+  /* limit the overlap to the decel of 'prev' and accel of 'spec',
+     ignoring tran or rot if there's no motion in it */
+  tmax = prev->totalt;
+  for (i = 0; i < 2; i++) {
+    if (prev->cj[i].dtend > GO_REAL_EPSILON ||
+	(0 == i && prev->planned)) {
+      t = go_motion_spec_decel_time(prev, i);
+      if (t < tmax) tmax = t;
+    }
+    if (spec->cj[i].dtend > GO_REAL_EPSILON ||
+	(0 == i && spec->planned)) {
+      t = go_motion_spec_accel_time(spec, i);
+      if (t < tmax) tmax = t;
+    }
+  }
+  /* don't overlap before 'prev' is done with its predecessor */
+  if (tmin < prev->tprev) tmin = prev->tprev;
+  if (prev->totalt - tmin < tmax) {
+    tmax = prev->totalt - tmin;
+  }
+  if (tmax <= GO_REAL_EPSILON) return;
+
+  /* bisect for the largest overlap within the tolerance */
+  dtend = prev->planned ? prev->cjv.dtend : prev->cj[0].dtend;
+  tlo = 0.0, thi = tmax;
+  for (it = 0; it < BLEND_ITERATIONS; it++) {
+    t = 0.5 * (tlo + thi);
+    go_motion_spec_tran_interp(prev, prev->totalt - t, &tis);
+    if (dtend - tis.d > prev->tol) {
+      thi = t;
+      continue;
+    }
+    go_motion_spec_tran_interp(spec, t, &tis);
+    if (tis.d > prev->tol) {
+      thi = t;
+      continue;
+    }
+    tlo = t;
+  }
+  if (tlo <= GO_REAL_EPSILON) return;
+
+  prev->tnext = prev->totalt - tlo;
+  spec->tprev = tlo;
+}
+
+static void
+go_motion_queue_plan(go_motion_queue * queue)
+{
+  go_motion_spec * prev;
+  go_motion_spec * spec;
+  go_traj_cjv_spec cjv;
+  go_real now;
+  go_real v, v1;
+  go_integer frozen;
+  go_integer first;
+  go_integer i;
+
+  if (queue->number < 2) return;
+
+  /* find the last frozen motion, and the time into it */
+  spec = queue->start;
+  now = queue->time;
+  frozen = 0;
+  if (now > spec->tnext) {
+    now -= spec->tnext;
+    frozen = 1;
+  }
+
+  /* backward pass, finding the highest exit speed for each motion */
+  spec = go_motion_queue_at(queue, queue->number - 1);
+  spec->vjmax = 0.0;
+  first = frozen + 1;
+  for (i = queue->number - 1; i > frozen; i--) {
+    spec = go_motion_queue_at(queue, i);
+    prev = go_motion_queue_at(queue, i - 1);
+    v = go_motion_junction_speed(prev, spec);
+    if (v > 0.0) {
+      /* the fastest we can enter and still slow down in time */
+      v = go_traj_ramp_reach(spec->cjv.dtend, spec->vjmax, v,
+			     spec->par[0].acc, spec->par[0].jerk);
+    }
+    if (i - 1 > frozen && v == prev->vjmax) {
+      /* nothing changes from here back */
+      first = i;
+      break;
+    }
+    prev->vjmax = v;
+  }
+
+  if (first == frozen + 1) {
+    /* see if the last frozen motion can speed up its exit */
+    prev = go_motion_queue_at(queue, frozen);
+    if (prev->planned &&
+	prev->vjmax > prev->cjv.v1 &&
+	prev->cjv.t0 <= 0.0 &&
+	now <= prev->cjv.tc) {
+      v = prev->vjmax < prev->cjv.vp ? prev->vjmax : prev->cjv.vp;
+      if (GO_RESULT_OK == go_traj_cjv_compute(prev->cjv.dtend, prev->cjv.v0, prev->cjv.vp, v, prev->cjv.a, prev->cjv.j, &cjv) &&
+	  cjv.vp >= prev->cjv.vp) {
+	prev->cjv = cjv;
+	prev->totalt = cjv.tend;
+	(void) go_traj_cjv_poly(&prev->cjv, &prev->poly[0]);
+      }
+    }
+  }
+
+  /* forward pass, limiting the exit speeds by the entry speeds */
+  for (i = first; i < queue->number; i++) {
+    prev = go_motion_queue_at(queue, i - 1);
+    spec = go_motion_queue_at(queue, i);
+    if (spec->planned) {
+      v = prev->planned ? prev->cjv.v1 : 0.0;
+      if (v > spec->par[0].vel) v = spec->par[0].vel;
+      /* the fastest we can exit after speeding up from 'v' */
+      v1 = go_traj_ramp_reach(spec->cjv.dtend, v, spec->vjmax,
+			      spec->par[0].acc, spec->par[0].jerk);
+      if (GO_RESULT_OK != go_traj_cjv_compute(spec->cjv.dtend, v, spec->par[0].vel, v1, spec->par[0].acc, spec->par[0].jerk, &spec->cjv)) {
+	/* shouldn't happen, since the passes keep speeds reachable,
+	   but hold the entry speed so at least the motion is smooth */
+	(void) go_traj_cjv_compute(spec->cjv.dtend, v, spec->par[0].vel, v, spec->par[0].acc, spec->par[0].jerk, &spec->cjv);
+      }
+      spec->totalt = spec->cjv.tend;
+      (void) go_traj_cjv_poly(&spec->cjv, &spec->poly[0]);
+      /* until the next motion is planned, this one runs to its end */
+      spec->tnext = spec->totalt;
+    }
+    /* blend if we meet at rest */
+    if (prev->planned && spec->planned && prev->cjv.v1 > 0.0) {
+      prev->tnext = prev->totalt;
+      spec->tprev = 0.0;
+    } else {
+      go_motion_queue_blend(prev, spec, i - 1 == frozen ? now : 0.0);
+    }
+  }
+}
+
 /*
   Circular motion is done in cylindrical coordinates, enabling purely
   circular (theta) motion as well as helical (z) motion and spiral (r)
@@ -575,9 +1275,17 @@ go_motion_queue_append_ujoint(go_motion_queue * queue,
   rotcur = rotstart * urot * rotational distance
 */
 
+/*
+  Fills in 'motionout' for the world 'motion' as it would be appended to the
+  queue if the queue ended at 'there', without changing the queue.
+*/
 static go_result
-go_motion_queue_append_world(go_motion_queue * queue,
-			     const go_motion_spec * motion)
+go_motion_world_build(const go_motion_queue * queue,
+		      const go_position * there,
+		      const go_motion_spec * motion,
+		      const go_cart * points,
+		      go_integer num,
+		      go_motion_spec * motionout)
 {
   go_motion_spec spec;
   go_quat quat;
@@ -593,19 +1301,19 @@ go_motion_queue_append_world(go_motion_queue * queue,
   go_rvec rvec;
   go_real td;
   go_real rd;
+  go_real kmax;
   go_result retval;
 
-  if (queue->number >= queue->size) {
-    return GO_RESULT_NO_SPACE;
-  }
-
   spec = *motion;
   time = spec.totalt;	    /* save requested time and override totalt
 			       later if applicable */
+  if (spec.tol < 0.0) {
+    spec.tol = queue->tol;  /* use the queue's tolerance */
+  }
 
   switch (spec.type) {
   case GO_MOTION_LINEAR:
-    go_cart_cart_sub(&spec.end.u.pose.tran, &queue->there.u.pose.tran, &cart);
+    go_cart_cart_sub(&spec.end.u.pose.tran, &there->u.pose.tran, &cart);
     go_cart_mag(&cart, &td);
     if (GO_RESULT_OK != go_cart_unit(&cart, &spec.u.lpar.uvec)) {
       /* no translational motion, so set uvec to X */
@@ -621,7 +1329,7 @@ go_motion_queue_append_world(go_motion_queue * queue,
 
     /* get the vector from the center to the start and project onto
        the normal plane */
-    (void) go_cart_cart_sub(&queue->there.u.pose.tran, &spec.u.cpar.center, &rcs);
+    (void) go_cart_cart_sub(&there->u.pose.tran, &spec.u.cpar.center, &rcs);
     (void) go_cart_plane_proj(&rcs, &spec.u.cpar.normal, &rcsp);
     /* save the projected starting radius */
     (void) go_cart_mag(&rcsp, &spec.u.cpar.rstart);
@@ -686,15 +1394,28 @@ go_motion_queue_append_world(go_motion_queue * queue,
     }
     break;
 
+  case GO_MOTION_SPLINE:
+    retval = go_motion_spline_build(queue, &spec.u.spar, &there->u.pose.tran, &spec.end.u.pose.tran, points, num, &kmax);
+    if (GO_RESULT_OK != retval) return retval;
+    td = spec.u.spar.stot;
+    /* the planner limits the acceleration along the curve but not
+       across it, so slow down enough that the tightest bend keeps
+       within the limit too */
+    if (kmax > GO_REAL_EPSILON &&
+	spec.par[0].acc < spec.par[0].vel * spec.par[0].vel * kmax) {
+      spec.par[0].vel = sqrt(spec.par[0].acc / kmax);
+    }
+    break;
+
   default:
     return GO_RESULT_ERROR;
   } /* switch (spec.type) */
 
   /* do rotation the same way for either linear or circular moves */
-  if (GO_RESULT_OK != go_quat_inv(&queue->there.u.pose.rot, &quat)) {
+  if (GO_RESULT_OK != go_quat_inv(&there->u.pose.rot, &quat)) {
     /* 'there' should always be invertible; if not it wasn't initialized
-       to I, so do it here */
-    quat = queue->there.u.pose.rot = go_quat_identity();
+       to I, which go_motion_queue_append_world fixes */
+    quat = go_quat_identity();
   }
   retval = go_quat_quat_mult(&quat, &spec.end.u.pose.rot, &quat);
   if (GO_RESULT_OK != retval) {
@@ -727,9 +1448,54 @@ go_motion_queue_append_world(go_motion_queue * queue,
     go_traj_cj_scale(&spec.cj[1], spec.totalt, &spec.cj[1]);
   }
 
-  spec.start = queue->there;
+  /* plan the translation of untimed, translation-only motions */
+  spec.planned = 0;
+  if (time <= 0.0 &&
+      td > GO_REAL_EPSILON &&
+      spec.cj[1].dtend <= GO_REAL_EPSILON &&
+      GO_RESULT_OK == go_traj_cjv_compute(td, 0.0, spec.par[0].vel, 0.0, spec.par[0].acc, spec.par[0].jerk, &spec.cjv)) {
+    spec.planned = 1;
+    spec.totalt = spec.cjv.tend;
+  }
+  spec.vjmax = 0.0;
+  spec.tnext = spec.totalt;
+  spec.tprev = 0.0;
+  go_motion_spec_compile(queue, &spec);
+  spec.start = *there;
+
+  *motionout = spec;
+
+  return GO_RESULT_OK;
+}
+
+static go_result
+go_motion_queue_append_world(go_motion_queue * queue,
+			     const go_motion_spec * motion,
+			     const go_cart * points,
+			     go_integer num)
+{
+  go_motion_spec spec;
+  go_quat quat;
+  go_result retval;
+
+  if (queue->number >= queue->size) {
+    return GO_RESULT_NO_SPACE;
+  }
+
+  if (GO_RESULT_OK != go_quat_inv(&queue->there.u.pose.rot, &quat)) {
+    /* 'there' should always be invertible; if not it wasn't initialized
+       to I, so do it here */
+    queue->there.u.pose.rot = go_quat_identity();
+  }
+
+  retval = go_motion_world_build(queue, &queue->there, motion, points, num, &spec);
+  if (GO_RESULT_OK != retval) return retval;
+
   queue->there = spec.end;
   *queue->end = spec;
+  if (spec.type == GO_MOTION_SPLINE) {
+    queue->points_number += spec.u.spar.num;
+  }
   queue->number++;
   queue->end++;
   if (queue->end >= queue->endptr) {
@@ -737,6 +1503,9 @@ go_motion_queue_append_world(go_motion_queue * queue,
   }
   queue->last_id = spec.id;
 
+  /* replan the queue with this motion on the end */
+  go_motion_queue_plan(queue);
+
   return GO_RESULT_OK;
 }
 
@@ -753,12 +1522,26 @@ go_motion_queue_append(go_motion_queue * queue,
   }
 
   if (queue->type == GO_MOTION_WORLD) {
-    return go_motion_queue_append_world(queue, motion);
+    return go_motion_queue_append_world(queue, motion, NULL, 0);
   }
 
   return GO_RESULT_ERROR;
 }
 
+go_result
+go_motion_queue_append_spline(go_motion_queue * queue,
+			      const go_motion_spec * motion,
+			      const go_cart * points,
+			      go_integer num)
+{
+  if (queue->type != GO_MOTION_WORLD ||
+      motion->type != GO_MOTION_SPLINE) {
+    return GO_RESULT_ERROR;
+  }
+
+  return go_motion_queue_append_world(queue, motion, points, num);
+}
+
 go_result go_motion_queue_number(const go_motion_queue * queue,
 				 go_integer * number)
 {
@@ -787,6 +1570,34 @@ go_result go_motion_queue_head(const go_motion_queue * queue,
   return GO_RESULT_OK;
 }
 
+go_result go_motion_queue_planned_time(const go_motion_queue * queue,
+				       go_real * left,
+				       go_real * total)
+{
+  go_motion_spec * ptr;
+  go_real time;
+  go_integer i;
+
+  /* each motion takes until the next one starts */
+  time = 0.0;
+  for (i = 0, ptr = queue->start; i < queue->number; i++) {
+    time += ptr->tnext;
+    ptr++;
+    if (ptr >= queue->endptr) {
+      ptr = queue->startptr;
+    }
+  }
+  if (queue->number > 0) {
+    time -= queue->time;
+    if (time < 0.0) time = 0.0;
+  }
+
+  if (NULL != left) *left = time;
+  if (NULL != total) *total = queue->donet + time;
+
+  return GO_RESULT_OK;
+}
+
 go_result 
 go_motion_queue_here(const go_motion_queue * queue, 
 		     go_position * position)
@@ -835,8 +1646,8 @@ static go_result
 go_motion_queue_interp_joint(go_motion_queue * queue, 
 			     go_real * joint)
 {
-  go_motion_spec spec;
-  go_traj_interp_spec tis;
+  const go_motion_spec * spec;
+  go_real d;
   go_integer i;
 
   if (0 == queue->number) {
@@ -846,20 +1657,21 @@ go_motion_queue_interp_joint(go_motion_queue * queue,
     return GO_RESULT_OK;
   }
 
-  spec = *queue->start;
+  spec = queue->start;
 
   for (i = 0; i < queue->joint_num; i++) {
-    go_traj_cj_interp(&spec.cj[i], queue->time, &tis);
-    if (spec.end.u.joint[i] > spec.start.u.joint[i]) {
-      joint[i] = queue->here.u.joint[i] = spec.start.u.joint[i] + tis.d; 
+    d = go_traj_poly_eval(&spec->poly[i], queue->time);
+    if (spec->end.u.joint[i] > spec->start.u.joint[i]) {
+      joint[i] = queue->here.u.joint[i] = spec->start.u.joint[i] + d; 
     } else {
-      joint[i] = queue->here.u.joint[i] = spec.start.u.joint[i] - tis.d; 
+      joint[i] = queue->here.u.joint[i] = spec->start.u.joint[i] - d; 
     }
   }
 
-  if (queue->time >= spec.totalt) {
+  if (queue->time >= spec->totalt) {
     /* we finished this move, so take it off the queue and set
        the time to zero as the basis for the next move */
+    queue->donet += spec->totalt;
     go_motion_queue_delete(queue);
     queue->time = 0.;
   }
@@ -867,55 +1679,106 @@ go_motion_queue_interp_joint(go_motion_queue * queue,
   return GO_RESULT_OK;
 }
 
+/*
+  Interpolates the translation of 'motion' at 'time' into 'tran'.
+*/
 static go_result
-go_motion_spec_interp_world(go_motion_spec * motion, go_real time, go_pose * pose)
+go_motion_spec_interp_tran(const go_motion_queue * queue, const go_motion_spec * motion, go_real time, go_cart * tran)
 {
-  go_traj_interp_spec tis;
-  go_traj_interp_spec ris;
-  go_cart cart;
-  go_quat quat;
+  const go_motion_circular_params * cpar;
+  const go_motion_spline_params * spar;
+  go_real w[4];
+  go_real u;
+  go_integer seg;
+  go_real d;
   go_real frac;
+  go_real th, c, s;
+  go_real r, z;
 
-  go_traj_cj_interp(&motion->cj[0], time, &tis);
-  go_traj_cj_interp(&motion->cj[1], time, &ris);
+  d = go_traj_poly_eval(&motion->poly[0], time);
 
   switch (motion->type) {
   case GO_MOTION_LINEAR:
-    go_cart_scale_mult(&motion->u.lpar.uvec, tis.d, &cart);
-    go_cart_cart_add(&motion->start.u.pose.tran, &cart, &pose->tran);
+    tran->x = motion->start.u.pose.tran.x + d * motion->u.lpar.uvec.x;
+    tran->y = motion->start.u.pose.tran.y + d * motion->u.lpar.uvec.y;
+    tran->z = motion->start.u.pose.tran.z + d * motion->u.lpar.uvec.z;
     break;
 
   case GO_MOTION_CIRCULAR:
-    if (motion->u.cpar.stotinv < 0) {
+    cpar = &motion->u.cpar;
+    if (cpar->stotinv < 0) {
       /* no translational motion around the circle, so we're there */
-      pose->tran = motion->end.u.pose.tran;
+      *tran = motion->end.u.pose.tran;
       break;
     }
-    pose->tran = motion->u.cpar.center;	/* start at center */
-    frac = tis.d * motion->u.cpar.stotinv; /* get fraction of move */
-    /* scale rotation around axis */
-    go_quat_scale_mult(&motion->u.cpar.qnormal, frac * motion->u.cpar.thtot, &quat);
-    /* grow the radial vector */
-    go_cart_scale_mult(&motion->u.cpar.urcsp, motion->u.cpar.rstart + frac * motion->u.cpar.rtot, &cart);
-    /* sweep the radial vector */
-    go_quat_cart_mult(&quat, &cart, &cart);
-    /* add it to our pose vector */
-    go_cart_cart_add(&pose->tran, &cart, &pose->tran);
+    frac = d * cpar->stotinv;	/* get fraction of move */
+    /* sweep the radial vector around the normal, and grow it */
+    th = frac * cpar->thtot;
+    r = cpar->rstart + frac * cpar->rtot;
+    go_sincos(th, &s, &c);
+    c *= r;
+    s *= r;
     /* grow the z vector */
-    go_cart_scale_mult(&motion->u.cpar.normal, frac * motion->u.cpar.ztot, &cart);
-    /* add it to the starting z */
-    go_cart_cart_add(&motion->u.cpar.zstart, &cart, &cart);
-    /* add this to the pose */
-    go_cart_cart_add(&pose->tran, &cart, &pose->tran);
+    z = frac * cpar->ztot;
+    /* add them to the center and the starting z */
+    tran->x = cpar->center.x + c * cpar->urcsp.x + s * cpar->vrcsp.x + cpar->zstart.x + z * cpar->normal.x;
+    tran->y = cpar->center.y + c * cpar->urcsp.y + s * cpar->vrcsp.y + cpar->zstart.y + z * cpar->normal.y;
+    tran->z = cpar->center.z + c * cpar->urcsp.z + s * cpar->vrcsp.z + cpar->zstart.z + z * cpar->normal.z;
+    break;
+
+  case GO_MOTION_SPLINE:
+    spar = &motion->u.spar;
+    if (spar->stot <= GO_REAL_EPSILON) {
+      *tran = motion->end.u.pose.tran;
+      break;
+    }
+    go_motion_spline_locate(queue, spar, d, &seg, &u);
+    go_motion_spline_weights(u, w, NULL, NULL);
+    go_motion_spline_sum(queue, spar->first, seg, w, tran);
     break;
 
   default:
     return GO_RESULT_ERROR;
   }
-  
-  /* rotation is handled the same way for either type */
-  go_quat_scale_mult(&motion->uquat, ris.d, &quat);
-  go_quat_quat_mult(&motion->start.u.pose.rot, &quat, &pose->rot);
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Interpolates the rotation of 'motion' at 'time', relative to its
+  start, into 'quat'. Rotation is handled the same way for either type.
+*/
+static void
+go_motion_spec_interp_rot(const go_motion_spec * motion, go_real time, go_quat * quat)
+{
+  go_real ha;			/* half angle */
+  go_real sh;			/* sine of half angle */
+
+  if (0.0 == motion->raxis.x &&
+      0.0 == motion->raxis.y &&
+      0.0 == motion->raxis.z) {
+    *quat = go_quat_identity();
+    return;
+  }
+
+  ha = 0.5 * go_traj_poly_eval(&motion->poly[1], time);
+  go_sincos(ha, &sh, &quat->s);
+  quat->x = sh * motion->raxis.x;
+  quat->y = sh * motion->raxis.y;
+  quat->z = sh * motion->raxis.z;
+}
+
+static go_result
+go_motion_spec_interp_world(const go_motion_queue * queue, const go_motion_spec * motion, go_real time, go_pose * pose)
+{
+  go_quat quat;
+  go_result retval;
+
+  retval = go_motion_spec_interp_tran(queue, motion, time, &pose->tran);
+  if (GO_RESULT_OK != retval) return retval;
+
+  go_motion_spec_interp_rot(motion, time, &quat);
+  pose->rot = go_quat_quat_mult_i(&motion->start.u.pose.rot, &quat);
 
   return GO_RESULT_OK;
 }
@@ -923,8 +1786,13 @@ go_motion_spec_interp_world(go_motion_spec * motion, go_real time, go_pose * pos
 static go_result 
 go_motion_queue_interp_world(go_motion_queue * queue, go_pose * pose)
 {
-  go_motion_spec motion;
+  const go_motion_spec * motion;
+  const go_motion_spec * next;
+  go_cart cart;
+  go_quat quat;
   go_real time;
+  go_real tnext;
+  go_flag flowing;
   go_result retval;
 
   if (0 == queue->number) {
@@ -932,16 +1800,39 @@ go_motion_queue_interp_world(go_motion_queue * queue, go_pose * pose)
     return GO_RESULT_OK;
   }
 
-  motion = *queue->start;
+  motion = queue->start;
   time = queue->time;
 
-  retval = go_motion_spec_interp_world(&motion, time, pose);
+  retval = go_motion_spec_interp_world(queue, motion, time, pose);
   if (GO_RESULT_OK != retval) return retval;
 
-  if (queue->time >= motion.totalt) {
+  if (queue->number > 1 && time > motion->tnext) {
+    /* we're blending, so add in the displacement of the next move */
+    next = queue->start + 1;
+    if (next >= queue->endptr) {
+      next = queue->startptr;
+    }
+    retval = go_motion_spec_interp_tran(queue, next, time - motion->tnext, &cart);
+    if (GO_RESULT_OK != retval) return retval;
+    cart = go_cart_cart_sub_i(&cart, &next->start.u.pose.tran);
+    pose->tran = go_cart_cart_add_i(&pose->tran, &cart);
+    go_motion_spec_interp_rot(next, time - motion->tnext, &quat);
+    pose->rot = go_quat_quat_mult_i(&pose->rot, &quat);
+  }
+
+  if (queue->time >= motion->totalt) {
     /* we finished this move */
+    tnext = motion->tnext;
+    flowing = (motion->tnext < motion->totalt ||
+	       (motion->planned && motion->cjv.v1 > 0.0));
+    queue->donet += tnext;
     go_motion_queue_delete(queue);
-    queue->time = 0.;
+    if (queue->number > 0 && flowing) {
+      /* we're already into the next move by this much */
+      queue->time -= tnext;
+    } else {
+      queue->time = 0.;
+    }
   }
 
   queue->here.u.pose = *pose;
@@ -979,10 +1870,12 @@ go_motion_queue_interp(go_motion_queue * queue, go_position * position)
 go_result go_motion_queue_stop(go_motion_queue * queue)
 {
   go_motion_spec * specptr;
+  go_traj_interp_spec tis;
   go_real now;			/* time to begin stopping motion */
   go_real endtime;		/* time motion is really done */
   go_integer i;
   go_flag neg;
+  go_flag keep;			/* non-zero means stop the next motion */
   go_result retval;
 
   /* don't need to stop an empty or stopping queue */
@@ -990,15 +1883,47 @@ go_result go_motion_queue_stop(go_motion_queue * queue)
     return GO_RESULT_OK;
   }
 
-  /* drop all pending motions from the queue */
-  (void) go_motion_queue_drop_pending(queue);
-
   /* point our attention at the current motion */
   specptr = queue->start;
 
   /* we want to stop now, the current queue time */
   now = queue->time;
 
+  keep = 0;
+  if (queue->number > 1) {
+    if (now > specptr->tnext) {
+      /* we're blending into the next motion, so let the current one
+	 finish and stop the next one instead, dropping the rest */
+      now -= specptr->tnext;
+      keep = 1;
+    } else if (specptr->planned && specptr->cjv.v1 > 0.0) {
+      /* we're flowing into the next motion, so if we can't stop
+	 before the end of this one, stop as soon as the next begins */
+      go_traj_cjv_interp(&specptr->cjv, now, &tis);
+      if (specptr->cjv.dtend - tis.d <
+	  go_traj_ramp_distance(tis.v, 0.0, specptr->cjv.a, specptr->cjv.j)) {
+	now = 0.0;
+	keep = 1;
+      }
+    }
+  }
+
+  if (keep) {
+    specptr++;
+    if (specptr >= queue->endptr) {
+      specptr = queue->startptr;
+    }
+    queue->end = specptr + 1;
+    if (queue->end >= queue->endptr) {
+      queue->end = queue->startptr;
+    }
+    queue->number = 2;
+    go_motion_queue_points_trim(queue);
+  } else {
+    /* drop all pending motions from the queue */
+    (void) go_motion_queue_drop_pending(queue);
+  }
+
   /* 'endtime' will the the revised stop time */
   endtime = 0.0;
 
@@ -1028,6 +1953,7 @@ go_result go_motion_queue_stop(go_motion_queue * queue)
       /* revise the queue's end position */
       queue->there.u.joint[i] = specptr->end.u.joint[i];
     }
+    go_motion_spec_compile(queue, specptr);
   } else if (queue->type == GO_MOTION_UJOINT) {
     for (i = 0; i < queue->joint_num; i++) {
       neg = specptr->end.u.joint[i] < specptr->start.u.joint[i] ? 1 : 0;
@@ -1040,6 +1966,15 @@ go_result go_motion_queue_stop(go_motion_queue * queue)
       maxit(specptr->cj[i].tend, endtime);
       queue->there.u.joint[i] = specptr->end.u.joint[i];
     }
+    go_motion_spec_compile(queue, specptr);
+  } else if (queue->type == GO_MOTION_WORLD && specptr->planned) {
+    /* planned motions have no rotation, so just stop the translation */
+    (void) go_traj_cjv_stop(&specptr->cjv, now, &specptr->cjv);
+    endtime = specptr->cjv.tend;
+    go_motion_spec_compile(queue, specptr);
+    retval = go_motion_spec_interp_world(queue, specptr, endtime, &specptr->end.u.pose);
+    if (GO_RESULT_OK != retval) return retval;
+    queue->there.u.pose = specptr->end.u.pose;
   } else if (queue->type == GO_MOTION_WORLD) {
     (void) go_traj_cj_stop(&specptr->cj[0], now, &specptr->cj[0]);
     maxit(specptr->cj[0].tend, endtime);
@@ -1049,9 +1984,10 @@ go_result go_motion_queue_stop(go_motion_queue * queue)
        rot to that time */
     (void) go_traj_cj_extend(&specptr->cj[0], endtime, &specptr->cj[0]);
     (void) go_traj_cj_extend(&specptr->cj[1], endtime, &specptr->cj[1]);
+    go_motion_spec_compile(queue, specptr);
     /* now the tran and rot are extended; now we need to recompute
        the new end translation and rotation */
-    retval = go_motion_spec_interp_world(specptr, endtime, &specptr->end.u.pose);
+    retval = go_motion_spec_interp_world(queue, specptr, endtime, &specptr->end.u.pose);
     if (GO_RESULT_OK != retval) return retval;
     /* else revise the queue's end position */
     queue->there.u.pose = specptr->end.u.pose;
@@ -1061,6 +1997,7 @@ go_result go_motion_queue_stop(go_motion_queue * queue)
   }
 
   specptr->totalt = endtime;
+  specptr->tnext = endtime;
 
   return GO_RESULT_OK;
 }
@@ -1088,6 +2025,16 @@ go_result go_motion_queue_delete(go_motion_queue * queue)
     return GO_RESULT_OK;
   }
 
+  if (queue->type == GO_MOTION_WORLD &&
+      queue->start->type == GO_MOTION_SPLINE) {
+    /* give its control points back to the pool */
+    queue->points_start += queue->start->u.spar.num;
+    if (queue->points_start >= queue->points_size) {
+      queue->points_start -= queue->points_size;
+    }
+    queue->points_number -= queue->start->u.spar.num;
+  }
+
   queue->start++;
   if (queue->start >= queue->endptr) {
     queue->start = queue->startptr;
@@ -1117,6 +2064,9 @@ go_result go_motion_queue_drop_pending(go_motion_queue * queue)
     queue->end = queue->startptr;
   }
   queue->number = 1;
+  go_motion_queue_points_trim(queue);
+  /* nothing left to blend into */
+  queue->start->tnext = queue->start->totalt;
 
   return GO_RESULT_OK;
 }
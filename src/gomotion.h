@@ -41,7 +41,8 @@ enum {
   /* these are used to further specify types of world motion */
   GO_MOTION_LINEAR,
   GO_MOTION_CIRCULAR,
-  GO_MOTION_WRAPPED /* where rotation is considered a wrapped linear axis */
+  GO_MOTION_WRAPPED, /* where rotation is considered a wrapped linear axis */
+  GO_MOTION_SPLINE
 };
 
 /*
@@ -90,6 +91,9 @@ typedef struct {
   /*! The unit vector from center to start, projected onto the normal plane. */
   go_cart urcsp;
 
+  /*! The unit vector a quarter turn ahead of 'urcsp', normal x urcsp. */
+  go_cart vrcsp;
+
   /*! The starting radius. */
   go_real rstart;
 
@@ -114,8 +118,40 @@ typedef struct {
   go_integer turns;
 } go_motion_circular_params;
 
+/*
+  Spline moves follow a uniform cubic B-spline from the start through
+  the end, shaped by the control points between them. The control
+  points are kept in the queue's point pool rather than in the spec,
+  since there can be many of them. The start and end points are put
+  between points reflected through them so that the curve passes
+  through them, so a spline with 'n' control points of its own takes
+  'n' + 4 entries in the pool and has 'n' + 1 segments.
+
+  The arc length is tabulated on append at GO_MOTION_SPLINE_DIVS points
+  along each segment, so that the length along the curve from the
+  trajectory planner can be turned into the spline parameter with a
+  search and a linear interpolation.
+*/
+
+#define GO_MOTION_SPLINE_DIVS 8
+
 typedef struct {
-  go_flag type;			/* ALL: GO_MOTION_JOINT,LINEAR,CIRCULAR */
+  go_cart point;		/*< control point */
+  /*! The arc length from the start of the spline to the segment
+    beginning at this point, at each of the divisions of the segment. */
+  go_real s[GO_MOTION_SPLINE_DIVS];
+} go_motion_spline_point;
+
+typedef struct {
+  go_integer first;		/* (SPL) index in the pool of the first point */
+  go_integer num;		/* (SPL) number of points in the pool */
+  go_real stot;			/* (SPL) total arc length */
+  go_cart ustart;		/* (SPL) unit tangent at the start */
+  go_cart uend;			/* (SPL) unit tangent at the end */
+} go_motion_spline_params;
+
+typedef struct {
+  go_flag type;			/* ALL: GO_MOTION_JOINT,LINEAR,CIRCULAR,SPLINE */
   go_integer id;		/* ALL: id echoed as current move */
   go_real totalt;		/* (ALL) total planned time for the motion */
   go_position start;		/* (ALL)  start pose wrt world; prev end */
@@ -128,10 +164,30 @@ typedef struct {
   union {
     go_motion_linear_params lpar;	/* (LIN) linear params */
     go_motion_circular_params cpar;	/* CIR: some circular params */
+    go_motion_spline_params spar;	/* (SPL) spline params */
   } u;
   /* (ALL) times for the various tran phases of CV, CA and CJ profiles */
   /* For world motion [0] is for tran, [1] is for rot, rest unused */
   go_traj_cj_spec cj[GO_MOTION_JOINT_NUM];
+  /* Blending of world moves. If 'tol' is positive, the tail of this
+     motion may be overlapped with the head of the previous one so long
+     as the path stays within 'tol' of the corner; if zero, the motion
+     comes to an exact stop; if negative, the queue's tolerance is used. */
+  go_real tol;			/* ALL: path blending tolerance */
+  go_real tnext;		/* (ALL) time into this motion when next begins */
+  go_real tprev;		/* (ALL) time into this motion when prev ends */
+  /* Look-ahead planning of world moves. If 'planned' is set, translation
+     follows 'cjv' instead of cj[0], starting and ending at the speeds
+     chosen for the junctions with the neighboring motions. */
+  go_flag planned;		/* (ALL) non-zero if translation follows 'cjv' */
+  go_real vjmax;		/* (ALL) highest speed allowed at the end */
+  go_traj_cjv_spec cjv;		/* (ALL) planned translation profile */
+  /* Compiled profiles, evaluated each cycle. For joint moves each
+     pertains to the indexed joint. For world moves [0] is the tran
+     profile, from 'cjv' if planned, [1] is the rot profile, and the
+     rest are unused. They're recompiled whenever the profiles change. */
+  go_traj_poly_spec poly[GO_MOTION_JOINT_NUM];
+  go_cart raxis;		/* (ALL) unit axis of 'uquat', zero if none */
 } go_motion_spec;
 
 extern go_result go_motion_spec_init(go_motion_spec * spec);
@@ -149,6 +205,7 @@ extern go_result go_motion_spec_set_cpar(go_motion_spec * spec, go_cart * center
 extern go_result go_motion_spec_set_time(go_motion_spec * spec, go_real time);
 extern go_result go_motion_spec_set_end_position(go_motion_spec * spec, go_position * end);
 extern go_result go_motion_spec_set_end_pose(go_motion_spec * spec, go_pose * end);
+extern go_result go_motion_spec_set_tol(go_motion_spec * spec, go_real tol);
 
 typedef struct {
   go_traj_ca_spec scale_spec;
@@ -186,7 +243,13 @@ typedef struct {
   go_integer last_id;		/*< id of last motion appended */
   go_real deltat;		/*< cycle time */
   go_real time;			/*< time into the current spec */
+  go_real tol;			/*< default path blending tolerance */
+  go_real donet;		/*< planned time of the finished motions */
   go_scale_spec timescale;	/*< walked-in time scale factor */
+  go_motion_spline_point *points; /*< pool of spline control points */
+  go_integer points_size;	/*< size of the pool */
+  go_integer points_start;	/*< index of the first point in use */
+  go_integer points_number;	/*< number of points in use */
 } go_motion_queue;
 
 extern go_result go_motion_queue_init(go_motion_queue * queue,
@@ -196,6 +259,14 @@ extern go_result go_motion_queue_init(go_motion_queue * queue,
 
 extern go_result go_motion_queue_reset(go_motion_queue * queue);
 
+/*!
+  Gives the queue the space for the control points of spline moves,
+  \a size of them. Without it, spline moves can't be appended.
+*/
+extern go_result go_motion_queue_set_points(go_motion_queue * queue,
+					    go_motion_spline_point * space,
+					    go_integer size);
+
 extern go_result go_motion_queue_set_type(go_motion_queue * queue,
 					  go_flag type);
 
@@ -217,9 +288,23 @@ extern go_result go_motion_queue_set_scale(go_motion_queue * queue,
 					   go_real scale_v,
 					   go_real scale_a);
 
+extern go_result go_motion_queue_set_tol(go_motion_queue * queue,
+					 go_real tol);
+
 extern go_result go_motion_queue_append(go_motion_queue * queue,
 					const go_motion_spec * motion);
 
+/*!
+  Appends the spline move \a motion, whose curve runs from the end of
+  the queue to the end of \a motion, shaped by the \a num control
+  points \a points in between. Returns GO_RESULT_NO_SPACE if either
+  the queue or its point pool is full.
+*/
+extern go_result go_motion_queue_append_spline(go_motion_queue * queue,
+					       const go_motion_spec * motion,
+					       const go_cart * points,
+					       go_integer num);
+
 extern go_result go_motion_queue_number(const go_motion_queue * queue,
 					go_integer * number);
 
@@ -229,6 +314,16 @@ extern go_result go_motion_queue_size(const go_motion_queue * queue,
 extern go_result go_motion_queue_head(const go_motion_queue * queue,
 				      go_motion_spec * motion);
 
+/*
+  go_motion_queue_planned_time() returns in 'left' the planned time to
+  finish the motions on the queue, and in 'total' this plus the planned
+  time of all the motions finished since the queue was initialized,
+  without any time scaling.
+*/
+extern go_result go_motion_queue_planned_time(const go_motion_queue * queue,
+					      go_real * left,
+					      go_real * total);
+
 extern go_result go_motion_queue_here(const go_motion_queue * queue,
 				      go_position * position);
 
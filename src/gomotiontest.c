@@ -1,6 +1,230 @@
 #include <stdio.h>
+#include <string.h>		/* strcmp */
+#include <time.h>		/* clock */
 #include "go.h"
 
+/*
+  The benchmark runs a queue of joint, linear or circular moves through
+  go_motion_queue_interp(), and compares this with how interpolation
+  used to be done each cycle, from a copy of the motion spec using the
+  phase-by-phase profiles and quaternion scaling, which is reproduced
+  here as the "before" case. It prints the ns per cycle for each, and
+  the largest difference in position between them.
+*/
+
+enum { BENCH_QUEUE_SIZE = 100, BENCH_REPS = 20 };
+static go_motion_spec bench_space[BENCH_QUEUE_SIZE];
+static go_motion_spec bench_copy[BENCH_QUEUE_SIZE];
+
+static void before_interp_joint(const go_motion_spec * specptr, go_integer joint_num, go_real time, go_real * joint)
+{
+  go_motion_spec spec;
+  go_traj_interp_spec tis;
+  go_integer i;
+
+  spec = *specptr;
+
+  for (i = 0; i < joint_num; i++) {
+    go_traj_cj_interp(&spec.cj[i], time, &tis);
+    if (spec.end.u.joint[i] > spec.start.u.joint[i]) {
+      joint[i] = spec.start.u.joint[i] + tis.d;
+    } else {
+      joint[i] = spec.start.u.joint[i] - tis.d;
+    }
+  }
+}
+
+static void before_interp_world(const go_motion_spec * specptr, go_real time, go_pose * pose)
+{
+  go_motion_spec motion;
+  go_traj_interp_spec tis;
+  go_traj_interp_spec ris;
+  go_cart cart;
+  go_quat quat;
+  go_real frac;
+
+  motion = *specptr;
+
+  if (motion.planned) {
+    go_traj_cjv_interp(&motion.cjv, time, &tis);
+  } else {
+    go_traj_cj_interp(&motion.cj[0], time, &tis);
+  }
+  go_traj_cj_interp(&motion.cj[1], time, &ris);
+
+  if (GO_MOTION_LINEAR == motion.type) {
+    go_cart_scale_mult(&motion.u.lpar.uvec, tis.d, &cart);
+    go_cart_cart_add(&motion.start.u.pose.tran, &cart, &pose->tran);
+  } else {
+    pose->tran = motion.u.cpar.center;
+    frac = tis.d * motion.u.cpar.stotinv;
+    go_quat_scale_mult(&motion.u.cpar.qnormal, frac * motion.u.cpar.thtot, &quat);
+    go_cart_scale_mult(&motion.u.cpar.urcsp, motion.u.cpar.rstart + frac * motion.u.cpar.rtot, &cart);
+    go_quat_cart_mult(&quat, &cart, &cart);
+    go_cart_cart_add(&pose->tran, &cart, &pose->tran);
+    go_cart_scale_mult(&motion.u.cpar.normal, frac * motion.u.cpar.ztot, &cart);
+    go_cart_cart_add(&motion.u.cpar.zstart, &cart, &cart);
+    go_cart_cart_add(&pose->tran, &cart, &pose->tran);
+  }
+
+  go_quat_scale_mult(&motion.uquat, ris.d, &quat);
+  go_quat_quat_mult(&motion.start.u.pose.rot, &quat, &pose->rot);
+}
+
+static go_real position_diff(go_flag type, go_integer joint_num, const go_position * p1, const go_position * p2)
+{
+  go_real diff, d;
+  go_integer i;
+
+  diff = 0.0;
+  if (GO_MOTION_JOINT == type) {
+    for (i = 0; i < joint_num; i++) {
+      d = fabs(p1->u.joint[i] - p2->u.joint[i]);
+      if (d > diff) diff = d;
+    }
+  } else {
+    (void) go_cart_cart_disp(&p1->u.pose.tran, &p2->u.pose.tran, &diff);
+    d = fabs(p1->u.pose.rot.s - p2->u.pose.rot.s);
+    if (d > diff) diff = d;
+  }
+
+  return diff;
+}
+
+/* fills the queue with moves of 'type', returning how many */
+static go_integer bench_fill(go_motion_queue * gmq, go_flag type, go_integer joint_num)
+{
+  go_motion_spec gms;
+  go_position position;
+  go_cart center, normal;
+  go_integer i, j;
+
+  go_motion_spec_init(&gms);
+  go_motion_spec_set_id(&gms, 1);
+  go_motion_spec_set_tol(&gms, 0.0);
+
+  if (GO_MOTION_JOINT == type) {
+    go_motion_queue_set_type(gmq, GO_MOTION_JOINT);
+    go_motion_queue_set_joint_number(gmq, joint_num);
+    go_motion_spec_set_type(&gms, GO_MOTION_JOINT);
+    for (i = 0; i < joint_num; i++) {
+      go_motion_spec_set_jpar(&gms, i, 1, 10, 100);
+      position.u.joint[i] = 0.0;
+    }
+    go_motion_queue_set_here(gmq, &position);
+  } else {
+    go_motion_queue_set_type(gmq, GO_MOTION_WORLD);
+    go_motion_spec_set_type(&gms, type);
+    go_motion_spec_set_tpar(&gms, 1, 10, 100);
+    go_motion_spec_set_rpar(&gms, 1, 10, 100);
+    position.u.pose = go_pose_this(1, 0, 0, 1, 0, 0, 0);
+    go_motion_queue_set_here(gmq, &position);
+    center.x = center.y = center.z = 0.0;
+    normal.x = normal.y = 0.0, normal.z = 1.0;
+    go_motion_spec_set_cpar(&gms, &center, &normal, 0);
+  }
+
+  for (i = 0; i < BENCH_QUEUE_SIZE; i++) {
+    if (GO_MOTION_JOINT == type) {
+      for (j = 0; j < joint_num; j++) {
+	position.u.joint[j] = (i & 1 ? 0.1 : -0.1) * (j + 1);
+      }
+    } else {
+      /* go around a unit circle in 8 steps, turning and rising a bit */
+      position.u.pose = go_pose_this(cos(GO_PI_4 * (i + 1)),
+				     sin(GO_PI_4 * (i + 1)),
+				     0.01 * (i & 1),
+				     cos(0.05 * (i & 1)), 0, 0,
+				     sin(0.05 * (i & 1)));
+    }
+    go_motion_spec_set_end_position(&gms, &position);
+    if (GO_RESULT_OK != go_motion_queue_append(gmq, &gms)) break;
+  }
+
+  return i;
+}
+
+static int bench(go_flag type, char * name)
+{
+  enum { JOINT_NUM = 6 };
+  go_real deltat = 0.001;
+  go_motion_queue gmq;
+  go_position position, before;
+  go_integer n, i, cycles;
+  go_integer rep;
+  go_real time, diff, maxdiff;
+  clock_t start;
+  double tafter, tbefore;
+
+  if (GO_RESULT_OK != go_motion_queue_init(&gmq, bench_space, BENCH_QUEUE_SIZE, deltat)) {
+    return 1;
+  }
+
+  /* after: the queue as it interpolates now */
+  tafter = 0.0;
+  cycles = 0;
+  for (rep = 0; rep < BENCH_REPS; rep++) {
+    (void) go_motion_queue_reset(&gmq);
+    n = bench_fill(&gmq, type, JOINT_NUM);
+    for (i = 0; i < n; i++) bench_copy[i] = bench_space[i];
+    start = clock();
+    while (! go_motion_queue_is_empty(&gmq)) {
+      go_motion_queue_interp(&gmq, &position);
+      cycles++;
+    }
+    tafter += (double) (clock() - start) / CLOCKS_PER_SEC;
+  }
+
+  /* before: a copy of the spec and its profiles evaluated each cycle,
+     at the same times the queue would have */
+  tbefore = 0.0;
+  for (rep = 0; rep < BENCH_REPS; rep++) {
+    start = clock();
+    for (i = 0; i < n; i++) {
+      time = 0.0;
+      do {
+	time += deltat;
+	if (GO_MOTION_JOINT == type) {
+	  before_interp_joint(&bench_copy[i], JOINT_NUM, time, before.u.joint);
+	} else {
+	  before_interp_world(&bench_copy[i], time, &before.u.pose);
+	}
+      } while (time < bench_copy[i].totalt);
+    }
+    tbefore += (double) (clock() - start) / CLOCKS_PER_SEC;
+  }
+
+  /* and check that they agree */
+  (void) go_motion_queue_reset(&gmq);
+  n = bench_fill(&gmq, type, JOINT_NUM);
+  for (i = 0; i < n; i++) bench_copy[i] = bench_space[i];
+  maxdiff = 0.0;
+  for (i = 0; i < n; i++) {
+    time = 0.0;
+    do {
+      time += deltat;
+      go_motion_queue_interp(&gmq, &position);
+      if (GO_MOTION_JOINT == type) {
+	before_interp_joint(&bench_copy[i], JOINT_NUM, time, before.u.joint);
+      } else {
+	before_interp_world(&bench_copy[i], time, &before.u.pose);
+      }
+      /* the queue starts into the next move on the cycle that passes
+	 the end of this one, so compare only up to the end */
+      if (time <= bench_copy[i].totalt) {
+	diff = position_diff(type, JOINT_NUM, &position, &before);
+	if (diff > maxdiff) maxdiff = diff;
+      }
+    } while (time < bench_copy[i].totalt);
+  }
+
+  printf("%-8s %d moves, %d cycles: before %.1f ns/cycle, after %.1f ns/cycle, max diff %g\n",
+	 name, (int) n, (int) (cycles / BENCH_REPS),
+	 1.0e9 * tbefore / cycles, 1.0e9 * tafter / cycles, (double) maxdiff);
+
+  return 0;
+}
+
 int main(int argc, char *argv[])
 {
   enum { QUEUE_SIZE = 1 };	/* < 3 tests for good length handling */
@@ -17,7 +241,14 @@ int main(int argc, char *argv[])
 
   time = 0.0;
 
-  if (argc == 1) {
+  if (argc > 1 && 0 == strcmp(argv[1], "-b")) {
+    /* "-b" means run the interpolation benchmark */
+    if (0 != bench(GO_MOTION_JOINT, "joint") ||
+	0 != bench(GO_MOTION_LINEAR, "linear") ||
+	0 != bench(GO_MOTION_CIRCULAR, "circular")) {
+      return 1;
+    }
+  } else if (argc == 1) {
     /* no arg means do world motion */
     if (GO_RESULT_OK != go_motion_queue_set_type(&gmq, GO_MOTION_WORLD)) {
       return 1;
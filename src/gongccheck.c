@@ -0,0 +1,1142 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file gongccheck.c
+
+  \brief Checks that the robot in an .ini file can run a whole NC
+  program, without running it.
+
+  Syntax: gongccheck -i <ini file> {-k <kinematics>} {-c <cycle time>} {-t <threads>} <program>
+
+  The program is read by the interpreter and the Go canonical
+  interface, as Task does, and its moves planned on a motion queue as
+  Traj does, every 'cycle time', which is [TRAJ] CYCLE_TIME if not
+  given. Each cycle's pose is checked for being within the [TRAJ]
+  limits, for having an inverse kinematics solution, and for that
+  being within the joint limits. The timeline is cut into chunks that
+  'threads' threads check at once, one per processor if not given.
+
+  What's printed is the first failure and the line it came from, how
+  many cycles failed each way, the joint that came closest to its
+  limit, and the planned time of the whole program. The exit value
+  is 0 if nothing failed, else 1.
+
+  The time goes with the number of cycles more than lines. On one
+  thread, a 100,000-line program of short G1 moves, 300,000 cycles of
+  0.08 seconds, checks in about 4 seconds with genserkins. With
+  trivkins one as long, 1.3 million cycles, checks in 0.3 seconds.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>		/* malloc */
+#include <string.h>		/* strncpy */
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>		/* sysconf */
+#endif
+#include <inifile.h>
+#include <ulapi.h>
+#include "go.h"
+#include "gokin.h"
+#include "taskintf.h"		/* TASK_EXEC_DELAY_TYPE */
+#include "trajintf.h"		/* traj_cmd_move_world */
+#include "trajplan.h"		/* traj_plan_move_world */
+#include "rs274ngc.h"
+#include "rs274ngc_return.h"
+#include "interplist.h"
+#include "canon_go.h"		/* canon_go_flush, canon_go_reset */
+
+/*
+  The interp list the Go canonical interface writes, and its merging
+  tolerance, as Task has them.
+*/
+interplist_struct task_interplist;
+double canon_compress_tol = 0.0;
+
+enum {MAX_JOINT_NUM = 8};
+enum {MAX_THREAD_NUM = 64};
+enum {INTERP_LIST_SIZE = 1000};
+enum {DEFAULT_QUEUE_SIZE = 100}; /* as gorun's, for [TRAJ] QUEUE_SIZE */
+enum {DEFAULT_SPLINE_POINTS = 1000}; /* and [TRAJ] SPLINE_POINTS */
+enum {CHUNK_SAMPLES = 2048};
+enum {SEED_STRIDE = 16};	/* samples between seeds */
+
+#define CHECK_MUTEX_KEY 1102
+
+/*
+  How far a chunk's seed may be from where the chunk before left its
+  joints and still be the same solution. Iterative kinematics only
+  converge so closely, so this is looser than their tolerance, but
+  much less than the distance between solutions.
+*/
+#define STITCH_TOL 1.0e-2
+
+static struct {
+  double m_per_length_units;
+  double rad_per_angle_units;
+  char kin_name[GO_KIN_NAME_LEN];
+  go_real cycle_time;
+  go_pose home;
+  go_pose min_limit;
+  go_pose max_limit;
+  go_pose tool_transform;
+  go_pose tool_transform_inv;
+  go_real max_tvel, max_tacc, max_tjerk;
+  go_real max_rvel, max_racc, max_rjerk;
+  go_real blend_tol;
+  go_integer queue_size;
+  go_integer spline_points;
+  char parameter_file_name[INIFILE_MAX_LINELEN];
+  char tool_file_name[INIFILE_MAX_LINELEN];
+  go_integer joint_num;
+  go_link links[MAX_JOINT_NUM];
+  go_real jhome[MAX_JOINT_NUM];
+  go_real jmin[MAX_JOINT_NUM];
+  go_real jmax[MAX_JOINT_NUM];
+} check_set;
+
+static int
+ini_load(char * inifile_name)
+{
+  FILE * fp;
+  const char * inistring;
+  char servo_string[32];
+  int link;
+  int i1;
+  double d1, d2, d3, d4, d5, d6, d7, d8, d9;
+  go_rpy rpy;
+  go_cart cart;
+  go_link * link_params = check_set.links;
+
+  if (NULL == (fp = fopen(inifile_name, "r"))) return 1;
+
+#define CLOSE_AND_RETURN(ret)			\
+  fclose(fp);					\
+  return (ret)
+
+  check_set.m_per_length_units = 1;
+  inistring = ini_find(fp, "LENGTH_UNITS_PER_M", "GOMOTION");
+  if (NULL != inistring) {
+    if (1 != sscanf(inistring, "%lf", &d1) || d1 <= 0.0) {
+      fprintf(stderr, "bad entry: [GOMOTION] LENGTH_UNITS_PER_M = %s\n", inistring);
+      CLOSE_AND_RETURN(1);
+    }
+    check_set.m_per_length_units = 1.0 / d1;
+  }
+
+  check_set.rad_per_angle_units = 1;
+  inistring = ini_find(fp, "ANGLE_UNITS_PER_RAD", "GOMOTION");
+  if (NULL != inistring) {
+    if (1 != sscanf(inistring, "%lf", &d1) || d1 <= 0.0) {
+      fprintf(stderr, "bad entry: [GOMOTION] ANGLE_UNITS_PER_RAD = %s\n", inistring);
+      CLOSE_AND_RETURN(1);
+    }
+    check_set.rad_per_angle_units = 1.0 / d1;
+  }
+
+#define TGL(x) (go_real) ((x) * check_set.m_per_length_units)
+#define TGA(x) (go_real) ((x) * check_set.rad_per_angle_units)
+#define TGQ(x) (GO_QUANTITY_ANGLE == link_params[link].quantity ? TGA(x) : TGL(x))
+#define TGP(pose) \
+  (pose).tran.x = TGL(d1), (pose).tran.y = TGL(d2), (pose).tran.z = TGL(d3), \
+  rpy.r = TGA(d4), rpy.p = TGA(d5), rpy.y = TGA(d6), \
+  go_rpy_quat_convert(&rpy, &(pose).rot)
+
+  if (0 == check_set.kin_name[0]) {
+    inistring = ini_find(fp, "KINEMATICS", "TRAJ");
+    if (NULL == inistring) {
+      fprintf(stderr, "[TRAJ] KINEMATICS not found\n");
+      CLOSE_AND_RETURN(1);
+    }
+    strncpy(check_set.kin_name, inistring, GO_KIN_NAME_LEN);
+    check_set.kin_name[GO_KIN_NAME_LEN - 1] = 0;
+  }
+
+  if (check_set.cycle_time <= 0) {
+    inistring = ini_find(fp, "CYCLE_TIME", "TRAJ");
+    if (NULL == inistring || 1 != sscanf(inistring, "%lf", &d1) || d1 <= 0) {
+      fprintf(stderr, "bad or missing entry: [TRAJ] CYCLE_TIME\n");
+      CLOSE_AND_RETURN(1);
+    }
+    check_set.cycle_time = d1;
+  }
+
+  inistring = ini_find(fp, "HOME", "TRAJ");
+  if (NULL == inistring ||
+      6 != sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+    fprintf(stderr, "bad or missing entry: [TRAJ] HOME\n");
+    CLOSE_AND_RETURN(1);
+  }
+  TGP(check_set.home);
+
+  inistring = ini_find(fp, "MIN_LIMIT", "TRAJ");
+  if (NULL == inistring ||
+      6 != sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+    fprintf(stderr, "bad or missing entry: [TRAJ] MIN_LIMIT\n");
+    CLOSE_AND_RETURN(1);
+  }
+  TGP(check_set.min_limit);
+
+  inistring = ini_find(fp, "MAX_LIMIT", "TRAJ");
+  if (NULL == inistring ||
+      6 != sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+    fprintf(stderr, "bad or missing entry: [TRAJ] MAX_LIMIT\n");
+    CLOSE_AND_RETURN(1);
+  }
+  TGP(check_set.max_limit);
+
+  check_set.tool_transform = go_pose_identity();
+  inistring = ini_find(fp, "TOOL_TRANSFORM", "TRAJ");
+  if (NULL != inistring) {
+    if (6 != sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+      fprintf(stderr, "bad entry: [TRAJ] TOOL_TRANSFORM = %s\n", inistring);
+      CLOSE_AND_RETURN(1);
+    }
+    TGP(check_set.tool_transform);
+  }
+  go_pose_inv(&check_set.tool_transform, &check_set.tool_transform_inv);
+
+  /* these default as Traj's do */
+#define GET_PROFILE(key, var, conv)					\
+  var = 1;								\
+  inistring = ini_find(fp, key, "TRAJ");				\
+  if (NULL != inistring) {						\
+    if (1 != sscanf(inistring, "%lf", &d1) || d1 <= 0) {		\
+      fprintf(stderr, "bad entry: [TRAJ] %s = %s\n", key, inistring);	\
+      CLOSE_AND_RETURN(1);						\
+    }									\
+    var = conv(d1);							\
+  }
+  GET_PROFILE("MAX_TVEL", check_set.max_tvel, TGL);
+  GET_PROFILE("MAX_TACC", check_set.max_tacc, TGL);
+  GET_PROFILE("MAX_TJERK", check_set.max_tjerk, TGL);
+  GET_PROFILE("MAX_RVEL", check_set.max_rvel, TGA);
+  GET_PROFILE("MAX_RACC", check_set.max_racc, TGA);
+  GET_PROFILE("MAX_RJERK", check_set.max_rjerk, TGA);
+#undef GET_PROFILE
+
+  check_set.queue_size = DEFAULT_QUEUE_SIZE;
+  inistring = ini_find(fp, "QUEUE_SIZE", "TRAJ");
+  if (NULL != inistring) {
+    if (1 != sscanf(inistring, "%i", &i1) || i1 < 2) {
+      fprintf(stderr, "bad entry: [TRAJ] QUEUE_SIZE = %s\n", inistring);
+      CLOSE_AND_RETURN(1);
+    }
+    check_set.queue_size = i1;
+  }
+
+  check_set.spline_points = DEFAULT_SPLINE_POINTS;
+  inistring = ini_find(fp, "SPLINE_POINTS", "TRAJ");
+  if (NULL != inistring) {
+    if (1 != sscanf(inistring, "%i", &i1) || i1 < 0) {
+      fprintf(stderr, "bad entry: [TRAJ] SPLINE_POINTS = %s\n", inistring);
+      CLOSE_AND_RETURN(1);
+    }
+    check_set.spline_points = i1;
+  }
+
+  check_set.blend_tol = 0;
+  inistring = ini_find(fp, "BLEND_TOL", "TRAJ");
+  if (NULL != inistring) {
+    if (1 != sscanf(inistring, "%lf", &d1) || d1 < 0) {
+      fprintf(stderr, "bad entry: [TRAJ] BLEND_TOL = %s\n", inistring);
+      CLOSE_AND_RETURN(1);
+    }
+    check_set.blend_tol = TGL(d1);
+  }
+
+  inistring = ini_find(fp, "COMPRESS_TOL", "TASK");
+  if (NULL != inistring) {
+    if (1 != sscanf(inistring, "%lf", &d1) || d1 < 0) {
+      fprintf(stderr, "bad entry: [TASK] COMPRESS_TOL = %s\n", inistring);
+      CLOSE_AND_RETURN(1);
+    }
+    canon_compress_tol = d1 * check_set.m_per_length_units;
+  }
+
+  check_set.parameter_file_name[0] = 0;
+  inistring = ini_find(fp, "PARAMETER_FILE_NAME", "TASK");
+  if (NULL != inistring) {
+    strncpy(check_set.parameter_file_name, inistring, sizeof(check_set.parameter_file_name));
+    check_set.parameter_file_name[sizeof(check_set.parameter_file_name) - 1] = 0;
+  }
+
+  check_set.tool_file_name[0] = 0;
+  inistring = ini_find(fp, "TOOL_FILE_NAME", "TASK");
+  if (NULL != inistring) {
+    strncpy(check_set.tool_file_name, inistring, sizeof(check_set.tool_file_name));
+    check_set.tool_file_name[sizeof(check_set.tool_file_name) - 1] = 0;
+  }
+
+  for (link = 0; link < MAX_JOINT_NUM; link++) {
+    sprintf(servo_string, "SERVO_%d", link + 1);
+
+    inistring = ini_find(fp, "QUANTITY", servo_string);
+    if (NULL == inistring) {
+      /* no "QUANTITY" in this section, or no section, so we're done */
+      break;
+    } else if (ini_match(inistring, "ANGLE")) {
+      link_params[link].quantity = GO_QUANTITY_ANGLE;
+    } else if (ini_match(inistring, "LENGTH")) {
+      link_params[link].quantity = GO_QUANTITY_LENGTH;
+    } else {
+      fprintf(stderr, "bad entry: [%s] QUANTITY = %s\n", servo_string, inistring);
+      CLOSE_AND_RETURN(1);
+    }
+
+    go_body_init(&link_params[link].body);
+
+    inistring = ini_find(fp, "MASS", servo_string);
+    if (NULL != inistring) {
+      if (1 == sscanf(inistring, "%lf", &d1)) {
+	link_params[link].body.mass = d1;
+      } else {
+	fprintf(stderr, "bad entry: [%s] MASS = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    }
+
+    inistring = ini_find(fp, "INERTIA", servo_string);
+    if (NULL != inistring) {
+      if (9 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6, &d7, &d8, &d9)) {
+	link_params[link].body.inertia[0][0] = TGL(TGL(d1));
+	link_params[link].body.inertia[0][1] = TGL(TGL(d2));
+	link_params[link].body.inertia[0][2] = TGL(TGL(d3));
+	link_params[link].body.inertia[1][0] = TGL(TGL(d4));
+	link_params[link].body.inertia[1][1] = TGL(TGL(d5));
+	link_params[link].body.inertia[1][2] = TGL(TGL(d6));
+	link_params[link].body.inertia[2][0] = TGL(TGL(d7));
+	link_params[link].body.inertia[2][1] = TGL(TGL(d8));
+	link_params[link].body.inertia[2][2] = TGL(TGL(d9));
+      } else {
+	fprintf(stderr, "bad entry: [%s] INERTIA = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    }
+
+    inistring = ini_find(fp, "HOME", servo_string);
+    if (NULL == inistring || 1 != sscanf(inistring, "%lf", &d1)) {
+      fprintf(stderr, "bad or missing entry: [%s] HOME\n", servo_string);
+      CLOSE_AND_RETURN(1);
+    }
+    check_set.jhome[link] = TGQ(d1);
+
+    /* limits that aren't a range mean the joint isn't limited */
+    check_set.jmin[link] = check_set.jmax[link] = 0;
+    inistring = ini_find(fp, "MIN_LIMIT", servo_string);
+    if (NULL != inistring && 1 == sscanf(inistring, "%lf", &d1)) {
+      check_set.jmin[link] = TGQ(d1);
+    }
+    inistring = ini_find(fp, "MAX_LIMIT", servo_string);
+    if (NULL != inistring && 1 == sscanf(inistring, "%lf", &d1)) {
+      check_set.jmax[link] = TGQ(d1);
+    }
+
+    if (NULL != (inistring = ini_find(fp, "DH_PARAMETERS", servo_string))) {
+      if (4 == sscanf(inistring, "%lf %lf %lf %lf", &d1, &d2, &d3, &d4)) {
+	link_params[link].u.dh.a = TGL(d1);
+	link_params[link].u.dh.alpha = TGA(d2);
+	link_params[link].u.dh.d = TGL(d3);
+	link_params[link].u.dh.theta = TGA(d4);
+	link_params[link].type = GO_LINK_DH;
+      } else {
+	fprintf(stderr, "bad entry: [%s] DH = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "PP_PARAMETERS", servo_string))) {
+      if (6 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+	TGP(link_params[link].u.pp.pose);
+	link_params[link].type = GO_LINK_PP;
+      } else {
+	fprintf(stderr, "bad entry: [%s] PP = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "URDF_PARAMETERS", servo_string))) {
+      if (9 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6, &d7, &d8, &d9)) {
+	TGP(link_params[link].u.urdf.pose);
+	cart.x = TGL(d7);
+	cart.y = TGL(d8);
+	cart.z = TGL(d9);
+	if (GO_RESULT_OK != go_cart_unit(&cart, &cart)) {
+	  fprintf(stderr, "bad entry: [%s] URDF = %s\n", servo_string, inistring);
+	  CLOSE_AND_RETURN(1);
+	}
+	link_params[link].u.urdf.axis = cart;
+	link_params[link].type = GO_LINK_URDF;
+      } else {
+	fprintf(stderr, "bad entry: [%s] URDF = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "PK_PARAMETERS", servo_string))) {
+      if (6 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+	link_params[link].u.pk.base.x = TGL(d1);
+	link_params[link].u.pk.base.y = TGL(d2);
+	link_params[link].u.pk.base.z = TGL(d3);
+	link_params[link].u.pk.platform.x = TGL(d4);
+	link_params[link].u.pk.platform.y = TGL(d5);
+	link_params[link].u.pk.platform.z = TGL(d6);
+	link_params[link].type = GO_LINK_PK;
+      } else {
+	fprintf(stderr, "bad entry: [%s] PK = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else {
+      /* no "DH,PP,URDF,PK_PARAMETERS" in this section, so we're done */
+      break;
+    }
+  } /* for (link) */
+  check_set.joint_num = link;
+
+#undef TGL
+#undef TGA
+#undef TGQ
+#undef TGP
+
+  CLOSE_AND_RETURN(0);
+}
+
+/*
+  What's checked each cycle, and what went wrong with the program
+  before it got to the cycles.
+*/
+enum {
+  CHECK_INVERT = 0,		/* no inverse kinematics solution */
+  CHECK_JOINT_LIMIT,		/* a joint past its limit */
+  CHECK_WORLD_LIMIT,		/* the pose outside the [TRAJ] limits */
+  CHECK_CLAMP,			/* a move's end clamped to the limits */
+  CHECK_APPEND,			/* a move couldn't be queued */
+  CHECK_INTERP,			/* the queue couldn't be interpolated */
+  CHECK_PROGRAM,		/* the interpreter stopped with an error */
+  CHECK_KINDS
+};
+
+static const char * check_what[CHECK_KINDS] = {
+  "can't invert",
+  "past a joint limit",
+  "outside the world limits",
+  "move end clamped to the world limits",
+  "can't queue move",
+  "can't interpolate",
+  "program error"
+};
+
+typedef struct {
+  go_integer count[CHECK_KINDS];
+  go_flag failed;		/* non-zero if 'first' is set */
+  struct {
+    go_integer kind;
+    go_integer id;
+    go_integer joint;		/* for CHECK_JOINT_LIMIT */
+    go_real time;
+  } first;
+  go_flag near;			/* non-zero if 'worst' is set */
+  struct {
+    go_real fraction;		/* margin over half the joint's range */
+    go_real margin;
+    go_integer joint;
+    go_integer id;
+    go_real time;
+  } worst;
+} check_result;
+
+static void check_result_init(check_result * r)
+{
+  go_integer t;
+
+  for (t = 0; t < CHECK_KINDS; t++) r->count[t] = 0;
+  r->failed = 0;
+  r->near = 0;
+}
+
+static void check_result_add(check_result * r, go_integer kind, go_integer id, go_integer joint, go_real time)
+{
+  r->count[kind]++;
+  if (! r->failed) {
+    r->failed = 1;
+    r->first.kind = kind;
+    r->first.id = id;
+    r->first.joint = joint;
+    r->first.time = time;
+  }
+}
+
+/* merges 'later' into 'r', which has what came before it */
+static void check_result_merge(check_result * r, const check_result * later)
+{
+  go_integer t;
+
+  for (t = 0; t < CHECK_KINDS; t++) r->count[t] += later->count[t];
+  if (later->failed && (! r->failed || later->first.time < r->first.time)) {
+    r->failed = 1;
+    r->first = later->first;
+  }
+  if (later->near && (! r->near || later->worst.fraction < r->worst.fraction)) {
+    r->near = 1;
+    r->worst = later->worst;
+  }
+}
+
+typedef struct {
+  go_pose ecp;
+  go_real time;
+  go_integer id;
+} check_sample;
+
+enum {CHUNK_FREE = 0, CHUNK_FILLED, CHUNK_WORKING, CHUNK_DONE};
+
+typedef struct {
+  go_flag state;
+  go_integer number;		/* where in the timeline it is */
+  go_integer num;		/* how many samples */
+  check_sample samples[CHUNK_SAMPLES];
+  go_real seed[MAX_JOINT_NUM];	/* the joints to start from */
+  go_real last[MAX_JOINT_NUM];	/* where they ended */
+  check_result result;
+} check_chunk;
+
+/* puts revolute joints within a half turn of 'last', as Traj does */
+static void shift_joints(go_real * joints, const go_real * last)
+{
+  go_integer t;
+
+  for (t = 0; t < check_set.joint_num; t++) {
+    if (GO_QUANTITY_ANGLE != check_set.links[t].quantity) continue;
+    while (joints[t] - last[t] >= GO_PI) joints[t] -= GO_2_PI;
+    while (joints[t] - last[t] <= -GO_PI) joints[t] += GO_2_PI;
+  }
+}
+
+/*
+  Solves the inverse kinematics for 'ecp' seeded with 'joints', and
+  if it can, leaves the solution there shifted to be near them.
+*/
+static go_result check_inv(void * kins, const go_pose * ecp, go_real * joints)
+{
+  go_real j[MAX_JOINT_NUM];
+  go_pose kcp;
+  go_integer t;
+
+  go_pose_pose_mult(ecp, &check_set.tool_transform_inv, &kcp);
+  for (t = 0; t < check_set.joint_num; t++) j[t] = joints[t];
+  if (GO_RESULT_OK != go_kin_inv(kins, &kcp, j)) return GO_RESULT_ERROR;
+  shift_joints(j, joints);
+  for (t = 0; t < check_set.joint_num; t++) joints[t] = j[t];
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Checks each sample in the chunk, starting from its seed. Each
+  sample's solution seeds the next, as each cycle's does in Traj.
+*/
+static void check_chunk_run(void * kins, check_chunk * chunk)
+{
+  check_result * r = &chunk->result;
+  const check_sample * s;
+  go_real joints[MAX_JOINT_NUM];
+  go_real margin, fraction;
+  go_integer n, t;
+
+  check_result_init(r);
+  for (t = 0; t < check_set.joint_num; t++) joints[t] = chunk->seed[t];
+
+  for (n = 0; n < chunk->num; n++) {
+    s = &chunk->samples[n];
+
+    if (s->ecp.tran.x < check_set.min_limit.tran.x ||
+	s->ecp.tran.y < check_set.min_limit.tran.y ||
+	s->ecp.tran.z < check_set.min_limit.tran.z ||
+	s->ecp.tran.x > check_set.max_limit.tran.x ||
+	s->ecp.tran.y > check_set.max_limit.tran.y ||
+	s->ecp.tran.z > check_set.max_limit.tran.z) {
+      check_result_add(r, CHECK_WORLD_LIMIT, s->id, 0, s->time);
+    }
+
+    /* on failure the joints stay where they were, as Traj's do */
+    if (GO_RESULT_OK != check_inv(kins, &s->ecp, joints)) {
+      check_result_add(r, CHECK_INVERT, s->id, 0, s->time);
+      continue;
+    }
+
+    for (t = 0; t < check_set.joint_num; t++) {
+      if (check_set.jmax[t] <= check_set.jmin[t]) continue;
+      margin = joints[t] - check_set.jmin[t];
+      if (check_set.jmax[t] - joints[t] < margin) margin = check_set.jmax[t] - joints[t];
+      if (margin < 0) check_result_add(r, CHECK_JOINT_LIMIT, s->id, t, s->time);
+      fraction = margin / (0.5 * (check_set.jmax[t] - check_set.jmin[t]));
+      if (! r->near || fraction < r->worst.fraction) {
+	r->near = 1;
+	r->worst.fraction = fraction;
+	r->worst.margin = margin;
+	r->worst.joint = t;
+	r->worst.id = s->id;
+	r->worst.time = s->time;
+      }
+    }
+  }
+
+  for (t = 0; t < check_set.joint_num; t++) chunk->last[t] = joints[t];
+}
+
+/* what the threads share, under the mutex */
+typedef struct {
+  void * mutex;
+  check_chunk * ring;
+  go_integer ring_num;
+  go_flag quit;			/* set when there's no more to do */
+  go_integer done;		/* threads that have quit */
+  go_integer bad;		/* threads that couldn't set up */
+} check_args;
+
+static void * check_kins_new(void)
+{
+  void * kins;
+
+  kins = malloc(go_kin_size());
+  if (NULL == kins) return NULL;
+  if (GO_RESULT_OK != go_kin_init(kins) ||
+      GO_RESULT_OK != go_kin_set_parameters(kins, check_set.links, check_set.joint_num)) {
+    free(kins);
+    return NULL;
+  }
+
+  return kins;
+}
+
+/*
+  Each thread takes the earliest filled chunk, checks it and marks it
+  done, until told to quit.
+*/
+static void check_code(void * arg)
+{
+  check_args * args = (check_args *) arg;
+  check_chunk * chunk;
+  void * kins;
+  go_integer t;
+  go_flag quit;
+
+  kins = check_kins_new();
+
+  for (;;) {
+    chunk = NULL;
+    ulapi_mutex_take(args->mutex);
+    quit = args->quit || NULL == kins;
+    for (t = 0; t < args->ring_num; t++) {
+      if (CHUNK_FILLED == args->ring[t].state &&
+	  (NULL == chunk || args->ring[t].number < chunk->number)) {
+	chunk = &args->ring[t];
+      }
+    }
+    if (NULL != chunk && ! quit) chunk->state = CHUNK_WORKING;
+    ulapi_mutex_give(args->mutex);
+
+    if (quit) break;
+    if (NULL == chunk) {
+      ulapi_sleep(0.0005);
+      continue;
+    }
+
+    check_chunk_run(kins, chunk);
+
+    ulapi_mutex_take(args->mutex);
+    chunk->state = CHUNK_DONE;
+    ulapi_mutex_give(args->mutex);
+  }
+
+  if (NULL != kins) free(kins);
+
+  ulapi_mutex_take(args->mutex);
+  if (NULL == kins) args->bad++;
+  args->done++;
+  ulapi_mutex_give(args->mutex);
+
+  return;
+}
+
+/*
+  The main thread plans the program and fills chunks of the timeline.
+  As it does, it solves every SEED_STRIDE'th pose from the one before,
+  and seeds each chunk with the solution for its first pose, so chunks
+  can be checked at once rather than each waiting for the one before
+  to end. When a chunk is
+  done it's stitched to the one before: its first pose is solved again
+  from where that one ended, and if that lands on a different solution
+  than its seed, the chunk is checked again from there.
+*/
+static struct {
+  check_args args;
+  go_integer thread_num;
+  void * kins;			/* the main thread's */
+  go_integer filled;		/* how many chunks have been filled */
+  go_integer stitched;		/* how many have been stitched */
+  check_chunk * fill;		/* the one being filled, if any */
+  go_real seed[MAX_JOINT_NUM];	/* the last seed */
+  go_real last[MAX_JOINT_NUM];	/* where the last stitched one ended */
+  check_result result;
+  go_integer restitched;	/* how many were checked again */
+  go_integer samples;
+} check_main;
+
+static go_flag check_state(check_chunk * chunk, go_flag state)
+{
+  go_flag is;
+
+  ulapi_mutex_take(check_main.args.mutex);
+  is = (chunk->state == state);
+  ulapi_mutex_give(check_main.args.mutex);
+
+  return is;
+}
+
+static void check_state_set(check_chunk * chunk, go_flag state)
+{
+  ulapi_mutex_take(check_main.args.mutex);
+  chunk->state = state;
+  ulapi_mutex_give(check_main.args.mutex);
+}
+
+static void chunk_stitch(check_chunk * chunk)
+{
+  go_real joints[MAX_JOINT_NUM];
+  go_integer t;
+
+  while (! check_state(chunk, CHUNK_DONE)) ulapi_sleep(0.0005);
+
+  if (chunk->number > 0) {
+    for (t = 0; t < check_set.joint_num; t++) joints[t] = check_main.last[t];
+    if (GO_RESULT_OK == check_inv(check_main.kins, &chunk->samples[0].ecp, joints)) {
+      for (t = 0; t < check_set.joint_num; t++) {
+	if (joints[t] - chunk->seed[t] > STITCH_TOL ||
+	    joints[t] - chunk->seed[t] < -STITCH_TOL) break;
+      }
+      if (t < check_set.joint_num) {
+	for (t = 0; t < check_set.joint_num; t++) chunk->seed[t] = check_main.last[t];
+	check_chunk_run(check_main.kins, chunk);
+	check_main.restitched++;
+      }
+    }
+  }
+
+  check_result_merge(&check_main.result, &chunk->result);
+  for (t = 0; t < check_set.joint_num; t++) check_main.last[t] = chunk->last[t];
+  check_main.stitched++;
+  check_state_set(chunk, CHUNK_FREE);
+}
+
+static void chunk_submit(check_chunk * chunk)
+{
+  if (check_main.thread_num > 0) {
+    check_state_set(chunk, CHUNK_FILLED);
+  } else {
+    check_chunk_run(check_main.kins, chunk);
+    chunk->state = CHUNK_DONE;
+  }
+  check_main.filled++;
+}
+
+static void check_sample_put(const go_pose * ecp, go_real time, go_integer id)
+{
+  check_chunk * chunk;
+  go_integer t;
+
+  if (NULL == check_main.fill) {
+    /* the next chunk goes where the one a ring ago was */
+    chunk = &check_main.args.ring[check_main.filled % check_main.args.ring_num];
+    while (check_main.stitched <= check_main.filled - check_main.args.ring_num) {
+      chunk_stitch(&check_main.args.ring[check_main.stitched % check_main.args.ring_num]);
+    }
+    chunk->number = check_main.filled;
+    chunk->num = 0;
+    check_main.fill = chunk;
+  }
+
+  chunk = check_main.fill;
+  chunk->samples[chunk->num].ecp = *ecp;
+  chunk->samples[chunk->num].time = time;
+  chunk->samples[chunk->num].id = id;
+  check_main.samples++;
+
+  /*
+    The seeds follow the timeline every so often, so they stay on the
+    solution the joints would be on. If one fails the seed stays the
+    last one, and the failure is found again when the chunk is checked.
+  */
+  if (0 == chunk->num % SEED_STRIDE) {
+    (void) check_inv(check_main.kins, ecp, check_main.seed);
+    if (0 == chunk->num) {
+      for (t = 0; t < check_set.joint_num; t++) chunk->seed[t] = check_main.seed[t];
+    }
+  }
+
+  if (++chunk->num == CHUNK_SAMPLES) {
+    chunk_submit(chunk);
+    check_main.fill = NULL;
+  }
+}
+
+static void check_sample_flush(void)
+{
+  if (NULL != check_main.fill) {
+    chunk_submit(check_main.fill);
+    check_main.fill = NULL;
+  }
+  while (check_main.stitched < check_main.filled) {
+    chunk_stitch(&check_main.args.ring[check_main.stitched % check_main.args.ring_num]);
+  }
+}
+
+/* the motion queue, as Traj runs it, sized as gomain sizes Traj's */
+static go_motion_queue plan_queue;
+static go_motion_spec * plan_space = NULL;
+static go_motion_spline_point * plan_points = NULL;
+/* what Traj plans moves with, from the ini file */
+static traj_set_struct plan_set;
+static go_real plan_time = 0;
+static go_integer plan_id = 0;
+static go_flag plan_failed = 0;
+
+/* runs the queue for one cycle, checking where it goes */
+static void plan_step(void)
+{
+  go_motion_spec head;
+  go_position ecp;
+
+  if (GO_RESULT_OK == go_motion_queue_head(&plan_queue, &head)) {
+    plan_id = go_motion_spec_get_id(&head);
+  }
+  if (GO_RESULT_OK != go_motion_queue_interp(&plan_queue, &ecp)) {
+    check_result_add(&check_main.result, CHECK_INTERP, plan_id, 0, plan_time);
+    plan_failed = 1;
+    return;
+  }
+  plan_time += check_set.cycle_time;
+  check_sample_put(&ecp.u.pose, plan_time, plan_id);
+}
+
+static go_flag plan_has_room(void)
+{
+  go_integer size, number;
+
+  go_motion_queue_size(&plan_queue, &size);
+  go_motion_queue_number(&plan_queue, &number);
+
+  return size > number;
+}
+
+/*
+  Appends the move as Task and Traj would, with the accel and jerk
+  Task fills in and Traj's own planning.
+*/
+static void plan_move(const traj_cmd_move_world * move)
+{
+  traj_cmd_move_world task_move;
+  go_motion_spec gms;
+
+  while (! plan_has_room() && ! plan_failed) plan_step();
+  if (plan_failed) return;
+
+  task_move = *move;
+  task_move.ta = plan_set.max_tacc;
+  task_move.tj = plan_set.max_tjerk;
+  task_move.ra = plan_set.max_racc;
+  task_move.rj = plan_set.max_rjerk;
+  if (traj_plan_move_world(&task_move, &plan_set, &gms)) {
+    check_result_add(&check_main.result, CHECK_CLAMP, move->id, 0, plan_time);
+  }
+
+  if (GO_RESULT_OK != go_motion_queue_append(&plan_queue, &gms)) {
+    check_result_add(&check_main.result, CHECK_APPEND, move->id, 0, plan_time);
+    plan_failed = 1;
+  }
+}
+
+static void plan_drain(void)
+{
+  while (! go_motion_queue_is_empty(&plan_queue) && ! plan_failed) plan_step();
+}
+
+/*
+  Takes what the interpreter put on the interp list. Moves are queued
+  as soon as there's room, as Task does with read-ahead, so the queue
+  blends them as it would. A dwell lets the queue run for that long
+  before more moves are queued, and a wait for motion lets it empty.
+*/
+static void plan_interplist(void)
+{
+  interplist_type val;
+  go_real left;
+
+  while (-1 != interplist_get(&task_interplist, &val) && ! plan_failed) {
+    switch (val.type) {
+    case TRAJ_CMD_MOVE_WORLD_TYPE:
+      plan_move(&val.u.move_world);
+      break;
+    case TASK_EXEC_DELAY_TYPE:
+      for (left = val.u.delay.time;
+	   left > 0 && ! go_motion_queue_is_empty(&plan_queue) && ! plan_failed;
+	   left -= check_set.cycle_time) plan_step();
+      /* standing still needs no checking */
+      if (left > 0) plan_time += left;
+      break;
+    case TASK_EXEC_WAIT_FOR_MOTION_TYPE:
+      plan_drain();
+      break;
+    default:
+      /* tool commands don't move the robot */
+      break;
+    }
+  }
+}
+
+static int processor_num(void)
+{
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n > 0) return n > MAX_THREAD_NUM ? MAX_THREAD_NUM : (int) n;
+#endif
+  return 1;
+}
+
+static double to_units(go_integer joint, go_real value)
+{
+  return GO_QUANTITY_ANGLE == check_set.links[joint].quantity ?
+    value / check_set.rad_per_angle_units : value / check_set.m_per_length_units;
+}
+
+int main(int argc, char *argv[])
+{
+  enum { BUFFERLEN = 256 };
+  int option;
+  char inifile_name[BUFFERLEN] = "gomotion.ini";
+  char * program;
+  int thread_num = 0;
+  double d1;
+  go_position position;
+  void * tasks[MAX_THREAD_NUM];
+  check_result * r;
+  ulapi_real start;
+  go_integer t;
+  int retval;
+
+  opterr = 0;
+  while (1) {
+    option = ulapi_getopt(argc, argv, ":i:k:c:t:");
+    if (option == -1)
+      break;
+
+    switch (option) {
+    case 'i':
+      strncpy(inifile_name, ulapi_optarg, BUFFERLEN);
+      inifile_name[BUFFERLEN - 1] = 0;
+      break;
+
+    case 'k':
+      strncpy(check_set.kin_name, ulapi_optarg, GO_KIN_NAME_LEN);
+      check_set.kin_name[GO_KIN_NAME_LEN - 1] = 0;
+      break;
+
+    case 'c':
+      if (1 != sscanf(ulapi_optarg, "%lf", &d1) || d1 <= 0) {
+	fprintf(stderr, "bad value for cycle time: %s\n", ulapi_optarg);
+	return 1;
+      }
+      check_set.cycle_time = d1;
+      break;
+
+    case 't':
+      if (1 != sscanf(ulapi_optarg, "%i", &thread_num) || thread_num < 1 || thread_num > MAX_THREAD_NUM) {
+	fprintf(stderr, "bad value for threads: %s\n", ulapi_optarg);
+	return 1;
+      }
+      break;
+
+    case ':':
+      fprintf(stderr, "missing value for -%c\n", ulapi_optopt);
+      return 1;
+      break;
+
+    default:			/* '?' */
+      fprintf (stderr, "unrecognized option -%c\n", ulapi_optopt);
+      return 1;
+      break;
+    }
+  }
+  if (ulapi_optind != argc - 1) {
+    fprintf(stderr, "need one program to check\n");
+    return 1;
+  }
+  program = argv[ulapi_optind];
+
+  if (0 != go_init()) {
+    fprintf(stderr, "can't init go\n");
+    return 1;
+  }
+
+  if (ULAPI_OK != ulapi_init()) {
+    fprintf(stderr, "can't init ulapi\n");
+    return 1;
+  }
+
+  if (0 != ini_load(inifile_name)) {
+    fprintf(stderr, "can't load ini file %s\n", inifile_name);
+    return 1;
+  }
+
+  if (GO_RESULT_OK != go_kin_select(check_set.kin_name)) {
+    fprintf(stderr, "can't select kinematics %s\n", check_set.kin_name);
+    return 1;
+  }
+  if (NULL == (check_main.kins = check_kins_new())) {
+    fprintf(stderr, "can't set up kinematics %s\n", check_set.kin_name);
+    return 1;
+  }
+
+  plan_space = (go_motion_spec *) malloc(check_set.queue_size * sizeof(go_motion_spec));
+  if (check_set.spline_points > 0) {
+    plan_points = (go_motion_spline_point *) malloc(check_set.spline_points * sizeof(go_motion_spline_point));
+  }
+  if (NULL == plan_space ||
+      (check_set.spline_points > 0 && NULL == plan_points)) {
+    fprintf(stderr, "can't allocate motion queue of %d moves\n", (int) check_set.queue_size);
+    return 1;
+  }
+  if (GO_RESULT_OK != go_motion_queue_init(&plan_queue, plan_space, check_set.queue_size, check_set.cycle_time) ||
+      GO_RESULT_OK != go_motion_queue_set_points(&plan_queue, plan_points, check_set.spline_points) ||
+      GO_RESULT_OK != go_motion_queue_set_type(&plan_queue, GO_MOTION_WORLD)) {
+    fprintf(stderr, "can't init motion queue\n");
+    return 1;
+  }
+  position.u.pose = check_set.home;
+  go_motion_queue_set_here(&plan_queue, &position);
+  plan_set.min_limit = check_set.min_limit;
+  plan_set.max_limit = check_set.max_limit;
+  plan_set.blend_tol = check_set.blend_tol;
+  plan_set.max_tvel = check_set.max_tvel;
+  plan_set.max_tacc = check_set.max_tacc;
+  plan_set.max_tjerk = check_set.max_tjerk;
+  plan_set.max_rvel = check_set.max_rvel;
+  plan_set.max_racc = check_set.max_racc;
+  plan_set.max_rjerk = check_set.max_rjerk;
+
+  /* the main thread checks too if it's the only one */
+  if (0 == thread_num) thread_num = processor_num();
+  check_main.thread_num = (thread_num > 1 ? thread_num : 0);
+  check_main.args.ring_num = 4 * thread_num;
+  check_main.args.ring = (check_chunk *) malloc(check_main.args.ring_num * sizeof(check_chunk));
+  check_main.args.mutex = ulapi_mutex_new(CHECK_MUTEX_KEY);
+  if (NULL == check_main.args.ring || NULL == check_main.args.mutex) {
+    fprintf(stderr, "can't allocate %d chunks\n", (int) check_main.args.ring_num);
+    return 1;
+  }
+  for (t = 0; t < check_main.args.ring_num; t++) check_main.args.ring[t].state = CHUNK_FREE;
+  check_main.args.quit = 0;
+  check_main.args.done = 0;
+  check_main.args.bad = 0;
+  for (t = 0; t < check_set.joint_num; t++) check_main.seed[t] = check_set.jhome[t];
+  check_result_init(&check_main.result);
+
+  for (t = 0; t < check_main.thread_num; t++) {
+    tasks[t] = ulapi_task_new();
+    if (NULL == tasks[t] ||
+	ULAPI_OK != ulapi_task_start(tasks[t], check_code, &check_main.args, ulapi_prio_lowest(), 0)) {
+      fprintf(stderr, "can't start thread %d\n", (int) t + 1);
+      return 1;
+    }
+  }
+
+  if (0 != interplist_init(&task_interplist, INTERP_LIST_SIZE)) {
+    fprintf(stderr, "can't allocate interp list of %d entries\n", INTERP_LIST_SIZE);
+    return 1;
+  }
+  if (0 != check_set.parameter_file_name[0] &&
+      RS274NGC_OK != rs274ngc_c_restore_parameters(check_set.parameter_file_name)) {
+    fprintf(stderr, "can't restore parameter file %s\n", check_set.parameter_file_name);
+  }
+  if (0 != check_set.tool_file_name[0] &&
+      RS274NGC_OK != rs274ngc_c_restore_tool_table(check_set.tool_file_name)) {
+    fprintf(stderr, "can't load tool table file %s\n", check_set.tool_file_name);
+  }
+  if (RS274NGC_OK != rs274ngc_c_init()) {
+    fprintf(stderr, "can't initialize NC code interpreter\n");
+    return 1;
+  }
+  canon_go_reset();
+  if (RS274NGC_OK != rs274ngc_c_open(program)) {
+    fprintf(stderr, "can't open program %s\n", program);
+    return 1;
+  }
+
+  start = ulapi_time();
+
+  do {
+    retval = rs274ngc_c_read();
+    if (RS274NGC_OK == retval) retval = rs274ngc_c_execute(NULL);
+    /* once the program stops, nothing more will end a run of feeds */
+    if (RS274NGC_OK != retval) canon_go_flush();
+    plan_interplist();
+  } while (RS274NGC_OK == retval && ! plan_failed);
+  if (! plan_failed) plan_drain();
+
+  if (RS274NGC_OK != retval &&
+      RS274NGC_ENDFILE != retval &&
+      RS274NGC_EXECUTE_FINISH != retval &&
+      RS274NGC_EXIT != retval) {
+    check_result_add(&check_main.result, CHECK_PROGRAM, rs274ngc_c_sequence_number(), 0, plan_time);
+  }
+  rs274ngc_c_close();
+
+  check_sample_flush();
+
+  ulapi_mutex_take(check_main.args.mutex);
+  check_main.args.quit = 1;
+  ulapi_mutex_give(check_main.args.mutex);
+  for (;;) {
+    ulapi_mutex_take(check_main.args.mutex);
+    t = (check_main.args.done >= check_main.thread_num);
+    ulapi_mutex_give(check_main.args.mutex);
+    if (t) break;
+    ulapi_sleep(0.001);
+  }
+
+  r = &check_main.result;
+
+  printf("%s: %d lines, planned time %f seconds, %d cycles of %f seconds\n",
+	 program, (int) rs274ngc_c_sequence_number(), (double) plan_time,
+	 (int) check_main.samples, (double) check_set.cycle_time);
+  printf("checked in %f seconds with %d threads, %d chunks, %d checked again\n",
+	 (double) (ulapi_time() - start), thread_num,
+	 (int) check_main.filled, (int) check_main.restitched);
+
+  if (r->failed) {
+    printf("first failure: line %d at %f seconds: %s",
+	   (int) r->first.id, (double) r->first.time, check_what[r->first.kind]);
+    if (CHECK_JOINT_LIMIT == r->first.kind) printf(", joint %d", (int) r->first.joint + 1);
+    if (CHECK_PROGRAM == r->first.kind) printf(", %s", rs274ngc_c_error(retval));
+    printf("\n");
+    for (t = 0; t < CHECK_KINDS; t++) {
+      if (r->count[t] > 0) printf("%s: %d\n", check_what[t], (int) r->count[t]);
+    }
+  } else {
+    printf("no failures\n");
+  }
+
+  if (r->near) {
+    printf("closest to a limit: joint %d, %f from it, %f of half its range, line %d at %f seconds\n",
+	   (int) r->worst.joint + 1, to_units(r->worst.joint, r->worst.margin),
+	   (double) r->worst.fraction, (int) r->worst.id, (double) r->worst.time);
+  }
+
+  return r->failed ? 1 : 0;
+}
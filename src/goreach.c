@@ -0,0 +1,266 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file goreach.c
+
+  \brief Workspace map files and lookups. See goreach.h.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>		/* FILE, fopen */
+#include <stdlib.h>		/* malloc, free */
+#include <string.h>		/* memset */
+#include <math.h>		/* fabs, floor */
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/types.h>
+#include <sys/stat.h>		/* fstat */
+#include <sys/mman.h>		/* mmap */
+#include <fcntl.h>		/* open */
+#include <unistd.h>		/* close */
+#endif
+#include "gotypes.h"
+#include "gomath.h"
+#include "goreach.h"
+
+static size_t reach_size(const go_reach_header * header)
+{
+  return sizeof(go_reach_header) +
+    (size_t) header->norient * 4 * sizeof(double) +
+    (size_t) header->nx * header->ny * header->nz * header->norient * sizeof(go_reach_cell);
+}
+
+static void reach_point(go_reach_map * map)
+{
+  map->header = (go_reach_header *) map->base;
+  map->orient = (double *) (map->header + 1);
+  map->cells = (go_reach_cell *) (map->orient + 4 * map->header->norient);
+}
+
+go_result go_reach_alloc(go_reach_map * map, const go_reach_header * header)
+{
+  if (header->nx < 1 || header->ny < 1 || header->nz < 1 ||
+      header->norient < 1 || header->spacing <= 0) return GO_RESULT_BAD_ARGS;
+
+  map->size = reach_size(header);
+  map->base = malloc(map->size);
+  if (NULL == map->base) return GO_RESULT_NO_SPACE;
+  memset(map->base, 0, map->size);
+  map->mapped = 0;
+  /* the header has the sizes the rest is laid out by */
+  *((go_reach_header *) map->base) = *header;
+  reach_point(map);
+  map->header->magic = GO_REACH_MAGIC;
+  map->header->version = GO_REACH_VERSION;
+
+  return GO_RESULT_OK;
+}
+
+go_result go_reach_write(const go_reach_map * map, const char * path)
+{
+  FILE * fp;
+  size_t n;
+
+  if (NULL == (fp = fopen(path, "wb"))) return GO_RESULT_ERROR;
+  n = fwrite(map->base, 1, map->size, fp);
+  if (0 != fclose(fp) || n != map->size) return GO_RESULT_ERROR;
+
+  return GO_RESULT_OK;
+}
+
+go_result go_reach_open(go_reach_map * map, const char * path)
+{
+  go_reach_header header;
+  FILE * fp;
+  size_t n;
+
+  /* check the header first */
+  if (NULL == (fp = fopen(path, "rb"))) return GO_RESULT_ERROR;
+  n = fread(&header, sizeof(header), 1, fp);
+  if (1 != n ||
+      GO_REACH_MAGIC != header.magic ||
+      GO_REACH_VERSION != header.version ||
+      header.nx < 1 || header.ny < 1 || header.nz < 1 ||
+      header.norient < 1 || header.spacing <= 0) {
+    fclose(fp);
+    return GO_RESULT_ERROR;
+  }
+  map->size = reach_size(&header);
+
+#ifdef HAVE_SYS_MMAN_H
+  {
+    struct stat st;
+    int fd;
+
+    fclose(fp);
+    if (-1 == (fd = open(path, O_RDONLY))) return GO_RESULT_ERROR;
+    if (0 != fstat(fd, &st) || (size_t) st.st_size < map->size) {
+      close(fd);
+      return GO_RESULT_ERROR;
+    }
+    map->base = mmap(NULL, map->size, PROT_READ, MAP_SHARED, fd, 0);
+    /* the mapping stays after the file is closed */
+    close(fd);
+    if (MAP_FAILED == map->base) return GO_RESULT_ERROR;
+    map->mapped = 1;
+  }
+#else
+  map->base = malloc(map->size);
+  if (NULL == map->base) {
+    fclose(fp);
+    return GO_RESULT_NO_SPACE;
+  }
+  rewind(fp);
+  n = fread(map->base, 1, map->size, fp);
+  fclose(fp);
+  if (n != map->size) {
+    free(map->base);
+    return GO_RESULT_ERROR;
+  }
+  map->mapped = 0;
+#endif
+
+  reach_point(map);
+
+  return GO_RESULT_OK;
+}
+
+go_result go_reach_close(go_reach_map * map)
+{
+  if (NULL == map->base) return GO_RESULT_OK;
+
+#ifdef HAVE_SYS_MMAN_H
+  if (map->mapped) {
+    munmap(map->base, map->size);
+  } else {
+    free(map->base);
+  }
+#else
+  free(map->base);
+#endif
+  map->base = NULL;
+  map->header = NULL;
+  map->orient = NULL;
+  map->cells = NULL;
+
+  return GO_RESULT_OK;
+}
+
+go_result go_reach_cell_pose(const go_reach_map * map, go_integer i, go_integer j, go_integer k, go_integer o, go_pose * pose)
+{
+  const go_reach_header * h = map->header;
+
+  if (i < 0 || i >= h->nx ||
+      j < 0 || j >= h->ny ||
+      k < 0 || k >= h->nz ||
+      o < 0 || o >= h->norient) return GO_RESULT_RANGE_ERROR;
+
+  pose->tran.x = (go_real) (h->min[0] + i * h->spacing);
+  pose->tran.y = (go_real) (h->min[1] + j * h->spacing);
+  pose->tran.z = (go_real) (h->min[2] + k * h->spacing);
+  pose->rot.s = (go_real) map->orient[4 * o];
+  pose->rot.x = (go_real) map->orient[4 * o + 1];
+  pose->rot.y = (go_real) map->orient[4 * o + 2];
+  pose->rot.z = (go_real) map->orient[4 * o + 3];
+
+  return GO_RESULT_OK;
+}
+
+void go_reach_cell_encode(go_reach_cell * cell, const go_reach_value * value)
+{
+  go_real x;
+
+  cell->reach = (unsigned char) value->reach;
+  x = value->margin < 0 ? 0 : value->margin > 1 ? 1 : value->margin;
+  cell->margin = (unsigned char) floor(x * GO_REACH_MARGIN_MAX + 0.5);
+  x = value->dex < 0 ? 0 : value->dex > 1 ? 1 : value->dex;
+  cell->dex = (unsigned short) floor(x * GO_REACH_DEX_MAX + 0.5);
+}
+
+void go_reach_cell_decode(const go_reach_cell * cell, go_reach_value * value)
+{
+  value->reach = cell->reach;
+  value->margin = (go_real) cell->margin / GO_REACH_MARGIN_MAX;
+  value->dex = (go_real) cell->dex / GO_REACH_DEX_MAX;
+}
+
+/* the orientation nearest 'quat', whichever sign either has */
+static go_integer reach_orient(const go_reach_map * map, const go_quat * quat)
+{
+  const double * q;
+  go_real dot, best = -1;
+  go_integer o, besto = 0;
+
+  for (o = 0; o < map->header->norient; o++) {
+    q = &map->orient[4 * o];
+    dot = fabs(q[0] * quat->s + q[1] * quat->x + q[2] * quat->y + q[3] * quat->z);
+    if (dot > best) best = dot, besto = o;
+  }
+
+  return besto;
+}
+
+go_result go_reach_lookup(const go_reach_map * map, const go_pose * pose, go_reach_value * value)
+{
+  const go_reach_header * h = map->header;
+  go_integer i, j, k;
+
+  i = (go_integer) floor((pose->tran.x - h->min[0]) / h->spacing + 0.5);
+  j = (go_integer) floor((pose->tran.y - h->min[1]) / h->spacing + 0.5);
+  k = (go_integer) floor((pose->tran.z - h->min[2]) / h->spacing + 0.5);
+  if (i < 0 || i >= h->nx ||
+      j < 0 || j >= h->ny ||
+      k < 0 || k >= h->nz) return GO_RESULT_RANGE_ERROR;
+
+  go_reach_cell_decode(&map->cells[go_reach_index(map, i, j, k, reach_orient(map, &pose->rot))], value);
+
+  return GO_RESULT_OK;
+}
+
+go_result go_reach_nearest(const go_reach_map * map, const go_pose * pose, go_real margin, go_real dex, go_pose * nearest, go_reach_value * value)
+{
+  const go_reach_header * h = map->header;
+  const go_reach_cell * cell;
+  go_reach_value v;
+  go_integer o, i, j, k;
+  go_integer besti = -1, bestj = 0, bestk = 0;
+  go_real dx, dy, dz, dist, best = 0;
+
+  o = reach_orient(map, &pose->rot);
+
+  /* the grid is scanned whole, so there's no bound on how far */
+  for (k = 0; k < h->nz; k++) {
+    dz = h->min[2] + k * h->spacing - pose->tran.z;
+    for (j = 0; j < h->ny; j++) {
+      dy = h->min[1] + j * h->spacing - pose->tran.y;
+      for (i = 0; i < h->nx; i++) {
+	cell = &map->cells[go_reach_index(map, i, j, k, o)];
+	if (GO_REACH_YES != cell->reach) continue;
+	dx = h->min[0] + i * h->spacing - pose->tran.x;
+	dist = dx * dx + dy * dy + dz * dz;
+	if (besti >= 0 && dist >= best) continue;
+	go_reach_cell_decode(cell, &v);
+	if (v.margin < margin || v.dex < dex) continue;
+	besti = i, bestj = j, bestk = k, best = dist;
+      }
+    }
+  }
+
+  if (besti < 0) return GO_RESULT_ERROR;
+
+  go_reach_cell_pose(map, besti, bestj, bestk, o, nearest);
+  if (NULL != value) go_reach_cell_decode(&map->cells[go_reach_index(map, besti, bestj, bestk, o)], value);
+
+  return GO_RESULT_OK;
+}
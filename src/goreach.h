@@ -0,0 +1,157 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file goreach.h
+
+  \brief Workspace maps, telling how well a robot reaches the poses on
+  a grid, made ahead of time by goreachmap and looked up when checking
+  a program.
+
+  The grid is of positions, evenly spaced along X, Y and Z, and at
+  each position a set of orientations. Each pose on the grid has a
+  cell saying whether the inverse kinematics reached it, and if so
+  how far the joints were from their limits and how far the Jacobian
+  was from singular. Poses between the grid points take the cell of
+  the nearest one.
+
+  The map file is the header, the orientations and then the cells,
+  as they are in memory on the machine that made it. Cells are in
+  order of orientation, then X, then Y, then Z, so those for one
+  position are together.
+*/
+
+#ifndef GOREACH_H
+#define GOREACH_H
+
+#include <stddef.h>		/* size_t */
+#include "gotypes.h"		/* go_result, go_integer */
+#include "gomath.h"		/* go_pose */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if 0
+}
+#endif
+
+/* "GORM", for go reach map */
+#define GO_REACH_MAGIC 0x474F524D
+#define GO_REACH_VERSION 1
+
+enum {
+  GO_REACH_NO = 0,		/* inverse kinematics failed */
+  GO_REACH_LIMITS,		/* solved, but past a joint limit */
+  GO_REACH_YES			/* solved within the joint limits */
+};
+
+/*
+  The file header. These are plain C types so that the file is the
+  same however go_real is defined.
+*/
+typedef struct {
+  int magic;			/* GO_REACH_MAGIC */
+  int version;			/* GO_REACH_VERSION */
+  int nx, ny, nz;		/* how many positions along each axis */
+  int norient;			/* how many orientations at each */
+  int joint_num;		/* how many joints the robot has */
+  int pad;
+  double min[3];		/* the first position, [m] */
+  double spacing;		/* between positions, [m] */
+  double length;		/* [m] the Jacobian's translation was scaled by */
+} go_reach_header;
+
+/*
+  A cell is 4 bytes. The margin is the smallest distance of any
+  joint from its nearer limit, as a fraction of half its range, and
+  the dexterity is the reciprocal of the Jacobian's condition number,
+  both from 0 to 1 and scaled to the largest value that fits.
+*/
+typedef struct {
+  unsigned char reach;		/* GO_REACH_NO,LIMITS,YES */
+  unsigned char margin;		/* 0..255 */
+  unsigned short dex;		/* 0..65535 */
+} go_reach_cell;
+
+#define GO_REACH_MARGIN_MAX 255
+#define GO_REACH_DEX_MAX 65535
+
+/* a cell, decoded */
+typedef struct {
+  go_flag reach;		/* GO_REACH_NO,LIMITS,YES */
+  go_real margin;		/* 0 at a limit, 1 mid-range */
+  go_real dex;			/* 0 singular, 1 isotropic */
+} go_reach_value;
+
+typedef struct {
+  go_reach_header * header;
+  double * orient;		/* s x y z of each orientation */
+  go_reach_cell * cells;
+  void * base;			/* what was mapped or allocated */
+  size_t size;			/* how big it is */
+  go_flag mapped;		/* non-zero if mapped from the file */
+} go_reach_map;
+
+/*!
+  Allocates a map for \a header, whose sizes have been filled in,
+  with the orientations and cells zeroed. The header is copied to
+  the map's.
+*/
+extern go_result go_reach_alloc(go_reach_map * map, const go_reach_header * header);
+
+/*! Writes the map to the file \a path. */
+extern go_result go_reach_write(const go_reach_map * map, const char * path);
+
+/*!
+  Maps the map file \a path into memory, read only, or reads it in if
+  the system can't map files. Returns GO_RESULT_ERROR if it can't be
+  opened, or if it's not a map file of this version.
+*/
+extern go_result go_reach_open(go_reach_map * map, const char * path);
+
+/*! Unmaps or frees the map, whichever it was. */
+extern go_result go_reach_close(go_reach_map * map);
+
+/*! The index of the cell for orientation \a o at position \a i,j,k. */
+#define go_reach_index(map,i,j,k,o) \
+((((size_t) (k) * (map)->header->ny + (j)) * (map)->header->nx + (i)) * (map)->header->norient + (o))
+
+/*! The pose of the cell for orientation \a o at position \a i,j,k. */
+extern go_result go_reach_cell_pose(const go_reach_map * map, go_integer i, go_integer j, go_integer k, go_integer o, go_pose * pose);
+
+extern void go_reach_cell_encode(go_reach_cell * cell, const go_reach_value * value);
+
+extern void go_reach_cell_decode(const go_reach_cell * cell, go_reach_value * value);
+
+/*!
+  Looks up the cell nearest \a pose, in position and then in
+  orientation, returning its value. Returns GO_RESULT_RANGE_ERROR if
+  the position is more than half a spacing outside the grid.
+*/
+extern go_result go_reach_lookup(const go_reach_map * map, const go_pose * pose, go_reach_value * value);
+
+/*!
+  Finds the nearest position to \a pose whose cell for the orientation
+  nearest that of \a pose was reached within the limits, with at
+  least \a margin and \a dex. Fills in the pose of the cell, and its
+  value if \a value isn't null. Returns GO_RESULT_ERROR if there's
+  none.
+*/
+extern go_result go_reach_nearest(const go_reach_map * map, const go_pose * pose, go_real margin, go_real dex, go_pose * nearest, go_reach_value * value);
+
+#if 0
+{
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GOREACH_H */
@@ -0,0 +1,850 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file goreachmap.c
+
+  \brief Makes a workspace map for the robot in an .ini file, or looks
+  up poses in one. See goreach.h for what's in the map.
+
+  Syntax: goreachmap -i <ini file> {-k <kinematics>} -b "<xmin ymin zmin xmax ymax zmax>" -s <spacing> {-r "<r p y>"}* {-j "<joints>"} {-l <length>} {-t <threads>} {-o <map file>}
+
+  makes the map, running the inverse kinematics for each pose on the
+  grid from 'min' to 'max', every 'spacing', and at each orientation
+  given with -r, or that of [TRAJ] HOME if none are. Lengths and angles
+  are in the units of the .ini file. The inverse kinematics start from
+  the solution of the cell before, or from 'joints' if given, else the
+  [SERVO_n] HOME values, which shouldn't be singular. The Jacobian's translation rows
+  are divided by 'length' so they compare with the rotation rows; it
+  should be about the size of the robot, and is 1 meter if not given.
+  The grid is split across 'threads' threads, one per processor if
+  not given, each with its own kinematics.
+
+  Syntax: goreachmap -i <ini file> -q "<x y z r p y>" {-m <margin>} {-d <dexterity>} {-o <map file>}
+
+  looks up the pose in the map, and finds the nearest one reached
+  with at least 'margin' and 'dexterity', each from 0 to 1.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>		/* malloc */
+#include <string.h>		/* strncpy */
+#include <math.h>		/* sqrt */
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>		/* sysconf */
+#endif
+#include <inifile.h>
+#include <ulapi.h>		/* ulapi_getopt, ulapi_task_new */
+#include "go.h"			/* go_pose */
+#include "gokin.h"		/* go_kin_inv */
+#include "goreach.h"
+
+/* how many joints we can support */
+enum {MAX_JOINT_NUM = 8};
+
+/* how many orientations can be given */
+enum {MAX_ORIENT_NUM = 64};
+
+/* how many threads can be run */
+enum {MAX_THREAD_NUM = 256};
+
+#define REACH_MUTEX_KEY 1101
+
+static int
+ini_load(char * inifile_name,
+	 double * m_per_length_units,
+	 double * rad_per_angle_units,
+	 go_pose * home,
+	 int * link_number,
+	 go_link * link_params,
+	 go_real * jhome,
+	 go_real * jmin,
+	 go_real * jmax,
+	 char * kin_name)
+{
+  FILE * fp;
+  const char * inistring;
+  char servo_string[32];
+  int link;
+  double d1, d2, d3, d4, d5, d6, d7, d8, d9;
+  go_rpy rpy;
+  go_cart cart;
+
+  if (NULL == (fp = fopen(inifile_name, "r"))) return 1;
+
+#define CLOSE_AND_RETURN(ret)			\
+  fclose(fp);					\
+  return (ret)
+
+  inistring = ini_find(fp, "LENGTH_UNITS_PER_M", "GOMOTION");
+  if (NULL == inistring) {
+    fprintf(stderr, "[GOMOTION] LENGTH_UNITS_PER_M not found, using 1\n");
+  } else if (1 != sscanf(inistring, "%lf", &d1) || d1 <= 0.0) {
+    fprintf(stderr, "bad entry: [GOMOTION] LENGTH_UNITS_PER_M = %s\n", inistring);
+    CLOSE_AND_RETURN(1);
+  } else {
+    *m_per_length_units = 1.0 / d1;
+  }
+
+  inistring = ini_find(fp, "ANGLE_UNITS_PER_RAD", "GOMOTION");
+  if (NULL == inistring) {
+    fprintf(stderr, "[GOMOTION] ANGLE_UNITS_PER_RAD not found, using 1\n");
+  } else if (1 != sscanf(inistring, "%lf", &d1) || d1 <= 0.0) {
+    fprintf(stderr, "bad entry: [GOMOTION] ANGLE_UNITS_PER_RAD = %s\n", inistring);
+    CLOSE_AND_RETURN(1);
+  } else {
+    *rad_per_angle_units = 1.0 / d1;
+  }
+
+#define TGL(x) (go_real) ((x) * (*m_per_length_units))
+#define TGA(x) (go_real) ((x) * (*rad_per_angle_units))
+#define TGQ(x) (GO_QUANTITY_ANGLE == link_params[link].quantity ? TGA(x) : TGL(x))
+
+  /* if kin_name is empty, set it from .ini file */
+  if (0 == kin_name[0]) {
+    inistring = ini_find(fp, "KINEMATICS", "TRAJ");
+    if (NULL == inistring) {
+      fprintf(stderr, "[TRAJ] KINEMATICS not found\n");
+      CLOSE_AND_RETURN(1);
+    }
+    strncpy(kin_name, inistring, GO_KIN_NAME_LEN);
+    kin_name[GO_KIN_NAME_LEN - 1] = 0;
+  }
+
+  inistring = ini_find(fp, "HOME", "TRAJ");
+  if (NULL == inistring ||
+      6 != sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+    fprintf(stderr, "bad or missing entry: [TRAJ] HOME\n");
+    CLOSE_AND_RETURN(1);
+  }
+  home->tran.x = TGL(d1);
+  home->tran.y = TGL(d2);
+  home->tran.z = TGL(d3);
+  rpy.r = TGA(d4);
+  rpy.p = TGA(d5);
+  rpy.y = TGA(d6);
+  go_rpy_quat_convert(&rpy, &home->rot);
+
+  for (link = 0; link < MAX_JOINT_NUM; link++) {
+    sprintf(servo_string, "SERVO_%d", link + 1);
+
+    inistring = ini_find(fp, "QUANTITY", servo_string);
+    if (NULL == inistring) {
+      /* no "QUANTITY" in this section, or no section, so we're done */
+      break;
+    } else if (ini_match(inistring, "ANGLE")) {
+      link_params[link].quantity = GO_QUANTITY_ANGLE;
+    } else if (ini_match(inistring, "LENGTH")) {
+      link_params[link].quantity = GO_QUANTITY_LENGTH;
+    } else {
+      fprintf(stderr, "bad entry: [%s] QUANTITY = %s\n", servo_string, inistring);
+      CLOSE_AND_RETURN(1);
+    }
+
+    go_body_init(&link_params[link].body);
+
+    inistring = ini_find(fp, "MASS", servo_string);
+    if (NULL != inistring) {
+      if (1 == sscanf(inistring, "%lf", &d1)) {
+	link_params[link].body.mass = d1;
+      } else {
+	fprintf(stderr, "bad entry: [%s] MASS = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    }
+
+    inistring = ini_find(fp, "INERTIA", servo_string);
+    if (NULL != inistring) {
+      if (9 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6, &d7, &d8, &d9)) {
+	link_params[link].body.inertia[0][0] = TGL(TGL(d1));
+	link_params[link].body.inertia[0][1] = TGL(TGL(d2));
+	link_params[link].body.inertia[0][2] = TGL(TGL(d3));
+	link_params[link].body.inertia[1][0] = TGL(TGL(d4));
+	link_params[link].body.inertia[1][1] = TGL(TGL(d5));
+	link_params[link].body.inertia[1][2] = TGL(TGL(d6));
+	link_params[link].body.inertia[2][0] = TGL(TGL(d7));
+	link_params[link].body.inertia[2][1] = TGL(TGL(d8));
+	link_params[link].body.inertia[2][2] = TGL(TGL(d9));
+      } else {
+	fprintf(stderr, "bad entry: [%s] INERTIA = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    }
+
+    inistring = ini_find(fp, "HOME", servo_string);
+    if (NULL == inistring || 1 != sscanf(inistring, "%lf", &d1)) {
+      fprintf(stderr, "bad or missing entry: [%s] HOME\n", servo_string);
+      CLOSE_AND_RETURN(1);
+    }
+    jhome[link] = TGQ(d1);
+
+    inistring = ini_find(fp, "MIN_LIMIT", servo_string);
+    if (NULL == inistring || 1 != sscanf(inistring, "%lf", &d1)) {
+      fprintf(stderr, "bad or missing entry: [%s] MIN_LIMIT\n", servo_string);
+      CLOSE_AND_RETURN(1);
+    }
+    jmin[link] = TGQ(d1);
+
+    inistring = ini_find(fp, "MAX_LIMIT", servo_string);
+    if (NULL == inistring || 1 != sscanf(inistring, "%lf", &d1)) {
+      fprintf(stderr, "bad or missing entry: [%s] MAX_LIMIT\n", servo_string);
+      CLOSE_AND_RETURN(1);
+    }
+    jmax[link] = TGQ(d1);
+
+    if (NULL != (inistring = ini_find(fp, "DH_PARAMETERS", servo_string))) {
+      if (4 == sscanf(inistring, "%lf %lf %lf %lf", &d1, &d2, &d3, &d4)) {
+	link_params[link].u.dh.a = TGL(d1);
+	link_params[link].u.dh.alpha = TGA(d2);
+	link_params[link].u.dh.d = TGL(d3);
+	link_params[link].u.dh.theta = TGA(d4);
+	link_params[link].type = GO_LINK_DH;
+      } else {
+	fprintf(stderr, "bad entry: [%s] DH = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "PP_PARAMETERS", servo_string))) {
+      if (6 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+	link_params[link].u.pp.pose.tran.x = TGL(d1);
+	link_params[link].u.pp.pose.tran.y = TGL(d2);
+	link_params[link].u.pp.pose.tran.z = TGL(d3);
+	rpy.r = TGA(d4);
+	rpy.p = TGA(d5);
+	rpy.y = TGA(d6);
+	go_rpy_quat_convert(&rpy, &link_params[link].u.pp.pose.rot);
+	link_params[link].type = GO_LINK_PP;
+      } else {
+	fprintf(stderr, "bad entry: [%s] PP = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "URDF_PARAMETERS", servo_string))) {
+      if (9 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6, &d7, &d8, &d9)) {
+	link_params[link].u.urdf.pose.tran.x = TGL(d1);
+	link_params[link].u.urdf.pose.tran.y = TGL(d2);
+	link_params[link].u.urdf.pose.tran.z = TGL(d3);
+	rpy.r = TGA(d4);
+	rpy.p = TGA(d5);
+	rpy.y = TGA(d6);
+	go_rpy_quat_convert(&rpy, &link_params[link].u.urdf.pose.rot);
+	cart.x = TGL(d7);
+	cart.y = TGL(d8);
+	cart.z = TGL(d9);
+	if (GO_RESULT_OK != go_cart_unit(&cart, &cart)) {
+	  fprintf(stderr, "bad entry: [%s] URDF = %s\n", servo_string, inistring);
+	  CLOSE_AND_RETURN(1);
+	}
+	link_params[link].u.urdf.axis = cart;
+	link_params[link].type = GO_LINK_URDF;
+      } else {
+	fprintf(stderr, "bad entry: [%s] URDF = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else if (NULL != (inistring = ini_find(fp, "PK_PARAMETERS", servo_string))) {
+      if (6 == sscanf(inistring, "%lf %lf %lf %lf %lf %lf", &d1, &d2, &d3, &d4, &d5, &d6)) {
+	link_params[link].u.pk.base.x = TGL(d1);
+	link_params[link].u.pk.base.y = TGL(d2);
+	link_params[link].u.pk.base.z = TGL(d3);
+	link_params[link].u.pk.platform.x = TGL(d4);
+	link_params[link].u.pk.platform.y = TGL(d5);
+	link_params[link].u.pk.platform.z = TGL(d6);
+	link_params[link].type = GO_LINK_PK;
+      } else {
+	fprintf(stderr, "bad entry: [%s] PK = %s\n", servo_string, inistring);
+	CLOSE_AND_RETURN(1);
+      }
+    } else {
+      /* no "DH,PP,URDF,PK_PARAMETERS" in this section, so we're done */
+      break;
+    }
+  } /* for (link) */
+  *link_number = link;
+
+#undef TGL
+#undef TGA
+#undef TGQ
+
+  CLOSE_AND_RETURN(0);
+}
+
+/* what each thread is given; the map and counters are shared */
+typedef struct {
+  go_reach_map * map;
+  go_link * links;
+  go_integer joint_num;
+  const go_real * jhome;
+  const go_real * jmin;
+  const go_real * jmax;
+  go_real length;
+  void * mutex;
+  go_integer * next;		/* the next row of cells to do */
+  go_integer * done;		/* how many threads are done */
+  go_integer * bad;		/* how many couldn't set up */
+} reach_args;
+
+/*
+  The reciprocal of the condition number of the Jacobian at 'joints',
+  with the translation rows divided by 'length'. It's computed from
+  the eigenvalues of J^T J, or J J^T if there are more than 6 joints,
+  which are the squares of the singular values of J. Kinematics that
+  don't have a Jacobian are differenced.
+*/
+static go_real reach_dex(void * kins, go_integer joint_num, const go_real * joints, const go_pose * pose, go_real length)
+{
+  enum {DELTA_JOINT = 1};
+  go_real J[6][MAX_JOINT_NUM];
+  go_real G[MAX_JOINT_NUM][MAX_JOINT_NUM];
+  go_real * Gp[MAX_JOINT_NUM];
+  go_real d[MAX_JOINT_NUM], e[MAX_JOINT_NUM];
+  go_real jv[MAX_JOINT_NUM];
+  go_real delta = 1.0e-6;
+  go_real min, max;
+  go_vel vel;
+  go_pose dpose;
+  go_quat quat;
+  go_integer i, j, k, m;
+
+  for (j = 0; j < joint_num; j++) jv[j] = 0;
+  for (j = 0; j < joint_num; j++) {
+    jv[j] = 1;
+    if (GO_RESULT_OK != go_kin_jac_fwd(kins, joints, jv, pose, &vel)) {
+      /* move the joint a little and see how the pose changes */
+      for (i = 0; i < joint_num; i++) jv[i] = joints[i];
+      jv[j] += delta;
+      dpose = *pose;
+      if (GO_RESULT_OK != go_kin_fwd(kins, jv, &dpose)) return 0;
+      vel.v.x = (dpose.tran.x - pose->tran.x) / delta;
+      vel.v.y = (dpose.tran.y - pose->tran.y) / delta;
+      vel.v.z = (dpose.tran.z - pose->tran.z) / delta;
+      go_quat_inv(&pose->rot, &quat);
+      go_quat_quat_mult(&dpose.rot, &quat, &quat);
+      /* the vector part is half the small angle */
+      if (quat.s < 0) quat.x = -quat.x, quat.y = -quat.y, quat.z = -quat.z;
+      vel.w.x = 2 * quat.x / delta;
+      vel.w.y = 2 * quat.y / delta;
+      vel.w.z = 2 * quat.z / delta;
+      for (i = 0; i < joint_num; i++) jv[i] = 0;
+    }
+    jv[j] = 0;
+    J[0][j] = vel.v.x / length;
+    J[1][j] = vel.v.y / length;
+    J[2][j] = vel.v.z / length;
+    J[3][j] = vel.w.x;
+    J[4][j] = vel.w.y;
+    J[5][j] = vel.w.z;
+  }
+
+  if (joint_num <= 6) {
+    m = joint_num;
+    for (i = 0; i < m; i++) {
+      for (j = 0; j < m; j++) {
+	G[i][j] = 0;
+	for (k = 0; k < 6; k++) G[i][j] += J[k][i] * J[k][j];
+      }
+    }
+  } else {
+    m = 6;
+    for (i = 0; i < m; i++) {
+      for (j = 0; j < m; j++) {
+	G[i][j] = 0;
+	for (k = 0; k < joint_num; k++) G[i][j] += J[i][k] * J[j][k];
+      }
+    }
+  }
+  for (i = 0; i < m; i++) Gp[i] = G[i];
+
+  if (GO_RESULT_OK != go_tridiag_reduce(Gp, m, d, e) ||
+      GO_RESULT_OK != go_tridiag_ql(d, e, m, Gp)) return 0;
+
+  min = max = d[0];
+  for (i = 1; i < m; i++) {
+    if (d[i] < min) min = d[i];
+    if (d[i] > max) max = d[i];
+  }
+  if (max <= 0 || min <= 0) return 0;
+
+  return sqrt(min / max);
+}
+
+/*
+  Fills in the cell for 'pose', starting the inverse kinematics from
+  'joints' and then from home if that fails, leaving the solution in
+  'joints' and returning non-zero if there is one.
+*/
+static go_flag reach_cell(void * kins, const reach_args * args, const go_pose * pose, go_real * joints, go_flag seeded, go_reach_cell * cell)
+{
+  go_reach_value value;
+  go_pose check;
+  go_real margin, half;
+  go_integer t;
+  go_flag ok;
+
+  ok = (GO_RESULT_OK == go_kin_inv(kins, pose, joints));
+  if (! ok && seeded) {
+    for (t = 0; t < args->joint_num; t++) joints[t] = args->jhome[t];
+    ok = (GO_RESULT_OK == go_kin_inv(kins, pose, joints));
+  }
+
+  /* some iterative kinematics stop short, so check */
+  if (ok) {
+    check = *pose;
+    ok = (GO_RESULT_OK == go_kin_fwd(kins, joints, &check) &&
+	  go_pose_pose_compare(pose, &check));
+  }
+
+  if (! ok) {
+    value.reach = GO_REACH_NO;
+    value.margin = 0;
+    value.dex = 0;
+    go_reach_cell_encode(cell, &value);
+    return 0;
+  }
+
+  value.reach = GO_REACH_YES;
+  value.margin = 1;
+  for (t = 0; t < args->joint_num; t++) {
+    /* limits that aren't a range mean the joint isn't limited */
+    if (args->jmax[t] <= args->jmin[t]) continue;
+    /* revolute joints may be a turn away from their range */
+    if (GO_QUANTITY_ANGLE == args->links[t].quantity) {
+      while (joints[t] > args->jmax[t] && joints[t] - GO_2_PI >= args->jmin[t]) joints[t] -= GO_2_PI;
+      while (joints[t] < args->jmin[t] && joints[t] + GO_2_PI <= args->jmax[t]) joints[t] += GO_2_PI;
+    }
+    half = 0.5 * (args->jmax[t] - args->jmin[t]);
+    margin = joints[t] - args->jmin[t];
+    if (args->jmax[t] - joints[t] < margin) margin = args->jmax[t] - joints[t];
+    margin /= half;
+    if (margin < 0) value.reach = GO_REACH_LIMITS, margin = 0;
+    if (margin < value.margin) value.margin = margin;
+  }
+  value.dex = reach_dex(kins, args->joint_num, joints, pose, args->length);
+  go_reach_cell_encode(cell, &value);
+
+  return 1;
+}
+
+/*
+  Each thread takes rows of cells along X until there are none left.
+  Along the row, each orientation starts from the solution for it in
+  the cell before, so the iterative kinematics have a close seed.
+*/
+static void reach_code(void * arg)
+{
+  reach_args * args = (reach_args *) arg;
+  go_reach_map * map = args->map;
+  const go_reach_header * h = map->header;
+  void * kins;
+  go_real joints[MAX_ORIENT_NUM][MAX_JOINT_NUM];
+  go_flag seeded[MAX_ORIENT_NUM];
+  go_pose pose;
+  go_integer row, i, o, t;
+
+  kins = malloc(go_kin_size());
+  if (NULL == kins ||
+      GO_RESULT_OK != go_kin_init(kins) ||
+      GO_RESULT_OK != go_kin_set_parameters(kins, args->links, args->joint_num)) {
+    ulapi_mutex_take(args->mutex);
+    (*args->bad)++;
+    (*args->done)++;
+    ulapi_mutex_give(args->mutex);
+    if (NULL != kins) free(kins);
+    return;
+  }
+
+  for (;;) {
+    ulapi_mutex_take(args->mutex);
+    row = (*args->next)++;
+    ulapi_mutex_give(args->mutex);
+    if (row >= h->ny * h->nz) break;
+
+    for (o = 0; o < h->norient; o++) {
+      for (t = 0; t < args->joint_num; t++) joints[o][t] = args->jhome[t];
+      seeded[o] = 0;
+    }
+
+    for (i = 0; i < h->nx; i++) {
+      for (o = 0; o < h->norient; o++) {
+	go_reach_cell_pose(map, i, row % h->ny, row / h->ny, o, &pose);
+	if (reach_cell(kins, args, &pose, joints[o], seeded[o], &map->cells[go_reach_index(map, i, row % h->ny, row / h->ny, o)])) {
+	  seeded[o] = 1;
+	} else {
+	  for (t = 0; t < args->joint_num; t++) joints[o][t] = args->jhome[t];
+	  seeded[o] = 0;
+	}
+      }
+    }
+  }
+
+  free(kins);
+
+  ulapi_mutex_take(args->mutex);
+  (*args->done)++;
+  ulapi_mutex_give(args->mutex);
+
+  return;
+}
+
+static int processor_num(void)
+{
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n > 0) return n > MAX_THREAD_NUM ? MAX_THREAD_NUM : (int) n;
+#endif
+  return 1;
+}
+
+static int reach_query(const char * map_name, const go_pose * pose, go_real margin, go_real dex, double length_units_per_m, double angle_units_per_rad)
+{
+  go_reach_map map;
+  go_reach_value value;
+  go_pose nearest;
+  go_rpy rpy;
+  go_result retval;
+
+  if (GO_RESULT_OK != go_reach_open(&map, map_name)) {
+    fprintf(stderr, "can't open map file %s\n", map_name);
+    return 1;
+  }
+
+  retval = go_reach_lookup(&map, pose, &value);
+  if (GO_RESULT_OK != retval) {
+    printf("outside the map\n");
+  } else {
+    printf("%s, margin %f, dexterity %f\n",
+	   GO_REACH_YES == value.reach ? "reached" :
+	   GO_REACH_LIMITS == value.reach ? "reached past the limits" : "not reached",
+	   (double) value.margin, (double) value.dex);
+  }
+
+  if (GO_RESULT_OK != go_reach_nearest(&map, pose, margin, dex, &nearest, &value)) {
+    printf("none reached with margin %f, dexterity %f\n", (double) margin, (double) dex);
+  } else {
+    go_quat_rpy_convert(&nearest.rot, &rpy);
+    printf("nearest %f %f %f %f %f %f, margin %f, dexterity %f\n",
+	   (double) (nearest.tran.x * length_units_per_m),
+	   (double) (nearest.tran.y * length_units_per_m),
+	   (double) (nearest.tran.z * length_units_per_m),
+	   (double) (rpy.r * angle_units_per_rad),
+	   (double) (rpy.p * angle_units_per_rad),
+	   (double) (rpy.y * angle_units_per_rad),
+	   (double) value.margin, (double) value.dex);
+  }
+
+  go_reach_close(&map);
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  enum { BUFFERLEN = 256 };
+  int option;
+  char inifile_name[BUFFERLEN] = "gomotion.ini";
+  char map_name[BUFFERLEN] = "goreach.map";
+  char kin_name[GO_KIN_NAME_LEN] = "";
+  double m_per_length_units = 1;
+  double rad_per_angle_units = 1;
+  double bounds[6];
+  double spacing = 0;
+  double length = -1;
+  double rpys[MAX_ORIENT_NUM][3];
+  int orient_num = 0;
+  int thread_num = 0;
+  double query[6];
+  int querying = 0;
+  double seed[MAX_JOINT_NUM];
+  int seed_num = 0;
+  double margin = 0, dex = 0;
+  int bounded = 0;
+  int link_number;
+  go_link link_params[MAX_JOINT_NUM];
+  go_real jhome[MAX_JOINT_NUM];
+  go_real jmin[MAX_JOINT_NUM];
+  go_real jmax[MAX_JOINT_NUM];
+  go_pose home;
+  go_pose pose;
+  go_rpy rpy;
+  go_reach_header header;
+  go_reach_map map;
+  reach_args args;
+  void * tasks[MAX_THREAD_NUM];
+  go_integer next = 0, done = 0, bad = 0;
+  go_integer counts[GO_REACH_YES + 1];
+  size_t n, cell_num;
+  ulapi_real start;
+  int t;
+
+  opterr = 0;
+  while (1) {
+    option = ulapi_getopt(argc, argv, ":i:k:o:b:s:r:j:l:t:q:m:d:");
+    if (option == -1)
+      break;
+
+    switch (option) {
+    case 'i':
+      strncpy(inifile_name, ulapi_optarg, BUFFERLEN);
+      inifile_name[BUFFERLEN - 1] = 0;
+      break;
+
+    case 'k':
+      strncpy(kin_name, ulapi_optarg, GO_KIN_NAME_LEN);
+      kin_name[GO_KIN_NAME_LEN - 1] = 0;
+      break;
+
+    case 'o':
+      strncpy(map_name, ulapi_optarg, BUFFERLEN);
+      map_name[BUFFERLEN - 1] = 0;
+      break;
+
+    case 'b':
+      if (6 != sscanf(ulapi_optarg, "%lf %lf %lf %lf %lf %lf", &bounds[0], &bounds[1], &bounds[2], &bounds[3], &bounds[4], &bounds[5]) ||
+	  bounds[3] < bounds[0] || bounds[4] < bounds[1] || bounds[5] < bounds[2]) {
+	fprintf(stderr, "bad value for bounds: %s\n", ulapi_optarg);
+	return 1;
+      }
+      bounded = 1;
+      break;
+
+    case 's':
+      if (1 != sscanf(ulapi_optarg, "%lf", &spacing) || spacing <= 0) {
+	fprintf(stderr, "bad value for spacing: %s\n", ulapi_optarg);
+	return 1;
+      }
+      break;
+
+    case 'r':
+      if (orient_num >= MAX_ORIENT_NUM) {
+	fprintf(stderr, "too many orientations, only %d handled\n", MAX_ORIENT_NUM);
+	return 1;
+      }
+      if (3 != sscanf(ulapi_optarg, "%lf %lf %lf", &rpys[orient_num][0], &rpys[orient_num][1], &rpys[orient_num][2])) {
+	fprintf(stderr, "bad value for orientation: %s\n", ulapi_optarg);
+	return 1;
+      }
+      orient_num++;
+      break;
+
+    case 'j':
+      seed_num = sscanf(ulapi_optarg, "%lf %lf %lf %lf %lf %lf %lf %lf", &seed[0], &seed[1], &seed[2], &seed[3], &seed[4], &seed[5], &seed[6], &seed[7]);
+      if (seed_num < 1) {
+	fprintf(stderr, "bad value for joints: %s\n", ulapi_optarg);
+	return 1;
+      }
+      break;
+
+    case 'l':
+      if (1 != sscanf(ulapi_optarg, "%lf", &length) || length <= 0) {
+	fprintf(stderr, "bad value for length: %s\n", ulapi_optarg);
+	return 1;
+      }
+      break;
+
+    case 't':
+      if (1 != sscanf(ulapi_optarg, "%i", &thread_num) || thread_num < 1 || thread_num > MAX_THREAD_NUM) {
+	fprintf(stderr, "bad value for threads: %s\n", ulapi_optarg);
+	return 1;
+      }
+      break;
+
+    case 'q':
+      if (6 != sscanf(ulapi_optarg, "%lf %lf %lf %lf %lf %lf", &query[0], &query[1], &query[2], &query[3], &query[4], &query[5])) {
+	fprintf(stderr, "bad value for query: %s\n", ulapi_optarg);
+	return 1;
+      }
+      querying = 1;
+      break;
+
+    case 'm':
+      if (1 != sscanf(ulapi_optarg, "%lf", &margin)) {
+	fprintf(stderr, "bad value for margin: %s\n", ulapi_optarg);
+	return 1;
+      }
+      break;
+
+    case 'd':
+      if (1 != sscanf(ulapi_optarg, "%lf", &dex)) {
+	fprintf(stderr, "bad value for dexterity: %s\n", ulapi_optarg);
+	return 1;
+      }
+      break;
+
+    case ':':
+      fprintf(stderr, "missing value for -%c\n", ulapi_optopt);
+      return 1;
+      break;
+
+    default:			/* '?' */
+      fprintf (stderr, "unrecognized option -%c\n", ulapi_optopt);
+      return 1;
+      break;
+    }
+  }
+  if (ulapi_optind < argc) {
+    fprintf(stderr, "extra non-option characters: %s\n", argv[ulapi_optind]);
+    return 1;
+  }
+
+  if (0 != go_init()) {
+    fprintf(stderr, "can't init go\n");
+    return 1;
+  }
+
+  if (ULAPI_OK != ulapi_init()) {
+    fprintf(stderr, "can't init ulapi\n");
+    return 1;
+  }
+
+  if (0 != ini_load(inifile_name,
+		    &m_per_length_units,
+		    &rad_per_angle_units,
+		    &home,
+		    &link_number,
+		    link_params,
+		    jhome,
+		    jmin,
+		    jmax,
+		    kin_name)) {
+    fprintf(stderr, "can't load ini file %s\n", inifile_name);
+    return 1;
+  }
+
+  if (querying) {
+    pose.tran.x = query[0] * m_per_length_units;
+    pose.tran.y = query[1] * m_per_length_units;
+    pose.tran.z = query[2] * m_per_length_units;
+    rpy.r = query[3] * rad_per_angle_units;
+    rpy.p = query[4] * rad_per_angle_units;
+    rpy.y = query[5] * rad_per_angle_units;
+    go_rpy_quat_convert(&rpy, &pose.rot);
+    return reach_query(map_name, &pose, margin, dex, 1.0 / m_per_length_units, 1.0 / rad_per_angle_units);
+  }
+
+  if (! bounded || spacing <= 0) {
+    fprintf(stderr, "need bounds with -b and spacing with -s\n");
+    return 1;
+  }
+
+  if (link_number < 1) {
+    fprintf(stderr, "no links found\n");
+    return 1;
+  }
+
+  if (seed_num > 0) {
+    if (seed_num != link_number) {
+      fprintf(stderr, "need %d joints, got %d\n", link_number, seed_num);
+      return 1;
+    }
+    for (t = 0; t < link_number; t++) {
+      jhome[t] = GO_QUANTITY_ANGLE == link_params[t].quantity ?
+	seed[t] * rad_per_angle_units : seed[t] * m_per_length_units;
+    }
+  }
+
+  if (GO_RESULT_OK != go_kin_select(kin_name)) {
+    fprintf(stderr, "can't select kinematics %s\n", kin_name);
+    return 1;
+  }
+
+  header.nx = (int) ((bounds[3] - bounds[0]) / spacing + 0.5) + 1;
+  header.ny = (int) ((bounds[4] - bounds[1]) / spacing + 0.5) + 1;
+  header.nz = (int) ((bounds[5] - bounds[2]) / spacing + 0.5) + 1;
+  header.norient = orient_num > 0 ? orient_num : 1;
+  header.joint_num = link_number;
+  header.pad = 0;
+  header.min[0] = bounds[0] * m_per_length_units;
+  header.min[1] = bounds[1] * m_per_length_units;
+  header.min[2] = bounds[2] * m_per_length_units;
+  header.spacing = spacing * m_per_length_units;
+  header.length = length > 0 ? length * m_per_length_units : 1;
+
+  if (GO_RESULT_OK != go_reach_alloc(&map, &header)) {
+    fprintf(stderr, "can't allocate a map of %d x %d x %d x %d\n", header.nx, header.ny, header.nz, header.norient);
+    return 1;
+  }
+
+  for (t = 0; t < header.norient; t++) {
+    if (0 == orient_num) {
+      pose.rot = home.rot;
+    } else {
+      rpy.r = rpys[t][0] * rad_per_angle_units;
+      rpy.p = rpys[t][1] * rad_per_angle_units;
+      rpy.y = rpys[t][2] * rad_per_angle_units;
+      go_rpy_quat_convert(&rpy, &pose.rot);
+    }
+    map.orient[4 * t] = pose.rot.s;
+    map.orient[4 * t + 1] = pose.rot.x;
+    map.orient[4 * t + 2] = pose.rot.y;
+    map.orient[4 * t + 3] = pose.rot.z;
+  }
+
+  if (0 == thread_num) thread_num = processor_num();
+  if (thread_num > header.ny * header.nz) thread_num = header.ny * header.nz;
+
+  args.map = &map;
+  args.links = link_params;
+  args.joint_num = link_number;
+  args.jhome = jhome;
+  args.jmin = jmin;
+  args.jmax = jmax;
+  args.length = header.length;
+  args.mutex = ulapi_mutex_new(REACH_MUTEX_KEY);
+  args.next = &next;
+  args.done = &done;
+  args.bad = &bad;
+  if (NULL == args.mutex) {
+    fprintf(stderr, "can't create mutex\n");
+    return 1;
+  }
+
+  cell_num = (size_t) header.nx * header.ny * header.nz * header.norient;
+  printf("%d x %d x %d positions, %d orientations, %lu cells, %d threads\n",
+	 header.nx, header.ny, header.nz, header.norient, (unsigned long) cell_num, thread_num);
+
+  start = ulapi_time();
+  for (t = 0; t < thread_num; t++) {
+    tasks[t] = ulapi_task_new();
+    if (NULL == tasks[t] ||
+	ULAPI_OK != ulapi_task_start(tasks[t], reach_code, &args, ulapi_prio_lowest(), 0)) {
+      fprintf(stderr, "can't start thread %d\n", t + 1);
+      return 1;
+    }
+  }
+
+  for (;;) {
+    ulapi_sleep(0.1);
+    ulapi_mutex_take(args.mutex);
+    t = (done >= thread_num);
+    ulapi_mutex_give(args.mutex);
+    if (t) break;
+  }
+
+  if (bad > 0) {
+    fprintf(stderr, "can't set up kinematics %s\n", kin_name);
+    return 1;
+  }
+
+  counts[GO_REACH_NO] = counts[GO_REACH_LIMITS] = counts[GO_REACH_YES] = 0;
+  for (n = 0; n < cell_num; n++) counts[map.cells[n].reach]++;
+  printf("%d reached, %d past the limits, %d not reached, in %f seconds\n",
+	 (int) counts[GO_REACH_YES], (int) counts[GO_REACH_LIMITS], (int) counts[GO_REACH_NO],
+	 (double) (ulapi_time() - start));
+
+  if (GO_RESULT_OK != go_reach_write(&map, map_name)) {
+    fprintf(stderr, "can't write map file %s\n", map_name);
+    return 1;
+  }
+  go_reach_close(&map);
+
+  return 0;
+}
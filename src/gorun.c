@@ -27,6 +27,9 @@ static enum {USE_UNIX, USE_RTAI} which_ulapi = USE_UNIX;
 
 #define DEFAULT_PENDANT_NAME "pendant.tcl"
 
+#define DEFAULT_TRAJ_QUEUE_SIZE 100
+#define DEFAULT_TRAJ_SPLINE_POINTS 1000
+
 static int ini_load(char *inifile_name,
 		    char *gomain,
 		    char ext_init_string[INIFILE_MAX_LINELEN],
@@ -38,6 +41,9 @@ static int ini_load(char *inifile_name,
 		    int *servo_shm_key,
 		    int *servo_sem_key,
 		    int *traj_shm_key,
+		    int *traj_queue_shm_key,
+		    int *traj_queue_size,
+		    int *traj_spline_points,
 		    char kinematics[INIFILE_MAX_LINELEN],
 		    int *go_log_shm_key,
 		    int *go_io_shm_key,
@@ -181,6 +187,38 @@ static int ini_load(char *inifile_name,
     CLOSE_AND_RETURN;
   }
 
+  key = "QUEUE_SHM_KEY";
+  inistring = ini_find(fp, key, section);
+  if (NULL == inistring) {
+    /* optional, make it the one after the comm buffer's */
+    *traj_queue_shm_key = *traj_shm_key + 1;
+  } else if (1 != sscanf(inistring, "%i", traj_queue_shm_key)) {
+    fprintf(stderr, "gorun: bad entry: [%s] %s = %s\n", section, key, inistring);
+    CLOSE_AND_RETURN;
+  }
+
+  key = "QUEUE_SIZE";
+  inistring = ini_find(fp, key, section);
+  if (NULL == inistring) {
+    /* optional, make it the default */
+    *traj_queue_size = DEFAULT_TRAJ_QUEUE_SIZE;
+  } else if (1 != sscanf(inistring, "%i", traj_queue_size) ||
+	     *traj_queue_size < 2) {
+    fprintf(stderr, "gorun: bad entry: [%s] %s = %s\n", section, key, inistring);
+    CLOSE_AND_RETURN;
+  }
+
+  key = "SPLINE_POINTS";
+  inistring = ini_find(fp, key, section);
+  if (NULL == inistring) {
+    /* optional, make it the default */
+    *traj_spline_points = DEFAULT_TRAJ_SPLINE_POINTS;
+  } else if (1 != sscanf(inistring, "%i", traj_spline_points) ||
+	     *traj_spline_points < 0) {
+    fprintf(stderr, "gorun: bad entry: [%s] %s = %s\n", section, key, inistring);
+    CLOSE_AND_RETURN;
+  }
+
   key = "KINEMATICS";
   inistring = ini_find(fp, key, section);
   if (NULL == inistring) {
@@ -328,6 +366,9 @@ int main(int argc, char *argv[])
   int servo_shm_key;
   int servo_sem_key;
   int traj_shm_key;
+  int traj_queue_shm_key;
+  int traj_queue_size;
+  int traj_spline_points;
   char kinematics[INIFILE_MAX_LINELEN];
   int go_log_shm_key;
   int go_io_shm_key;
@@ -420,6 +461,9 @@ int main(int argc, char *argv[])
 		    &servo_shm_key,
 		    &servo_sem_key,
 		    &traj_shm_key,
+		    &traj_queue_shm_key,
+		    &traj_queue_size,
+		    &traj_spline_points,
 		    kinematics,
 		    &go_log_shm_key,
 		    &go_io_shm_key,
@@ -511,7 +555,7 @@ int main(int argc, char *argv[])
 
   if (USE_RTAI == which_ulapi) {
     result = ulapi_snprintf(path, sizeof(path)-1,
-			    "sudo insmod -f %s%s%s%s%s%s%s DEBUG=%d EXT_INIT_STRING=%s SERVO_HOWMANY=%d SERVO_SHM_KEY=%d SERVO_SEM_KEY=%d TRAJ_SHM_KEY=%d KINEMATICS=%s GO_LOG_SHM_KEY=%d GO_IO_SHM_KEY=%d", 
+			    "sudo insmod -f %s%s%s%s%s%s%s DEBUG=%d EXT_INIT_STRING=%s SERVO_HOWMANY=%d SERVO_SHM_KEY=%d SERVO_SEM_KEY=%d TRAJ_SHM_KEY=%d TRAJ_QUEUE_SHM_KEY=%d TRAJ_QUEUE_SIZE=%d TRAJ_SPLINE_POINTS=%d KINEMATICS=%s GO_LOG_SHM_KEY=%d GO_IO_SHM_KEY=%d", 
 			    dirname, ulapi_pathsep, "..", ulapi_pathsep, "rtlib", ulapi_pathsep, "gomain_mod.ko",
 			    debug_arg ? 1 : 0,
 			    ext_init_string,
@@ -519,6 +563,9 @@ int main(int argc, char *argv[])
 			    (int) servo_shm_key,
 			    (int) servo_sem_key, 
 			    (int) traj_shm_key,
+			    (int) traj_queue_shm_key,
+			    (int) traj_queue_size,
+			    (int) traj_spline_points,
 			    kinematics,
 			    (int) go_log_shm_key,
 			    (int) go_io_shm_key);
@@ -535,7 +582,7 @@ int main(int argc, char *argv[])
     }
   } else {
     result = ulapi_snprintf(path, sizeof(path)-1,
-			    "%s%s%s DEBUG=%d EXT_INIT_STRING=\"%s\" SERVO_HOWMANY=%d SERVO_SHM_KEY=%d SERVO_SEM_KEY=%d TRAJ_SHM_KEY=%d KINEMATICS=%s GO_LOG_SHM_KEY=%d GO_IO_SHM_KEY=%d", 
+			    "%s%s%s DEBUG=%d EXT_INIT_STRING=\"%s\" SERVO_HOWMANY=%d SERVO_SHM_KEY=%d SERVO_SEM_KEY=%d TRAJ_SHM_KEY=%d TRAJ_QUEUE_SHM_KEY=%d TRAJ_QUEUE_SIZE=%d TRAJ_SPLINE_POINTS=%d KINEMATICS=%s GO_LOG_SHM_KEY=%d GO_IO_SHM_KEY=%d", 
 			    dirname, ulapi_pathsep, gomain,
 			    debug_arg ? 1 : 0,
 			    ext_init_string,
@@ -543,6 +590,9 @@ int main(int argc, char *argv[])
 			    (int) servo_shm_key,
 			    (int) servo_sem_key, 
 			    (int) traj_shm_key,
+			    (int) traj_queue_shm_key,
+			    (int) traj_queue_size,
+			    (int) traj_spline_points,
 			    kinematics,
 			    (int) go_log_shm_key,
 			    (int) go_io_shm_key);
@@ -391,6 +391,13 @@ static void print_traj_stat(traj_stat_struct *stat)
 	 TRAJ_JOINT_FRAME ? "Joint" : "?");
   printf("inpos:              %s\n", stat->inpos ? "INPOS" : "NOT INPOS");
   printf("in queue:           %d\n", (int) stat->queue_count);
+  printf("queue time:         %f\n", (double) stat->queue_time);
+  printf("planned time:       %f\n", (double) stat->planned_time);
+  printf("ring get, credits:  %d %d\n", (int) stat->ring_get, (int) stat->ring_credits);
+  printf("kin fwd iterations: %d max %d avg %f\n", (int) stat->kin_fwd.last, (int) stat->kin_fwd.max, (double) stat->kin_fwd.avg);
+  printf("ecp act stamp:      %d\n", (int) stat->ecp_act_stamp);
+  printf("kin cache hits:     %d misses %d\n", (int) stat->kin_cache_hits, (int) stat->kin_cache_misses);
+  printf("kin inv iterations: %d max %d avg %f\n", (int) stat->kin_inv.last, (int) stat->kin_inv.max, (double) stat->kin_inv.avg);
   go_quat_rpy_convert(&stat->ecp.rot, &rpy);
   printf("ecp:                %f %f %f %f %f %f\n",
 	 FGL(stat->ecp.tran.x), FGL(stat->ecp.tran.y), FGL(stat->ecp.tran.z),
@@ -479,6 +486,7 @@ static void print_traj_set(traj_set_struct *set)
   printf("max_rvel:           %f\n", (double) set->max_rvel);
   printf("max_racc:           %f\n", (double) set->max_racc);
   printf("max_rjerk:          %f\n", (double) set->max_rjerk);
+  printf("blend_tol:          %f\n", (double) set->blend_tol);
 
   printf("scale:              %f\n", (double) set->scale);
   printf("scale_v:            %f\n", (double) set->scale_v);
@@ -492,6 +500,10 @@ static void print_traj_set(traj_set_struct *set)
   printf("log_which:          %d\n", (int) set->log_which);
 
   printf("queue size:         %d\n", (int) set->queue_size);
+  printf("kin predict:        %d\n", (int) set->kin_predict);
+  printf("kin fwd every:      %d\n", (int) set->kin_fwd_every);
+  printf("kin cache size:     %d resolution %f rot %f\n", (int) set->kin_cache_size, (double) set->kin_cache_resolution, (double) set->kin_cache_rot_resolution);
+  printf("kin nearest:        %s\n", set->kin_nearest ? "on" : "off");
 }
 
 static void print_traj_ref(traj_ref_struct *ref)
@@ -529,6 +541,9 @@ static void print_task_stat(task_stat_struct *stat)
   } else {
     printf("program:            (%s)\n", old_program);
   }
+  printf("program time:       %f\n", (double) stat->program_time);
+  printf("interp list:        %d of %d, high %d\n", (int) stat->interp_list_howmany, (int) stat->interp_list_size, (int) stat->interp_list_high_water);
+  printf("compression:        %d feeds to %d moves, deviation %f\n", (int) stat->compress_in, (int) stat->compress_out, FGL(stat->compress_deviation));
 }
 
 static void print_task_set(task_set_struct *set)
@@ -1527,6 +1542,8 @@ int main(int argc, char *argv[])
 	traj_cmd.u.move_world.id = traj_cmd.serial_number;
 	traj_cmd.u.move_world.type = GO_MOTION_LINEAR;
 	traj_cmd.u.move_world.time = movetime;
+	/* blend with the configured tolerance */
+	traj_cmd.u.move_world.tol = -1.0;
 	traj_cmd.u.move_world.end.tran.x = TGL(da[0]);
 	traj_cmd.u.move_world.end.tran.y = TGL(da[1]);
 	traj_cmd.u.move_world.end.tran.z = TGL(da[2]);
@@ -1558,6 +1575,8 @@ int main(int argc, char *argv[])
 	traj_cmd.u.move_world.id = traj_cmd.serial_number;
 	traj_cmd.u.move_world.type = GO_MOTION_CIRCULAR;
 	traj_cmd.u.move_world.time = movetime;
+	/* blend with the configured tolerance */
+	traj_cmd.u.move_world.tol = -1.0;
 	traj_cmd.u.move_world.end.tran.x = TGL(da[0]);
 	traj_cmd.u.move_world.end.tran.y = TGL(da[1]);
 	traj_cmd.u.move_world.end.tran.z = TGL(da[2]);
@@ -1824,6 +1843,7 @@ int main(int argc, char *argv[])
 	traj_cfg.u.profile.max_rvel = da[3];
 	traj_cfg.u.profile.max_racc = da[4];
 	traj_cfg.u.profile.max_rjerk = da[5];
+	traj_cfg.u.profile.blend_tol = traj_set_ptr->blend_tol;
 	DO_TRAJ_CFG;
       } else {
 	printf("need tv ta tj rv ra rj\n");
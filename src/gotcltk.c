@@ -2216,6 +2216,8 @@ gotk_traj_jog_world_or_tool(ClientData clientData, Tcl_Interp * interp, int objc
   traj_cmd.u.move_world.ra = local_racc;
   traj_cmd.u.move_world.rj = local_rjerk;
   traj_cmd.u.move_world.time = 0.0;
+  /* blend with the configured tolerance */
+  traj_cmd.u.move_world.tol = -1.0;
   DO_TRAJ_CMD;
 
   UNLOCK;
@@ -2331,6 +2333,8 @@ gotk_traj_move_world_or_tool(ClientData clientData, Tcl_Interp * interp, int obj
     traj_cmd.type = TRAJ_CMD_MOVE_WORLD_TYPE;
     traj_cmd.u.move_world.id = traj_cmd.serial_number + 1;
     traj_cmd.u.move_world.end = pose;
+    /* blend with the configured tolerance */
+    traj_cmd.u.move_world.tol = -1.0;
     if (is_circular) {
       traj_cmd.u.move_world.type = GO_MOTION_CIRCULAR;
       traj_cmd.u.move_world.center = center;
@@ -2404,6 +2408,118 @@ gotk_traj_move_world_or_tool(ClientData clientData, Tcl_Interp * interp, int obj
   return TCL_OK;
 }
 
+static int
+gotk_traj_move_spline(ClientData clientData, Tcl_Interp * interp, int objc, Tcl_Obj * CONST objv[])
+{
+  static traj_cmd_spline spline;
+  double d1;
+  go_pose pose;
+  go_rpy rpy;
+  int listc;
+  Tcl_Obj ** listv;
+  int t;
+  Tcl_Obj * resultPtr;
+
+  /*
+    7 args, proc end-x y z r p w {x1 y1 z1 x2 y2 z2 ...}
+  */
+
+  if (objc != 8) {
+    Tcl_WrongNumArgs(interp, 1, objv, "<X Y Z R P W> {<x y z> ...}");
+    return TCL_ERROR;
+  }
+
+  if (TCL_OK != Tcl_GetDoubleFromObj(interp, objv[1], &d1)) {
+    return TCL_ERROR;
+  }
+  pose.tran.x = TGL(d1);
+  
+  if (TCL_OK != Tcl_GetDoubleFromObj(interp, objv[2], &d1)) {
+    return TCL_ERROR;
+  }
+  pose.tran.y = TGL(d1);
+  
+  if (TCL_OK != Tcl_GetDoubleFromObj(interp, objv[3], &d1)) {
+    return TCL_ERROR;
+  }
+  pose.tran.z = TGL(d1);
+  
+  if (TCL_OK != Tcl_GetDoubleFromObj(interp, objv[4], &d1)) {
+    return TCL_ERROR;
+  }
+  rpy.r = TGA(d1);
+  
+  if (TCL_OK != Tcl_GetDoubleFromObj(interp, objv[5], &d1)) {
+    return TCL_ERROR;
+  }
+  rpy.p = TGA(d1);
+  
+  if (TCL_OK != Tcl_GetDoubleFromObj(interp, objv[6], &d1)) {
+    return TCL_ERROR;
+  }
+  rpy.y = TGA(d1);
+
+  go_rpy_quat_convert(&rpy, &pose.rot);
+
+  if (TCL_OK != Tcl_ListObjGetElements(interp, objv[7], &listc, &listv)) {
+    return TCL_ERROR;
+  }
+  if (0 != listc % 3 || listc / 3 > TRAJ_CMD_SPLINE_MAX) {
+    Tcl_SetResult(interp, "need x y z for each of up to the max number of control points", TCL_STATIC);
+    return TCL_ERROR;
+  }
+
+  for (t = 0; t < listc; t++) {
+    if (TCL_OK != Tcl_GetDoubleFromObj(interp, listv[t], &d1)) {
+      return TCL_ERROR;
+    }
+    if (0 == t % 3) spline.point[t / 3].x = TGL(d1);
+    else if (1 == t % 3) spline.point[t / 3].y = TGL(d1);
+    else spline.point[t / 3].z = TGL(d1);
+  }
+  spline.count = listc / 3;
+
+  LOCK;
+
+  /* the points go out of line, before the command that uses them */
+  spline.id = traj_cmd.serial_number + 1;
+  spline.tail = ++spline.head;
+  traj_comm_ptr->traj_spline = spline;
+
+  traj_cmd.type = TRAJ_CMD_MOVE_SPLINE_TYPE;
+  traj_cmd.u.move_spline.move.id = traj_cmd.serial_number + 1;
+  traj_cmd.u.move_spline.move.type = GO_MOTION_SPLINE;
+  traj_cmd.u.move_spline.move.end = pose;
+  traj_cmd.u.move_spline.move.tol = 0.0;
+  traj_cmd.u.move_spline.count = spline.count;
+  if (local_move_time > GO_REAL_EPSILON) {
+    /* as with world moves, max the pars and scale to the time */
+    traj_cmd.u.move_spline.move.tv = traj_set_ptr->max_tvel;
+    traj_cmd.u.move_spline.move.ta = traj_set_ptr->max_tacc;
+    traj_cmd.u.move_spline.move.tj = traj_set_ptr->max_tjerk;
+    traj_cmd.u.move_spline.move.rv = traj_set_ptr->max_rvel;
+    traj_cmd.u.move_spline.move.ra = traj_set_ptr->max_racc;
+    traj_cmd.u.move_spline.move.rj = traj_set_ptr->max_rjerk;
+    traj_cmd.u.move_spline.move.time = local_move_time;
+  } else {
+    traj_cmd.u.move_spline.move.tv = local_tvel;
+    traj_cmd.u.move_spline.move.ta = local_tacc;
+    traj_cmd.u.move_spline.move.tj = local_tjerk;
+    traj_cmd.u.move_spline.move.rv = local_rvel;
+    traj_cmd.u.move_spline.move.ra = local_racc;
+    traj_cmd.u.move_spline.move.rj = local_rjerk;
+    traj_cmd.u.move_spline.move.time = -1.0;
+  }
+  DO_TRAJ_CMD;
+
+  UNLOCK;
+
+  resultPtr = Tcl_GetObjResult(interp);
+  Tcl_SetIntObj(resultPtr, traj_wait_inpos());
+
+  return TCL_OK;
+}
+
 static int
 gotk_traj_here(ClientData clientData, Tcl_Interp * interp, int objc, Tcl_Obj * CONST objv[])
 {
@@ -4160,6 +4276,7 @@ void gotk_create_commands(Tcl_Interp * interp)
 
   Tcl_CreateObjCommand(interp, "gotk_traj_move_world", gotk_traj_move_world_or_tool, CD1, NULL);
   Tcl_CreateObjCommand(interp, "gotk_traj_move_tool", gotk_traj_move_world_or_tool, CD2, NULL);
+  Tcl_CreateObjCommand(interp, "gotk_traj_move_spline", gotk_traj_move_spline, NULL, NULL);
   Tcl_CreateObjCommand(interp, "gotk_traj_here", gotk_traj_here, NULL, NULL);
   Tcl_CreateObjCommand(interp, "gotk_traj_cfg_scale", gotk_traj_cfg_scale, NULL, NULL);
   Tcl_CreateObjCommand(interp, "gotk_traj_cfg_home", gotk_traj_cfg_home, NULL, NULL);
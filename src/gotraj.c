@@ -567,14 +567,30 @@ go_result go_traj_cj_scale(const go_traj_cj_spec * ts, go_real t,
   return GO_RESULT_OK;
 }
 
+/*
+  Fills in stages V, VI and VII of 'ots' from the end of its stage IV,
+  as the mirror image of stages I, II and III of 'ts'. Taking the
+  cruise that's no longer done off the original ends instead would
+  subtract nearly equal distances on long moves, which loses most of
+  the digits of the stopping distance with float go_reals.
+*/
+static void cj_stop_mirror(const go_traj_cj_spec * ts, go_traj_cj_spec * ots)
+{
+  ots->t5 = ots->t4 + ts->t1;
+  ots->dt5 = ots->dt4 + (ts->dt3 - ts->dt2);
+  ots->t6 = ots->t5 + (ts->t2 - ts->t1);
+  ots->dt6 = ots->dt5 + (ts->dt2 - ts->dt1);
+  ots->tend = ots->t6 + ts->t1;
+  ots->dtend = ots->dt6 + ts->dt1;
+  ots->invd = reciprocate(ots->dtend);
+}
+
 go_result go_traj_cj_stop(const go_traj_cj_spec * ts, go_real t,
 			  go_traj_cj_spec * pts)
 {
   go_traj_cj_spec ots;
   go_real id2;			/* incremental phase II distance */
   go_real id3;			/* incremental phase III distance */
-  go_real it4;			/* incremental phase IV time */
-  go_real id4;			/* incremental phase IV distance */
 
   if (t <= 0.) {
     ots.jt0 = ts->jt0;
@@ -674,16 +690,8 @@ go_result go_traj_cj_stop(const go_traj_cj_spec * ts, go_real t,
     /* null stage IV */
     ots.t4 = ts->t3;
     ots.dt4 = ts->dt3;
-    /* take off original stage IV for remaining stages */
-    it4 = ts->t4 - ts->t3;
-    id4 = ts->vt3 * it4;
-    ots.t5 = ts->t5 - it4;
-    ots.dt5 = ts->dt5 - id4;
-    ots.t6 = ts->t6 - it4;
-    ots.dt6 = ts->dt6 - id4;
-    ots.tend = ts->tend - it4;
-    ots.dtend = ts->dtend - id4;
-    ots.invd = reciprocate(ots.dtend);
+    /* remaining stages mirror the first */
+    cj_stop_mirror(ts, &ots);
   } else if (t < ts->t4) {
     /* stopping in stage IV */
     /* stages I, II and III unchanged */
@@ -699,17 +707,10 @@ go_result go_traj_cj_stop(const go_traj_cj_spec * ts, go_real t,
     ots.dt3 = ts->dt3;
     ots.vt3 = ts->vt3;
     /* adjusted stage IV */
-    it4 = ts->t4 - t;
-    id4 = ts->vt3 * it4;
     ots.t4 = t;
-    ots.dt4 = ts->dt4 - id4;
-    ots.t5 = ts->t5 - it4;
-    ots.dt5 = ts->dt5 - id4;
-    ots.t6 = ts->t6 - it4;
-    ots.dt6 = ts->dt6 - id4;
-    ots.tend = ts->tend - it4;
-    ots.dtend = ts->dtend - id4;
-    ots.invd = reciprocate(ots.dtend);
+    ots.dt4 = ts->dt3 + ts->vt3 * (t - ts->t3);
+    /* remaining stages mirror the first */
+    cj_stop_mirror(ts, &ots);
   } else {
     /* stopping in stage V, VI or VII-- leave alone */
     ots = *ts;
@@ -837,3 +838,340 @@ go_result go_traj_cj_interp(const go_traj_cj_spec * ts, go_real t,
   return GO_RESULT_OK;
 }
 
+
+/*!
+  \defgroup TRAJ_CJV Constant Jerk Profiles Between Speeds
+
+  The CJ profile above starts and ends at rest. When consecutive
+  motions are planned to flow through their junctions, each motion
+  instead starts at speed \a v0, ramps to a peak or cruise speed \a vp
+  and ramps down to an ending speed \a v1. Each ramp is the first (or
+  last) three phases of a CJ profile: a jerk phase, a constant
+  acceleration phase if the speed change is large enough to reach the
+  max accel \a a, and a de-jerk phase. Since the ramp is symmetric in
+  time, its distance is simply the average of the starting and ending
+  speeds times its duration.
+*/
+
+/*!
+  Computes the jerk time \a tj and constant accel time \a ta for a
+  ramp that changes speed by \a dv with max accel \a a and jerk \a j.
+  Returns the total time of the ramp.
+*/
+static go_real go_traj_ramp_times(go_real dv, go_real a, go_real j,
+				  go_real * tj, go_real * ta)
+{
+  if (dv <= 0.) {
+    *tj = 0., *ta = 0.;
+  } else if (dv * j > go_sq(a)) {
+    /* reaches max accel */
+    *tj = a / j;
+    *ta = dv / a - *tj;
+  } else {
+    *tj = sqrt(dv / j);
+    *ta = 0.;
+  }
+
+  return *tj + *tj + *ta;
+}
+
+go_real go_traj_ramp_distance(go_real v0, go_real v1, go_real a, go_real j)
+{
+  go_real tj, ta;
+
+  return 0.5 * (v0 + v1) * go_traj_ramp_times(fabs(v1 - v0), a, j, &tj, &ta);
+}
+
+go_real go_traj_ramp_reach(go_real d, go_real v, go_real vmax, go_real a, go_real j)
+{
+  go_real lo, hi, mid;
+  go_integer i;
+
+  if (vmax <= v) return vmax;
+  if (go_traj_ramp_distance(v, vmax, a, j) <= d) return vmax;
+
+  /* the ramp distance grows with the ending speed, so bisect for it,
+     keeping the lower bound so the result is always reachable */
+  for (i = 0, lo = v, hi = vmax; i < GO_TRAJ_RAMP_ITERATIONS; i++) {
+    mid = 0.5 * (lo + hi);
+    if (go_traj_ramp_distance(v, mid, a, j) <= d) lo = mid;
+    else hi = mid;
+  }
+
+  return lo;
+}
+
+/*
+  Interpolates a ramp starting at speed 'va' and changing by 'dv'
+  with sign 'sgn', at time 't' into the ramp.
+*/
+static void go_traj_ramp_interp(go_real va, go_real dv, go_real sgn,
+				go_real tj, go_real ta, go_real j,
+				go_real t, go_traj_interp_spec * ti)
+{
+  go_real ap;			/* peak accel */
+  go_real vj, dj;		/* speed, distance at end of jerk phase */
+  go_real vb;			/* speed at the end */
+  go_real T;			/* total time */
+  go_real r;
+
+  ap = j * tj;
+  T = tj + tj + ta;
+  vb = va + sgn * dv;
+
+  if (t < tj) {
+    ti->j = sgn * j;
+    ti->a = sgn * j * t;
+    ti->v = va + sgn * 0.5 * j * go_sq(t);
+    ti->d = va * t + sgn * (1. / 6.) * j * go_cub(t);
+  } else if (t < tj + ta) {
+    r = t - tj;
+    vj = va + sgn * 0.5 * ap * tj;
+    dj = va * tj + sgn * (1. / 6.) * j * go_cub(tj);
+    ti->j = 0.;
+    ti->a = sgn * ap;
+    ti->v = vj + sgn * ap * r;
+    ti->d = dj + vj * r + sgn * 0.5 * ap * go_sq(r);
+  } else {
+    r = T - t;
+    if (r < 0.) r = 0.;
+    ti->j = -sgn * j;
+    ti->a = sgn * j * r;
+    ti->v = vb - sgn * 0.5 * j * go_sq(r);
+    ti->d = 0.5 * (va + vb) * T - (vb * r - sgn * (1. / 6.) * j * go_cub(r));
+  }
+}
+
+static void go_traj_cjv_compute_the_rest(go_traj_cjv_spec * pts, go_real d)
+{
+  go_real dc;
+
+  pts->tr1 = go_traj_ramp_times(pts->vp - pts->v0, pts->a, pts->j, &pts->tj1, &pts->ta1);
+  pts->dr1 = 0.5 * (pts->v0 + pts->vp) * pts->tr1;
+  pts->tr2 = go_traj_ramp_times(pts->vp - pts->v1, pts->a, pts->j, &pts->tj2, &pts->ta2);
+  pts->dr2 = 0.5 * (pts->vp + pts->v1) * pts->tr2;
+
+  /* whatever distance is left over is covered at the cruise speed */
+  dc = d - pts->dr1 - pts->dr2;
+  if (dc < 0. || pts->vp <= 0.) dc = 0.;
+  pts->dc = pts->dr1 + dc;
+  pts->tc = pts->tr1 + (dc > 0. ? dc / pts->vp : 0.);
+  pts->tend = pts->tc + pts->tr2;
+  pts->dtend = pts->dc + pts->dr2;
+}
+
+go_result go_traj_cjv_compute(go_real d, go_real v0, go_real v,
+			      go_real v1, go_real a, go_real j,
+			      go_traj_cjv_spec * pts)
+{
+  go_real vlo, lo, hi, mid;
+  go_integer i;
+
+  if (d < 0. || v0 < 0. || v1 < 0. || v <= 0. || a <= 0. || j <= 0.) {
+    return GO_RESULT_ERROR;
+  }
+
+  pts->v0 = v0;
+  pts->v1 = v1;
+  pts->a = a;
+  pts->j = j;
+  pts->t0 = 0.;
+  pts->d0 = 0.;
+
+  vlo = v0 > v1 ? v0 : v1;
+  if (v < vlo) v = vlo;
+
+  if (go_traj_ramp_distance(v0, v, a, j) +
+      go_traj_ramp_distance(v, v1, a, j) <= d) {
+    /* we can reach the max speed, and cruise there */
+    pts->vp = v;
+  } else if (go_traj_ramp_distance(v0, vlo, a, j) +
+	     go_traj_ramp_distance(vlo, v1, a, j) > d + GO_REAL_EPSILON) {
+    /* we can't even get from 'v0' to 'v1' in this distance */
+    return GO_RESULT_ERROR;
+  } else {
+    /* bisect for the highest peak speed that fits */
+    for (i = 0, lo = vlo, hi = v; i < GO_TRAJ_RAMP_ITERATIONS; i++) {
+      mid = 0.5 * (lo + hi);
+      if (go_traj_ramp_distance(v0, mid, a, j) +
+	  go_traj_ramp_distance(mid, v1, a, j) <= d) lo = mid;
+      else hi = mid;
+    }
+    pts->vp = lo;
+  }
+
+  go_traj_cjv_compute_the_rest(pts, d);
+
+  return GO_RESULT_OK;
+}
+
+go_result go_traj_cjv_stop(const go_traj_cjv_spec * ts, go_real t,
+			   go_traj_cjv_spec * pts)
+{
+  go_traj_interp_spec ti;
+  go_traj_cjv_spec ots;
+
+  if (t >= ts->tend) {
+    /* we've already stopped */
+    *pts = *ts;
+    return GO_RESULT_OK;
+  }
+
+  go_traj_cjv_interp(ts, t, &ti);
+
+  /* ramp down from the speed we're at now, starting now */
+  ots.v0 = ti.v;
+  ots.vp = ti.v;
+  ots.v1 = 0.;
+  ots.a = ts->a;
+  ots.j = ts->j;
+  go_traj_cjv_compute_the_rest(&ots, go_traj_ramp_distance(ti.v, 0., ts->a, ts->j));
+  ots.t0 = t;
+  ots.d0 = ti.d;
+  ots.tend += t;
+  ots.dtend += ti.d;
+  *pts = ots;
+
+  return GO_RESULT_OK;
+}
+
+go_result go_traj_cjv_interp(const go_traj_cjv_spec * ts, go_real t,
+			     go_traj_interp_spec * ti)
+{
+  if (t >= ts->tend) {
+    ti->j = 0.;
+    ti->a = 0.;
+    ti->v = ts->v1;
+    ti->d = ts->dtend;
+  } else {
+    t -= ts->t0;
+    if (t < 0.) t = 0.;
+    if (t < ts->tr1) {
+      go_traj_ramp_interp(ts->v0, ts->vp - ts->v0, 1., ts->tj1, ts->ta1, ts->j, t, ti);
+    } else if (t < ts->tc) {
+      ti->j = 0.;
+      ti->a = 0.;
+      ti->v = ts->vp;
+      ti->d = ts->dr1 + ts->vp * (t - ts->tr1);
+    } else {
+      go_traj_ramp_interp(ts->vp, ts->vp - ts->v1, -1., ts->tj2, ts->ta2, ts->j, t - ts->tc, ti);
+      ti->d += ts->dc;
+    }
+    ti->d += ts->d0;
+  }
+
+  if (ts->dtend <= 0.) {
+    ti->s = 1.;
+  } else {
+    ti->s = ti->d / ts->dtend;
+  }
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Adds a phase to 'ps' that starts at time 't' with distance 'd',
+  speed 'v', accel 'a' and jerk 'j'. The phase takes over from the
+  last one no sooner than it started, as the interps only check for
+  later phases once earlier ones are done. Rounding can leave phases
+  of zero or even negative length, so the new phase may replace the
+  last, and is shifted to start where the last did.
+*/
+static void go_traj_poly_add(go_traj_poly_spec * ps, go_real t,
+			     go_real d, go_real v, go_real a, go_real j)
+{
+  go_integer n = ps->n;
+  go_real r;
+
+  r = 0.;
+  if (n > 0 && t <= ps->t[n - 1]) {
+    n--;
+    r = ps->t[n] - t;
+    t = ps->t[n];
+  }
+  if (n >= GO_TRAJ_POLY_MAX) return;
+
+  ps->t[n] = t;
+  ps->c[n][0] = d + r * (v + r * ((1. / 2.) * a + r * (1. / 6.) * j));
+  ps->c[n][1] = v + r * (a + r * (1. / 2.) * j);
+  ps->c[n][2] = (1. / 2.) * (a + r * j);
+  ps->c[n][3] = (1. / 6.) * j;
+  ps->n = n + 1;
+}
+
+/* ends the last phase added to 'ps' at time 't' with distance 'd' */
+static void go_traj_poly_end(go_traj_poly_spec * ps, go_real t, go_real d)
+{
+  if (ps->n > 0 && t <= ps->t[ps->n - 1]) ps->n--;
+  ps->t[ps->n] = t;
+  ps->dtend = d;
+}
+
+go_result go_traj_cj_poly(const go_traj_cj_spec * ts,
+			  go_traj_poly_spec * ps)
+{
+  ps->n = 0;
+
+  go_traj_poly_add(ps, 0., 0., 0., 0., ts->jt0);
+  go_traj_poly_add(ps, ts->t1, ts->dt1, ts->vt1, ts->at1, 0.);
+  go_traj_poly_add(ps, ts->t2, ts->dt2, ts->vt2, ts->at1, -ts->jt0);
+  go_traj_poly_add(ps, ts->t3, ts->dt3, ts->vt3, 0., 0.);
+  go_traj_poly_add(ps, ts->t4, ts->dt4, ts->vt3, 0., -ts->jt0);
+  go_traj_poly_add(ps, ts->t5, ts->dt5, ts->vt2, -ts->at1, 0.);
+  go_traj_poly_add(ps, ts->t6, ts->dt6, ts->vt1, -ts->at1, ts->jt0);
+  go_traj_poly_end(ps, ts->tend, ts->dtend);
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Adds the phases of a ramp to 'ps', starting at time 't' with
+  distance 'd' and speed 'va', and changing speed by 'dv' with sign
+  'sgn', as go_traj_ramp_interp() does.
+*/
+static void go_traj_poly_add_ramp(go_traj_poly_spec * ps, go_real t,
+				  go_real d, go_real va, go_real sgn,
+				  go_real tj, go_real ta, go_real j)
+{
+  go_real ap;			/* peak accel */
+  go_real vj, dj;		/* speed, distance at end of jerk phase */
+
+  ap = sgn * j * tj;
+  vj = va + 0.5 * ap * tj;
+  dj = d + va * tj + sgn * (1. / 6.) * j * go_cub(tj);
+
+  go_traj_poly_add(ps, t, d, va, 0., sgn * j);
+  go_traj_poly_add(ps, t + tj, dj, vj, ap, 0.);
+  go_traj_poly_add(ps, t + tj + ta, dj + vj * ta + 0.5 * ap * go_sq(ta),
+		   vj + ap * ta, ap, -sgn * j);
+}
+
+go_result go_traj_cjv_poly(const go_traj_cjv_spec * ts,
+			   go_traj_poly_spec * ps)
+{
+  ps->n = 0;
+
+  /* before 't0' the profile holds at 'd0', which the first phase
+     gives since times before it are evaluated at its start */
+  go_traj_poly_add_ramp(ps, ts->t0, ts->d0, ts->v0, 1., ts->tj1, ts->ta1, ts->j);
+  go_traj_poly_add(ps, ts->t0 + ts->tr1, ts->d0 + ts->dr1, ts->vp, 0., 0.);
+  go_traj_poly_add_ramp(ps, ts->t0 + ts->tc, ts->d0 + ts->dc, ts->vp, -1., ts->tj2, ts->ta2, ts->j);
+  go_traj_poly_end(ps, ts->tend, ts->dtend);
+
+  return GO_RESULT_OK;
+}
+
+go_real go_traj_poly_eval(const go_traj_poly_spec * ps, go_real t)
+{
+  const go_real * c;
+  go_integer i;
+
+  if (t < ps->t[0]) t = ps->t[0];
+  if (t >= ps->t[ps->n]) return ps->dtend;
+
+  for (i = 0; t >= ps->t[i + 1]; i++);
+  c = ps->c[i];
+  t -= ps->t[i];
+
+  return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+}
@@ -49,6 +49,36 @@ typedef struct {
   go_real s, d, v, a, j;
 } go_traj_interp_spec;
 
+/*
+  The CJV profile ramps from a starting speed to a peak speed, cruises,
+  and ramps to an ending speed, with each ramp following the jerk and
+  accel phases of the CJ profile. Times and distances are relative to
+  the start of each ramp or cruise, offset by 't0' and 'd0' if the
+  profile has been stopped.
+*/
+typedef struct {
+  go_real v0;			/*< starting speed */
+  go_real vp;			/*< peak, or cruise, speed */
+  go_real v1;			/*< ending speed */
+  go_real a;			/*< max accel */
+  go_real j;			/*< jerk */
+  go_real tj1;			/*< jerk time of the ramp up */
+  go_real ta1;			/*< const accel time of the ramp up */
+  go_real tr1;			/*< total time of the ramp up */
+  go_real dr1;			/*< distance of the ramp up */
+  go_real tc;			/*< cumulative time at end of cruise */
+  go_real dc;			/*< cumulative distance at end of cruise */
+  go_real tj2;			/*< jerk time of the ramp down */
+  go_real ta2;			/*< const accel time of the ramp down */
+  go_real tr2;			/*< total time of the ramp down */
+  go_real dr2;			/*< distance of the ramp down */
+  go_real t0;			/*< time offset of the profile */
+  go_real d0;			/*< distance offset of the profile */
+  go_real tend;			/*< total time for motion */
+  go_real dtend;		/*< total distance for motion */
+} go_traj_cjv_spec;
+
+
 /*
   go_traj_ca_generate() takes an accel value, and intervals for the accel period
   and cruise period, and fills in the go_traj_ca_spec with the
@@ -158,6 +188,99 @@ extern go_result go_traj_cj_extend(const go_traj_cj_spec * ts, go_real t,
 extern go_result go_traj_cj_interp(const go_traj_cj_spec * ts, go_real t,
 				   go_traj_interp_spec * ti);
 
+/* how many bisections are done when searching for ramp speeds */
+#define GO_TRAJ_RAMP_ITERATIONS 40
+
+/*
+  go_traj_ramp_distance() returns the distance covered by a constant-jerk
+  ramp from speed 'v0' to speed 'v1', with max accel 'a' and jerk 'j'.
+*/
+
+extern go_real go_traj_ramp_distance(go_real v0, go_real v1,
+				     go_real a, go_real j);
+
+/*
+  go_traj_ramp_reach() returns the highest speed, no more than 'vmax',
+  that can be reached from speed 'v' within distance 'd'. Since ramps
+  are symmetric, this is also the highest speed from which 'v' can be
+  reached within 'd'. If 'vmax' is below 'v', 'vmax' is returned.
+*/
+
+extern go_real go_traj_ramp_reach(go_real d, go_real v, go_real vmax,
+				  go_real a, go_real j);
+
+/*
+  go_traj_cjv_compute() takes values for distance 'd' to move, starting
+  speed 'v0', max speed 'v', ending speed 'v1', max accel 'a' and
+  jerk 'j', and fills in the go_traj_cjv_spec with the interval
+  parameters. It returns GO_RESULT_ERROR if 'v1' can't be reached from
+  'v0' within 'd'.
+*/
+
+extern go_result go_traj_cjv_compute(go_real d, go_real v0, go_real v,
+				     go_real v1, go_real a, go_real j,
+				     go_traj_cjv_spec * pts);
+
+/*
+  go_traj_cjv_stop() takes a time 't' for the desired time to begin
+  stopping, and recomputes the profile to ramp down to rest from the
+  speed at that time.
+*/
+
+extern go_result go_traj_cjv_stop(const go_traj_cjv_spec * ts, go_real t,
+				  go_traj_cjv_spec * pts);
+
+/*
+  go_traj_cjv_interp() takes a go_traj_cjv_spec and interpolates the
+  d-v-a-j values for the given time t, storing the d-v-a-j values in ti.
+*/
+
+extern go_result go_traj_cjv_interp(const go_traj_cjv_spec * ts, go_real t,
+				    go_traj_interp_spec * ti);
+
+/*!
+  \defgroup TRAJ_POLY Compiled Profiles
+
+  The CJ and CJV profiles above are compact to store but take a
+  search through their phases and a bit of arithmetic on the phase
+  parameters each time they're interpolated. For interpolating every
+  cycle, either can be compiled into a go_traj_poly_spec, the same
+  profile expressed as up to GO_TRAJ_POLY_MAX cubic polynomials in the
+  time into each phase, so that each interpolation is just a few
+  compares and a polynomial evaluation.
+*/
+
+#define GO_TRAJ_POLY_MAX 7
+
+typedef struct {
+  go_integer n;			/*< number of phases */
+  /*! phase i runs from t[i] to t[i+1] */
+  go_real t[GO_TRAJ_POLY_MAX + 1];
+  /*! in phase i, d = c[i][0] + r*(c[i][1] + r*(c[i][2] + r*c[i][3])),
+    r = t - t[i] */
+  go_real c[GO_TRAJ_POLY_MAX][4];
+  go_real dtend;		/*< total distance for motion */
+} go_traj_poly_spec;
+
+/*
+  go_traj_cj_poly() compiles the CJ profile 'ts' into 'ps'.
+*/
+extern go_result go_traj_cj_poly(const go_traj_cj_spec * ts,
+				 go_traj_poly_spec * ps);
+
+/*
+  go_traj_cjv_poly() compiles the CJV profile 'ts' into 'ps'.
+*/
+extern go_result go_traj_cjv_poly(const go_traj_cjv_spec * ts,
+				  go_traj_poly_spec * ps);
+
+/*
+  go_traj_poly_eval() returns the distance along the compiled profile
+  'ps' at time 't', the same as the 'd' that go_traj_cj,cjv_interp()
+  would give for the profile it was compiled from.
+*/
+extern go_real go_traj_poly_eval(const go_traj_poly_spec * ps, go_real t);
+
 #if 0
 {
 #endif
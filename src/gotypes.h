@@ -169,6 +169,15 @@ enum {
 
   FLT_MIN = 1.175494e-38, FLT_EPSILON 1.192093e-07
   DBL_MIN = 2.225074e-308, DBL_EPSILON 2.220446e-16
+
+  GO_REAL_EPSILON is about the square root of these, and is the
+  tolerance for general quantities and for singularity tests.
+  GO_TRAN_EPSILON and GO_ROT_EPSILON are the tolerances for lengths in
+  meters and angles in radians, for the GO_TRAN,ROT_CLOSE,SMALL
+  macros in gomath.h. With float go_reals these are tighter than
+  GO_REAL_EPSILON, since a float workspace a few meters across still
+  resolves to a micron and a fraction of an arc second, and 1.0e-4 is
+  a tenth of a millimeter.
 */
 
 #if defined(GO_REAL_FLOAT)
@@ -178,6 +187,8 @@ extern int go_real_float;
 #define GO_REAL_MIN FLT_MIN
 #define GO_REAL_MAX FLT_MAX
 #define GO_REAL_EPSILON (1.0e-4)
+#define GO_TRAN_EPSILON (1.0e-5)
+#define GO_ROT_EPSILON (1.0e-5)
 #define GO_INF FLT_MAX
 
 #elif defined(GO_REAL_LONG_DOUBLE)
@@ -187,6 +198,8 @@ extern int go_real_long_double;
 #define GO_REAL_MIN DBL_MIN
 #define GO_REAL_MAX DBL_MAX
 #define GO_REAL_EPSILON (1.0e-7)
+#define GO_TRAN_EPSILON GO_REAL_EPSILON
+#define GO_ROT_EPSILON GO_REAL_EPSILON
 #define GO_INF DBL_MAX
 
 #else
@@ -197,6 +210,8 @@ extern int go_real_double;
 #define GO_REAL_MIN DBL_MIN
 #define GO_REAL_MAX DBL_MAX
 #define GO_REAL_EPSILON (1.0e-7)
+#define GO_TRAN_EPSILON GO_REAL_EPSILON
+#define GO_ROT_EPSILON GO_REAL_EPSILON
 #define GO_INF DBL_MAX
 #endif
 
@@ -9,40 +9,33 @@
   See NIST Administration Manual 4.09.07 b and Appendix I. 
 */
 
-#include <stdlib.h>		/* malloc, free */
+#include <stdlib.h>		/* malloc */
 #include "interplist.h"
 
 int interplist_put(interplist_struct *list, interplist_type val)
 {
-  interplist_entry *entry;
-
-  entry = malloc(sizeof(*entry));
-
-  entry->val = val;
-  entry->next = NULL;
-  if (list->head == NULL) {
-    list->head = entry;
-  } else {
-    list->tail->next = entry;
+  if (list->howmany >= list->size) {
+    list->overflows++;
+    return -1;
   }
-  list->tail = entry;
+
+  list->ring[(list->get + list->howmany) % list->size] = val;
   list->howmany++;
+  if (list->howmany > list->high_water) {
+    list->high_water = list->howmany;
+  }
 
   return 0;
 }
 
 int interplist_get(interplist_struct *list, interplist_type *val)
 {
-  interplist_entry *next;
-
-  if (NULL == list->head) {
+  if (0 == list->howmany) {
     return -1;
   }
 
-  next = list->head->next;
-  *val = list->head->val;
-  free(list->head);
-  list->head = next;
+  *val = list->ring[list->get];
+  list->get = (list->get + 1) % list->size;
   list->howmany--;
 
   return 0;
@@ -50,11 +43,11 @@ int interplist_get(interplist_struct *list, interplist_type *val)
 
 int interplist_peek(interplist_struct *list, interplist_type *val)
 {
-  if (NULL == list->head) {
+  if (0 == list->howmany) {
     return -1;
   }
 
-  *val = list->head->val;
+  *val = list->ring[list->get];
 
   return 0;
 }
@@ -64,22 +57,38 @@ unsigned int interplist_howmany(interplist_struct *list)
   return list->howmany;
 }
 
-int interplist_init(interplist_struct *list)
+int interplist_find(interplist_struct *list, go_integer type)
 {
-  list->head = NULL;
-  list->tail = NULL;
+  unsigned int i;
+
+  for (i = 0; i < list->howmany; i++) {
+    if (type == list->ring[(list->get + i) % list->size].type) return 0;
+  }
+
+  return -1;
+}
+
+int interplist_init(interplist_struct *list, unsigned int size)
+{
+  list->ring = NULL;
+  list->size = 0;
+  list->get = 0;
+  list->howmany = 0;
+  list->high_water = 0;
+  list->overflows = 0;
+
+  if (0 == size) return -1;
+  list->ring = malloc(size * sizeof(*list->ring));
+  if (NULL == list->ring) return -1;
+  list->size = size;
 
   return 0;
 }
 
 int interplist_clear(interplist_struct *list)
 {
-  interplist_type val;
-  int retval;
-
-  do {
-    retval = interplist_get(list, &val);
-  } while (retval == 0);
+  list->get = 0;
+  list->howmany = 0;
 
   return 0;
 }
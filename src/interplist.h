@@ -23,26 +23,41 @@ extern "C" {
 }
 #endif
 
+/*
+  The interp list holds only what Task needs of each canonical command,
+  not the whole command message, so these are the per-type payloads.
+*/
+
+typedef struct {
+  go_integer id;		/*< which tool type is targeted */
+  tool_cmd_on on;		/*< for TOOL_CMD_ON_TYPE */
+} interplist_tool;
+
 typedef struct {
   go_integer type;
   union {
-    task_cmd_struct task_cmd;
-    traj_cmd_struct traj_cmd;
-    tool_cmd_struct tool_cmd;
+    task_exec_delay delay;	/*< for TASK_EXEC_DELAY_TYPE */
+    traj_cmd_move_world move_world; /*< for TRAJ_CMD_MOVE_WORLD_TYPE */
+    interplist_tool tool;	/*< for TOOL_CMD_ON,OFF_TYPE */
   } u;
 } interplist_type;
 
-typedef struct _interplist_entry {
-  interplist_type val;
-  struct _interplist_entry *next;
-} interplist_entry;
-
+/*
+  The list is a fixed-size ring of entries allocated once, in
+  interplist_init. Puts to a full list are dropped and counted in
+  'overflows', and 'high_water' is the most entries it's ever held,
+  for sizing it.
+*/
 typedef struct {
-  interplist_entry *head;
-  interplist_entry *tail;
+  interplist_type *ring;
+  unsigned int size;
+  unsigned int get;		/*< where the next entry comes from */
   unsigned int howmany;
+  unsigned int high_water;
+  unsigned int overflows;
 } interplist_struct;
 
+/* returns 0 if put, or -1 if the list is full */
 extern int interplist_put(interplist_struct *list, interplist_type val);
 
 extern int interplist_get(interplist_struct *list, interplist_type *val);
@@ -51,7 +66,11 @@ extern int interplist_peek(interplist_struct *list, interplist_type *val);
 
 extern unsigned int interplist_howmany(interplist_struct *list);
 
-extern int interplist_init(interplist_struct *list);
+/* returns 0 if an entry of 'type' is on the list, else -1 */
+extern int interplist_find(interplist_struct *list, go_integer type);
+
+/* returns 0 if room for 'size' entries could be allocated, else -1 */
+extern int interplist_init(interplist_struct *list, unsigned int size);
 
 extern int interplist_clear(interplist_struct *list);
 
@@ -9,6 +9,8 @@
   See NIST Administration Manual 4.09.07 b and Appendix I. 
 */
 
+#include <stddef.h>		/* NULL */
+#include <math.h>		/* fabs, floor */
 #include "gotypes.h"		/* go_result, go_integer */
 #include "gomath.h"		/* go_pose */
 #include "gokin.h"		/* go_kin_fwd_flags */
@@ -22,20 +24,297 @@
 #include "tripointkins.h"
 #include "spheristkins.h"
 #include "robochkins.h"
+#ifdef GO_KIN_GENERATED
+#include "gokingen.h"		/* GO_KIN_GENERATED_OPS */
+#endif
 
-static enum {
-  USE_TRIVKINS = 1,
-  USE_GENHEXKINS,
-  USE_GENSERKINS,
-  USE_FANUCKINS,
-  USE_FANUC_LRMATE200ID_KINS,
-  USE_PUMAKINS,
-  USE_SCARAKINS,
-  USE_TRIPOINTKINS,
-  USE_SPHERISTKINS,
-  USE_THREE21KINS,
-  USE_ROBOCHKINS
-} go_kin_which = USE_TRIVKINS;
+/*
+  The function tables for each kind. Some kinematics take a pointer
+  to their own structure rather than void, so they're cast here; the
+  blob is passed through to them just the same.
+*/
+
+#define KIN_FUNC(type, func) ((type) (func))
+
+typedef go_result (*kin_init_func)(void *);
+typedef go_integer (*kin_num_joints_func)(void *);
+typedef go_result (*kin_fwd_func)(void *, const go_real *, go_pose *);
+typedef go_result (*kin_inv_func)(void *, const go_pose *, go_real *);
+typedef go_kin_type (*kin_get_type_func)(void *);
+typedef go_result (*kin_parameters_func)(void *, go_link *, go_integer);
+typedef go_result (*kin_jac_inv_func)(void *, const go_pose *, const go_vel *, const go_real *, go_real *);
+typedef go_result (*kin_jac_fwd_func)(void *, const go_real *, const go_real *, const go_pose *, go_vel *);
+typedef go_result (*kin_set_flags_func)(void *, go_flag, go_flag);
+typedef go_result (*kin_get_flags_func)(void *, go_flag *, go_flag *);
+typedef go_integer (*kin_iterations_func)(void *);
+typedef go_result (*kin_fwd_batch_func)(void *, go_integer, go_real **, go_pose_batch *, go_result *);
+typedef go_result (*kin_inv_batch_func)(void *, go_integer, const go_pose_batch *, go_real **, go_result *);
+typedef go_result (*kin_inv_all_func)(void *, const go_pose *, go_real *, go_flag *, go_integer *);
+
+static const go_kin_ops triv_kin_ops = {
+  triv_kin_get_name,
+  triv_kin_size,
+  triv_kin_init,
+  triv_kin_num_joints,
+  triv_kin_fwd,
+  triv_kin_inv,
+  triv_kin_get_type,
+  triv_kin_set_parameters,
+  triv_kin_get_parameters,
+  triv_kin_jac_inv,
+  triv_kin_jac_fwd,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  triv_kin_fwd_batch,
+  triv_kin_inv_batch,
+  NULL
+};
+
+static const go_kin_ops genhex_kin_ops = {
+  genhex_kin_get_name,
+  genhex_kin_size,
+  genhex_kin_init,
+  genhex_kin_num_joints,
+  genhex_kin_fwd,
+  genhex_kin_inv,
+  genhex_kin_get_type,
+  genhex_kin_set_parameters,
+  genhex_kin_get_parameters,
+  genhex_kin_jac_inv,
+  genhex_kin_jac_fwd,
+  NULL,
+  NULL,
+  KIN_FUNC(kin_iterations_func, genhex_kin_fwd_iterations),
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+static const go_kin_ops genser_kin_ops = {
+  genser_kin_get_name,
+  genser_kin_size,
+  genser_kin_init,
+  genser_kin_num_joints,
+  genser_kin_fwd,
+  genser_kin_inv,
+  genser_kin_get_type,
+  genser_kin_set_parameters,
+  genser_kin_get_parameters,
+  genser_kin_jac_inv,
+  genser_kin_jac_fwd,
+  NULL,
+  NULL,
+  NULL,
+  KIN_FUNC(kin_iterations_func, genser_kin_inv_iterations),
+  genser_kin_fwd_batch,
+  genser_kin_inv_batch,
+  NULL
+};
+
+static const go_kin_ops fanuc_kin_ops = {
+  fanuc_kin_get_name,
+  fanuc_kin_size,
+  KIN_FUNC(kin_init_func, fanuc_kin_init),
+  KIN_FUNC(kin_num_joints_func, fanuc_kin_num_joints),
+  KIN_FUNC(kin_fwd_func, fanuc_kin_fwd),
+  KIN_FUNC(kin_inv_func, fanuc_kin_inv),
+  KIN_FUNC(kin_get_type_func, fanuc_kin_get_type),
+  KIN_FUNC(kin_parameters_func, fanuc_kin_set_parameters),
+  KIN_FUNC(kin_parameters_func, fanuc_kin_get_parameters),
+  KIN_FUNC(kin_jac_inv_func, fanuc_kin_jac_inv),
+  KIN_FUNC(kin_jac_fwd_func, fanuc_kin_jac_fwd),
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  KIN_FUNC(kin_fwd_batch_func, fanuc_kin_fwd_batch),
+  KIN_FUNC(kin_inv_batch_func, fanuc_kin_inv_batch),
+  KIN_FUNC(kin_inv_all_func, fanuc_kin_inv_all)
+};
+
+static const go_kin_ops fanuc_lrmate200id_kin_ops = {
+  fanuc_lrmate200id_kin_get_name,
+  fanuc_lrmate200id_kin_size,
+  KIN_FUNC(kin_init_func, fanuc_lrmate200id_kin_init),
+  KIN_FUNC(kin_num_joints_func, fanuc_lrmate200id_kin_num_joints),
+  KIN_FUNC(kin_fwd_func, fanuc_lrmate200id_kin_fwd),
+  KIN_FUNC(kin_inv_func, fanuc_lrmate200id_kin_inv),
+  KIN_FUNC(kin_get_type_func, fanuc_lrmate200id_kin_get_type),
+  KIN_FUNC(kin_parameters_func, fanuc_lrmate200id_kin_set_parameters),
+  KIN_FUNC(kin_parameters_func, fanuc_lrmate200id_kin_get_parameters),
+  KIN_FUNC(kin_jac_inv_func, fanuc_lrmate200id_kin_jac_inv),
+  KIN_FUNC(kin_jac_fwd_func, fanuc_lrmate200id_kin_jac_fwd),
+  KIN_FUNC(kin_set_flags_func, fanuc_lrmate200id_kin_set_flags),
+  KIN_FUNC(kin_get_flags_func, fanuc_lrmate200id_kin_get_flags),
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  KIN_FUNC(kin_inv_all_func, fanuc_lrmate200id_kin_inv_all)
+};
+
+static const go_kin_ops puma_kin_ops = {
+  puma_kin_get_name,
+  puma_kin_size,
+  puma_kin_init,
+  puma_kin_num_joints,
+  puma_kin_fwd,
+  puma_kin_inv,
+  puma_kin_get_type,
+  puma_kin_set_parameters,
+  puma_kin_get_parameters,
+  puma_kin_jac_inv,
+  puma_kin_jac_fwd,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  puma_kin_fwd_batch,
+  puma_kin_inv_batch,
+  puma_kin_inv_all
+};
+
+static const go_kin_ops scara_kin_ops = {
+  scara_kin_get_name,
+  scara_kin_size,
+  scara_kin_init,
+  scara_kin_num_joints,
+  scara_kin_fwd,
+  scara_kin_inv,
+  scara_kin_get_type,
+  scara_kin_set_parameters,
+  scara_kin_get_parameters,
+  scara_kin_jac_inv,
+  scara_kin_jac_fwd,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  scara_kin_fwd_batch,
+  scara_kin_inv_batch,
+  NULL
+};
+
+static const go_kin_ops tripoint_kin_ops = {
+  tripoint_kin_get_name,
+  tripoint_kin_size,
+  tripoint_kin_init,
+  tripoint_kin_num_joints,
+  tripoint_kin_fwd,
+  tripoint_kin_inv,
+  tripoint_kin_get_type,
+  tripoint_kin_set_parameters,
+  tripoint_kin_get_parameters,
+  tripoint_kin_jac_inv,
+  tripoint_kin_jac_fwd,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+static const go_kin_ops spherist_kin_ops = {
+  spherist_kin_get_name,
+  spherist_kin_size,
+  spherist_kin_init,
+  spherist_kin_num_joints,
+  spherist_kin_fwd,
+  spherist_kin_inv,
+  spherist_kin_get_type,
+  spherist_kin_set_parameters,
+  spherist_kin_get_parameters,
+  spherist_kin_jac_inv,
+  spherist_kin_jac_fwd,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+static const go_kin_ops three21_kin_ops = {
+  three21_kin_get_name,
+  three21_kin_size,
+  KIN_FUNC(kin_init_func, three21_kin_init),
+  KIN_FUNC(kin_num_joints_func, three21_kin_num_joints),
+  KIN_FUNC(kin_fwd_func, three21_kin_fwd),
+  KIN_FUNC(kin_inv_func, three21_kin_inv),
+  KIN_FUNC(kin_get_type_func, three21_kin_get_type),
+  KIN_FUNC(kin_parameters_func, three21_kin_set_parameters),
+  KIN_FUNC(kin_parameters_func, three21_kin_get_parameters),
+  KIN_FUNC(kin_jac_inv_func, three21_kin_jac_inv),
+  KIN_FUNC(kin_jac_fwd_func, three21_kin_jac_fwd),
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  KIN_FUNC(kin_inv_all_func, three21_kin_inv_all)
+};
+
+static const go_kin_ops roboch_kin_ops = {
+  roboch_kin_get_name,
+  roboch_kin_size,
+  roboch_kin_init,
+  roboch_kin_num_joints,
+  roboch_kin_fwd,
+  roboch_kin_inv,
+  roboch_kin_get_type,
+  roboch_kin_set_parameters,
+  roboch_kin_get_parameters,
+  roboch_kin_jac_inv,
+  roboch_kin_jac_fwd,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+static const go_kin_ops * const go_kin_all[] = {
+  &triv_kin_ops,
+  &genhex_kin_ops,
+  &genser_kin_ops,
+  &fanuc_kin_ops,
+  &fanuc_lrmate200id_kin_ops,
+  &puma_kin_ops,
+  &scara_kin_ops,
+  &tripoint_kin_ops,
+  &spherist_kin_ops,
+  &three21_kin_ops,
+  &roboch_kin_ops
+#ifdef GO_KIN_GENERATED
+  /* those made by gokingen for particular robots */
+  , GO_KIN_GENERATED_OPS
+#endif
+};
+
+/* what go_kin_size() and go_kin_init() are for */
+static const go_kin_ops * go_kin_selected = &triv_kin_ops;
+
+/*
+  The blob is the function table pointer followed by the kinematics'
+  own structure. The union keeps that structure aligned for any real
+  number it holds.
+*/
+typedef union {
+  const go_kin_ops * ops;
+  double align;
+} go_kin_head;
+
+#define KIN_OPS(kins) (((go_kin_head *) (kins))->ops)
+#define KIN_IMPL(kins) ((void *) (((go_kin_head *) (kins)) + 1))
 
 static go_integer strmatch(const char * a, const char * b)
 {
@@ -47,291 +326,270 @@ static go_integer strmatch(const char * a, const char * b)
 
 go_result go_kin_select(const char * name)
 {
-  if (strmatch(name, triv_kin_get_name())) {
-    go_kin_which = USE_TRIVKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, genhex_kin_get_name())) {
-    go_kin_which = USE_GENHEXKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, genser_kin_get_name())) {
-    go_kin_which = USE_GENSERKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, fanuc_kin_get_name())) {
-    go_kin_which = USE_FANUCKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, fanuc_lrmate200id_kin_get_name())) {
-    go_kin_which = USE_FANUC_LRMATE200ID_KINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, puma_kin_get_name())) {
-    go_kin_which = USE_PUMAKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, scara_kin_get_name())) {
-    go_kin_which = USE_SCARAKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, tripoint_kin_get_name())) {
-    go_kin_which = USE_TRIPOINTKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, spherist_kin_get_name())) {
-    go_kin_which = USE_SPHERISTKINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, three21_kin_get_name())) {
-    go_kin_which = USE_THREE21KINS;
-    return GO_RESULT_OK;
-  }
-  if (strmatch(name, roboch_kin_get_name())) {
-    go_kin_which = USE_ROBOCHKINS;
-    return GO_RESULT_OK;
+  go_integer t;
+
+  for (t = 0; t < (go_integer) (sizeof(go_kin_all) / sizeof(*go_kin_all)); t++) {
+    if (strmatch(name, go_kin_all[t]->get_name())) {
+      go_kin_selected = go_kin_all[t];
+      return GO_RESULT_OK;
+    }
   }
 
-  go_kin_which = USE_TRIVKINS;
+  go_kin_selected = &triv_kin_ops;
   return GO_RESULT_ERROR;
 }
 
 go_integer go_kin_size(void)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_size();
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_size();
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_size();
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_size();
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_size();
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_size();
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_size();
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_size();
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_size();
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_size();
-
-  return triv_kin_size();
+  return (go_integer) sizeof(go_kin_head) + go_kin_selected->size();
 }
 
 go_result go_kin_init(void * kins) 
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_init(kins);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_init(kins);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_init(kins);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_init(kins);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_init(kins);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_init(kins);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_init(kins);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_init(kins);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_init(kins);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_init(kins);
-
-  return triv_kin_init(kins);
+  KIN_OPS(kins) = go_kin_selected;
+
+  return go_kin_selected->init(KIN_IMPL(kins));
 }
 
 const char * go_kin_get_name(void)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_get_name();
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_get_name();
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_get_name();
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_get_name();
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_get_name();
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_get_name();
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_get_name();
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_get_name();
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_get_name();
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_get_name();
-
-  return triv_kin_get_name();
+  return go_kin_selected->get_name();
+}
+
+const char * go_kin_get_instance_name(void * kins)
+{
+  return KIN_OPS(kins)->get_name();
+}
+
+void * go_kin_impl(void * kins)
+{
+  return KIN_IMPL(kins);
 }
 
 go_integer go_kin_num_joints(void * kins)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_num_joints(kins);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_num_joints(kins);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_num_joints(kins);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_num_joints(kins);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_num_joints(kins);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_num_joints(kins);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_num_joints(kins);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_num_joints(kins);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_num_joints(kins);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_num_joints(kins);
-
-  return triv_kin_num_joints(kins);
+  return KIN_OPS(kins)->num_joints(KIN_IMPL(kins));
 }
 
 go_result go_kin_fwd(void * kins,
 		     const go_real *joint,
 		     go_pose * world)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_fwd(kins, joint, world);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_fwd(kins, joint, world);
-
-  return triv_kin_fwd(kins, joint, world);
+  return KIN_OPS(kins)->fwd(KIN_IMPL(kins), joint, world);
 }
 
 go_result go_kin_inv(void * kins,
 		     const go_pose * world,
 		     go_real *joint)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_inv(kins, world, joint);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_inv(kins, world, joint);
-
-  return triv_kin_inv(kins, world, joint);
+  return KIN_OPS(kins)->inv(KIN_IMPL(kins), world, joint);
+}
+
+void go_pose_batch_get(const go_pose_batch * batch, go_integer n, go_pose * pose)
+{
+  pose->tran.x = batch->x[n];
+  pose->tran.y = batch->y[n];
+  pose->tran.z = batch->z[n];
+  pose->rot.s = batch->s[n];
+  pose->rot.x = batch->i[n];
+  pose->rot.y = batch->j[n];
+  pose->rot.z = batch->k[n];
+}
+
+void go_pose_batch_put(go_pose_batch * batch, go_integer n, const go_pose * pose)
+{
+  batch->x[n] = pose->tran.x;
+  batch->y[n] = pose->tran.y;
+  batch->z[n] = pose->tran.z;
+  batch->s[n] = pose->rot.s;
+  batch->i[n] = pose->rot.x;
+  batch->j[n] = pose->rot.y;
+  batch->k[n] = pose->rot.z;
+}
+
+/*
+  The batch fallbacks, for kinematics with no batch functions of
+  their own, run each item through the scalar call.
+*/
+
+static go_result kin_fwd_batch_each(void * kins,
+				    go_integer num,
+				    go_real ** joints,
+				    go_pose_batch * world,
+				    go_result * results)
+{
+  go_real joint[GO_KIN_BATCH_JOINTS];
+  go_pose pose;
+  go_integer joint_num;
+  go_integer n, t;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  joint_num = go_kin_num_joints(kins);
+  if (joint_num > GO_KIN_BATCH_JOINTS) return GO_RESULT_BAD_ARGS;
+
+  for (n = 0; n < num; n++) {
+    for (t = 0; t < joint_num; t++) joint[t] = joints[t][n];
+    retval = go_kin_fwd(kins, joint, &pose);
+    if (GO_RESULT_OK == retval) {
+      go_pose_batch_put(world, n, &pose);
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
+static go_result kin_inv_batch_each(void * kins,
+				    go_integer num,
+				    const go_pose_batch * world,
+				    go_real ** joints,
+				    go_result * results)
+{
+  go_real joint[GO_KIN_BATCH_JOINTS];
+  go_pose pose;
+  go_integer joint_num;
+  go_integer n, t;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  joint_num = go_kin_num_joints(kins);
+  if (joint_num > GO_KIN_BATCH_JOINTS) return GO_RESULT_BAD_ARGS;
+
+  for (n = 0; n < num; n++) {
+    for (t = 0; t < joint_num; t++) joint[t] = joints[t][n];
+    go_pose_batch_get(world, n, &pose);
+    retval = go_kin_inv(kins, &pose, joint);
+    if (GO_RESULT_OK == retval) {
+      for (t = 0; t < joint_num; t++) joints[t][n] = joint[t];
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
+go_result go_kin_fwd_batch(void * kins,
+			   go_integer num,
+			   go_real ** joints,
+			   go_pose_batch * world,
+			   go_result * results)
+{
+  if (NULL != KIN_OPS(kins)->fwd_batch)
+    return KIN_OPS(kins)->fwd_batch(KIN_IMPL(kins), num, joints, world, results);
+
+  return kin_fwd_batch_each(kins, num, joints, world, results);
+}
+
+go_result go_kin_inv_batch(void * kins,
+			   go_integer num,
+			   const go_pose_batch * world,
+			   go_real ** joints,
+			   go_result * results)
+{
+  if (NULL != KIN_OPS(kins)->inv_batch)
+    return KIN_OPS(kins)->inv_batch(KIN_IMPL(kins), num, world, joints, results);
+
+  return kin_inv_batch_each(kins, num, world, joints, results);
+}
+
+go_result go_kin_inv_all(void * kins,
+			 const go_pose * world,
+			 go_real * joints,
+			 go_flag * iflags,
+			 go_integer * count)
+{
+  go_flag fflags;
+  go_result retval;
+
+  if (NULL != KIN_OPS(kins)->inv_all)
+    return KIN_OPS(kins)->inv_all(KIN_IMPL(kins), world, joints, iflags, count);
+
+  *count = 0;
+  retval = go_kin_inv(kins, world, joints);
+  if (GO_RESULT_OK != retval) return retval;
+  if (GO_RESULT_OK != go_kin_get_flags(kins, &fflags, iflags)) *iflags = 0;
+  *count = 1;
+
+  return GO_RESULT_OK;
+}
+
+go_result go_kin_inv_nearest(void * kins,
+			     const go_pose * world,
+			     const go_real * weights,
+			     go_real * joints,
+			     go_flag * iflags)
+{
+  go_real all[GO_KIN_INV_ALL_MAX * GO_KIN_BATCH_JOINTS];
+  go_flag allflags[GO_KIN_INV_ALL_MAX];
+  go_link links[GO_KIN_BATCH_JOINTS];
+  go_flag angle[GO_KIN_BATCH_JOINTS];
+  go_real cost, d, best_cost;
+  go_integer joint_num;
+  go_integer count, best;
+  go_integer n, t;
+  go_result retval;
+
+  joint_num = go_kin_num_joints(kins);
+  if (joint_num > GO_KIN_BATCH_JOINTS) return GO_RESULT_BAD_ARGS;
+
+  /*
+    Angular joints are taken the short way round, since the solutions
+    come out in the principal range and the joints needn't be.
+  */
+  for (t = 0; t < joint_num; t++) links[t].quantity = GO_QUANTITY_NONE;
+  retval = go_kin_get_parameters(kins, links, joint_num);
+  for (t = 0; t < joint_num; t++) {
+    angle[t] = (GO_RESULT_OK == retval && GO_QUANTITY_ANGLE == links[t].quantity);
+  }
+
+  for (t = 0; t < joint_num; t++) all[t] = joints[t];
+  retval = go_kin_inv_all(kins, world, all, allflags, &count);
+  if (GO_RESULT_OK != retval) return retval;
+
+  best = 0;
+  best_cost = 0;
+  for (n = 0; n < count; n++) {
+    cost = 0;
+    for (t = 0; t < joint_num; t++) {
+      if (angle[t]) {
+	d = all[n * joint_num + t] - joints[t];
+	d -= GO_2_PI * floor(d / GO_2_PI + 0.5);
+	all[n * joint_num + t] = joints[t] + d;
+      }
+      d = fabs(all[n * joint_num + t] - joints[t]);
+      if (NULL != weights) d *= weights[t];
+      if (d > cost) cost = d;
+    }
+    if (0 == n || cost < best_cost) {
+      best = n;
+      best_cost = cost;
+    }
+  }
+
+  for (t = 0; t < joint_num; t++) joints[t] = all[best * joint_num + t];
+  if (NULL != iflags) *iflags = allflags[best];
+
+  return GO_RESULT_OK;
 }
 
 go_kin_type go_kin_get_type(void * kins)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_get_type(kins);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_get_type(kins);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_get_type(kins);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_get_type(kins);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_get_type(kins);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_get_type(kins);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_get_type(kins);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_get_type(kins);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_get_type(kins);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_get_type(kins);
-
-  return triv_kin_get_type(kins);
+  return KIN_OPS(kins)->get_type(KIN_IMPL(kins));
 }
 
 go_result go_kin_set_parameters(void * kins, go_link * params, go_integer num)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_set_parameters(kins, params, num);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_set_parameters(kins, params, num);
-
-  return triv_kin_set_parameters(kins, params, num);
+  return KIN_OPS(kins)->set_parameters(KIN_IMPL(kins), params, num);
 }
 
 go_result go_kin_get_parameters(void * kins, go_link * params, go_integer num)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_get_parameters(kins, params, num);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_get_parameters(kins, params, num);
-
-  return triv_kin_get_parameters(kins, params, num);
+  return KIN_OPS(kins)->get_parameters(KIN_IMPL(kins), params, num);
 }
 
 go_result go_kin_jac_inv(void * kins,
@@ -339,67 +597,24 @@ go_result go_kin_jac_inv(void * kins,
 			 const go_vel * vel,
 			 const go_real * joints, go_real * jointvels)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_jac_inv(kins, pos, vel, joints, jointvels);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_jac_inv(kins, pos, vel, joints, jointvels);
-
-  return triv_kin_jac_inv(kins, pos, vel, joints, jointvels);
+  return KIN_OPS(kins)->jac_inv(KIN_IMPL(kins), pos, vel, joints, jointvels);
 }
 
-
 go_result go_kin_jac_fwd(void * kins,
 			 const go_real * joints,
 			 const go_real * jointvels,
 			 const go_pose * pos,
 			 go_vel * vel)
 {
-  if (go_kin_which == USE_GENHEXKINS)
-    return genhex_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_GENSERKINS)
-    return genser_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_FANUCKINS)
-    return fanuc_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_PUMAKINS)
-    return puma_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_SCARAKINS)
-    return scara_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_TRIPOINTKINS)
-    return tripoint_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_SPHERISTKINS)
-    return spherist_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_THREE21KINS)
-    return three21_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-  if (go_kin_which == USE_ROBOCHKINS)
-    return roboch_kin_jac_fwd(kins, joints, jointvels, pos, vel);
-
-  return triv_kin_jac_fwd(kins, joints, jointvels, pos, vel);
+  return KIN_OPS(kins)->jac_fwd(KIN_IMPL(kins), joints, jointvels, pos, vel);
 }
 
 go_result go_kin_set_flags(void *kins,
 			   go_flag fflags,
 			   go_flag iflags)
 {
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_set_flags(kins, fflags, iflags);
+  if (NULL != KIN_OPS(kins)->set_flags)
+    return KIN_OPS(kins)->set_flags(KIN_IMPL(kins), fflags, iflags);
 
   /* others are not yet implemented -- to do */
   return GO_RESULT_IMPL_ERROR;
@@ -409,10 +624,322 @@ go_result go_kin_get_flags(void *kins,
 			   go_flag *fflags,
 			   go_flag *iflags)
 {
-  if (go_kin_which == USE_FANUC_LRMATE200ID_KINS)
-    return fanuc_lrmate200id_kin_get_flags(kins, fflags, iflags);
+  if (NULL != KIN_OPS(kins)->get_flags)
+    return KIN_OPS(kins)->get_flags(KIN_IMPL(kins), fflags, iflags);
 
   /* ditto */
   return GO_RESULT_IMPL_ERROR;
 }
 
+go_integer go_kin_fwd_iterations(void *kins)
+{
+  if (NULL != KIN_OPS(kins)->fwd_iterations)
+    return KIN_OPS(kins)->fwd_iterations(KIN_IMPL(kins));
+
+  /* the rest are closed-form */
+  return 0;
+}
+
+go_integer go_kin_inv_iterations(void *kins)
+{
+  if (NULL != KIN_OPS(kins)->inv_iterations)
+    return KIN_OPS(kins)->inv_iterations(KIN_IMPL(kins));
+
+  /* ditto */
+  return 0;
+}
+
+go_result go_kin_predict_init(go_kin_predictor *p, go_integer order)
+{
+  if (order < 0 || order > GO_KIN_PREDICT_ORDER_MAX) return GO_RESULT_BAD_ARGS;
+
+  p->order = order;
+  p->number = 0;
+  p->stamp = 0;
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Makes room for a solution for cycle 'stamp' at the front of the
+  history, dropping the history unless it's from the cycle before,
+  or overwriting the newest if it's from this cycle.
+*/
+static void predict_make_room(go_kin_predictor *p, go_integer stamp)
+{
+  go_integer i, t;
+
+  if (p->number > 0 && stamp == p->stamp) return;
+
+  if (p->number > 0 && stamp == p->stamp + 1) {
+    if (p->number <= p->order) p->number++;
+    for (i = p->number - 1; i > 0; i--) {
+      for (t = 0; t < GO_KIN_PREDICT_JOINTS; t++) {
+	p->joints[i][t] = p->joints[i - 1][t];
+      }
+      p->pose[i] = p->pose[i - 1];
+    }
+  } else {
+    p->number = 1;
+  }
+  p->stamp = stamp;
+}
+
+go_result go_kin_predict_joints(go_kin_predictor *p, go_integer stamp, go_integer num, go_real *joints)
+{
+  go_integer t;
+
+  if (num > GO_KIN_PREDICT_JOINTS) return GO_RESULT_BAD_ARGS;
+  if (p->number < 2 || stamp != p->stamp + 1) return GO_RESULT_IGNORED;
+
+  if (p->number == 2) {
+    for (t = 0; t < num; t++) {
+      joints[t] = 2.0 * p->joints[0][t] - p->joints[1][t];
+    }
+  } else {
+    for (t = 0; t < num; t++) {
+      joints[t] = 3.0 * (p->joints[0][t] - p->joints[1][t]) + p->joints[2][t];
+    }
+  }
+
+  return GO_RESULT_OK;
+}
+
+go_result go_kin_predict_joints_add(go_kin_predictor *p, go_integer stamp, go_integer num, const go_real *joints)
+{
+  go_integer t;
+
+  if (num > GO_KIN_PREDICT_JOINTS) return GO_RESULT_BAD_ARGS;
+  if (p->order <= 0) return GO_RESULT_OK;
+
+  predict_make_room(p, stamp);
+  for (t = 0; t < num; t++) {
+    p->joints[0][t] = joints[t];
+  }
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Poses are extrapolated with the translation as for joints, and the
+  rotation by repeating the last rotation increment, or with second
+  order, that increment times its change from the one before.
+*/
+go_result go_kin_predict_pose(go_kin_predictor *p, go_integer stamp, go_pose *pose)
+{
+  go_quat qinv, d0, d1;
+
+  if (p->number < 2 || stamp != p->stamp + 1) return GO_RESULT_IGNORED;
+
+  go_quat_inv(&p->pose[1].rot, &qinv);
+  go_quat_quat_mult(&qinv, &p->pose[0].rot, &d0);
+
+  if (p->number == 2) {
+    pose->tran.x = 2.0 * p->pose[0].tran.x - p->pose[1].tran.x;
+    pose->tran.y = 2.0 * p->pose[0].tran.y - p->pose[1].tran.y;
+    pose->tran.z = 2.0 * p->pose[0].tran.z - p->pose[1].tran.z;
+  } else {
+    pose->tran.x = 3.0 * (p->pose[0].tran.x - p->pose[1].tran.x) + p->pose[2].tran.x;
+    pose->tran.y = 3.0 * (p->pose[0].tran.y - p->pose[1].tran.y) + p->pose[2].tran.y;
+    pose->tran.z = 3.0 * (p->pose[0].tran.z - p->pose[1].tran.z) + p->pose[2].tran.z;
+    /* d0 times d1inv d0, where d1 is the increment before d0 */
+    go_quat_inv(&p->pose[2].rot, &qinv);
+    go_quat_quat_mult(&qinv, &p->pose[1].rot, &d1);
+    go_quat_inv(&d1, &d1);
+    go_quat_quat_mult(&d1, &d0, &d1);
+    go_quat_quat_mult(&d0, &d1, &d0);
+  }
+  go_quat_quat_mult(&p->pose[0].rot, &d0, &pose->rot);
+  go_quat_norm(&pose->rot, &pose->rot);
+
+  return GO_RESULT_OK;
+}
+
+go_result go_kin_predict_pose_add(go_kin_predictor *p, go_integer stamp, const go_pose *pose)
+{
+  if (p->order <= 0) return GO_RESULT_OK;
+
+  predict_make_room(p, stamp);
+  p->pose[0] = *pose;
+
+  return GO_RESULT_OK;
+}
+
+go_result go_kin_cache_init(go_kin_cache *c, go_integer size, go_integer num, go_real resolution, go_real rot_resolution, go_real jump)
+{
+  if (size < 0 || size > GO_KIN_CACHE_SIZE ||
+      num < 0 || num > GO_KIN_CACHE_JOINTS ||
+      resolution <= 0.0 || rot_resolution <= 0.0 ||
+      jump < 0.0) return GO_RESULT_BAD_ARGS;
+
+  c->size = size;
+  c->num = num;
+  c->resolution = resolution;
+  c->rot_resolution = rot_resolution;
+  c->jump = jump;
+  c->hits = 0;
+  c->misses = 0;
+
+  return go_kin_cache_clear(c);
+}
+
+go_result go_kin_cache_clear(go_kin_cache *c)
+{
+  go_integer i;
+
+  for (i = 0; i < GO_KIN_CACHE_BUCKETS; i++) c->bucket[i] = -1;
+  c->count = 0;
+  c->newest = c->oldest = -1;
+
+  return GO_RESULT_OK;
+}
+
+static long cache_round(go_real x, go_real resolution)
+{
+  x /= resolution;
+  return (long) (x < 0.0 ? x - 0.5 : x + 0.5);
+}
+
+static go_integer cache_bucket(const long *key)
+{
+  unsigned long hash;
+  go_integer i;
+
+  for (i = 0, hash = 0; i < 7; i++) hash = hash * 31 + (unsigned long) key[i];
+
+  return (go_integer) (hash % GO_KIN_CACHE_BUCKETS);
+}
+
+/*
+  Rounds the pose into 'key', with the quaternion's sign made so the
+  two that are the same rotation match, and returns its bucket. A
+  small turn of some angle moves the quaternion by about half of it,
+  so its parts are rounded to half the rotation resolution.
+*/
+static go_integer cache_key(go_kin_cache *c, const go_pose *pose, long *key)
+{
+  go_real sign;
+  go_real qres;
+
+  sign = pose->rot.s < 0.0 ? -1.0 : 1.0;
+  qres = 0.5 * c->rot_resolution;
+  key[0] = cache_round(pose->tran.x, c->resolution);
+  key[1] = cache_round(pose->tran.y, c->resolution);
+  key[2] = cache_round(pose->tran.z, c->resolution);
+  key[3] = cache_round(sign * pose->rot.s, qres);
+  key[4] = cache_round(sign * pose->rot.x, qres);
+  key[5] = cache_round(sign * pose->rot.y, qres);
+  key[6] = cache_round(sign * pose->rot.z, qres);
+
+  return cache_bucket(key);
+}
+
+/* takes the entry out of the least recently used list */
+static void cache_unlist(go_kin_cache *c, go_integer e)
+{
+  if (c->entry[e].newer >= 0) c->entry[c->entry[e].newer].older = c->entry[e].older;
+  else c->newest = c->entry[e].older;
+  if (c->entry[e].older >= 0) c->entry[c->entry[e].older].newer = c->entry[e].newer;
+  else c->oldest = c->entry[e].newer;
+}
+
+/* puts the entry at the most recently used end of the list */
+static void cache_list(go_kin_cache *c, go_integer e)
+{
+  c->entry[e].newer = -1;
+  c->entry[e].older = c->newest;
+  if (c->newest >= 0) c->entry[c->newest].newer = e;
+  else c->oldest = e;
+  c->newest = e;
+}
+
+static go_flag cache_iflags(void *kins)
+{
+  go_flag fflags, iflags;
+
+  if (GO_RESULT_OK != go_kin_get_flags(kins, &fflags, &iflags)) return 0;
+
+  return iflags;
+}
+
+static go_integer cache_find(go_kin_cache *c, go_integer b, const long *key, go_flag iflags)
+{
+  go_integer e, i;
+
+  for (e = c->bucket[b]; e >= 0; e = c->entry[e].next) {
+    if (c->entry[e].iflags != iflags) continue;
+    for (i = 0; i < 7; i++) {
+      if (c->entry[e].key[i] != key[i]) break;
+    }
+    if (i == 7) return e;
+  }
+
+  return -1;
+}
+
+go_result go_kin_cache_get(go_kin_cache *c, void *kins, const go_pose *pose, go_real *joints)
+{
+  long key[7];
+  go_real diff;
+  go_integer b, e, t;
+
+  if (c->size <= 0) return GO_RESULT_IGNORED;
+
+  b = cache_key(c, pose, key);
+  e = cache_find(c, b, key, cache_iflags(kins));
+  if (e >= 0) {
+    for (t = 0; t < c->num; t++) {
+      diff = c->entry[e].joints[t] - joints[t];
+      if (diff > c->jump || diff < -c->jump) break;
+    }
+    if (t == c->num) {
+      for (t = 0; t < c->num; t++) joints[t] = c->entry[e].joints[t];
+      cache_unlist(c, e);
+      cache_list(c, e);
+      c->hits++;
+      return GO_RESULT_OK;
+    }
+  }
+  c->misses++;
+
+  return GO_RESULT_IGNORED;
+}
+
+go_result go_kin_cache_put(go_kin_cache *c, void *kins, const go_pose *pose, const go_real *joints)
+{
+  long key[7];
+  go_flag iflags;
+  go_integer b, e, t, *link;
+
+  if (c->size <= 0) return GO_RESULT_OK;
+
+  iflags = cache_iflags(kins);
+  b = cache_key(c, pose, key);
+  e = cache_find(c, b, key, iflags);
+
+  if (e >= 0) {
+    cache_unlist(c, e);
+  } else {
+    if (c->count < c->size) {
+      /* take an empty one */
+      e = c->count++;
+    } else {
+      /* take the least recently used, unlinking it from its bucket */
+      e = c->oldest;
+      cache_unlist(c, e);
+      for (link = &c->bucket[cache_bucket(c->entry[e].key)];
+	   *link != e;
+	   link = &c->entry[*link].next);
+      *link = c->entry[e].next;
+    }
+    for (t = 0; t < 7; t++) c->entry[e].key[t] = key[t];
+    c->entry[e].iflags = iflags;
+    c->entry[e].next = c->bucket[b];
+    c->bucket[b] = e;
+  }
+
+  for (t = 0; t < c->num; t++) c->entry[e].joints[t] = joints[t];
+  cache_list(c, e);
+
+  return GO_RESULT_OK;
+}
@@ -57,18 +57,22 @@ go_integer puma_kin_num_joints(void *kins)
   return PUMA_NUM_JOINTS;
 }
 
-go_result puma_kin_fwd(void *kins,
-		       const go_real *joint,
-		       go_pose *world)
+/*
+  The forward kinematics without the flags, which the batch needs
+  only for its last item. The sines and cosines of joint 1 and
+  joints 2 plus 3 are passed back for the flags.
+*/
+static void puma_fwd_hom(const puma_kin_struct *pk,
+			 const go_real *joint,
+			 go_hom *hom,
+			 go_real *s1p, go_real *c1p,
+			 go_real *s23p, go_real *c23p)
 {
-  puma_kin_struct *pk = (puma_kin_struct *) kins;
   go_real s1, s2, s3, s4, s5, s6;
   go_real c1, c2, c3, c4, c5, c6;
   go_real s23;
   go_real c23;
   go_real t1, t2, t3, t4, t5;
-  go_real sumSq, k;
-  go_hom hom;
 
   s1 = sin(joint[0]);
   s2 = sin(joint[1]);
@@ -97,9 +101,9 @@ go_result puma_kin_fwd(void *kins,
   t5 = c23 * s5 * c6;
 
   /* Define first column of rotation matrix */
-  hom.rot.x.x = c1 * t4 + s1 * t3;
-  hom.rot.x.y = s1 * t4 - c1 * t3;
-  hom.rot.x.z = -s23 * t1 - t5;
+  hom->rot.x.x = c1 * t4 + s1 * t3;
+  hom->rot.x.y = s1 * t4 - c1 * t3;
+  hom->rot.x.z = -s23 * t1 - t5;
 
   /* Calculate terms to be used in definition of...  */
   /* second column of rotation matrix.               */
@@ -110,27 +114,44 @@ go_result puma_kin_fwd(void *kins,
   t5 = c23 * s5 * s6;
 
   /* Define second column of rotation matrix */
-  hom.rot.y.x = c1 * t4 + s1 * t3;
-  hom.rot.y.y = s1 * t4 - c1 * t3;
-  hom.rot.y.z = -s23 * t1 + t5;
+  hom->rot.y.x = c1 * t4 + s1 * t3;
+  hom->rot.y.y = s1 * t4 - c1 * t3;
+  hom->rot.y.z = -s23 * t1 + t5;
 
   /* Calculate term to be used in definition of... */
   /* third column of rotation matrix.              */
   t1 = c23 * c4 * s5 + s23 * c5;
 
   /* Define third column of rotation matrix */
-  hom.rot.z.x = -c1 * t1 - s1 * s4 * s5;
-  hom.rot.z.y = -s1 * t1 + c1 * s4 * s5;
-  hom.rot.z.z = s23 * c4 * s5 - c23 * c5;
+  hom->rot.z.x = -c1 * t1 - s1 * s4 * s5;
+  hom->rot.z.y = -s1 * t1 + c1 * s4 * s5;
+  hom->rot.z.z = s23 * c4 * s5 - c23 * c5;
 
   /* Calculate term to be used in definition of...  */
   /* position vector.                               */
   t1 = pk->a2 * c2 + pk->a3 * c23 - pk->d4 * s23;
 
   /* Define position vector */
-  hom.tran.x = c1 * t1 - pk->d3 * s1;
-  hom.tran.y = s1 * t1 + pk->d3 * c1;
-  hom.tran.z = -pk->a3 * s23 - pk->a2 * s2 - pk->d4 * c23;
+  hom->tran.x = c1 * t1 - pk->d3 * s1;
+  hom->tran.y = s1 * t1 + pk->d3 * c1;
+  hom->tran.z = -pk->a3 * s23 - pk->a2 * s2 - pk->d4 * c23;
+
+  *s1p = s1, *c1p = c1;
+  *s23p = s23, *c23p = c23;
+}
+
+go_result puma_kin_fwd(void *kins,
+		       const go_real *joint,
+		       go_pose *world)
+{
+  puma_kin_struct *pk = (puma_kin_struct *) kins;
+  go_real s1, c1;
+  go_real s23, c23;
+  go_real t1, t2;
+  go_real sumSq, k;
+  go_hom hom;
+
+  puma_fwd_hom(pk, joint, &hom, &s1, &c1, &s23, &c23);
 
   /* Calculate terms to be used to...   */
   /* determine flags.                   */
@@ -170,6 +191,97 @@ go_result puma_kin_fwd(void *kins,
   return go_hom_pose_convert(&hom, world);
 }
 
+/*
+  Joint 2 and the wrist joints for the shoulder solution 'th1' and the
+  elbow solution 'th3', unflipped, shared by puma_kin_inv and
+  puma_kin_inv_all. Returns GO_RESULT_SINGULAR at a wrist singularity.
+*/
+static go_result puma_inv_arm_wrist(const puma_kin_struct *pk,
+				    const go_hom *hom,
+				    go_real th1, go_real s1, go_real c1,
+				    go_real th3,
+				    go_real *joint)
+{
+  go_real t1, t2, t3;
+  go_real th23;
+  go_real s3, c3;
+  go_real s23, c23;
+  go_real s4, c4;
+  go_real s5, c5;
+  go_real s6, c6;
+
+  /* compute sin, cos for later calcs */
+  s3 = sin(th3);
+  c3 = cos(th3);
+
+  /* Joint 2 */
+
+  t1 = (-pk->a3 - pk->a2 * c3) * hom->tran.z +
+    (c1 * hom->tran.x + s1 * hom->tran.y) * (pk->a2 * s3 - pk->d4);
+  t2 = (pk->a2 * s3 - pk->d4) * hom->tran.z +
+    (pk->a3 + pk->a2 * c3) * (c1 * hom->tran.x + s1 * hom->tran.y);
+  t3 = hom->tran.z * hom->tran.z + (c1 * hom->tran.x + s1 * hom->tran.y) *
+    (c1 * hom->tran.x + s1 * hom->tran.y);
+
+  th23 = atan2(t1, t2);
+  joint[0] = th1;
+  joint[1] = th23 - th3;
+  joint[2] = th3;
+
+  /* compute sin, cos for later calcs */
+  s23 = t1 / t3;
+  c23 = t2 / t3;
+
+  /* Joint 4 */
+
+  t1 = -hom->rot.z.x * s1 + hom->rot.z.y * c1;
+  t2 = -hom->rot.z.x * c1 * c23 - hom->rot.z.y * s1 * c23 + hom->rot.z.z * s23;
+  if (fabs(t1) < SINGULAR_FUZZ && fabs(t2) < SINGULAR_FUZZ) {
+    return GO_RESULT_SINGULAR;
+  }
+
+  joint[3] = atan2(t1, t2);
+
+  /* compute sin, cos for later calcs */
+  s4 = sin(joint[3]);
+  c4 = cos(joint[3]);
+
+  /* Joint 5 */
+
+  s5 = hom->rot.z.z * (s23 * c4) -
+    hom->rot.z.x * (c1 * c23 * c4 + s1 * s4) -
+    hom->rot.z.y * (s1 * c23 * c4 - c1 * s4);
+  c5 = -hom->rot.z.x * (c1 * s23) - hom->rot.z.y *
+    (s1 * s23) - hom->rot.z.z * c23;
+  joint[4] = atan2(s5, c5);
+
+  /* Joint 6 */
+
+  s6 = hom->rot.x.z * (s23 * s4) - hom->rot.x.x *
+    (c1 * c23 * s4 - s1 * c4) - hom->rot.x.y * (s1 * c23 * s4 + c1 * c4);
+  c6 = hom->rot.x.x * ((c1 * c23 * c4 + s1 * s4) *
+		       c5 - c1 * s23 * s5) + hom->rot.x.y *
+    ((s1 * c23 * c4 - c1 * s4) * c5 - s1 * s23 * s5) -
+    hom->rot.x.z * (s23 * c4 * c5 + c23 * s5);
+  joint[5] = atan2(s6, c6);
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Is wrist flip the normal or offset result? Absent agreement on
+  this, we'll just define it ourselves.
+*/
+static void puma_inv_flip(const go_real *joint, go_real *flipped)
+{
+  flipped[0] = joint[0];
+  flipped[1] = joint[1];
+  flipped[2] = joint[2];
+  flipped[3] = joint[3] + GO_PI;
+  flipped[4] = -joint[4];
+  flipped[5] = joint[5] + GO_PI;
+}
+
 go_result puma_kin_inv(void *kins,
 		       const go_pose *world,
 		       go_real *joint)
@@ -177,24 +289,14 @@ go_result puma_kin_inv(void *kins,
   puma_kin_struct *pk = (puma_kin_struct *) kins;
   go_hom hom;
 
-  go_real t1, t2, t3;
   go_real k;
   go_real sum_sq;
 
   go_real th1;
   go_real th3;
-  go_real th23;
-  go_real th2;
-  go_real th4;
-  go_real th5;
-  go_real th6;
 
   go_real s1, c1;
-  go_real s3, c3;
-  go_real s23, c23;
-  go_real s4, c4;
-  go_real s5, c5;
-  go_real s6, c6;
+  go_result retval;
 
   /* convert pose to hom */
   go_pose_hom_convert(world, &hom);
@@ -232,78 +334,138 @@ go_result puma_kin_inv(void *kins,
       atan2(k, sqrt(pk->a3 * pk->a3 + pk->d4 * pk->d4 - k * k));
   }
 
-  /* compute sin, cos for later calcs */
-  s3 = sin(th3);
-  c3 = cos(th3);
+  /* Joints 2, 4, 5 and 6 */
+  retval = puma_inv_arm_wrist(pk, &hom, th1, s1, c1, th3, joint);
+  if (GO_RESULT_OK != retval) return retval;
 
-  /* Joint 2 */
+  if (pk->iflags & PUMA_WRIST_FLIP) {
+    puma_inv_flip(joint, joint);
+  }
 
-  t1 = (-pk->a3 - pk->a2 * c3) * hom.tran.z +
-    (c1 * hom.tran.x + s1 * hom.tran.y) * (pk->a2 * s3 - pk->d4);
-  t2 = (pk->a2 * s3 - pk->d4) * hom.tran.z +
-    (pk->a3 + pk->a2 * c3) * (c1 * hom.tran.x + s1 * hom.tran.y);
-  t3 = hom.tran.z * hom.tran.z + (c1 * hom.tran.x + s1 * hom.tran.y) *
-    (c1 * hom.tran.x + s1 * hom.tran.y);
+  return GO_RESULT_OK;
+}
 
-  th23 = atan2(t1, t2);
-  th2 = th23 - th3;
+/*
+  Every solution puma_kin_inv would give over the flag settings. With
+  no shoulder offset in the elbow term, 'k' and its root are the same
+  for both shoulders and are worked out once, as are the base and
+  elbow angles; unreachable and wrist-singular branches are left out.
+*/
+go_result puma_kin_inv_all(void *kins,
+			   const go_pose *world,
+			   go_real *joint,
+			   go_flag *iflags,
+			   go_integer *count)
+{
+  puma_kin_struct *pk = (puma_kin_struct *) kins;
+  go_hom hom;
+  go_real k, sum_sq, r, rr;
+  go_real base, elbow;
+  go_real th1[2], s1[2], c1[2];
+  go_real th3[2];
+  go_real *sol;
+  go_integer shoulder, down;
 
-  /* compute sin, cos for later calcs */
-  s23 = t1 / t3;
-  c23 = t2 / t3;
+  go_pose_hom_convert(world, &hom);
 
-  /* Joint 4 */
+  *count = 0;
 
-  t1 = -hom.rot.z.x * s1 + hom.rot.z.y * c1;
-  t2 = -hom.rot.z.x * c1 * c23 - hom.rot.z.y * s1 * c23 + hom.rot.z.z * s23;
-  if (fabs(t1) < SINGULAR_FUZZ && fabs(t2) < SINGULAR_FUZZ) {
-    return GO_RESULT_SINGULAR;
+  sum_sq = hom.tran.x * hom.tran.x + hom.tran.y * hom.tran.y -
+    pk->d3 * pk->d3;
+  k = (sum_sq + hom.tran.z * hom.tran.z - pk->a2 * pk->a2 -
+       pk->a3 * pk->a3 - pk->d4 * pk->d4) / (2.0 * pk->a2);
+  rr = pk->a3 * pk->a3 + pk->d4 * pk->d4 - k * k;
+  if (sum_sq < 0.0 || rr < 0.0) return GO_RESULT_DOMAIN_ERROR;
+  r = sqrt(sum_sq);
+  rr = sqrt(rr);
+
+  base = atan2(hom.tran.y, hom.tran.x);
+  elbow = atan2(pk->a3, pk->d4);
+  for (shoulder = 0; shoulder < 2; shoulder++) {
+    th1[shoulder] = base - atan2(pk->d3, shoulder ? -r : r);
+    s1[shoulder] = sin(th1[shoulder]);
+    c1[shoulder] = cos(th1[shoulder]);
+  }
+  th3[0] = elbow - atan2(k, rr);
+  th3[1] = elbow - atan2(k, -rr);
+
+  for (shoulder = 0; shoulder < 2; shoulder++) {
+    for (down = 0; down < 2; down++) {
+      sol = &joint[*count * PUMA_NUM_JOINTS];
+      if (GO_RESULT_OK != puma_inv_arm_wrist(pk, &hom, th1[shoulder], s1[shoulder], c1[shoulder], th3[down], sol)) continue;
+      iflags[*count] = (shoulder ? PUMA_SHOULDER_RIGHT : 0) | (down ? PUMA_ELBOW_DOWN : 0);
+      puma_inv_flip(sol, sol + PUMA_NUM_JOINTS);
+      iflags[*count + 1] = iflags[*count] | PUMA_WRIST_FLIP;
+      *count += 2;
+    }
   }
 
-  th4 = atan2(t1, t2);
-
-  /* compute sin, cos for later calcs */
-  s4 = sin(th4);
-  c4 = cos(th4);
-
-  /* Joint 5 */
+  return *count > 0 ? GO_RESULT_OK : GO_RESULT_DOMAIN_ERROR;
+}
 
-  s5 = hom.rot.z.z * (s23 * c4) -
-    hom.rot.z.x * (c1 * c23 * c4 + s1 * s4) -
-    hom.rot.z.y * (s1 * c23 * c4 - c1 * s4);
-  c5 = -hom.rot.z.x * (c1 * s23) - hom.rot.z.y *
-    (s1 * s23) - hom.rot.z.z * c23;
-  th5 = atan2(s5, c5);
+/*
+  The batch skips the flags for all but the last item, which is what
+  they're left set from.
+*/
 
-  /* Joint 6 */
+go_result puma_kin_fwd_batch(void *kins,
+			     go_integer num,
+			     go_real **joints,
+			     go_pose_batch *world,
+			     go_result *results)
+{
+  puma_kin_struct *pk = (puma_kin_struct *) kins;
+  go_real joint[PUMA_NUM_JOINTS];
+  go_real s1, c1, s23, c23;
+  go_hom hom;
+  go_pose pose;
+  go_integer n, t;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  for (n = 0; n < num; n++) {
+    for (t = 0; t < PUMA_NUM_JOINTS; t++) joint[t] = joints[t][n];
+    if (n < num - 1) {
+      puma_fwd_hom(pk, joint, &hom, &s1, &c1, &s23, &c23);
+      retval = go_hom_pose_convert(&hom, &pose);
+    } else {
+      retval = puma_kin_fwd(kins, joint, &pose);
+    }
+    if (GO_RESULT_OK == retval) {
+      go_pose_batch_put(world, n, &pose);
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
 
-  s6 = hom.rot.x.z * (s23 * s4) - hom.rot.x.x *
-    (c1 * c23 * s4 - s1 * c4) - hom.rot.x.y * (s1 * c23 * s4 + c1 * c4);
-  c6 = hom.rot.x.x * ((c1 * c23 * c4 + s1 * s4) *
-		      c5 - c1 * s23 * s5) + hom.rot.x.y *
-    ((s1 * c23 * c4 - c1 * s4) * c5 - s1 * s23 * s5) -
-    hom.rot.x.z * (s23 * c4 * c5 + c23 * s5);
-  th6 = atan2(s6, c6);
+  return first;
+}
 
-  /*
-     Is wrist flip the normal or offset result? Absent agreement on
-     this, we'll just define it ourselves.
-   */
-  if (pk->iflags & PUMA_WRIST_FLIP) {
-    th4 = th4 + GO_PI;
-    th5 = -th5;
-    th6 = th6 + GO_PI;
+go_result puma_kin_inv_batch(void *kins,
+			     go_integer num,
+			     const go_pose_batch *world,
+			     go_real **joints,
+			     go_result *results)
+{
+  go_real joint[PUMA_NUM_JOINTS];
+  go_pose pose;
+  go_integer n, t;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  for (n = 0; n < num; n++) {
+    go_pose_batch_get(world, n, &pose);
+    retval = puma_kin_inv(kins, &pose, joint);
+    if (GO_RESULT_OK == retval) {
+      for (t = 0; t < PUMA_NUM_JOINTS; t++) joints[t][n] = joint[t];
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
   }
 
-  /* copy out */
-  joint[0] = th1;
-  joint[1] = th2;
-  joint[2] = th3;
-  joint[3] = th4;
-  joint[4] = th5;
-  joint[5] = th6;
-
-  return GO_RESULT_OK;
+  return first;
 }
 
 go_kin_type puma_kin_get_type(void *kins)
@@ -357,10 +519,17 @@ go_result puma_kin_get_parameters(void *kins,
 {
   puma_kin_struct *pk = (puma_kin_struct *) kins;
 
+  go_integer t;
+
   if (num < PUMA_NUM_JOINTS) {
     return GO_RESULT_ERROR;
   }
 
+  /* all the joints are revolute */
+  for (t = 0; t < PUMA_NUM_JOINTS; t++) {
+    params[t].quantity = GO_QUANTITY_ANGLE;
+  }
+
   params[2].type = GO_LINK_DH;
   params[2].quantity = GO_QUANTITY_ANGLE;
   params[2].u.dh.a = pk->a2;
@@ -854,7 +1023,6 @@ go_result puma_kin_jac_inv(void *kins,
 			   go_real *jointvels)
 {
   go_real mat[6][6];
-  go_real inv[6][6];
   go_real our_joints[6];
   go_real *joints;
   go_real velvec[6];
@@ -875,11 +1043,6 @@ go_result puma_kin_jac_inv(void *kins,
     return retval;
   }
 
-  retval = go_mat6_inv(mat, inv);
-  if (GO_RESULT_OK != retval) {
-    return retval;
-  }
-
   velvec[0] = vel->v.x;
   velvec[1] = vel->v.y;
   velvec[2] = vel->v.z;
@@ -887,7 +1050,7 @@ go_result puma_kin_jac_inv(void *kins,
   velvec[4] = vel->w.y;
   velvec[5] = vel->w.z;
 
-  return go_mat6_vec6_mult(inv, velvec, jointvels);
+  return go_mat6_solve(mat, velvec, jointvels);
 }
 
 /* extensions */
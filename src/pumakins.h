@@ -53,6 +53,28 @@ extern go_result puma_kin_inv(void *kins,
 			      const go_pose *world,
 			      go_real *joint);
 
+/*
+  Fills 'joint' with up to 8 solutions, one after another, and
+  'iflags' with the flags that give each, setting 'count'.
+*/
+extern go_result puma_kin_inv_all(void *kins,
+				  const go_pose *world,
+				  go_real *joint,
+				  go_flag *iflags,
+				  go_integer *count);
+
+extern go_result puma_kin_fwd_batch(void *kins,
+				   go_integer num,
+				   go_real **joints,
+				   go_pose_batch *world,
+				   go_result *results);
+
+extern go_result puma_kin_inv_batch(void *kins,
+				   go_integer num,
+				   const go_pose_batch *world,
+				   go_real **joints,
+				   go_result *results);
+
 extern go_kin_type puma_kin_get_type(void *kins); 
 
 extern go_result puma_kin_set_parameters(void *kins,
@@ -387,7 +387,6 @@ go_result roboch_kin_jac_fwd(void * kins,
 			     const go_pose * pos,
 			     go_vel * vel)
 {
-  go_real jac[6][6];
   go_real jac_inv[6][6];
   go_real vel_vec[6];
   go_result retval;
@@ -395,11 +394,10 @@ go_result roboch_kin_jac_fwd(void * kins,
   retval = jac_inv_mat(kins, pos, jac_inv);
   if (GO_RESULT_OK != retval) return retval;
 
-  retval = go_mat6_inv(jac_inv, jac);
+  /* the forward velocities solve jac_inv vel_vec = jointvels */
+  retval = go_mat6_solve(jac_inv, (go_real *) jointvels, vel_vec);
   if (GO_RESULT_OK != retval) return retval;
 
-  (void) go_mat6_vec6_mult(jac, jointvels, vel_vec);
-
   vel->v.x = vel_vec[0];
   vel->v.y = vel_vec[1];
   vel->v.z = vel_vec[2];
@@ -477,6 +477,9 @@ extern int rs274ngc_c_synch();
 /* restore interpreter tool table entries from a file */
 extern int rs274ngc_c_restore_tool_table(const char *filename);
 
+/* return the current sequence number (how many lines read) */
+extern int rs274ngc_c_sequence_number();
+
 #endif	/* not __cplusplus */
 
 #endif	/* RS274NGC_HH */
@@ -12527,6 +12527,12 @@ int rs274ngc_c_restore_tool_table(const char *filename)
   return rs274ngc_restore_tool_table(filename);
 }
 
+/* return the current sequence number (how many lines read) */
+int rs274ngc_c_sequence_number()
+{
+  return rs274ngc_sequence_number();
+}
+
 #if 0
 {
 #endif
@@ -72,24 +72,29 @@ go_integer scara_kin_num_joints(void * kins)
   Yaw is the sum of the planar joint angles th1 + th2 + th3.
 */
 
-go_result scara_kin_fwd(void * kins,
-			const go_real *joint,
-			go_pose * world)
+static void scara_flags_set(scarakin_struct * sk, go_real joint1)
 {
-  scarakin_struct * sk = (scarakin_struct *) kins;
-  go_rpy rpy;
-
   /* set elbow flag */
   sk->iflags = 0;
-  if (joint[1] < 0.0) {
+  if (joint1 < 0.0) {
     sk->iflags |= SCARA_ELBOW_DOWN;
   }
 
   /* check if we're at a singular configuration */
-  if (fabs(joint[1]) < SINGULAR_FUZZ ||
-      fabs(joint[1] - GO_PI) < SINGULAR_FUZZ) {
+  if (fabs(joint1) < SINGULAR_FUZZ ||
+      fabs(joint1 - GO_PI) < SINGULAR_FUZZ) {
     sk->iflags |= SCARA_SINGULAR;
   }
+}
+
+go_result scara_kin_fwd(void * kins,
+			const go_real *joint,
+			go_pose * world)
+{
+  scarakin_struct * sk = (scarakin_struct *) kins;
+  go_rpy rpy;
+
+  scara_flags_set(sk, joint[1]);
 
   world->tran.x = sk->L1 * cos(joint[0]) + sk->L2 * cos(joint[0] + joint[1]);
   world->tran.y = sk->L1 * sin(joint[0]) + sk->L2 * sin(joint[0] + joint[1]);
@@ -140,6 +145,100 @@ go_result scara_kin_inv(void * kins,
   return GO_RESULT_OK;
 } 
 
+/*
+  The batch forward kinematics work on the arrays directly, without
+  converting to and from poses. The rotation is about Z alone, so its
+  quaternion is the half-angle one, signed to have a nonnegative
+  scalar part as go_rpy_quat_convert gives it. The flags are set from
+  the last item.
+*/
+
+go_result scara_kin_fwd_batch(void * kins,
+			      go_integer num,
+			      go_real ** joints,
+			      go_pose_batch * world,
+			      go_result * results)
+{
+  scarakin_struct * sk = (scarakin_struct *) kins;
+  go_real * j0 = joints[0];
+  go_real * j1 = joints[1];
+  go_real * j2 = joints[2];
+  go_real * j3 = joints[3];
+  go_real sh, ch, sign;
+  go_integer n;
+
+  for (n = 0; n < num; n++) {
+    world->x[n] = sk->L1 * cos(j0[n]) + sk->L2 * cos(j0[n] + j1[n]);
+    world->y[n] = sk->L1 * sin(j0[n]) + sk->L2 * sin(j0[n] + j1[n]);
+    world->z[n] = -j3[n];
+    sh = sin(0.5 * (j0[n] + j1[n] + j2[n]));
+    ch = cos(0.5 * (j0[n] + j1[n] + j2[n]));
+    sign = (ch < 0.0 ? -1.0 : 1.0);
+    world->s[n] = sign * ch;
+    world->i[n] = 0.0;
+    world->j[n] = 0.0;
+    world->k[n] = sign * sh;
+  }
+
+  if (NULL != results) {
+    for (n = 0; n < num; n++) results[n] = GO_RESULT_OK;
+  }
+
+  if (num > 0) scara_flags_set(sk, j1[num - 1]);
+
+  return GO_RESULT_OK;
+}
+
+go_result scara_kin_inv_batch(void * kins,
+			      go_integer num,
+			      const go_pose_batch * world,
+			      go_real ** joints,
+			      go_result * results)
+{
+  scarakin_struct * sk = (scarakin_struct *) kins;
+  go_real c2, s2, discr;
+  go_real k1, k2;
+  go_real sign;
+  go_quat quat;
+  go_rpy rpy;
+  go_integer n;
+  go_result first = GO_RESULT_OK;
+
+  sign = (sk->iflags & SCARA_ELBOW_DOWN ? -1.0 : 1.0);
+
+  for (n = 0; n < num; n++) {
+    c2 = (go_sq(world->x[n]) + go_sq(world->y[n]) -
+	  go_sq(sk->L1) - go_sq(sk->L2)) * sk->inv_2L1L2;
+
+    discr = 1.0 - go_sq(c2);
+    if (discr < 0.0) {
+      if (GO_RESULT_OK == first) first = GO_RESULT_SINGULAR;
+      if (NULL != results) results[n] = GO_RESULT_SINGULAR;
+      continue;
+    }
+
+    s2 = sign * sqrt(discr);
+    joints[1][n] = atan2(s2, c2);
+
+    k1 = sk->L1 + sk->L2 * c2;
+    k2 = sk->L2 * s2;
+    joints[0][n] = atan2(world->y[n], world->x[n]) - atan2(k2, k1);
+
+    quat.s = world->s[n];
+    quat.x = world->i[n];
+    quat.y = world->j[n];
+    quat.z = world->k[n];
+    go_quat_rpy_convert(&quat, &rpy);
+    joints[2][n] = rpy.y - joints[0][n] - joints[1][n];
+
+    joints[3][n] = -world->z[n];
+
+    if (NULL != results) results[n] = GO_RESULT_OK;
+  }
+
+  return first;
+}
+
 go_kin_type scara_kin_get_type(void * kins)
 {
   return GO_KIN_BOTH;
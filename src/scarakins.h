@@ -50,6 +50,18 @@ extern go_result scara_kin_inv(void * kins,
 			       const go_pose * world,
 			       go_real *joint);
 
+extern go_result scara_kin_fwd_batch(void * kins,
+				    go_integer num,
+				    go_real ** joints,
+				    go_pose_batch * world,
+				    go_result * results);
+
+extern go_result scara_kin_inv_batch(void * kins,
+				    go_integer num,
+				    const go_pose_batch * world,
+				    go_real ** joints,
+				    go_result * results);
+
 extern go_kin_type scara_kin_get_type(void * kins); 
 
 extern go_result scara_kin_set_parameters(void * kins, go_link * params, go_integer num); 
@@ -871,7 +871,6 @@ go_result spherist_kin_jac_inv(void *kins,
 			   go_real *jointvels)
 {
   go_real mat[6][6];
-  go_real inv[6][6];
   go_real our_joints[6];
   go_real * joints;
   go_real velvec[6];
@@ -888,9 +887,6 @@ go_result spherist_kin_jac_inv(void *kins,
   retval = jac_fwd_mat(kins, joints, mat);
   if (GO_RESULT_OK != retval) return retval;
   
-  retval = go_mat6_inv(mat, inv);
-  if (GO_RESULT_OK != retval) return retval;
-
   velvec[0] = vel->v.x;
   velvec[1] = vel->v.y;
   velvec[2] = vel->v.z;
@@ -898,5 +894,5 @@ go_result spherist_kin_jac_inv(void *kins,
   velvec[4] = vel->w.y;
   velvec[5] = vel->w.z;
 
-  return go_mat6_vec6_mult(inv, velvec, jointvels);
+  return go_mat6_solve(mat, velvec, jointvels);
 } 
@@ -145,6 +145,13 @@ typedef struct {
   go_real cycle_time;		/*< actual cycle time */
   char program[TASK_CMD_PROGRAM_LEN];
   task_state_model_type state_model;
+  go_real program_time;		/*< planned motion time of the program */
+  go_integer interp_list_size;	/*< how many entries the interp list holds */
+  go_integer interp_list_howmany; /*< how many are on it now */
+  go_integer interp_list_high_water; /*< the most ever on it */
+  go_integer compress_in;	/*< feeds the program has read */
+  go_integer compress_out;	/*< moves they were merged into */
+  go_real compress_deviation;	/*< furthest the merged path strays */
   task_error error[TASK_ERROR_MAX];
   go_integer error_index;		/*< index of oldest error */
   unsigned char tail;
@@ -26,6 +26,7 @@
 #include "rs274ngc.h"
 #include "rs274ngc_return.h"
 #include "interplist.h"
+#include "canon_go.h"		/* canon_go_flush, ... */
 
 #define CONNECT_WAIT_TIME 10.0
 
@@ -79,6 +80,35 @@ static double old_scale = 1.0;
   functions, read by do_cmd_execute.
 */
 interplist_struct task_interplist;
+
+/*
+  When [TASK] READ_AHEAD is more than zero, the interpreter runs ahead
+  of motion in its own thread, keeping up to that many entries on the
+  interp list, and do_cmd_execute only takes them off. The interp list
+  and the interpreter are shared with the read-ahead thread under
+  'interp_mutex'. Reading ahead stops at each wait for motion, e.g.,
+  before a tool change or after a probe or program stop, since what
+  follows may depend on where the machine really is, and resumes once
+  Task is done waiting. With READ_AHEAD = 0, do_cmd_execute reads the
+  program itself as it goes.
+*/
+#define DEFAULT_READ_AHEAD 100
+static int interp_read_ahead = DEFAULT_READ_AHEAD;
+/*
+  The interp list is allocated once to hold [TASK] INTERP_LIST_SIZE
+  entries. A single program line can put several entries on it, e.g.,
+  a wait for motion, a wait for the tool and a tool command for each
+  of a spindle, coolant and tool change, so we read ahead no further
+  than INTERP_LINE_MAX short of full.
+*/
+#define DEFAULT_INTERP_LIST_SIZE 1000
+#define INTERP_LINE_MAX 16
+static int interp_list_size = DEFAULT_INTERP_LIST_SIZE;
+static void *interp_mutex = NULL;
+static int interp_running = 0;	/* set while a program is open */
+static int interp_waiting = 0;	/* set while Task waits for motion */
+static int interp_retval = 0;	/* how the interpreter last stopped */
+
 /*
   The global Go units, written here in ini_load and referenced in
   the Go canonical interface.
@@ -88,6 +118,13 @@ double m_per_length_units = 1.0;
 double angle_units_per_rad = 1.0;
 double rad_per_angle_units = 1.0;
 
+/*
+  How far, in meters, the Go canonical interface may let the path stray
+  when merging runs of short feeds into longer lines and arcs, written
+  here in ini_load from [TASK] COMPRESS_TOL. Zero means no merging.
+*/
+double canon_compress_tol = 0.0;
+
 /* the time in seconds we make it take for transitions from x-ing to x-ed */
 #define TRANSITION_TIME 1.0
 
@@ -103,6 +140,59 @@ static void resend_traj_cmd(traj_cmd_struct *traj_cmd)
   traj_comm_ptr->traj_cmd = *traj_cmd;
 }
 
+/*
+  Streamed moves go on Traj's command ring instead of through the
+  command buffer, so Task doesn't have to wait for Traj to take each
+  one. Traj credits us with how many moves it has room for on its
+  queue, as of where it took the ring to, so the moves we've put
+  since then count against that.
+*/
+static void put_traj_ring(traj_cmd_move_world *move)
+{
+  traj_cmd_ring *ring = &traj_comm_ptr->traj_ring;
+  go_integer put = ring->put;
+
+  ring->move[put] = *move;
+  /* make sure Traj sees the move before it sees the new 'put' */
+  TRAJ_RING_BARRIER();
+  ring->put = traj_ring_next(put);
+}
+
+static go_integer traj_ring_credits(traj_stat_struct *traj_stat)
+{
+  traj_cmd_ring *ring = &traj_comm_ptr->traj_ring;
+  go_integer credits;
+
+  credits = traj_stat->ring_credits -
+    (ring->put - traj_stat->ring_get + TRAJ_CMD_RING_SIZE) % TRAJ_CMD_RING_SIZE;
+  if (credits > traj_ring_room(ring)) credits = traj_ring_room(ring);
+
+  return credits < 0 ? 0 : credits;
+}
+
+/*
+  Returns non-zero if Traj can take more moves, either as credits on
+  the ring it's already streaming from, or by starting a new stream.
+*/
+static int traj_can_take_moves(traj_cmd_struct *traj_cmd, traj_stat_struct *traj_stat)
+{
+  if (traj_stat->echo_serial_number != traj_cmd->serial_number) return 0;
+  if (TRAJ_CMD_STREAM_WORLD_TYPE != traj_stat->command_type) return 1;
+  return traj_ring_credits(traj_stat) > 0;
+}
+
+/*
+  Returns non-zero if Traj is done with the last command and all the
+  moves we put on the ring, or quit with an error.
+*/
+static int traj_is_done(traj_cmd_struct *traj_cmd, traj_stat_struct *traj_stat)
+{
+  if (traj_stat->echo_serial_number != traj_cmd->serial_number) return 0;
+  if (traj_stat->status == GO_RCS_STATUS_ERROR) return 1;
+  return traj_stat->status != GO_RCS_STATUS_EXEC &&
+    traj_stat->ring_get == traj_comm_ptr->traj_ring.put;
+}
+
 static void write_traj_cfg(traj_cfg_struct *traj_cfg)
 {
   traj_cfg->tail = ++traj_cfg->head;
@@ -545,12 +635,89 @@ static void do_cmd_start(char *path, task_stat_struct *stat, task_set_struct *se
   }
 }
 
+/*
+  Reads and executes the next program line, returning the reader's
+  result if it's not RS274NGC_OK, otherwise the executor's.
+*/
+static int interp_read_execute(void)
+{
+  int retval;
+
+  retval = rs274ngc_c_read();
+  if (RS274NGC_OK == retval) retval = rs274ngc_c_execute(NULL);
+  /* once the program stops, nothing more will end a run of feeds */
+  if (RS274NGC_OK != retval) canon_go_flush();
+
+  return retval;
+}
+
+/*
+  Without a read-ahead thread, reads lines until something's on the
+  interp list or the program ends. With one, does nothing.
+*/
+static void interp_read_inline(void)
+{
+  interplist_type val;
+
+  if (interp_read_ahead > 0) return;
+
+  while (-1 == interplist_peek(&task_interplist, &val) &&
+	 RS274NGC_OK == interp_retval) {
+    interp_retval = interp_read_execute();
+  }
+}
+
+/*
+  Returns non-zero if the read-ahead thread can read the next line,
+  that is, a program is open and hasn't ended, there's room on the
+  interp list, and no wait for motion is pending.
+*/
+static int interp_can_read_ahead(void)
+{
+  return interp_running &&
+    RS274NGC_OK == interp_retval &&
+    ! interp_waiting &&
+    interplist_howmany(&task_interplist) < (unsigned int) interp_read_ahead &&
+    0 != interplist_find(&task_interplist, TASK_EXEC_WAIT_FOR_MOTION_TYPE);
+}
+
+typedef struct {
+  ulapi_real period;
+} interp_read_ahead_args;
+
+/*
+  The read-ahead thread reads and executes program lines one at a time
+  while it can, taking the mutex for each, and checks back every
+  period when it can't.
+*/
+static void interp_read_ahead_code(void *args)
+{
+  ulapi_real period = ((interp_read_ahead_args *) args)->period;
+  int can_read;
+
+  while (! do_exit) {
+    ulapi_mutex_take(interp_mutex);
+    can_read = interp_can_read_ahead();
+    if (can_read) {
+      interp_retval = interp_read_execute();
+    }
+    ulapi_mutex_give(interp_mutex);
+    if (! can_read) ulapi_sleep(period);
+  }
+
+  ulapi_task_exit(0);
+}
+
 static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *set, traj_cmd_struct *traj_cmd, traj_stat_struct *traj_stat, traj_set_struct *traj_set, tool_cmd_struct *tool_cmd, tool_stat_struct *tool_stat)
 {
   static ulapi_real dclock;
+  static go_real planned_start;	/* traj's planned time when we began */
+  static unsigned int overflows; /* interp list overflows when we began */
   char full_program[TASK_CMD_PROGRAM_LEN];
   int retval;
   interplist_type val;
+  traj_cmd_move_world move;
+  go_integer credits;
   enum {
     GO_RCS_STATE_WAITING_FOR_DELAY = GO_RCS_STATE_LAST,
     GO_RCS_STATE_WAITING_FOR_MOTION,
@@ -568,6 +735,7 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
       go_state_next(stat, GO_RCS_STATE_S0);
     } else {
       interplist_clear(&task_interplist);
+      canon_go_reset();
       if (ulapi_ispath(path)) {
 	/* it probably came from a file selector */
 	ulapi_snprintf(full_program, sizeof(full_program), "%s", path);
@@ -586,6 +754,12 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
       } else {
 	ulapi_strncpy(stat->program, path, sizeof(stat->program));
 	stat->program[sizeof(stat->program)-1] = 0;
+	planned_start = traj_stat->planned_time;
+	stat->program_time = 0.0;
+	interp_retval = RS274NGC_OK;
+	interp_waiting = 0;
+	interp_running = 1;
+	overflows = task_interplist.overflows;
 	dclock = TRANSITION_TIME;
 	stat->state_model = TASK_STATE_STARTING;
 	go_status_next(stat, GO_RCS_STATUS_EXEC);
@@ -599,12 +773,26 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
       go_state_next(stat, GO_RCS_STATE_S5); /* inserting S5 here for S2 */
     }
   } else if (go_state_match(stat, GO_RCS_STATE_S5)) {
+    /* the planned time grows as the program's moves are queued */
+    stat->program_time = traj_stat->planned_time - planned_start;
     if (in_failure) {
       go_status_next(stat, GO_RCS_STATUS_ERROR);
       go_state_next(stat, GO_RCS_STATE_FAILURE);
     } else {
       /* check subordinates for errors, and stop everything if so */
-      if (traj_stat->echo_serial_number == traj_cmd->serial_number &&
+      if (task_interplist.overflows != overflows) {
+	/* we've lost part of the program, so it can't go on */
+	CMD_PRINT_2("task: interp list full at %d entries\n", (int) task_interplist.size);
+	add_task_error(stat, set, TASK_ERROR_OUT_OF_MEMORY);
+	rs274ngc_c_close();
+	interp_running = 0;
+	traj_cmd->type = TRAJ_CMD_STOP_TYPE;
+	write_traj_cmd(traj_cmd);
+	tool_cmd->type = TOOL_CMD_ABORT_TYPE;
+	write_tool_cmd(tool_cmd);
+	go_status_next(stat, GO_RCS_STATUS_ERROR);
+	go_state_next(stat, GO_RCS_STATE_S6);
+      } else if (traj_stat->echo_serial_number == traj_cmd->serial_number &&
 	  traj_stat->status == GO_RCS_STATUS_ERROR) {
 	tool_cmd->type = TOOL_CMD_ABORT_TYPE;
 	write_tool_cmd(tool_cmd);
@@ -615,21 +803,24 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
 	write_traj_cmd(traj_cmd);
 	go_state_next(stat, GO_RCS_STATE_S6);
       } else {
-	/* handle the interp list */
+	/* handle the interp list, sending moves only when Traj can
+	   take them */
 	if ((-1 != interplist_peek(&task_interplist, &val)) &&
 	    (TRAJ_CMD_MOVE_WORLD_TYPE == val.type &&
-	     traj_stat->queue_count > traj_set->queue_size / 2)) {
+	     ! traj_can_take_moves(traj_cmd, traj_stat))) {
 	  go_state_next(stat, GO_RCS_STATE_WAITING_FOR_MOTION_QUEUE);
 	} else {
 	  if (-1 != interplist_get(&task_interplist, &val)) {
 	    switch (val.type) {
 	    case TASK_EXEC_DELAY_TYPE:
-	      CMD_PRINT_3("task: %s %f\n", task_cmd_symbol(val.type), (double) val.u.task_cmd.u.delay.time);
-	      dclock = val.u.task_cmd.u.delay.time;
+	      CMD_PRINT_3("task: %s %f\n", task_cmd_symbol(val.type), (double) val.u.delay.time);
+	      dclock = val.u.delay.time;
 	      go_state_next(stat, GO_RCS_STATE_WAITING_FOR_DELAY);
 	      break;
 	    case TASK_EXEC_WAIT_FOR_MOTION_TYPE:
 	      CMD_PRINT_2("task: %s\n", task_cmd_symbol(val.type));
+	      /* hold off reading ahead until we're done waiting */
+	      interp_waiting = 1;
 	      go_state_next(stat, GO_RCS_STATE_WAITING_FOR_MOTION);
 	      break;
 	    case TASK_EXEC_WAIT_FOR_TOOL_TYPE:
@@ -637,39 +828,64 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
 	      go_state_next(stat, GO_RCS_STATE_WAITING_FOR_TOOL);
 	      break;
 	    case TRAJ_CMD_MOVE_WORLD_TYPE:
-	      CMD_PRINT_3("task: %s %f ...\n", traj_cmd_symbol(val.type), (double) val.u.traj_cmd.u.move_world.end.tran.x);
-	      /* leave serial number, head and tail alone, and just
-		 copy over the type and data */
-	      traj_cmd->type = val.type;
-	      traj_cmd->u = val.u.traj_cmd.u;
-	      /* and set the move accel, jerk with our settings */
-	      traj_cmd->u.move_world.ta = traj_set->max_tacc;
-	      traj_cmd->u.move_world.tj = traj_set->max_tjerk;
-	      traj_cmd->u.move_world.ra = traj_set->max_racc;
-	      traj_cmd->u.move_world.rj = traj_set->max_rjerk;
-	      write_traj_cmd(traj_cmd);
+	      if (TRAJ_CMD_STREAM_WORLD_TYPE != traj_stat->command_type) {
+		/* leave serial number, head and tail alone, and just
+		   tell Traj to start streaming moves from the ring */
+		traj_cmd->type = TRAJ_CMD_STREAM_WORLD_TYPE;
+		write_traj_cmd(traj_cmd);
+	      }
+	      /* put this and the moves right after it on the ring,
+		 as many as Traj has credited us with */
+	      credits = traj_ring_credits(traj_stat);
+	      while (1) {
+		CMD_PRINT_3("task: %s %f ...\n", traj_cmd_symbol(val.type), (double) val.u.move_world.end.tran.x);
+		move = val.u.move_world;
+		/* and set the move accel, jerk with our settings */
+		move.ta = traj_set->max_tacc;
+		move.tj = traj_set->max_tjerk;
+		move.ra = traj_set->max_racc;
+		move.rj = traj_set->max_rjerk;
+		put_traj_ring(&move);
+		if (--credits <= 0) break;
+		interp_read_inline();
+		if (-1 == interplist_peek(&task_interplist, &val) ||
+		    TRAJ_CMD_MOVE_WORLD_TYPE != val.type) break;
+		(void) interplist_get(&task_interplist, &val);
+	      }
 	      break;
 	    case TOOL_CMD_ON_TYPE:
-	      CMD_PRINT_4("task: %s [%d] %f\n", tool_cmd_symbol(val.type), (int) val.u.tool_cmd.id, (double) val.u.tool_cmd.u.on.value);
+	      CMD_PRINT_4("task: %s [%d] %f\n", tool_cmd_symbol(val.type), (int) val.u.tool.id, (double) val.u.tool.on.value);
 	      tool_cmd->type = val.type;
-	      tool_cmd->id = val.u.tool_cmd.id;
-	      tool_cmd->u = val.u.tool_cmd.u;
+	      tool_cmd->id = val.u.tool.id;
+	      tool_cmd->u.on = val.u.tool.on;
 	      write_tool_cmd(tool_cmd);
 	      break;
 	    case TOOL_CMD_OFF_TYPE:
-	      CMD_PRINT_3("task: %s [%d]\n", tool_cmd_symbol(val.type), (int) val.u.tool_cmd.id);
+	      CMD_PRINT_3("task: %s [%d]\n", tool_cmd_symbol(val.type), (int) val.u.tool.id);
 	      tool_cmd->type = val.type;
-	      tool_cmd->id = val.u.tool_cmd.id;
-	      tool_cmd->u = val.u.tool_cmd.u;
+	      tool_cmd->id = val.u.tool.id;
+	      tool_cmd->u.on = val.u.tool.on;
 	      write_tool_cmd(tool_cmd);
 	      break;
 	    default:
 	      CMD_PRINT_2("task: unknown type %d\n", (int) val.type);
 	    } /* switch (val.type) */
 	  } else {
-	    retval = rs274ngc_c_read();
+	    /* the list is empty, so read more if it's up to us,
+	       and handle how the program ended if nothing more
+	       came of it */
+	    interp_read_inline();
+	    if (RS274NGC_OK == interp_retval ||
+		-1 != interplist_peek(&task_interplist, &val)) {
+	      retval = RS274NGC_OK;
+	    } else {
+	      retval = interp_retval;
+	      interp_retval = RS274NGC_OK;
+	      interp_running = 0;
+	    }
 	    if (RS274NGC_ENDFILE == retval ||
-		RS274NGC_EXECUTE_FINISH == retval) {
+		RS274NGC_EXECUTE_FINISH == retval ||
+		RS274NGC_EXIT == retval) {
 	      rs274ngc_c_close();
 	      go_status_next(stat, GO_RCS_STATUS_DONE);
 	      go_state_next(stat, GO_RCS_STATE_S6);
@@ -679,21 +895,6 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
 	      rs274ngc_c_close();
 	      go_status_next(stat, GO_RCS_STATUS_ERROR);
 	      go_state_next(stat, GO_RCS_STATE_S6);
-	    } else {
-	      retval = rs274ngc_c_execute(NULL);
-	      if (RS274NGC_ENDFILE == retval ||
-		  RS274NGC_EXECUTE_FINISH == retval ||
-		  RS274NGC_EXIT == retval) {
-		rs274ngc_c_close();
-		go_status_next(stat, GO_RCS_STATUS_DONE);
-		go_state_next(stat, GO_RCS_STATE_S6);
-	      } else if (RS274NGC_OK != retval) {
-		add_task_error(stat, set, TASK_ERROR_PROGRAM_ERROR);
-		CMD_PRINT_2("task: %s\n", rs274ngc_c_error(retval));
-		rs274ngc_c_close();
-		go_status_next(stat, GO_RCS_STATUS_ERROR);
-		go_state_next(stat, GO_RCS_STATE_S6);
-	      }
 	    }
 	  }
 	}
@@ -714,8 +915,8 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
       go_status_next(stat, GO_RCS_STATUS_ERROR);
       go_state_next(stat, GO_RCS_STATE_FAILURE);
     } else {
-      if (traj_stat->echo_serial_number == traj_cmd->serial_number &&
-	  traj_stat->status != GO_RCS_STATUS_EXEC) {
+      if (traj_is_done(traj_cmd, traj_stat)) {
+	interp_waiting = 0;
 	go_state_next(stat, GO_RCS_STATE_S5);
       }
     }
@@ -724,7 +925,7 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
       go_status_next(stat, GO_RCS_STATUS_ERROR);
       go_state_next(stat, GO_RCS_STATE_FAILURE);
     } else {
-      if (traj_stat->queue_count < traj_set->queue_size / 2) {
+      if (traj_can_take_moves(traj_cmd, traj_stat)) {
 	go_state_next(stat, GO_RCS_STATE_S5);
       }
     }
@@ -748,14 +949,16 @@ static void do_cmd_execute(char *path, task_stat_struct *stat, task_set_struct *
     go_state_next(stat, GO_RCS_STATE_S2);
   } else if (go_state_match(stat, GO_RCS_STATE_S6)) {
     /* wait for traj and tool to finish */
-    if (traj_stat->echo_serial_number == traj_cmd->serial_number &&
-	traj_stat->status != GO_RCS_STATUS_EXEC &&
+    if (traj_is_done(traj_cmd, traj_stat) &&
 	tool_stat->echo_serial_number == tool_cmd->serial_number &&
 	tool_stat->status != GO_RCS_STATUS_EXEC) {
       go_state_next(stat, GO_RCS_STATE_S2);
     }
     /* else keep waiting */
   } else if (go_state_match(stat, GO_RCS_STATE_S2)) {
+    stat->program_time = traj_stat->planned_time - planned_start;
+    CMD_PRINT_2("task: cmd execute planned motion time %f\n", (double) stat->program_time);
+    CMD_PRINT_4("task: cmd execute compressed %d feeds to %d moves, deviation %g\n", (int) stat->compress_in, (int) stat->compress_out, (double) stat->compress_deviation);
     dclock = TRANSITION_TIME;
     stat->state_model = TASK_STATE_COMPLETING;
     go_state_next(stat, GO_RCS_STATE_S3);
@@ -1068,6 +1271,8 @@ static int ini_load(char *inifile_name,
 		    char *tool_file_name, size_t tool_file_name_len,
 		    double *mttf,
 		    double *mttr,
+		    int *read_ahead,
+		    int *interp_list_size,
 		    int *traj_shm_key,
 		    int *tool_shm_key)
 {
@@ -1199,6 +1404,40 @@ static int ini_load(char *inifile_name,
     CLOSE_AND_RETURN;
   }
 
+  key = "READ_AHEAD";
+  inistring = ini_find(fp, key, section);
+  if (NULL == inistring) {
+    /* optional, leave as default */
+  } else if (1 != sscanf(inistring, "%i", read_ahead) || *read_ahead < 0) {
+    fprintf(stderr, "task: bad entry: [%s] %s = %s\n", section, key, inistring);
+    CLOSE_AND_RETURN;
+  }
+
+  key = "COMPRESS_TOL";
+  inistring = ini_find(fp, key, section);
+  if (NULL == inistring) {
+    /* optional, leave as default */
+  } else if (1 != sscanf(inistring, "%lf", &d1) || d1 < 0) {
+    fprintf(stderr, "task: bad entry: [%s] %s = %s\n", section, key, inistring);
+    CLOSE_AND_RETURN;
+  } else {
+    canon_compress_tol = d1 * m_per_length_units;
+  }
+
+  key = "INTERP_LIST_SIZE";
+  inistring = ini_find(fp, key, section);
+  if (NULL == inistring) {
+    /* optional, leave as default */
+  } else if (1 != sscanf(inistring, "%i", interp_list_size) ||
+	     *interp_list_size <= INTERP_LINE_MAX) {
+    fprintf(stderr, "task: bad entry: [%s] %s = %s\n", section, key, inistring);
+    CLOSE_AND_RETURN;
+  }
+  if (*read_ahead > *interp_list_size - INTERP_LINE_MAX) {
+    fprintf(stderr, "task: [%s] READ_AHEAD too big, using %d\n", section, *interp_list_size - INTERP_LINE_MAX);
+    *read_ahead = *interp_list_size - INTERP_LINE_MAX;
+  }
+
   section = "TRAJ";
 
   key = "SHM_KEY";
@@ -1252,6 +1491,7 @@ int main(int argc, char *argv[])
   task_comm_struct *task_comm_ptr;
   task_stat_struct task_stat;
   task_set_struct task_set;
+  canon_go_compress_stats compress_stats;
   task_cmd_struct pp_task_cmd[2], *task_cmd_ptr, *task_cmd_test;
   task_cfg_struct pp_task_cfg_struct[2], *task_cfg_ptr, *task_cfg_test;
 
@@ -1276,6 +1516,9 @@ int main(int argc, char *argv[])
   double next_time;
   int do_failures = 0;
 
+  void *interp_task;
+  interp_read_ahead_args interp_args;
+
   ulapi_real end;
   ulapi_real start_time;
 
@@ -1334,7 +1577,7 @@ int main(int argc, char *argv[])
     return 1;
   } 
 
-  if (0 != ini_load(inifile_name, &task_shm_key, &task_cycle_time, &task_debug, &task_strict, prog_dir, sizeof(prog_dir), parameter_file_name, sizeof(parameter_file_name), tool_file_name, sizeof(tool_file_name), &mttf, &mttr, &traj_shm_key, &tool_shm_key)) {
+  if (0 != ini_load(inifile_name, &task_shm_key, &task_cycle_time, &task_debug, &task_strict, prog_dir, sizeof(prog_dir), parameter_file_name, sizeof(parameter_file_name), tool_file_name, sizeof(tool_file_name), &mttf, &mttr, &interp_read_ahead, &interp_list_size, &traj_shm_key, &tool_shm_key)) {
     return 1;
   }
 
@@ -1476,6 +1719,13 @@ int main(int argc, char *argv[])
   task_stat.cycle_time = task_cycle_time;
   task_stat.program[0] = 0;
   task_stat.state_model = TASK_STATE_STOPPED;
+  task_stat.program_time = 0.0;
+  task_stat.interp_list_size = interp_list_size;
+  task_stat.interp_list_howmany = 0;
+  task_stat.interp_list_high_water = 0;
+  task_stat.compress_in = 0;
+  task_stat.compress_out = 0;
+  task_stat.compress_deviation = 0.0;
   for (t = 0; t < TASK_ERROR_MAX; t++) {
     task_stat.error[t].timestamp = ulapi_time();
     task_stat.error[t].code = TASK_ERROR_NONE;
@@ -1493,7 +1743,10 @@ int main(int argc, char *argv[])
   task_set.tail = task_set.head;
 
   /* initialize the NC code interpreter */
-  interplist_init(&task_interplist);
+  if (0 != interplist_init(&task_interplist, interp_list_size)) {
+    fprintf(stderr, "task: can't allocate interp list of %d entries\n", interp_list_size);
+    exit(0);
+  }
   if (0 != *parameter_file_name) {
     retval = rs274ngc_c_restore_parameters(parameter_file_name);
     if (RS274NGC_OK != retval ) {
@@ -1510,6 +1763,19 @@ int main(int argc, char *argv[])
   if (RS274NGC_OK != retval ) {
     TASK_PRINT_1("task: can't initialize NC code interpreter\n");
   }
+  interp_retval = RS274NGC_OK;
+
+  /* start the interpreter read-ahead thread, if we're reading ahead */
+  if (interp_read_ahead > 0) {
+    interp_mutex = ulapi_mutex_new(task_shm_key);
+    interp_task = ulapi_task_new();
+    if (NULL == interp_mutex || NULL == interp_task) {
+      fprintf(stderr, "task: can't start interpreter read-ahead\n");
+      exit(0);
+    }
+    interp_args.period = task_cycle_time;
+    ulapi_task_start(interp_task, interp_read_ahead_code, &interp_args, ulapi_prio_lowest(), 0);
+  }
 
   /* set up failure and repair statistical distributions */
   if (mttf > 0 && mttr > 0) {
@@ -1570,6 +1836,9 @@ int main(int argc, char *argv[])
       tool_set_test = tmp;
     }
 
+    /* the interp list and interpreter are ours until we're done */
+    if (NULL != interp_mutex) ulapi_mutex_take(interp_mutex);
+
     switch (cmd_type) {
     case 0:
     case -1:
@@ -1590,6 +1859,8 @@ int main(int argc, char *argv[])
       if (cmd_serial_number != task_stat.echo_serial_number) {
 	task_stat.echo_serial_number = cmd_serial_number;
 	task_stat.state = GO_RCS_STATE_NEW_COMMAND;
+	/* any new command stops reading ahead in a running program */
+	interp_running = 0;
       }
       break;
 
@@ -1669,6 +1940,15 @@ int main(int argc, char *argv[])
       break;
     }
 
+    task_stat.interp_list_howmany = interplist_howmany(&task_interplist);
+    task_stat.interp_list_high_water = task_interplist.high_water;
+    canon_go_stats(&compress_stats);
+    task_stat.compress_in = compress_stats.in;
+    task_stat.compress_out = compress_stats.out;
+    task_stat.compress_deviation = compress_stats.deviation;
+
+    if (NULL != interp_mutex) ulapi_mutex_give(interp_mutex);
+
     switch (task_set.command_type) {
     case TASK_CFG_NOP_TYPE:
       do_cfg_nop(&task_set);
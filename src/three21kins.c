@@ -177,17 +177,23 @@ go_result three21_kin_get_parameters(three21_kin_struct *kins, go_link *params,
   return GO_RESULT_OK;
 }
 
-go_result three21_kin_fwd(three21_kin_struct *kins,
-			const go_real *joints,
-			go_pose *world)
+/*
+  The forward kinematics without the flags, which the batches need
+  only once, giving the sines and cosines of joint 1 and of joints 2
+  and 3 together for the flags.
+*/
+static void three21_fwd_hom(three21_kin_struct *kins,
+			    const go_real *joints,
+			    go_hom *hom,
+			    go_real *s1p, go_real *c1p,
+			    go_real *s23p, go_real *c23p)
 {
   go_real s1, s2, s3, s4, s5, s6;
   go_real c1, c2, c3, c4, c5, c6;
   go_real s23;
   go_real c23;
   go_real t1, t2, t3, t4, t5;
-  go_real sum_sq, k, d23;
-  go_hom hom;
+  go_real d23;
 
   go_sincos(joints[0], &s1, &c1);
   go_sincos(joints[1], &s2, &c2);
@@ -209,9 +215,9 @@ go_result three21_kin_fwd(three21_kin_struct *kins,
   t5 = c23 * s5 * c6;
 
   /* Define first column of rotation matrix */
-  hom.rot.x.x = c1 * t4 + s1 * t3;
-  hom.rot.x.y = s1 * t4 - c1 * t3;
-  hom.rot.x.z = -s23 * t1 - t5;
+  hom->rot.x.x = c1 * t4 + s1 * t3;
+  hom->rot.x.y = s1 * t4 - c1 * t3;
+  hom->rot.x.z = -s23 * t1 - t5;
 
   /* Calculate terms to be used in definition of...  */
   /* second column of rotation matrix.               */
@@ -222,18 +228,18 @@ go_result three21_kin_fwd(three21_kin_struct *kins,
   t5 = c23 * s5 * s6;
 
   /* Define second column of rotation matrix */
-  hom.rot.y.x = c1 * t4 + s1 * t3;
-  hom.rot.y.y = s1 * t4 - c1 * t3;
-  hom.rot.y.z = -s23 * t1 + t5;
+  hom->rot.y.x = c1 * t4 + s1 * t3;
+  hom->rot.y.y = s1 * t4 - c1 * t3;
+  hom->rot.y.z = -s23 * t1 + t5;
 
   /* Calculate term to be used in definition of... */
   /* third column of rotation matrix.              */
   t1 = c23 * c4 * s5 + s23 * c5;
 
   /* Define third column of rotation matrix */
-  hom.rot.z.x = -c1 * t1 - s1 * s4 * s5;
-  hom.rot.z.y = -s1 * t1 + c1 * s4 * s5;
-  hom.rot.z.z = s23 * c4 * s5 - c23 * c5;
+  hom->rot.z.x = -c1 * t1 - s1 * s4 * s5;
+  hom->rot.z.y = -s1 * t1 + c1 * s4 * s5;
+  hom->rot.z.z = s23 * c4 * s5 - c23 * c5;
 
   /* Calculate term to be used in definition of...  */
   /* position vector.                               */
@@ -241,9 +247,38 @@ go_result three21_kin_fwd(three21_kin_struct *kins,
 
   /* Define position vector */
   d23 = kins->d2 + kins->d3;
-  hom.tran.x = c1 * t1 - d23 * s1;
-  hom.tran.y = s1 * t1 + d23 * c1;
-  hom.tran.z = -kins->a3 * s23 - kins->a2 * s2 - kins->d4 * c23;
+  hom->tran.x = c1 * t1 - d23 * s1;
+  hom->tran.y = s1 * t1 + d23 * c1;
+  hom->tran.z = -kins->a3 * s23 - kins->a2 * s2 - kins->d4 * c23;
+
+  *s1p = s1;
+  *c1p = c1;
+  *s23p = s23;
+  *c23p = c23;
+}
+
+go_result three21_kin_fwd_hom(three21_kin_struct *kins,
+			      const go_real *joints,
+			      go_hom *hom)
+{
+  go_real s1, c1, s23, c23;
+
+  three21_fwd_hom(kins, joints, hom, &s1, &c1, &s23, &c23);
+
+  return GO_RESULT_OK;
+}
+
+go_result three21_kin_fwd(three21_kin_struct *kins,
+			const go_real *joints,
+			go_pose *world)
+{
+  go_real s1, c1, s23, c23;
+  go_real t1, t2;
+  go_real sum_sq, k, d23;
+  go_hom hom;
+
+  three21_fwd_hom(kins, joints, &hom, &s1, &c1, &s23, &c23);
+  d23 = kins->d2 + kins->d3;
 
   /* Calculate terms to be used to...   */
   /* determine flags.                   */
@@ -290,46 +325,128 @@ go_result three21_kin_fwd(three21_kin_struct *kins,
   return go_hom_pose_convert(&hom, world);
 }
 
-go_result three21_kin_inv(three21_kin_struct *kins,
-			  const go_pose *world,
-			  go_real *joints)
+/*
+  The arm joint 2 and the wrist joints for the shoulder solution 'th1'
+  and the elbow solution 'th3', as in the unflipped wrist, shared by
+  the single and all-solutions inverses. Returns GO_RESULT_SINGULAR
+  if the wrist is singular.
+*/
+static go_result three21_inv_arm_wrist(three21_kin_struct *kins,
+				       const go_hom *hom,
+				       go_real th1, go_real s1, go_real c1,
+				       go_real th3,
+				       go_real *joints)
 {
-  go_hom hom;
-
   go_real t1, t2, t3;
-  go_real k, sum_sq, d23;
-
-  go_real th1;
-  go_real th3;
   go_real th23;
-  go_real th2;
-  go_real th4;
-  go_real th5;
-  go_real th6;
-
-  go_real s1, c1;
   go_real s3, c3;
   go_real s23, c23;
   go_real s4, c4;
   go_real s5, c5;
   go_real s6, c6;
 
+  /* compute sin, cos for later calcs */
+  go_sincos(th3, &s3, &c3);
+
+  /* Joint 2 */
+
+  t1 = (-kins->a3 - kins->a2 * c3) * hom->tran.z + (c1 * hom->tran.x + s1 * hom->tran.y - kins->a1) * (kins->a2 * s3 - kins->d4);
+  t2 = (kins->a2 * s3 - kins->d4) * hom->tran.z + (kins->a3 + kins->a2 * c3) * (c1 * hom->tran.x + s1 * hom->tran.y - kins->a1);
+  t3 = hom->tran.z * hom->tran.z + (c1 * hom->tran.x + s1 * hom->tran.y - kins->a1) * (c1 * hom->tran.x + s1 * hom->tran.y - kins->a1);
+
+  th23 = atan2(t1, t2);
+  joints[0] = th1;
+  joints[1] = th23 - th3;
+  joints[2] = th3;
+
+  /* compute sin, cos for later calcs */
+  s23 = t1 / t3;
+  c23 = t2 / t3;
+
+  /* Joint 4 */
+
+  t1 = -hom->rot.z.x * s1 + hom->rot.z.y * c1;
+  t2 = -hom->rot.z.x * c1 * c23 - hom->rot.z.y * s1 * c23 + hom->rot.z.z * s23;
+  if (fabs(t1) < SINGULAR_FUZZ && fabs(t2) < SINGULAR_FUZZ) {
+    return GO_RESULT_SINGULAR;
+  }
+
+  joints[3] = atan2(t1, t2);
+
+  /* compute sin, cos for later calcs */
+  s4 = sin(joints[3]);
+  c4 = cos(joints[3]);
+
+  /* Joint 5 */
+
+  s5 = hom->rot.z.z * (s23 * c4) -
+    hom->rot.z.x * (c1 * c23 * c4 + s1 * s4) -
+    hom->rot.z.y * (s1 * c23 * c4 - c1 * s4);
+  c5 = -hom->rot.z.x * (c1 * s23) - hom->rot.z.y *
+    (s1 * s23) - hom->rot.z.z * c23;
+  joints[4] = atan2(s5, c5);
+
+  /* Joint 6 */
+
+  s6 = hom->rot.x.z * (s23 * s4) - hom->rot.x.x *
+    (c1 * c23 * s4 - s1 * c4) - hom->rot.x.y * (s1 * c23 * s4 + c1 * c4);
+  c6 = hom->rot.x.x * ((c1 * c23 * c4 + s1 * s4) *
+		       c5 - c1 * s23 * s5) + hom->rot.x.y *
+    ((s1 * c23 * c4 - c1 * s4) * c5 - s1 * s23 * s5) -
+    hom->rot.x.z * (s23 * c4 * c5 + c23 * s5);
+  joints[5] = atan2(s6, c6);
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Is wrist flip the normal or offset result? Absent agreement on
+  this, we'll just define it ourselves.
+*/
+static void three21_inv_flip(const go_real *joints, go_real *flipped)
+{
+  flipped[0] = joints[0];
+  flipped[1] = joints[1];
+  flipped[2] = joints[2];
+  flipped[3] = joints[3] + GO_PI;
+  flipped[4] = -joints[4];
+  flipped[5] = joints[5] + GO_PI;
+}
+
+go_result three21_kin_inv(three21_kin_struct *kins,
+			  const go_pose *world,
+			  go_real *joints)
+{
+  go_hom hom;
+
   /* convert pose to hom */
   go_pose_hom_convert(world, &hom);
 
+  return three21_kin_inv_hom(kins, &hom, joints);
+}
+
+go_result three21_kin_inv_hom(three21_kin_struct *kins,
+			      const go_hom *hom,
+			      go_real *joints)
+{
+  go_real k, sum_sq, d23;
+  go_real th1, th3;
+  go_real s1, c1;
+  go_result retval;
+
   /* Joint 1 (2 independent solutions) */
 
   /* save sum of squares for this and subsequent calcs */
   d23 = kins->d2 + kins->d3;
-  sum_sq = hom.tran.x * hom.tran.x
-    + hom.tran.y * hom.tran.y 
+  sum_sq = hom->tran.x * hom->tran.x
+    + hom->tran.y * hom->tran.y 
     - d23 * d23;
 
   /* FIXME-- is use of + sqrt shoulder right or left? */
   if (kins->iflags & THREE21_SHOULDER_RIGHT) {
-    th1 = atan2(hom.tran.y, hom.tran.x) - atan2(d23, -sqrt(sum_sq));
+    th1 = atan2(hom->tran.y, hom->tran.x) - atan2(d23, -sqrt(sum_sq));
   } else {
-    th1 = atan2(hom.tran.y, hom.tran.x) - atan2(d23, sqrt(sum_sq));
+    th1 = atan2(hom->tran.y, hom->tran.x) - atan2(d23, sqrt(sum_sq));
   }
 
   /* save sin, cos for later calcs */
@@ -338,9 +455,9 @@ go_result three21_kin_inv(three21_kin_struct *kins,
   /* Joint 3 (2 independent solutions) */
 
   k = (sum_sq
-       + hom.tran.z * hom.tran.z
+       + hom->tran.z * hom->tran.z
        + kins->a1 * kins->a1
-       - 2 * kins->a1 * (c1 * hom.tran.x + s1 * hom.tran.y)
+       - 2 * kins->a1 * (c1 * hom->tran.x + s1 * hom->tran.y)
        - kins->a2 * kins->a2
        - kins->a3 * kins->a3
        - kins->d4 * kins->d4) / (2.0 * kins->a2);
@@ -352,74 +469,77 @@ go_result three21_kin_inv(three21_kin_struct *kins,
     th3 = atan2(kins->a3, kins->d4) - atan2(k, sqrt(kins->a3 * kins->a3 + kins->d4 * kins->d4 - k * k));
   }
 
-  /* compute sin, cos for later calcs */
-  go_sincos(th3, &s3, &c3);
-
-  /* Joint 2 */
-
-  t1 = (-kins->a3 - kins->a2 * c3) * hom.tran.z + (c1 * hom.tran.x + s1 * hom.tran.y - kins->a1) * (kins->a2 * s3 - kins->d4);
-  t2 = (kins->a2 * s3 - kins->d4) * hom.tran.z + (kins->a3 + kins->a2 * c3) * (c1 * hom.tran.x + s1 * hom.tran.y - kins->a1);
-  t3 = hom.tran.z * hom.tran.z + (c1 * hom.tran.x + s1 * hom.tran.y - kins->a1) * (c1 * hom.tran.x + s1 * hom.tran.y - kins->a1);
-
-  th23 = atan2(t1, t2);
-  th2 = th23 - th3;
+  /* Joints 2, 4, 5 and 6 */
+  retval = three21_inv_arm_wrist(kins, hom, th1, s1, c1, th3, joints);
+  if (GO_RESULT_OK != retval) return retval;
 
-  /* compute sin, cos for later calcs */
-  s23 = t1 / t3;
-  c23 = t2 / t3;
-
-  /* Joint 4 */
-
-  t1 = -hom.rot.z.x * s1 + hom.rot.z.y * c1;
-  t2 = -hom.rot.z.x * c1 * c23 - hom.rot.z.y * s1 * c23 + hom.rot.z.z * s23;
-  if (fabs(t1) < SINGULAR_FUZZ && fabs(t2) < SINGULAR_FUZZ) {
-    return GO_RESULT_SINGULAR;
+  if (kins->iflags & THREE21_WRIST_FLIP) {
+    three21_inv_flip(joints, joints);
   }
 
-  th4 = atan2(t1, t2);
-
-  /* compute sin, cos for later calcs */
-  s4 = sin(th4);
-  c4 = cos(th4);
-
-  /* Joint 5 */
+  return GO_RESULT_OK;
+}
 
-  s5 = hom.rot.z.z * (s23 * c4) -
-    hom.rot.z.x * (c1 * c23 * c4 + s1 * s4) -
-    hom.rot.z.y * (s1 * c23 * c4 - c1 * s4);
-  c5 = -hom.rot.z.x * (c1 * s23) - hom.rot.z.y *
-    (s1 * s23) - hom.rot.z.z * c23;
-  th5 = atan2(s5, c5);
+/*
+  All the solutions, as three21_kin_inv would give for each setting
+  of the flags, but with the terms that don't depend on a flag worked
+  out once. Shoulder and elbow solutions that don't exist, and elbow
+  solutions whose wrist is singular, are left out.
+*/
+go_result three21_kin_inv_all(three21_kin_struct *kins,
+			      const go_pose *world,
+			      go_real *joints,
+			      go_flag *iflags,
+			      go_integer *count)
+{
+  go_hom hom;
+  go_real k, sum_sq, d23, r, rr;
+  go_real base, elbow;
+  go_real th1, th3;
+  go_real s1, c1;
+  go_real *sol;
+  go_integer shoulder, down;
 
-  /* Joint 6 */
+  go_pose_hom_convert(world, &hom);
 
-  s6 = hom.rot.x.z * (s23 * s4) - hom.rot.x.x *
-    (c1 * c23 * s4 - s1 * c4) - hom.rot.x.y * (s1 * c23 * s4 + c1 * c4);
-  c6 = hom.rot.x.x * ((c1 * c23 * c4 + s1 * s4) *
-		      c5 - c1 * s23 * s5) + hom.rot.x.y *
-    ((s1 * c23 * c4 - c1 * s4) * c5 - s1 * s23 * s5) -
-    hom.rot.x.z * (s23 * c4 * c5 + c23 * s5);
-  th6 = atan2(s6, c6);
+  *count = 0;
 
-  /*
-     Is wrist flip the normal or offset result? Absent agreement on
-     this, we'll just define it ourselves.
-   */
-  if (kins->iflags & THREE21_WRIST_FLIP) {
-    th4 = th4 + GO_PI;
-    th5 = -th5;
-    th6 = th6 + GO_PI;
+  d23 = kins->d2 + kins->d3;
+  sum_sq = hom.tran.x * hom.tran.x
+    + hom.tran.y * hom.tran.y 
+    - d23 * d23;
+  if (sum_sq < 0.0) return GO_RESULT_DOMAIN_ERROR;
+  r = sqrt(sum_sq);
+  base = atan2(hom.tran.y, hom.tran.x);
+  elbow = atan2(kins->a3, kins->d4);
+
+  for (shoulder = 0; shoulder < 2; shoulder++) {
+    th1 = base - atan2(d23, shoulder ? -r : r);
+    go_sincos(th1, &s1, &c1);
+
+    k = (sum_sq
+	 + hom.tran.z * hom.tran.z
+	 + kins->a1 * kins->a1
+	 - 2 * kins->a1 * (c1 * hom.tran.x + s1 * hom.tran.y)
+	 - kins->a2 * kins->a2
+	 - kins->a3 * kins->a3
+	 - kins->d4 * kins->d4) / (2.0 * kins->a2);
+    rr = kins->a3 * kins->a3 + kins->d4 * kins->d4 - k * k;
+    if (rr < 0.0) continue;
+    rr = sqrt(rr);
+
+    for (down = 0; down < 2; down++) {
+      th3 = elbow - atan2(k, down ? -rr : rr);
+      sol = &joints[*count * THREE21_KIN_NUM_JOINTS];
+      if (GO_RESULT_OK != three21_inv_arm_wrist(kins, &hom, th1, s1, c1, th3, sol)) continue;
+      iflags[*count] = (shoulder ? THREE21_SHOULDER_RIGHT : 0) | (down ? THREE21_ELBOW_DOWN : 0);
+      three21_inv_flip(sol, sol + THREE21_KIN_NUM_JOINTS);
+      iflags[*count + 1] = iflags[*count] | THREE21_WRIST_FLIP;
+      *count += 2;
+    }
   }
 
-  /* copy out */
-  joints[0] = th1;
-  joints[1] = th2;
-  joints[2] = th3;
-  joints[3] = th4;
-  joints[4] = th5;
-  joints[5] = th6;
-
-  return GO_RESULT_OK;
+  return *count > 0 ? GO_RESULT_OK : GO_RESULT_DOMAIN_ERROR;
 }
 
 go_kin_type three21_kin_get_type(three21_kin_struct *kins)
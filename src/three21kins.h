@@ -66,6 +66,29 @@ extern go_result three21_kin_inv(three21_kin_struct *kins,
 				 const go_pose *world,
 				 go_real *joints);
 
+/*
+  These are as three21_kin_fwd and three21_kin_inv, but on the
+  homogeneous transform, for kinematics built on these that work with
+  it directly. The forward doesn't set the flags.
+*/
+extern go_result three21_kin_fwd_hom(three21_kin_struct *kins,
+				     const go_real *joints,
+				     go_hom *hom);
+
+extern go_result three21_kin_inv_hom(three21_kin_struct *kins,
+				     const go_hom *hom,
+				     go_real *joints);
+
+/*
+  Fills 'joints' with up to 8 solutions, one after another, and
+  'iflags' with the flags that give each, setting 'count'.
+*/
+extern go_result three21_kin_inv_all(three21_kin_struct *kins,
+				     const go_pose *world,
+				     go_real *joints,
+				     go_flag *iflags,
+				     go_integer *count);
+
 extern go_kin_type three21_kin_get_type(three21_kin_struct *kins); 
 
 extern go_result three21_kin_set_parameters(three21_kin_struct *kins, go_link *params, go_integer num);
@@ -231,6 +231,7 @@ int main(int argc, char *argv[])
   traj_stat_struct pp_traj_stat[2], * traj_stat_ptr, * traj_stat_test;
   void * tmp;
   go_pose Xinvim1, Xinv, Ai, Ainvi, Ni;
+  go_pose NinvAim1;
   go_real cartmag, quatmag;
   double end;
   int start_it;
@@ -371,6 +372,7 @@ int main(int argc, char *argv[])
 
   signal(SIGINT, quit);
   done = 0;
+  NinvAim1 = go_pose_identity();
 
   while (! done) {
     /*
@@ -394,12 +396,21 @@ int main(int argc, char *argv[])
 
     /* run our fwd kins using controller's actual joints to get actual
        position A(i) */
-    Ai = Ni;			/* need an estimate for convergence */
+    /*
+      Iterative kins need an estimate for convergence. We're too slow
+      to extrapolate A itself from cycle to cycle, but the offset from
+      nominal to actual changes slowly, so take A(i) to be about N(i)
+      Ninv(i-1) A(i-1).
+    */
+    go_pose_pose_mult(&Ni, &NinvAim1, &Ai);
     if (GO_RESULT_OK != go_kin_fwd(kinematics,
 				   traj_stat_ptr->joints_act,
 				   &Ai)) {
       fprintf(stderr, "%s: warning: can't calculate fwd kins\n", BN);
+      NinvAim1 = go_pose_identity();
     } else {
+      go_pose_inv(&Ni, &NinvAim1);
+      go_pose_pose_mult(&NinvAim1, &Ai, &NinvAim1);
       /* compute the rest of Xinv(i) = Ainv(i) N(i) Xinv(i-1) */
       go_pose_inv(&Ai, &Ainvi);
       go_pose_pose_mult(&Ainvi, &Xinv, &Xinv);
@@ -45,6 +45,8 @@ enum {
   TRAJ_CMD_TELEOP_WORLD_TYPE,
   TRAJ_CMD_TELEOP_TOOL_TYPE,
   TRAJ_CMD_HERE_TYPE,
+  TRAJ_CMD_STREAM_WORLD_TYPE,
+  TRAJ_CMD_MOVE_SPLINE_TYPE,
   TRAJ_CMD_STUB_TYPE
 };
 
@@ -65,6 +67,8 @@ enum {
 (x) == TRAJ_CMD_TELEOP_WORLD_TYPE ? "Teleop World" : \
 (x) == TRAJ_CMD_TELEOP_TOOL_TYPE ? "Teleop Tool" : \
 (x) == TRAJ_CMD_HERE_TYPE ? "Here" : \
+(x) == TRAJ_CMD_STREAM_WORLD_TYPE ? "Stream World" : \
+(x) == TRAJ_CMD_MOVE_SPLINE_TYPE ? "Move Spline" : \
 (x) == TRAJ_CMD_STUB_TYPE ? "Stub" : "?"
 
 enum {
@@ -116,6 +120,9 @@ enum {
   and jerk. If \a time is not positive, then the motion parameters \a
   tv, \a ta, \a tj, \a rv, \a ra and \a rj are used for the
   translational and rotational vel, accel and jerk, respectively.
+  If \a tol is positive, the move will be blended into the next one
+  if it arrives in time, cutting the corner by no more than \a tol.
+  If \a tol is negative, the configured blend tolerance is used.
 */
 typedef struct {
   go_integer id;		/*!< motion id */
@@ -127,6 +134,8 @@ typedef struct {
   go_cart center;		/*!< vector to center, for circles  */
   go_cart normal;		/*!< normal vector, for circles */
   go_integer turns;		/*!< how many turns, for circles  */
+  go_real tol;			/*!< blend tolerance, 0 for exact stop,
+				  negative for the configured default */
 } traj_cmd_move_world;
 
 /*!
@@ -173,6 +182,43 @@ typedef struct {
   go_flag home[SERVO_NUM];
 } traj_cmd_move_ujoint;
 
+/*!
+  The most control points in one spline move command.
+*/
+#define TRAJ_CMD_SPLINE_MAX 128
+
+/*!
+  The \a traj_cmd_move_spline moves the mechanism along a smooth curve
+  from where the last move ends to the end pose of \a move, shaped by
+  the \a count control points in between, in world coordinates.
+  The curve is a uniform cubic B-spline, and stays within the hull of
+  its control points. Other than its type, which is ignored, \a move
+  is handled like a \a traj_cmd_move_world, with the translation
+  following the length along the curve. One of these can replace the
+  many short linear moves that would otherwise approximate the curve.
+
+  The control points themselves go in the \a traj_cmd_spline, which
+  must be written before the command is sent.
+*/
+typedef struct {
+  traj_cmd_move_world move;	/*!< id, speeds, end pose and tolerance */
+  go_integer count;		/*!< how many control points there are */
+} traj_cmd_move_spline;
+
+/*!
+  The control points of the spline move whose id is \a id. These are
+  kept out of the command buffer, which Traj copies every cycle, and
+  are read once when the spline move command arrives. Traj refuses the
+  move unless \a id and \a count match the command's.
+*/
+typedef struct {
+  unsigned char head;
+  go_integer id;		/*!< id of the spline move these are for */
+  go_integer count;		/*!< how many control points are valid */
+  go_cart point[TRAJ_CMD_SPLINE_MAX]; /*!< the control points, in order */
+  unsigned char tail;
+} traj_cmd_spline;
+
 /*!
   traj_cmd_teleop_joint gives an array of joint speeds, accelerations
   for immediate following in joint space. The controller will clamp
@@ -257,6 +303,7 @@ typedef struct {
     traj_cmd_teleop_world teleop_world;
     traj_cmd_teleop_tool teleop_tool;
     traj_cmd_here here;
+    traj_cmd_move_spline move_spline;
     traj_cmd_stub stub;
   } u;
   unsigned char tail;
@@ -265,6 +312,21 @@ typedef struct {
 enum {TRAJ_WORLD_FRAME = 1,
       TRAJ_JOINT_FRAME};
 
+/*!
+  Iteration counts of the kinematics each cycle, for kinematics that
+  solve iteratively. The average is over all calls until there have
+  been \a TRAJ_KIN_STAT_WINDOW of them, and after that weights the
+  most recent that many or so.
+*/
+#define TRAJ_KIN_STAT_WINDOW 1000
+
+typedef struct {
+  go_integer calls;		/*!< calls counted, up to the window */
+  go_integer last;		/*!< iterations the last call took */
+  go_integer max;		/*!< the most any call took */
+  go_real avg;			/*!< the average per call */
+} traj_kin_stat;
+
 typedef struct {
   unsigned char head;
   GO_RCS_STAT_MSG;
@@ -275,6 +337,11 @@ typedef struct {
   go_real cycle_time;		/*!< actual cycle time */
   go_pose ecp;			/*!< the commanded end control point */
   go_pose ecp_act;		/*!< the actual end control point */
+  /*!
+    The \a heartbeat the forward kinematics last solved \a ecp_act on.
+    On other cycles it's extrapolated from the last two solutions.
+  */
+  go_integer ecp_act_stamp;
   go_pose kcp;			/*!< the kinematic control point */
   go_pose xinv;			/*!< inverse of nominal-to-actual transform */
   go_real joints[SERVO_NUM];	/*!< the commanded joints (offset) */
@@ -298,6 +365,14 @@ typedef struct {
   go_real joint_offsets[SERVO_NUM];
   go_mmavg mmavg;
   go_integer queue_count;	/*<! how many moves on the motion queue  */
+  go_real queue_time;	/*<! planned time left for moves on the queue */
+  go_real planned_time;	/*<! planned time of all moves so far, done or queued */
+  go_integer ring_get;		/*<! how far Traj has taken moves off the ring */
+  go_integer ring_credits;	/*<! how many moves past \a ring_get Traj can queue */
+  traj_kin_stat kin_fwd;	/*<! forward kinematics iterations, for \a ecp_act */
+  traj_kin_stat kin_inv;	/*<! inverse kinematics iterations, for world moves */
+  go_integer kin_cache_hits;	/*<! move end solutions taken from the cache */
+  go_integer kin_cache_misses;	/*<! inverse solutions the cache didn't have */
   unsigned char tail;
 } traj_stat_struct;
 
@@ -325,6 +400,7 @@ typedef struct {
   go_real max_rvel;
   go_real max_racc;
   go_real max_rjerk;
+  go_real blend_tol;		/*!< default path blending tolerance */
 } traj_cfg_profile;
 
 /* The kinematics implementation will know what to do with these
@@ -332,6 +408,12 @@ typedef struct {
 typedef struct {
   go_link parameters[SERVO_NUM];
   go_integer num;		/*!< how many there are */
+  go_integer predict;		/*!< order of the seed predictor, 0 for none */
+  go_integer fwd_every;	/*!< cycles between forward solutions, 1 for each */
+  go_integer cache_size;	/*!< inverse solutions to cache, 0 for none */
+  go_real cache_resolution;	/*!< what cached translations are rounded to */
+  go_real cache_rot_resolution;	/*!< what cached rotations are rounded to */
+  go_flag nearest;		/*!< solve move ends on the nearest branch */
 } traj_cfg_kinematics;
 
 typedef struct {
@@ -399,6 +481,7 @@ typedef struct {
   go_real max_rvel;
   go_real max_racc;
   go_real max_rjerk;
+  go_real blend_tol;		/*!< default path blending tolerance */
   /*! these are the current values  */
   go_real scale;		/*!< speed scale factor */
   go_real scale_v;		/*!< d(scale)/dt */
@@ -411,6 +494,12 @@ typedef struct {
   go_integer log_which;		/*!< which part we're logging, e.g, X */
   go_integer log_logging;	/*!< are we logging */
   go_integer queue_size;	/*!< how big the motion queue is */
+  go_integer kin_predict;	/*!< order of the kinematics seed predictor */
+  go_integer kin_fwd_every;	/*!< cycles between forward solutions for \a ecp_act */
+  go_integer kin_cache_size;	/*!< inverse solutions cached, 0 for none */
+  go_real kin_cache_resolution;	/*!< what cached translations are rounded to */
+  go_real kin_cache_rot_resolution; /*!< what cached rotations are rounded to */
+  go_flag kin_nearest;		/*!< move ends are solved on the nearest branch */
   unsigned char tail;
 } traj_set_struct;
 
@@ -425,12 +514,58 @@ typedef struct {
   unsigned char tail;
 } traj_ref_struct;
 
+/*!
+  The command ring streams world moves from a single producer, Task,
+  to a single consumer, Traj, alongside the single command buffer.
+  Task puts moves at \a put and Traj takes them from \a get, each
+  side writing only its own index. One entry is always left empty,
+  so \a put equal to \a get means the ring is empty.
+
+  Moves on the ring are run while Traj's current command is
+  TRAJ_CMD_STREAM_WORLD, which Task sends through the command buffer
+  as usual. Any other new command drops what's left on the ring.
+
+  The indices are padded onto their own cache lines so the producer
+  and consumer don't contend for them. The producer writes the move
+  before publishing the new \a put, and the consumer reads the move
+  before publishing the new \a get, with a TRAJ_RING_BARRIER() between
+  to keep the processor from reordering them.
+*/
+#define TRAJ_CMD_RING_SIZE 256
+#define TRAJ_RING_CACHE_LINE 64
+
+#if defined(__GNUC__)
+#define TRAJ_RING_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+/* x86 doesn't reorder stores with stores or loads with loads, so
+   stopping the compiler from doing so is enough */
+#define TRAJ_RING_BARRIER() _ReadWriteBarrier()
+#else
+#define TRAJ_RING_BARRIER()
+#endif
+
+typedef struct {
+  char pad0[TRAJ_RING_CACHE_LINE];
+  go_integer put;		/*!< next entry to fill, written by Task */
+  char pad1[TRAJ_RING_CACHE_LINE];
+  go_integer get;		/*!< next entry to take, written by Traj */
+  char pad2[TRAJ_RING_CACHE_LINE];
+  traj_cmd_move_world move[TRAJ_CMD_RING_SIZE];
+} traj_cmd_ring;
+
+#define traj_ring_next(i) (((i) + 1) % TRAJ_CMD_RING_SIZE)
+#define traj_ring_count(r) (((r)->put - (r)->get + TRAJ_CMD_RING_SIZE) % TRAJ_CMD_RING_SIZE)
+#define traj_ring_room(r) (TRAJ_CMD_RING_SIZE - 1 - traj_ring_count(r))
+
 typedef struct {
   traj_cmd_struct traj_cmd;
   traj_stat_struct traj_stat;
   traj_cfg_struct traj_cfg;
   traj_set_struct traj_set;
   traj_ref_struct traj_ref;
+  traj_cmd_ring traj_ring;
+  traj_cmd_spline traj_spline;
 } traj_comm_struct;
 
 #ifdef __cplusplus
@@ -445,6 +580,10 @@ extern traj_comm_struct * global_traj_comm_ptr;
 typedef struct {
   go_integer joint_num;		/*!< The number of joints, needed by the traj loop during initialization */
   void * kinematics;		/*!< Space for the kinematics calculations, allocated and set by gomain prior to starting the traj loop. */
+  go_motion_spec * queue_space;	/*!< Space for the motion queue, allocated in shared memory by gomain prior to starting the traj loop. */
+  go_integer queue_size;	/*!< How many motions fit in \a queue_space */
+  go_motion_spline_point * points_space; /*!< Space for the control points of spline moves, allocated along with \a queue_space. */
+  go_integer points_size;	/*!< How many points fit in \a points_space */
 } traj_arg_struct;
 
 extern void traj_loop(void * arg);
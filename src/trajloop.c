@@ -113,11 +113,13 @@
 #include <math.h>		/* fabs */
 #include <rtapi.h>
 #include "go.h"
+#include "gomathinline.h"	/* go_pose_pose_mult_i, ... */
 #include "gorcs.h"
 #include "gokin.h"		
 #include "golog.h"		/* go_log_entry,add, ... */
 #include "goio.h"		/* go_io_struct */
 #include "trajintf.h"
+#include "trajplan.h"		/* traj_plan_move_world, ... */
 #include "servointf.h"		/* servo_comm, servo_sem */
 
 #define BN "trajloop"
@@ -177,6 +179,195 @@ static void shift_joints(go_real *joints, go_real *last, go_integer num, void *k
   }
 }
 
+static void copy_joints(go_real * dst, go_real * src, go_integer howmany)
+{
+  go_integer servo_num;
+
+  if (howmany > SERVO_NUM) howmany = SERVO_NUM;
+
+  for (servo_num = 0; servo_num < howmany; servo_num++) {
+    dst[servo_num] = src[servo_num];
+  }
+
+  return;
+}
+
+/*
+  The predictors for seeding the inverse kinematics of world moves,
+  and the forward kinematics for the actual position, from the last
+  few cycles' solutions, to order \a kin_predict in the settings.
+*/
+static go_kin_predictor kin_inv_predictor;
+static go_kin_predictor kin_fwd_predictor;
+
+/*
+  The cache of inverse kinematics solutions for the ends of world
+  moves, for cells that go to the same poses again and again. When
+  it's on, each move's end is checked as it's appended, so one that
+  can't be reached is refused then rather than partway along. A
+  cached solution is only used if each joint is within KIN_CACHE_JUMP
+  of where the move before ends, less than the distance to another
+  solution. The cycle-by-cycle solutions don't use it.
+*/
+static go_kin_cache kin_cache;
+#define KIN_CACHE_JUMP 0.1
+#define DEFAULT_KIN_CACHE_RESOLUTION 1.0e-6
+#define DEFAULT_KIN_CACHE_ROT_RESOLUTION 1.0e-6
+
+/* world move ends are solved when they're queued if either is on */
+#define CHECK_MOVE_ENDS(set) (kin_cache.size > 0 || (set)->kin_nearest)
+
+/* the joints at the end of the last world move appended */
+static go_real end_joints[SERVO_NUM];
+
+static void kin_stat_add(traj_kin_stat * kstat, go_integer iterations)
+{
+  if (kstat->calls < TRAJ_KIN_STAT_WINDOW) kstat->calls++;
+  kstat->last = iterations;
+  if (iterations > kstat->max) kstat->max = iterations;
+  kstat->avg += (iterations - kstat->avg) / kstat->calls;
+}
+
+static void kin_stat_init(traj_kin_stat * kstat)
+{
+  kstat->calls = 0;
+  kstat->last = 0;
+  kstat->max = 0;
+  kstat->avg = 0.0;
+}
+
+/*
+  Runs the inverse kinematics for this cycle's 'kcp', seeded with
+  'joints' or what the predictor makes of the last few cycles, and
+  shifts the result to the revolution nearest the current joints.
+*/
+static go_result traj_kin_inv(traj_stat_struct * stat, traj_set_struct * set, void * kinematics, const go_pose * kcp, go_real * joints)
+{
+  go_result retval;
+
+  go_kin_predict_joints(&kin_inv_predictor, stat->heartbeat, set->joint_num, joints);
+  retval = go_kin_inv(kinematics, kcp, joints);
+  kin_stat_add(&stat->kin_inv, go_kin_inv_iterations(kinematics));
+  if (GO_RESULT_OK != retval) return retval;
+  shift_joints(joints, stat->joints, set->joint_num, kinematics);
+
+  go_kin_predict_joints_add(&kin_inv_predictor, stat->heartbeat, set->joint_num, joints);
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Solves for the joints at the end pose 'end' of a world move, from
+  the joints in 'joints' where the move before ends, taking them from
+  the cache if it has them. On success 'joints' holds the solution.
+  With 'kin_nearest' set this is the solution on whichever branch is
+  nearest those joints, rather than on the branch the inverse flags
+  give.
+*/
+static go_result check_move_end(traj_stat_struct * stat, traj_set_struct * set, void * kinematics, const go_pose * end, go_real * joints)
+{
+  go_pose kcp;
+  go_real seed[SERVO_NUM];
+  go_result retval;
+
+  kcp = go_pose_pose_mult_i(end, &set->tool_transform_inv);
+  retval = go_kin_cache_get(&kin_cache, kinematics, &kcp, joints);
+  if (GO_RESULT_OK != retval) {
+    copy_joints(seed, joints, set->joint_num);
+    if (set->kin_nearest) {
+      retval = go_kin_inv_nearest(kinematics, &kcp, NULL, joints, NULL);
+    } else {
+      retval = go_kin_inv(kinematics, &kcp, joints);
+    }
+    if (GO_RESULT_OK == retval) {
+      shift_joints(joints, seed, set->joint_num, kinematics);
+      go_kin_cache_put(&kin_cache, kinematics, &kcp, joints);
+    }
+  }
+  stat->kin_cache_hits = kin_cache.hits;
+  stat->kin_cache_misses = kin_cache.misses;
+
+  return retval;
+}
+
+/*
+  Sets 'joints' to where the last world move on the queue ends, or to
+  the current joints if the queue is empty.
+*/
+static void seed_move_end(traj_stat_struct * stat, traj_set_struct * set, go_motion_queue * queue, go_real * joints)
+{
+  copy_joints(joints, go_motion_queue_is_empty(queue) ? stat->joints : end_joints, set->joint_num);
+}
+
+/*
+  The last two forward kinematics solutions for the actual position,
+  newest first, and the cycles they were solved on. When they're
+  solved only every \a kin_fwd_every cycles, the actual position on
+  the cycles between is extrapolated from these.
+*/
+static go_pose kin_fwd_kcp[2];
+static go_integer kin_fwd_stamp[2];
+static go_integer kin_fwd_number = 0;
+
+/*
+  Runs the forward kinematics for this cycle's actual joints, seeded
+  with 'kcp_act' or what the predictor makes of the last few
+  solutions. The predictor's stamp counts solutions rather than
+  cycles, so it extrapolates across the cycles skipped between them.
+*/
+static go_result traj_kin_fwd(traj_stat_struct * stat, traj_set_struct * set, void * kinematics, go_pose * kcp_act)
+{
+  go_integer stamp;
+  go_result retval;
+
+  stamp = stat->heartbeat / set->kin_fwd_every;
+  go_kin_predict_pose(&kin_fwd_predictor, stamp, kcp_act);
+  retval = go_kin_fwd(kinematics, stat->joints_act, kcp_act);
+  kin_stat_add(&stat->kin_fwd, go_kin_fwd_iterations(kinematics));
+  if (GO_RESULT_OK != retval) return retval;
+
+  go_kin_predict_pose_add(&kin_fwd_predictor, stamp, kcp_act);
+  kin_fwd_kcp[1] = kin_fwd_kcp[0];
+  kin_fwd_stamp[1] = kin_fwd_stamp[0];
+  kin_fwd_kcp[0] = *kcp_act;
+  kin_fwd_stamp[0] = stat->heartbeat;
+  if (kin_fwd_number < 2) kin_fwd_number++;
+  stat->ecp_act_stamp = stat->heartbeat;
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Extrapolates the actual position for this cycle from the last two
+  forward solutions, at their rate of change in translation and about
+  the axis between their rotations. If they weren't solved in turn,
+  say since one failed, the last one is held instead.
+*/
+static void traj_kin_fwd_extrapolate(traj_stat_struct * stat, traj_set_struct * set, go_pose * kcp_act)
+{
+  go_real s;
+  go_cart dp;
+  go_quat dq;
+  go_rvec rvec;
+
+  *kcp_act = kin_fwd_kcp[0];
+  if (kin_fwd_number < 2 ||
+      kin_fwd_stamp[0] - kin_fwd_stamp[1] != set->kin_fwd_every) return;
+
+  s = (go_real) (stat->heartbeat - kin_fwd_stamp[0]) / set->kin_fwd_every;
+
+  dp = go_cart_cart_sub_i(&kin_fwd_kcp[0].tran, &kin_fwd_kcp[1].tran);
+  dp = go_cart_scale_mult_i(&dp, s);
+  kcp_act->tran = go_cart_cart_add_i(&kin_fwd_kcp[0].tran, &dp);
+
+  dq = go_quat_inv_i(&kin_fwd_kcp[1].rot);
+  dq = go_quat_quat_mult_i(&kin_fwd_kcp[0].rot, &dq);
+  go_quat_rvec_convert(&dq, &rvec);
+  go_rvec_scale_mult(&rvec, s, &rvec);
+  go_rvec_quat_convert(&rvec, &dq);
+  kcp_act->rot = go_quat_quat_mult_i(&dq, &kin_fwd_kcp[0].rot);
+}
+
 static void write_servo_cmd(servo_cmd_struct * servo_cmd, go_integer servo_num)
 {
   servo_cmd[servo_num].tail = ++servo_cmd[servo_num].head;
@@ -399,8 +590,8 @@ static go_pose walk_in(traj_stat_struct * stat, traj_set_struct * set, traj_ref_
   rincr = WALK_IN_SCALE * set->max_rvel * set->cycle_time;
 
   curinv = stat->xinv;
-  go_pose_inv(&curinv, &curinvinv);
-  go_pose_pose_mult(&curinvinv, &ref->xinv, &del);
+  curinvinv = go_pose_inv_i(&curinv);
+  del = go_pose_pose_mult_i(&curinvinv, &ref->xinv);
 
   if (GO_RESULT_OK != go_cart_unit(&del.tran, &uvec)) {
     del.tran.x = del.tran.y = del.tran.z = 0.0;
@@ -420,7 +611,7 @@ static go_pose walk_in(traj_stat_struct * stat, traj_set_struct * set, traj_ref_
     go_quat_scale_mult(&uquat, rdel, &del.rot);
   }
 
-  (void) go_pose_pose_mult(&curinv, &del, &curinv);
+  curinv = go_pose_pose_mult_i(&curinv, &del);
 
   return curinv;
 }
@@ -470,20 +661,18 @@ static void do_cmd_stop(traj_stat_struct * stat, traj_set_struct * set, traj_ref
 	stat->ecp = ecp.u.pose;
 #ifdef USE_XINV
 	stat->xinv = walk_in(stat, set, ref);
-	go_pose_pose_mult(&ecp.u.pose, &stat->xinv, &ecp.u.pose);
+	ecp.u.pose = go_pose_pose_mult_i(&ecp.u.pose, &stat->xinv);
 #endif
 	/* convert from ECP to KCP to before using the kinematics */
-	go_pose_pose_mult(&ecp.u.pose, &set->tool_transform_inv, &kcp);
+	kcp = go_pose_pose_mult_i(&ecp.u.pose, &set->tool_transform_inv);
 	for (servo_num = 0; servo_num < set->joint_num; servo_num++) {
 	  joints[servo_num] = stat->joints[servo_num]; /* seed the estimate */
 	}
-	if (GO_RESULT_OK != go_kin_inv(kinematics, &kcp, joints)) {
+	if (GO_RESULT_OK != traj_kin_inv(stat, set, kinematics, &kcp, joints)) {
 	  rtapi_print("trajloop: do_cmd_stop: can't invert\n");
 	  go_status_next(stat, GO_RCS_STATUS_ERROR);
 	  go_state_next(stat, GO_RCS_STATE_S0);
 	} else {
-	  /* shift joints to nearest revolution */
-	  shift_joints(joints, stat->joints, set->joint_num, kinematics);
 	  for (servo_num = 0; servo_num < set->joint_num; servo_num++) {
 	    stat->joints[servo_num] = joints[servo_num];
 	    servo_cmd[servo_num].type = SERVO_CMD_SERVO_TYPE;
@@ -542,19 +731,6 @@ static go_flag all_home_clear(traj_set_struct * set, servo_stat_struct * servo_s
   return 1;
 }
 
-static void copy_joints(go_real * dst, go_real * src, go_integer howmany)
-{
-  go_integer servo_num;
-
-  if (howmany > SERVO_NUM) howmany = SERVO_NUM;
-
-  for (servo_num = 0; servo_num < howmany; servo_num++) {
-    dst[servo_num] = src[servo_num];
-  }
-
-  return;
-}
-
 static void do_cmd_here(traj_cmd_struct * cmd, traj_stat_struct * stat, traj_set_struct * set, servo_cmd_struct * servo_cmd, servo_stat_struct * servo_stat, servo_cfg_struct * servo_cfg, servo_set_struct * servo_set, void * kinematics, go_motion_queue * queue)
 {
   go_real joints[SERVO_NUM];
@@ -789,10 +965,60 @@ static void do_cmd_move_ujoint(traj_cmd_struct * cmd, traj_stat_struct * stat, t
   }
 }
 
-static void do_cmd_move_joint(traj_cmd_struct * cmd, traj_stat_struct * stat, traj_set_struct * set, servo_cmd_struct * servo_cmd, servo_stat_struct * servo_stat, servo_set_struct * servo_set, go_motion_queue * queue)
+/*
+  Returns non-zero if there's room on the motion queue for another
+  move.
+*/
+static go_flag queue_has_room(go_motion_queue * queue)
+{
+  go_integer size;
+  go_integer number;
+
+  go_motion_queue_size(queue, &size);
+  go_motion_queue_number(queue, &number);
+
+  return size > number;
+}
+
+static go_result append_move_joint(traj_cmd_move_joint * move, traj_set_struct * set, servo_stat_struct * servo_stat, servo_set_struct * servo_set, go_motion_queue * queue)
 {
   go_integer servo_num;
   go_motion_spec gms;
+
+  go_motion_spec_init(&gms);
+  go_motion_spec_set_id(&gms, move->id);
+  go_motion_spec_set_type(&gms, GO_MOTION_JOINT);
+  if (move->time > GO_REAL_EPSILON) {
+    go_motion_spec_set_time(&gms, move->time);
+  }
+  for (servo_num = 0; servo_num < set->joint_num; servo_num++) {
+    /* clamp joint position to lie within limits, if this
+       joint is homed */
+    if (servo_stat[servo_num].homed) {
+      if (move->d[servo_num] > servo_set[servo_num].max_limit) {
+	gms.end.u.joint[servo_num] = servo_set[servo_num].max_limit;
+	CMD_PRINT_4("traj: clamping joint %d down from %f to %f\n", (int) servo_num, (double) move->d[servo_num], (double) servo_set[servo_num].max_limit);
+      } else if (move->d[servo_num] < servo_set[servo_num].min_limit) {
+	gms.end.u.joint[servo_num] = servo_set[servo_num].min_limit;
+	CMD_PRINT_4("traj: clamping joint %d up from %f to %f\n", (int) servo_num, (double) move->d[servo_num], (double) servo_set[servo_num].min_limit);
+      } else {
+	gms.end.u.joint[servo_num] = move->d[servo_num];
+      }
+    } else {
+      gms.end.u.joint[servo_num] = move->d[servo_num];
+    }
+    go_motion_spec_set_jpar(&gms, servo_num,
+			    move->v[servo_num],
+			    move->a[servo_num],
+			    move->j[servo_num]);
+  }
+
+  return go_motion_queue_append(queue, &gms);
+}
+
+static void do_cmd_move_joint(traj_cmd_struct * cmd, traj_stat_struct * stat, traj_set_struct * set, servo_cmd_struct * servo_cmd, servo_stat_struct * servo_stat, servo_set_struct * servo_set, go_motion_queue * queue)
+{
+  go_integer servo_num;
   go_position position;
 
   /* NEW_COMMAND */
@@ -830,34 +1056,7 @@ static void do_cmd_move_joint(traj_cmd_struct * cmd, traj_stat_struct * stat, tr
     if (cmd->u.move_joint.id !=
 	go_motion_queue_last_id(queue)) {
       /* a new set to append */
-      go_motion_spec_init(&gms);
-      go_motion_spec_set_id(&gms, cmd->u.move_joint.id);
-      go_motion_spec_set_type(&gms, GO_MOTION_JOINT);
-      if (cmd->u.move_joint.time > GO_REAL_EPSILON) {
-	go_motion_spec_set_time(&gms, cmd->u.move_joint.time);
-      }
-      for (servo_num = 0; servo_num < set->joint_num; servo_num++) {
-	/* clamp joint position to lie within limits, if this
-	   joint is homed */
-	if (servo_stat[servo_num].homed) {
-	  if (cmd->u.move_joint.d[servo_num] > servo_set[servo_num].max_limit) {
-	    gms.end.u.joint[servo_num] = servo_set[servo_num].max_limit;
-	    CMD_PRINT_4("traj: clamping joint %d down from %f to %f\n", (int) servo_num, (double) cmd->u.move_joint.d[servo_num], (double) servo_set[servo_num].max_limit);
-	  } else if (cmd->u.move_joint.d[servo_num] < servo_set[servo_num].min_limit) {
-	    gms.end.u.joint[servo_num] = servo_set[servo_num].min_limit;
-	    CMD_PRINT_4("traj: clamping joint %d up from %f to %f\n", (int) servo_num, (double) cmd->u.move_joint.d[servo_num], (double) servo_set[servo_num].min_limit);
-	  } else {
-	    gms.end.u.joint[servo_num] = cmd->u.move_joint.d[servo_num];
-	  }
-	} else {
-	  gms.end.u.joint[servo_num] = cmd->u.move_joint.d[servo_num];
-	}
-	go_motion_spec_set_jpar(&gms, servo_num,
-				cmd->u.move_joint.v[servo_num],
-				cmd->u.move_joint.a[servo_num],
-				cmd->u.move_joint.j[servo_num]);
-      }
-      if (GO_RESULT_OK != go_motion_queue_append(queue, &gms)) {
+      if (GO_RESULT_OK != append_move_joint(&cmd->u.move_joint, set, servo_stat, servo_set, queue)) {
 	rtapi_print("trajloop: can't append joint move\n");
 	stat->inpos = 1;
 	go_status_next(stat, GO_RCS_STATUS_ERROR);
@@ -891,41 +1090,6 @@ static void do_cmd_move_joint(traj_cmd_struct * cmd, traj_stat_struct * stat, tr
   }
 }
 
-static go_result clamp_pose(go_pose * pose, const go_pose * min, const go_pose * max)
-{
-  go_rpy inrpy, minrpy, maxrpy;
-  go_result retval;
-
-  if (pose->tran.x < min->tran.x) pose->tran.x = min->tran.x;
-  else if (pose->tran.x > max->tran.x) pose->tran.x = max->tran.x;
-  if (pose->tran.y < min->tran.y) pose->tran.y = min->tran.y;
-  else if (pose->tran.y > max->tran.y) pose->tran.y = max->tran.y;
-  if (pose->tran.z < min->tran.z) pose->tran.z = min->tran.z;
-  else if (pose->tran.z > max->tran.z) pose->tran.z = max->tran.z;
-
-  /* FIXME -- the naive algorithm doesn't work due to RPY values going
-   into and out of quaternions not being unique */
-  return GO_RESULT_OK;
-
-#if 0
-  retval = go_quat_rpy_convert(&pose->rot, &inrpy);
-  if (GO_RESULT_OK != retval) return retval;
-  retval = go_quat_rpy_convert(&min->rot, &minrpy);
-  if (GO_RESULT_OK != retval) return retval;
-  retval = go_quat_rpy_convert(&max->rot, &maxrpy);
-  if (GO_RESULT_OK != retval) return retval;
-
-  if (inrpy.r < minrpy.r) inrpy.r = minrpy.r;
-  else if (inrpy.r > maxrpy.r) inrpy.r = maxrpy.r;
-  if (inrpy.p < minrpy.p) inrpy.p = minrpy.p;
-  else if (inrpy.p > maxrpy.p) inrpy.p = maxrpy.p;
-  if (inrpy.y < minrpy.y) inrpy.y = minrpy.y;
-  else if (inrpy.y > maxrpy.y) inrpy.y = maxrpy.y;
-
-  return go_rpy_quat_convert(&inrpy, &pose->rot);
-#endif
-}
-
 static go_result clamp_vel(const go_pose * pose, go_vel * vel, const go_pose * min, const go_pose * max)
 {
   go_rpy inrpy, minrpy, maxrpy;
@@ -955,27 +1119,171 @@ static go_result clamp_vel(const go_pose * pose, go_vel * vel, const go_pose * m
   return GO_RESULT_OK;
 }
 
+/*
+  Fills in 'gms' for either the 'move_world' or 'move_tool' move,
+  depending on 'world', with its end clamped to the limits. Tool moves
+  are made into world moves from where the queue ends.
+*/
+static go_result make_move_world_or_tool(go_flag world, traj_cmd_move_world * move_world, traj_cmd_move_tool * move_tool, traj_set_struct * set, go_motion_queue * queue, go_motion_spec * gmsout)
+{
+  traj_cmd_move_world move;
+  go_position ecp;
+
+  if (world) {
+    move = *move_world;
+  } else {
+    move.id = move_tool->id;
+    move.type = move_tool->type;
+    move.time = move_tool->time;
+    move.tv = move_tool->tv;
+    move.ta = move_tool->ta;
+    move.tj = move_tool->tj;
+    move.rv = move_tool->rv;
+    move.ra = move_tool->ra;
+    move.rj = move_tool->rj;
+    /* tool moves are relative to where the last one ends, so stop */
+    move.tol = 0.0;
+    /*
+      The 'end' pose is in the end frame, i.e.,
+
+      E
+      .end
+
+      We need to convert this to a pose in the world (0) frame:
+
+      0    E      0
+      .T *  end =  end
+      E
+    */
+    /* get the ECP as the end of the queue */
+    go_motion_queue_there(queue, &ecp);
+    /* do the pose multiply to get 'end' in the world frame */
+    go_pose_pose_mult(&ecp.u.pose, &move_tool->end, &move.end);
+    if (move.type == GO_MOTION_CIRCULAR) {
+      go_pose_cart_mult(&ecp.u.pose, &move_tool->center, &move.center);
+      go_pose_cart_mult(&ecp.u.pose, &move_tool->normal, &move.normal);
+      move.turns = move_tool->turns;
+    }
+  }
+
+  /* gongccheck plans with this too, so programs are checked as run */
+  (void) traj_plan_move_world(&move, set, gmsout);
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Fills in 'gms' and 'points' for the spline move 'move_spline', with
+  its end and control points clamped to the limits. The points are
+  taken from the shared traj_cmd_spline, which must be for this
+  move and not in the middle of being written.
+*/
+static go_result make_move_spline(traj_cmd_move_spline * move_spline, traj_set_struct * set, go_motion_spec * gmsout, go_cart * points)
+{
+  static traj_cmd_spline spline;
+  traj_cmd_move_world * move;
+  traj_cmd_move_world world;
+  go_integer t;
+
+  move = &move_spline->move;
+  if (move_spline->count < 0 ||
+      move_spline->count > TRAJ_CMD_SPLINE_MAX) return GO_RESULT_BAD_ARGS;
+
+  spline = global_traj_comm_ptr->traj_spline;
+  if (spline.head != spline.tail ||
+      spline.id != move->id ||
+      spline.count != move_spline->count) return GO_RESULT_BAD_ARGS;
+
+  /*
+    Clamp the end and the control points to the limits. The curve
+    stays within the hull of its control points, so this keeps the
+    whole move inside.
+  */
+  world = *move;
+  world.type = GO_MOTION_SPLINE;
+  (void) traj_plan_move_world(&world, set, gmsout);
+  for (t = 0; t < move_spline->count; t++) {
+    points[t] = spline.point[t];
+    (void) traj_plan_clamp_cart(&points[t], &set->min_limit.tran, &set->max_limit.tran);
+  }
+
+  return GO_RESULT_OK;
+}
+
+/*
+  Appends moves from the command ring to the motion queue while there's
+  room, returning the result of the first one that can't be appended.
+  With the kinematics cache on, each end is checked first.
+*/
+static go_result drain_traj_ring(traj_stat_struct * stat, traj_set_struct * set, void * kinematics, go_motion_queue * queue)
+{
+  traj_cmd_ring * ring;
+  go_motion_spec gms;
+  go_real joints[SERVO_NUM];
+  go_integer put;
+  go_integer get;
+  go_result retval;
+
+  ring = &global_traj_comm_ptr->traj_ring;
+  put = ring->put;
+  /* make sure we see the moves Task wrote before it moved 'put' */
+  TRAJ_RING_BARRIER();
+
+  retval = GO_RESULT_OK;
+  for (get = ring->get; get != put && queue_has_room(queue); get = traj_ring_next(get)) {
+    retval = make_move_world_or_tool(1, &ring->move[get], NULL, set, queue, &gms);
+    if (GO_RESULT_OK != retval) break;
+    if (CHECK_MOVE_ENDS(set)) {
+      seed_move_end(stat, set, queue, joints);
+      retval = check_move_end(stat, set, kinematics, &gms.end.u.pose, joints);
+      if (GO_RESULT_OK != retval) break;
+    }
+    retval = go_motion_queue_append(queue, &gms);
+    if (GO_RESULT_OK != retval) break;
+    if (CHECK_MOVE_ENDS(set)) copy_joints(end_joints, joints, set->joint_num);
+  }
+
+  /* finish reading the moves before giving their space back to Task */
+  TRAJ_RING_BARRIER();
+  ring->get = get;
+
+  return retval;
+}
+
 static void do_cmd_move_world_or_tool(go_flag world, traj_cmd_struct * cmd, traj_stat_struct * stat, traj_set_struct * set, traj_ref_struct * ref, servo_cmd_struct * servo_cmd, servo_stat_struct * servo_stat, void * kinematics, go_motion_queue * queue)
 {
   go_motion_spec gms;
   go_position ecp;
-  go_pose end;
-  go_cart center;
-  go_cart normal;
   go_real joints[SERVO_NUM];
-  go_real tv, ta, tj;
-  go_real rv, ra, rj;
-  go_real time;
+  go_real end[SERVO_NUM];
+  go_cart points[TRAJ_CMD_SPLINE_MAX];
+  traj_cmd_move_world * move = NULL;
   go_integer id;
-  go_integer turns;
   go_integer servo_num;
-  go_flag is_circular;
+  go_flag stream;
+  go_flag spline;
+  go_result retval;
 
-  id = world ? cmd->u.move_world.id : cmd->u.move_tool.id;
-  is_circular = (cmd->u.move_tool.type == GO_MOTION_CIRCULAR);
+  stream = (TRAJ_CMD_STREAM_WORLD_TYPE == cmd->type);
+  spline = (TRAJ_CMD_MOVE_SPLINE_TYPE == cmd->type);
+  if (stream) {
+    /* the moves come from the command ring, not the command */
+    id = 0;
+  } else if (spline) {
+    id = cmd->u.move_spline.move.id;
+  } else if (world) {
+    move = &cmd->u.move_world;
+    id = move->id;
+  } else {
+    id = cmd->u.move_tool.id;
+  }
 
   if (go_state_match(stat, GO_RCS_STATE_NEW_COMMAND)) {
-    CMD_PRINT_3("traj: cmd move %s (%f ...)\n", world ? "world" : "tool", (double) cmd->u.move_world.end.tran.x);
+    if (stream) {
+      CMD_PRINT_1("traj: cmd stream world\n");
+    } else {
+      CMD_PRINT_3("traj: cmd move %s (%f ...)\n", spline ? "spline" : world ? "world" : "tool", (double) (spline ? cmd->u.move_spline.move.end.tran.x : world ? move->end.tran.x : cmd->u.move_tool.end.tran.x));
+    }
     go_state_new(stat);
     if (stat->admin_state == GO_RCS_ADMIN_STATE_INITIALIZED &&
 	stat->homed) {
@@ -993,7 +1301,7 @@ static void do_cmd_move_world_or_tool(go_flag world, traj_cmd_struct * cmd, traj
 	go_motion_queue_set_here(queue, &ecp);
       }
       /* make sure this move registers as new */
-      go_motion_queue_set_id(queue, id - 1);
+      if (! stream) go_motion_queue_set_id(queue, id - 1);
       go_status_next(stat, GO_RCS_STATUS_EXEC);
       go_state_next(stat, GO_RCS_STATE_S1);
     } else {
@@ -1005,96 +1313,48 @@ static void do_cmd_move_world_or_tool(go_flag world, traj_cmd_struct * cmd, traj
   }
 
   if (go_state_match(stat, GO_RCS_STATE_S1)) {
-    if (id != go_motion_queue_last_id(queue)) {
-      if (world) {
-	time = cmd->u.move_world.time;
-	tv = cmd->u.move_world.tv;
-	ta = cmd->u.move_world.ta;
-	tj = cmd->u.move_world.tj;
-	rv = cmd->u.move_world.rv;
-	ra = cmd->u.move_world.ra;
-	rj = cmd->u.move_world.rj;
-	end = cmd->u.move_world.end;
-	if (is_circular) {
-	  center = cmd->u.move_world.center;
-	  normal = cmd->u.move_world.normal;
-	  turns = cmd->u.move_world.turns;
-	}
-      } else {
-	time = cmd->u.move_tool.time;
-	tv = cmd->u.move_tool.tv;
-	ta = cmd->u.move_tool.ta;
-	tj = cmd->u.move_tool.tj;
-	rv = cmd->u.move_tool.rv;
-	ra = cmd->u.move_tool.ra;
-	rj = cmd->u.move_tool.rj;
-	end = cmd->u.move_tool.end;
-	/*
-	  The 'end' pose is in the end frame, i.e.,
-
-	  E
-	  .end
-
-	  We need to convert this to a pose in the world (0) frame:
-
-	  0    E      0
-	  .T *  end =  end
-	  E
-	*/
-	/* get the ECP as the end of the queue */
-	go_motion_queue_there(queue, &ecp);
-	/* do the pose multiply to get 'end' in the world frame */
-	go_pose_pose_mult(&ecp.u.pose, &cmd->u.move_tool.end, &end);
-	if (is_circular) {
-	  go_pose_cart_mult(&ecp.u.pose, &cmd->u.move_tool.center, &center);
-	  go_pose_cart_mult(&ecp.u.pose, &cmd->u.move_tool.normal, &normal);
-	  turns = cmd->u.move_tool.turns;
-	}
-      }
-
-      /*
-	Clamp the values to the limits. This doesn't check the whole
-	circular move, just the end.
-	FIXME-- check the whole circular move against limits.
-      */
-      if (GO_RESULT_OK != 
-	  clamp_pose(&end,
-		     &set->min_limit,
-		     &set->max_limit)) {
+    if (stream) {
+      if (GO_RESULT_OK != drain_traj_ring(stat, set, kinematics, queue)) {
+	rtapi_print("trajloop: can't append streamed world move\n");
 	stat->inpos = 1;
 	go_status_next(stat, GO_RCS_STATUS_ERROR);
 	go_state_next(stat, GO_RCS_STATE_S0);
 	return;
-      } 
-      /* now 'end' is in the world frame, clamped to be inside limits */
-
-      go_motion_spec_init(&gms);
-      go_motion_spec_set_id(&gms, id);
-      go_motion_spec_set_end_pose(&gms, &end);
-
-      if (is_circular) {
-	go_motion_spec_set_type(&gms, GO_MOTION_CIRCULAR);
-	go_motion_spec_set_cpar(&gms, &center, &normal, turns);
-      } else {
-	go_motion_spec_set_type(&gms, GO_MOTION_LINEAR);
+      } else if (! go_motion_queue_is_empty(queue)) {
+	/* more moves came in after we were done */
+	go_status_next(stat, GO_RCS_STATUS_EXEC);
       }
-
-      if (time > GO_REAL_EPSILON) {
-	go_motion_spec_set_tpar(&gms, set->max_tvel, set->max_tacc, set->max_tjerk);
-	go_motion_spec_set_rpar(&gms, set->max_rvel, set->max_racc, set->max_rjerk);
-	go_motion_spec_set_time(&gms, time);
+    } else if (id != go_motion_queue_last_id(queue)) {
+      if (spline) {
+	retval = make_move_spline(&cmd->u.move_spline, set, &gms, points);
       } else {
-	go_motion_spec_set_tpar(&gms, tv, ta, tj);
-	go_motion_spec_set_rpar(&gms, rv, ra, rj);
-	/* no need to set time for move; it's handled automatically
-	   by go_motion_spec_init() as the default */
+	retval = make_move_world_or_tool(world, move, &cmd->u.move_tool, set, queue, &gms);
       }
-      if (GO_RESULT_OK != go_motion_queue_append(queue, &gms)) {
-	rtapi_print("trajloop: can't append %s move\n", world ? "world" : "tool");
+      if (GO_RESULT_OK == retval && CHECK_MOVE_ENDS(set)) {
+	seed_move_end(stat, set, queue, end);
+	if (GO_RESULT_OK != check_move_end(stat, set, kinematics, &gms.end.u.pose, end)) {
+	  rtapi_print("trajloop: can't reach the end of %s move\n", spline ? "spline" : world ? "world" : "tool");
+	  stat->inpos = 1;
+	  go_status_next(stat, GO_RCS_STATUS_ERROR);
+	  go_state_next(stat, GO_RCS_STATE_S0);
+	  return;
+	}
+      }
+      if (GO_RESULT_OK == retval) {
+	if (spline) {
+	  retval = go_motion_queue_append_spline(queue, &gms, points, cmd->u.move_spline.count);
+	} else {
+	  retval = go_motion_queue_append(queue, &gms);
+	}
+      }
+      if (GO_RESULT_OK != retval) {
+	rtapi_print("trajloop: can't append %s move\n", spline ? "spline" : world ? "world" : "tool");
 	stat->inpos = 1;
 	go_status_next(stat, GO_RCS_STATUS_ERROR);
 	go_state_next(stat, GO_RCS_STATE_S0);
+	return;
       }
+      if (CHECK_MOVE_ENDS(set)) copy_joints(end_joints, end, set->joint_num);
     }
     /* else the id hasn't changed, so ignore this move */
 
@@ -1110,23 +1370,21 @@ static void do_cmd_move_world_or_tool(go_flag world, traj_cmd_struct * cmd, traj
       /* walk in any Xinv inputs to avoid jumps */
       stat->xinv = walk_in(stat, set, ref);
       /* adjust the nominal ECP to get one that goes out */
-      go_pose_pose_mult(&ecp.u.pose, &stat->xinv, &ecp.u.pose);
+      ecp.u.pose = go_pose_pose_mult_i(&ecp.u.pose, &stat->xinv);
       /* FIXME-- should we keep track of the adjusted ECP separately?
 	 We're overwriting it here. */
 #endif
       /* convert from ECP to KCP to before using the kinematics */
-      go_pose_pose_mult(&ecp.u.pose, &set->tool_transform_inv, &stat->kcp);
+      stat->kcp = go_pose_pose_mult_i(&ecp.u.pose, &set->tool_transform_inv);
       for (servo_num = 0; servo_num < set->joint_num; servo_num++) {
 	joints[servo_num] = stat->joints[servo_num]; /* seed the estimate */
       }
-      if (GO_RESULT_OK != go_kin_inv(kinematics, &stat->kcp, joints)) {
+      if (GO_RESULT_OK != traj_kin_inv(stat, set, kinematics, &stat->kcp, joints)) {
 	rtapi_print("trajloop: do_cmd_move_world_or_tool: can't invert\n");
 	stat->inpos = 1;
 	go_status_next(stat, GO_RCS_STATUS_ERROR);
 	go_state_next(stat, GO_RCS_STATE_S0);
       } else {
-	/* shift joints to nearest revolution */
-	shift_joints(joints, stat->joints, set->joint_num, kinematics);
 	stat->inpos = go_motion_queue_is_empty(queue);
 	if (stat->inpos) {
 	  go_status_next(stat, GO_RCS_STATUS_DONE);
@@ -1172,33 +1430,26 @@ static void do_cmd_track_world(traj_cmd_struct * cmd, traj_stat_struct * stat, t
     /* recall that the tracked position is in the ECP frame */
     ecp = cmd->u.track_world.position;
     /* clamp the values to the limits */
-    if (GO_RESULT_OK != 
-	clamp_pose(&ecp,
-		   &set->min_limit,
-		   &set->max_limit)) {
-      stat->inpos = 1;
-      go_status_next(stat, GO_RCS_STATUS_ERROR);
-      go_state_next(stat, GO_RCS_STATE_S0);
-      return;
-    } 
+    (void) traj_plan_clamp_pose(&ecp, &set->min_limit, &set->max_limit);
     /* keep the commanded position synchronized */
     stat->ecp = ecp;
 #ifdef USE_XINV
     stat->xinv = walk_in(stat, set, ref);
-    go_pose_pose_mult(&ecp, &stat->xinv, &ecp);
+    ecp = go_pose_pose_mult_i(&ecp, &stat->xinv);
     /* FIXME-- as with moves, should we keep track of the adjusted ECP
        separately? */
 #endif
     /* convert from ECP to KCP to before using the kinematics */
-    go_pose_pose_mult(&ecp, &set->tool_transform_inv, &kcp);
-    if (GO_RESULT_OK != go_kin_inv(kinematics, &kcp, joints)) {
+    kcp = go_pose_pose_mult_i(&ecp, &set->tool_transform_inv);
+    for (servo_num = 0; servo_num < set->joint_num; servo_num++) {
+      joints[servo_num] = stat->joints[servo_num]; /* seed the estimate */
+    }
+    if (GO_RESULT_OK != traj_kin_inv(stat, set, kinematics, &kcp, joints)) {
       rtapi_print("trajloop: can't invert\n");
       stat->inpos = 1;
       go_status_next(stat, GO_RCS_STATUS_ERROR);
       go_state_next(stat, GO_RCS_STATE_S0);
     } else {
-      /* shift joints to nearest revolution */
-      shift_joints(joints, stat->joints, set->joint_num, kinematics);
       for (servo_num = 0; servo_num < set->joint_num; servo_num++) {
 	stat->joints[servo_num] = joints[servo_num];
 	servo_cmd[servo_num].type = SERVO_CMD_SERVO_TYPE;
@@ -1395,9 +1646,9 @@ static void do_cmd_teleop_world_or_tool(go_flag world, traj_cmd_struct * cmd, tr
   if (go_state_match(stat, GO_RCS_STATE_S1)) {
     if (! world) {
       /* rotate the tran part from the tool frame to the ECP frame */
-      go_quat_cart_mult(&stat->ecp_act.rot, &tv.v, &tv.v);
+      tv.v = go_quat_cart_mult_i(&stat->ecp_act.rot, &tv.v);
       /* rotate the rot part likewise */
-      go_quat_cart_mult(&stat->ecp_act.rot, &tv.w, &tv.w);
+      tv.w = go_quat_cart_mult_i(&stat->ecp_act.rot, &tv.w);
     }
 
     /* inhibit speeds that take the device outside its limits, using
@@ -1428,7 +1679,7 @@ static void do_cmd_teleop_world_or_tool(go_flag world, traj_cmd_struct * cmd, tr
     go_pose_vel_mult(&set->tool_transform, world_teleop_speed, &tvk);
 
     /* convert ECP to KCP for position estimate to inverse Jacobian */
-    go_pose_pose_mult(&stat->ecp_act, &set->tool_transform_inv, &kcp_act);
+    kcp_act = go_pose_pose_mult_i(&stat->ecp_act, &set->tool_transform_inv);
 
     /* run the inverse Jacobian */
     retval = go_kin_jac_inv(kinematics,
@@ -1630,6 +1881,7 @@ static void do_cfg_profile(traj_cfg_struct * cfg, traj_set_struct * set)
     set->max_rvel = cfg->u.profile.max_rvel;
     set->max_racc = cfg->u.profile.max_racc;
     set->max_rjerk = cfg->u.profile.max_rjerk;
+    set->blend_tol = cfg->u.profile.blend_tol;
     go_status_next(set, GO_RCS_STATUS_DONE);
     go_state_next(set, GO_RCS_STATE_S0);
   } else {
@@ -1647,6 +1899,28 @@ static void do_cfg_kinematics(traj_cfg_struct * cfg, traj_set_struct * set, void
     retval = go_kin_set_parameters(kins,
 				   cfg->u.kinematics.parameters,
 				   cfg->u.kinematics.num);
+    if (GO_RESULT_OK == retval) {
+      retval = go_kin_predict_init(&kin_inv_predictor, cfg->u.kinematics.predict);
+    }
+    if (GO_RESULT_OK == retval) {
+      /* the old solutions are for the old parameters */
+      retval = go_kin_cache_init(&kin_cache,
+				 cfg->u.kinematics.cache_size,
+				 cfg->u.kinematics.num,
+				 cfg->u.kinematics.cache_resolution,
+				 cfg->u.kinematics.cache_rot_resolution,
+				 KIN_CACHE_JUMP);
+    }
+    if (GO_RESULT_OK == retval) {
+      go_kin_predict_init(&kin_fwd_predictor, cfg->u.kinematics.predict);
+      set->kin_predict = cfg->u.kinematics.predict;
+      set->kin_fwd_every = cfg->u.kinematics.fwd_every < 1 ? 1 : cfg->u.kinematics.fwd_every;
+      set->kin_cache_size = cfg->u.kinematics.cache_size;
+      set->kin_cache_resolution = cfg->u.kinematics.cache_resolution;
+      set->kin_cache_rot_resolution = cfg->u.kinematics.cache_rot_resolution;
+      set->kin_nearest = cfg->u.kinematics.nearest;
+      kin_fwd_number = 0;
+    }
     if (GO_RESULT_OK != retval) {
       go_status_next(set, GO_RCS_STATUS_ERROR);
     } else {
@@ -1800,6 +2074,8 @@ static void do_cfg_tool_transform(traj_stat_struct * stat, traj_cfg_struct * cfg
       /* now we can clobber the old tool transforms with the new ones */
       set->tool_transform = cfg->u.tool_transform.tool_transform;
       set->tool_transform_inv = inv;
+      /* and drop any solutions that went with the old ones */
+      go_kin_cache_clear(&kin_cache);
       /*
 	if the queue is in world mode, we need to reset its ECP
       */
@@ -1836,10 +2112,10 @@ void traj_loop(void * arg)
   go_integer joint_num;
   void * kinematics;
   go_rpy rpy;
-  enum { TRAJ_MOTION_QUEUE_SIZE = 10};
   go_position position;
   go_pose kcp_act;
-  go_motion_spec traj_motion_queue_space[TRAJ_MOTION_QUEUE_SIZE];
+  go_motion_spec * traj_motion_queue_space;
+  go_integer traj_motion_queue_size;
   go_motion_queue traj_motion_queue;
   go_real deltat = DEFAULT_CYCLE_TIME;
   go_real calc_time;		/* actual time for traj calcs */
@@ -1875,12 +2151,17 @@ void traj_loop(void * arg)
 
   joint_num = ((traj_arg_struct *) arg)->joint_num;
   kinematics = ((traj_arg_struct *) arg)->kinematics;
+  traj_motion_queue_space = ((traj_arg_struct *) arg)->queue_space;
+  traj_motion_queue_size = ((traj_arg_struct *) arg)->queue_size;
 
   if (GO_RESULT_OK != go_init() ||
       GO_RESULT_OK != go_motion_queue_init(&traj_motion_queue,
 					   traj_motion_queue_space, 
-					   TRAJ_MOTION_QUEUE_SIZE,
+					   traj_motion_queue_size,
 					   deltat) ||
+      GO_RESULT_OK != go_motion_queue_set_points(&traj_motion_queue,
+						 ((traj_arg_struct *) arg)->points_space,
+						 ((traj_arg_struct *) arg)->points_size) ||
       GO_RESULT_OK != go_motion_queue_set_type(&traj_motion_queue,
 					       GO_MOTION_JOINT)) {
     rtapi_print("trajloop: can't init traj motion queue\n");
@@ -1950,9 +2231,15 @@ void traj_loop(void * arg)
   traj_stat.frame = TRAJ_JOINT_FRAME;
   traj_stat.inpos = 1;
   go_motion_queue_number(&traj_motion_queue, &traj_stat.queue_count);
+  go_motion_queue_planned_time(&traj_motion_queue, &traj_stat.queue_time, &traj_stat.planned_time);
+  /* start with an empty command ring */
+  global_traj_comm_ptr->traj_ring.get = global_traj_comm_ptr->traj_ring.put;
+  traj_stat.ring_get = global_traj_comm_ptr->traj_ring.get;
+  traj_stat.ring_credits = traj_motion_queue_size;
   traj_stat.cycle_time = DEFAULT_CYCLE_TIME;
   traj_stat.ecp = DEFAULT_POSITION;
   traj_stat.ecp_act = traj_stat.ecp;
+  traj_stat.ecp_act_stamp = 0;
   traj_stat.xinv = traj_ref_ptr->xinv;
   for (servo_num = 0; servo_num < joint_num; servo_num++) {
     traj_stat.joints[servo_num] = DEFAULT_JOINT;
@@ -1961,6 +2248,13 @@ void traj_loop(void * arg)
     traj_stat.joint_offsets[servo_num] = 0.0;
   }
   go_mmavg_init(&traj_stat.mmavg, NULL, 0, traj_timestamp);
+  kin_stat_init(&traj_stat.kin_fwd);
+  kin_stat_init(&traj_stat.kin_inv);
+  go_kin_predict_init(&kin_inv_predictor, 0);
+  go_kin_predict_init(&kin_fwd_predictor, 0);
+  go_kin_cache_init(&kin_cache, 0, joint_num, DEFAULT_KIN_CACHE_RESOLUTION, DEFAULT_KIN_CACHE_ROT_RESOLUTION, KIN_CACHE_JUMP);
+  traj_stat.kin_cache_hits = 0;
+  traj_stat.kin_cache_misses = 0;
   traj_stat.tail = traj_stat.head;
 
   traj_set.head = 0;
@@ -1989,6 +2283,13 @@ void traj_loop(void * arg)
   traj_set.max_rvel = 1.0;
   traj_set.max_racc = 1.0;
   traj_set.max_rjerk = 1.0;
+  traj_set.blend_tol = 0.0;
+  traj_set.kin_predict = 0;
+  traj_set.kin_fwd_every = 1;
+  traj_set.kin_cache_size = 0;
+  traj_set.kin_cache_resolution = DEFAULT_KIN_CACHE_RESOLUTION;
+  traj_set.kin_cache_rot_resolution = DEFAULT_KIN_CACHE_ROT_RESOLUTION;
+  traj_set.kin_nearest = 0;
   traj_set.scale = 1.0;
   traj_set.scale_v = 1.0;
   traj_set.scale_a = 1.0;
@@ -2106,16 +2407,22 @@ void traj_loop(void * arg)
     /* now traj_ref_ptr is where we look for our reference */
 
     /* calculate actual world position, initially using the world
-       position as an estimate */
+       position as an estimate, or extrapolate it on the cycles
+       between solutions if they're not done every cycle */
     if (traj_stat.homed) {
-      kcp_act = traj_stat.kcp;
-      retval = go_kin_fwd(kinematics,
-			  traj_stat.joints_act,
-			  &kcp_act);
+      if (homed_transition ||
+	  kin_fwd_number < 2 ||
+	  traj_stat.heartbeat - traj_stat.ecp_act_stamp >= traj_set.kin_fwd_every) {
+	kcp_act = traj_stat.kcp;
+	retval = traj_kin_fwd(&traj_stat, &traj_set, kinematics, &kcp_act);
+      } else {
+	traj_kin_fwd_extrapolate(&traj_stat, &traj_set, &kcp_act);
+	retval = GO_RESULT_OK;
+      }
       if (0 != retval) {
 	rtapi_print("trajloop: forward kinematics error\n");
       } else {
-	go_pose_pose_mult(&kcp_act, &traj_set.tool_transform, &traj_stat.ecp_act);
+	traj_stat.ecp_act = go_pose_pose_mult_i(&kcp_act, &traj_set.tool_transform);
 	if (homed_transition) {
 	  traj_stat.ecp = traj_stat.ecp_act;
 	}
@@ -2123,7 +2430,7 @@ void traj_loop(void * arg)
     } else {
       traj_stat.ecp = traj_set.home;
       traj_stat.ecp_act = traj_stat.ecp;
-      go_pose_pose_mult(&traj_stat.ecp, &traj_set.tool_transform_inv, &traj_stat.kcp);
+      traj_stat.kcp = go_pose_pose_mult_i(&traj_stat.ecp, &traj_set.tool_transform_inv);
     }
 
     switch (cmd_type) {
@@ -2147,11 +2454,17 @@ void traj_loop(void * arg)
     case TRAJ_CMD_TELEOP_WORLD_TYPE:
     case TRAJ_CMD_TELEOP_TOOL_TYPE:
     case TRAJ_CMD_HERE_TYPE:
+    case TRAJ_CMD_STREAM_WORLD_TYPE:
+    case TRAJ_CMD_MOVE_SPLINE_TYPE:
     case TRAJ_CMD_STUB_TYPE:
       traj_stat.command_type = cmd_type;
       if (cmd_serial_number != traj_stat.echo_serial_number) {
 	traj_stat.echo_serial_number = cmd_serial_number;
 	traj_stat.state = GO_RCS_STATE_NEW_COMMAND;
+	if (TRAJ_CMD_STREAM_WORLD_TYPE != cmd_type) {
+	  /* anything else ends the stream, so drop what's left of it */
+	  global_traj_comm_ptr->traj_ring.get = global_traj_comm_ptr->traj_ring.put;
+	}
       }
       break;
 
@@ -2235,6 +2548,8 @@ void traj_loop(void * arg)
       break;
 
     case TRAJ_CMD_MOVE_WORLD_TYPE:
+    case TRAJ_CMD_STREAM_WORLD_TYPE:
+    case TRAJ_CMD_MOVE_SPLINE_TYPE:
       do_cmd_move_world_or_tool(1, traj_cmd_ptr, &traj_stat, &traj_set, traj_ref_ptr, servo_cmd, servo_stat_ptr[0], kinematics, &traj_motion_queue);
       break;
 
@@ -2338,6 +2653,10 @@ void traj_loop(void * arg)
     /* update status */
     traj_stat.heartbeat++;
     go_motion_queue_number(&traj_motion_queue, &traj_stat.queue_count);
+    go_motion_queue_planned_time(&traj_motion_queue, &traj_stat.queue_time, &traj_stat.planned_time);
+    /* credit Task with the moves we have room for past what we took */
+    traj_stat.ring_get = global_traj_comm_ptr->traj_ring.get;
+    traj_stat.ring_credits = traj_set.queue_size - traj_stat.queue_count;
     rtapi_clock_get_time(&sec, &nsec);
     rtapi_clock_get_interval(old_sec, old_nsec,
 			     sec, nsec,
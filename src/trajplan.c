@@ -0,0 +1,89 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file trajplan.c
+
+  \brief How Traj turns world move commands into motion queue specs.
+*/
+
+#include "go.h"
+#include "gomotion.h"
+#include "trajintf.h"
+#include "trajplan.h"
+
+go_flag traj_plan_clamp_cart(go_cart * cart, const go_cart * min, const go_cart * max)
+{
+  go_cart was = *cart;
+
+  if (cart->x < min->x) cart->x = min->x;
+  else if (cart->x > max->x) cart->x = max->x;
+  if (cart->y < min->y) cart->y = min->y;
+  else if (cart->y > max->y) cart->y = max->y;
+  if (cart->z < min->z) cart->z = min->z;
+  else if (cart->z > max->z) cart->z = max->z;
+
+  return ! go_cart_cart_compare(cart, &was);
+}
+
+go_flag traj_plan_clamp_pose(go_pose * pose, const go_pose * min, const go_pose * max)
+{
+  /* FIXME -- clamping the rotation with the naive algorithm doesn't
+     work due to RPY values going into and out of quaternions not
+     being unique, so it's left alone */
+  return traj_plan_clamp_cart(&pose->tran, &min->tran, &max->tran);
+}
+
+go_flag traj_plan_move_world(const traj_cmd_move_world * move, const traj_set_struct * set, go_motion_spec * spec)
+{
+  go_pose end;
+  go_cart center;
+  go_cart normal;
+  go_flag clamped;
+
+  /*
+    Clamp the values to the limits. This doesn't check the whole
+    circular move, just the end.
+    FIXME-- check the whole circular move against limits.
+  */
+  end = move->end;
+  clamped = traj_plan_clamp_pose(&end, &set->min_limit, &set->max_limit);
+
+  go_motion_spec_init(spec);
+  go_motion_spec_set_id(spec, move->id);
+  go_motion_spec_set_end_pose(spec, &end);
+  go_motion_spec_set_tol(spec, move->tol < 0.0 ? set->blend_tol : move->tol);
+
+  if (GO_MOTION_CIRCULAR == move->type) {
+    center = move->center;
+    normal = move->normal;
+    go_motion_spec_set_type(spec, GO_MOTION_CIRCULAR);
+    go_motion_spec_set_cpar(spec, &center, &normal, move->turns);
+  } else if (GO_MOTION_SPLINE == move->type) {
+    /* the control points go along with it when it's appended */
+    go_motion_spec_set_type(spec, GO_MOTION_SPLINE);
+  } else {
+    go_motion_spec_set_type(spec, GO_MOTION_LINEAR);
+  }
+
+  if (move->time > GO_REAL_EPSILON) {
+    go_motion_spec_set_tpar(spec, set->max_tvel, set->max_tacc, set->max_tjerk);
+    go_motion_spec_set_rpar(spec, set->max_rvel, set->max_racc, set->max_rjerk);
+    go_motion_spec_set_time(spec, move->time);
+  } else {
+    go_motion_spec_set_tpar(spec, move->tv, move->ta, move->tj);
+    go_motion_spec_set_rpar(spec, move->rv, move->ra, move->rj);
+    /* no need to set time for move; it's handled automatically
+       by go_motion_spec_init() as the default */
+  }
+
+  return clamped;
+}
@@ -0,0 +1,68 @@
+/*
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*/
+
+/*!
+  \file trajplan.h
+
+  \brief How Traj turns world move commands into motion queue specs.
+  Traj and gongccheck both plan with these, so a checked program is
+  planned just as it will be run.
+*/
+
+#ifndef TRAJPLAN_H
+#define TRAJPLAN_H
+
+#include "go.h"			/* go_pose */
+#include "gomotion.h"		/* go_motion_spec */
+#include "trajintf.h"		/* traj_cmd_move_world, traj_set_struct */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if 0
+}
+#endif
+
+/*!
+  Clamps \a cart to within \a min and \a max. Returns non-zero if it
+  moved.
+*/
+extern go_flag traj_plan_clamp_cart(go_cart * cart,
+				    const go_cart * min,
+				    const go_cart * max);
+
+/*!
+  Clamps the translation of \a pose to within that of \a min and \a
+  max, leaving the rotation alone. Returns non-zero if it moved.
+*/
+extern go_flag traj_plan_clamp_pose(go_pose * pose,
+				    const go_pose * min,
+				    const go_pose * max);
+
+/*!
+  Fills in \a spec for the linear, circular or spline world move \a
+  move, with its end clamped to the limits in \a set and a negative
+  tolerance replaced with the configured one. A move with a positive
+  time gets the max speeds in \a set, to be scaled to that time.
+  Returns non-zero if the end was clamped.
+*/
+extern go_flag traj_plan_move_world(const traj_cmd_move_world * move,
+				    const traj_set_struct * set,
+				    go_motion_spec * spec);
+
+#if 0
+{
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* TRAJPLAN_H */
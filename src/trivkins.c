@@ -96,6 +96,108 @@ go_result triv_kin_inv(void *kins,
   return GO_RESULT_OK;
 } 
 
+/*
+  The batches copy straight between the arrays, with only the angles
+  going through the conversions.
+*/
+
+go_result triv_kin_fwd_batch(void *kins,
+			     go_integer num,
+			     go_real **joints,
+			     go_pose_batch *world,
+			     go_result *results)
+{
+#ifdef USE_ZYZ
+  go_zyz zyz;
+#else
+  go_rpy rpy;
+#endif
+  go_quat quat;
+  go_integer n;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  for (n = 0; n < num; n++) {
+#ifdef USE_ZYZ
+    zyz.z = joints[3][n];
+    zyz.y = joints[4][n];
+    zyz.zp = joints[5][n];
+    retval = go_zyz_quat_convert(&zyz, &quat);
+#else
+    rpy.r = joints[3][n];
+    rpy.p = joints[4][n];
+    rpy.y = joints[5][n];
+    retval = go_rpy_quat_convert(&rpy, &quat);
+#endif
+    if (GO_RESULT_OK == retval) {
+      world->x[n] = joints[0][n];
+      world->y[n] = joints[1][n];
+      world->z[n] = joints[2][n];
+      world->s[n] = quat.s;
+      world->i[n] = quat.x;
+      world->j[n] = quat.y;
+      world->k[n] = quat.z;
+    } else if (GO_RESULT_OK == first) {
+      first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
+go_result triv_kin_inv_batch(void *kins,
+			     go_integer num,
+			     const go_pose_batch *world,
+			     go_real **joints,
+			     go_result *results)
+{
+#ifdef USE_ZYZ
+  go_zyz zyz;
+#else
+  go_rpy rpy;
+#endif
+  go_quat quat;
+  go_integer n;
+  go_result retval;
+  go_result first = GO_RESULT_OK;
+
+  for (n = 0; n < num; n++) {
+    quat.s = world->s[n];
+    quat.x = world->i[n];
+    quat.y = world->j[n];
+    quat.z = world->k[n];
+#ifdef USE_ZYZ
+    retval = go_quat_zyz_convert(&quat, &zyz);
+    if (GO_RESULT_OK == retval) {
+      joints[0][n] = world->x[n];
+      joints[1][n] = world->y[n];
+      joints[2][n] = world->z[n];
+      joints[3][n] = zyz.z;
+      joints[4][n] = zyz.y;
+      joints[5][n] = zyz.zp;
+    }
+#else
+    retval = go_quat_rpy_convert(&quat, &rpy);
+    if (GO_RESULT_OK == retval) {
+      joints[0][n] = world->x[n];
+      joints[1][n] = world->y[n];
+      joints[2][n] = world->z[n];
+      joints[3][n] = rpy.r;
+      joints[4][n] = rpy.p;
+      joints[5][n] = rpy.y;
+    }
+#endif
+    if (GO_RESULT_OK != retval) {
+      retval = GO_RESULT_ERROR;
+      if (GO_RESULT_OK == first) first = retval;
+    }
+    if (NULL != results) results[n] = retval;
+  }
+
+  return first;
+}
+
 go_kin_type triv_kin_get_type(void *kins)
 {
   return GO_KIN_BOTH;